@@ -69,9 +69,12 @@
 #	else
 #		error UNSUPPORTED DYNAMIC LINKER
 #	endif
-
+#	if defined(HAVE_PTHREAD)
+#		include <pthread.h>
+#	endif
 #endif
 
+static hawk_t* app_hawk = HAWK_NULL; /* set while the workers of --parallel run */
 static hawk_rtx_t* app_rtx = HAWK_NULL;
 static int app_debug = 0;
 
@@ -107,6 +110,8 @@ struct arg_t
 	int incl_conv;
 	hawk_parsestd_t* psin; /* input source streams */
 	hawk_bch_t*   osf;  /* output source file */
+	hawk_bch_t*   cif;  /* compiled image file to produce */
+	hawk_bch_t*   iif;  /* compiled image file to load */
 	xarg_t        icf; /* input console files */
 	xarg_t        ocf; /* output console files */
 	gvm_t         gvm; /* global variable map */
@@ -123,6 +128,11 @@ struct arg_t
 	int          optoff;
 
 	hawk_uintptr_t  memlimit;
+	hawk_oow_t      gc_slice_work;
+	hawk_oow_t      gc_slice_time;
+	hawk_oow_t      arena_size;
+	hawk_oow_t      max_open_outfiles;
+	hawk_oow_t      parallel;
 #if defined(HAWK_BUILD_DEBUG)
 	hawk_uintptr_t  failmalloc;
 #endif
@@ -278,8 +288,8 @@ static void stop_run (int signo)
 	int e = errno;
 #endif
 
-	/*hawk_haltall(hawk_rtx_gethawk(app_rtx));*/
-	hawk_rtx_halt (app_rtx);
+	if (app_hawk) hawk_haltall (app_hawk);
+	else hawk_rtx_halt (app_rtx);
 
 #if !defined(_WIN32) && !defined(__OS2__) && !defined(__DOS__)
 	errno = e;
@@ -524,6 +534,9 @@ struct opttab_t
 	{ "numstrdetect", HAWK_NUMSTRDETECT,   "detect a numeric string and convert it to a number" },
 	{ "strictnaming", HAWK_STRICTNAMING,   "enable the strict naming rule" },
 	{ "tolerant",     HAWK_TOLERANT,       "make more fault-tolerant" },
+	{ "bytecode",     HAWK_BYTECODE,       "compile expressions to register code" },
+	{ "optimize",     HAWK_OPTIMIZE,       "fold constant expressions and drop dead code" },
+	{ "byteio",       HAWK_BYTEIO,         "treat each byte of the standard I/O as a character" },
 	{ HAWK_NULL,      0,                   HAWK_NULL }
 };
 
@@ -543,12 +556,22 @@ static void print_usage (FILE* out, const hawk_bch_t* argv0)
 	fprintf (out, "                                   passed to the function as parameters\n");
 	fprintf (out, " -f/--file            file         set the source script file\n");
 	fprintf (out, " -d/--deparsed-file   file         set the deparsed script file to produce\n");
+	fprintf (out, " --compile            file         set the compiled image file to produce\n");
+	fprintf (out, "                                   the script is not executed\n");
+	fprintf (out, " --image              file         set the compiled image file to load\n");
+	fprintf (out, "                                   the script is parsed if it is stale\n");
 	fprintf (out, " -t/--console-output  file         set the console output file\n");
 	fprintf (out, "                                   multiple -t options are allowed\n");
 	fprintf (out, " -F/--field-separator string       set a field separator(FS)\n");
 	fprintf (out, " -v/--assign          var=value    add a global variable with a value\n");
 	fprintf (out, " -m/--memory-limit    number       limit the memory usage (bytes)\n");
+	fprintf (out, " --gc-slice           number       collect garbage incrementally with the work budget per slice\n");
+	fprintf (out, " --gc-slice-time      number       limit the time of a gc slice (microseconds)\n");
+	fprintf (out, " --arena              number       allocate short-lived strings in per-record arena blocks of the given size\n");
+	fprintf (out, " --max-open-outfiles  number       keep at most the given number of output files open\n");
+	fprintf (out, " --parallel           number       process the input files on the given number of threads if the program has @pragma reduce\n");
 	fprintf (out, " -w                                expand datafile wildcards\n");
+	fprintf (out, " -b                                same as --byteio on\n");
 
 #if defined(HAWK_BUILD_DEBUG)
 	fprintf (out, " -X                   number       fail the number'th memory allocation\n");
@@ -669,14 +692,24 @@ static int process_argv (int argc, hawk_bch_t* argv[], struct arg_t* arg)
 		{ ":numstrdetect",     '\0' },
 		{ ":strictnaming",     '\0' },
 		{ ":tolerant",         '\0' },
+		{ ":bytecode",         '\0' },
+		{ ":optimize",         '\0' },
+		{ ":byteio",           '\0' },
 
 		{ ":call",             'c' },
 		{ ":file",             'f' },
 		{ ":deparsed-file",    'd' },
+		{ ":compile",          '\0' },
+		{ ":image",            '\0' },
 		{ ":console-output",   't' },
 		{ ":field-separator",  'F' },
 		{ ":assign",           'v' },
 		{ ":memory-limit",     'm' },
+		{ ":gc-slice",         '\0' },
+		{ ":gc-slice-time",    '\0' },
+		{ ":arena",            '\0' },
+		{ ":max-open-outfiles", '\0' },
+		{ ":parallel",         '\0' },
 
 		{ ":script-encoding",  '\0' },
 		{ ":console-encoding", '\0' },
@@ -694,9 +727,9 @@ static int process_argv (int argc, hawk_bch_t* argv[], struct arg_t* arg)
 	static hawk_bcli_t opt =
 	{
 #if defined(HAWK_BUILD_DEBUG)
-		"hDc:f:d:t:F:v:m:I:wX:",
+		"hDbc:f:d:t:F:v:m:I:wX:",
 #else
-		"hDc:f:d:t:F:v:m:I:w",
+		"hDbc:f:d:t:F:v:m:I:w",
 #endif
 		lng
 	};
@@ -839,6 +872,13 @@ static int process_argv (int argc, hawk_bch_t* argv[], struct arg_t* arg)
 				break;
 			}
 
+			case 'b':
+			{
+				arg->opton |= HAWK_BYTEIO;
+				arg->optoff &= ~HAWK_BYTEIO;
+				break;
+			}
+
 
 			case 'I':
 			{
@@ -898,6 +938,34 @@ static int process_argv (int argc, hawk_bch_t* argv[], struct arg_t* arg)
 				{
 					arg->modlibdirs = opt.arg;
 				}
+				else if (hawk_comp_bcstr(opt.lngopt, "gc-slice", 0) == 0)
+				{
+					arg->gc_slice_work = strtoul(opt.arg, HAWK_NULL, 10);
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "gc-slice-time", 0) == 0)
+				{
+					arg->gc_slice_time = strtoul(opt.arg, HAWK_NULL, 10);
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "arena", 0) == 0)
+				{
+					arg->arena_size = strtoul(opt.arg, HAWK_NULL, 10);
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "max-open-outfiles", 0) == 0)
+				{
+					arg->max_open_outfiles = strtoul(opt.arg, HAWK_NULL, 10);
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "parallel", 0) == 0)
+				{
+					arg->parallel = strtoul(opt.arg, HAWK_NULL, 10);
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "compile", 0) == 0)
+				{
+					arg->cif = opt.arg;
+				}
+				else if (hawk_comp_bcstr(opt.lngopt, "image", 0) == 0)
+				{
+					arg->iif = opt.arg;
+				}
 				else
 				{
 					for (i = 0; opttab[i].name; i++)
@@ -1120,6 +1188,175 @@ static hawk_mmgr_t debug_mmgr =
 };
 #endif
 
+/* ---------------------------------------------------------------------- */
+
+#if defined(HAVE_PTHREAD)
+typedef struct worker_t worker_t;
+struct worker_t
+{
+	hawk_rtx_t* rtx;
+	hawk_val_t* retv;
+	pthread_t   thr;
+};
+
+static void* run_worker (void* ctx)
+{
+	worker_t* w = (worker_t*)ctx;
+	w->retv = hawk_rtx_loopwithphases(w->rtx, HAWK_RTX_PHASE_BEGIN | HAWK_RTX_PHASE_MAIN);
+	return HAWK_NULL;
+}
+
+/* each worker runs the BEGIN blocks and the pattern-action blocks over
+ * a contiguous chunk of the input files on its own thread. the reduction
+ * variables of the workers are merged into the first worker which runs
+ * the END blocks alone. */
+static int execute_parallel (hawk_t* hawk, arg_t* arg, const hawk_bch_t* id)
+{
+	worker_t* w;
+	hawk_bch_t** files;
+	hawk_oow_t nw, nstarted, i, first, count;
+	hawk_val_t* retv;
+	hawk_int_t tmp;
+	int xcode = 0, ret = -1;
+
+	nw = (arg->parallel < arg->icf.size)? arg->parallel: arg->icf.size;
+
+	w = (worker_t*)calloc(nw, HAWK_SIZEOF(*w));
+	files = (hawk_bch_t**)malloc(HAWK_SIZEOF(*files) * (arg->icf.size + nw));
+	if (!w || !files)
+	{
+		print_error ("out of memory\n");
+		goto oops;
+	}
+
+	hawk_freeze (hawk);
+
+	for (i = 0, first = 0; i < nw; i++)
+	{
+		hawk_bch_t** chunk;
+
+		count = arg->icf.size / nw + (i < arg->icf.size % nw);
+		chunk = &files[first + i]; /* each chunk is terminated by HAWK_NULL */
+		memcpy (chunk, &arg->icf.ptr[first], HAWK_SIZEOF(*chunk) * count);
+		chunk[count] = HAWK_NULL;
+		first += count;
+
+		w[i].rtx = hawk_rtx_openstdwithbcstr(hawk, 0, id, chunk, arg->ocf.ptr, arg->console_cmgr);
+		if (HAWK_UNLIKELY(!w[i].rtx))
+		{
+			print_hawk_error (hawk);
+			goto oops;
+		}
+
+		if (apply_fs_and_gvs_to_rtx(w[i].rtx, arg) <= -1)
+		{
+			print_hawk_rtx_error (w[i].rtx);
+			goto oops;
+		}
+	}
+
+	app_hawk = hawk;
+	set_intr_run ();
+
+	for (nstarted = 0; nstarted < nw; nstarted++)
+	{
+		if (pthread_create(&w[nstarted].thr, HAWK_NULL, run_worker, &w[nstarted]) != 0) break;
+	}
+	if (nstarted < nw) hawk_haltall (hawk);
+	for (i = 0; i < nstarted; i++) pthread_join (w[i].thr, HAWK_NULL);
+
+	if (nstarted < nw)
+	{
+		print_error ("cannot create a thread\n");
+		goto done;
+	}
+
+	for (i = 0; i < nw; i++)
+	{
+		if (!w[i].retv)
+		{
+			print_hawk_rtx_error (w[i].rtx);
+			goto done;
+		}
+
+		/* remember the first non-zero exit code passed to exit */
+		if (xcode == 0 && hawk_rtx_valtoint(w[i].rtx, w[i].retv, &tmp) >= 0) xcode = tmp;
+		hawk_rtx_refdownval (w[i].rtx, w[i].retv);
+		w[i].retv = HAWK_NULL;
+
+		if (i > 0)
+		{
+			if (hawk_rtx_reduce(w[0].rtx, w[i].rtx) <= -1)
+			{
+				print_hawk_rtx_error (w[0].rtx);
+				goto done;
+			}
+			hawk_rtx_close (w[i].rtx);
+			w[i].rtx = HAWK_NULL;
+		}
+	}
+
+	retv = hawk_rtx_loopwithphases(w[0].rtx, HAWK_RTX_PHASE_END);
+	if (!retv)
+	{
+		print_hawk_rtx_error (w[0].rtx);
+		goto done;
+	}
+
+	hawk_rtx_refdownval (w[0].rtx, retv);
+	if (app_debug) dprint_return (w[0].rtx, retv);
+
+	ret = xcode;
+	if (hawk_rtx_valtoint(w[0].rtx, retv, &tmp) >= 0 && tmp != 0) ret = tmp;
+
+done:
+	unset_intr_run ();
+	app_hawk = HAWK_NULL;
+
+oops:
+	if (w)
+	{
+		for (i = 0; i < nw; i++)
+		{
+			if (!w[i].rtx) continue;
+			if (w[i].retv) hawk_rtx_refdownval (w[i].rtx, w[i].retv);
+			hawk_rtx_close (w[i].rtx);
+		}
+		free (w);
+	}
+	if (files) free (files);
+	return ret;
+}
+#endif
+
+static int can_execute_parallel (hawk_t* hawk, arg_t* arg)
+{
+	if (arg->parallel <= 1 || arg->call || arg->icf.size <= 1) return 0;
+
+#if defined(HAVE_PTHREAD)
+	if (!hawk_isreducible(hawk))
+	{
+		print_warning ("--parallel ignored for a program without @pragma reduce\n");
+		return 0;
+	}
+
+	/* the workers can't share output files or the memory limit heap */
+	if (arg->ocf.size > 0 || arg->memlimit > 0)
+	{
+		print_warning ("--parallel ignored with -t or -m\n");
+		return 0;
+	}
+	#if defined(HAWK_BUILD_DEBUG)
+	if (arg->failmalloc > 0) return 0;
+	#endif
+
+	return 1;
+#else
+	print_warning ("--parallel not supported\n");
+	return 0;
+#endif
+}
+
 static HAWK_INLINE int execute_hawk (int argc, hawk_bch_t* argv[])
 {
 	hawk_t* hawk = HAWK_NULL;
@@ -1207,6 +1444,11 @@ static HAWK_INLINE int execute_hawk (int argc, hawk_bch_t* argv[])
 		hawk_setopt (hawk, HAWK_OPT_DEPTH_INCLUDE, &tmp);
 	}
 
+	hawk_setopt (hawk, HAWK_OPT_RTX_GC_SLICE_WORK, &arg.gc_slice_work);
+	hawk_setopt (hawk, HAWK_OPT_RTX_GC_SLICE_TIME, &arg.gc_slice_time);
+	hawk_setopt (hawk, HAWK_OPT_RTX_ARENA_SIZE, &arg.arena_size);
+	hawk_setopt (hawk, HAWK_OPT_RTX_MAX_OPEN_OUTFILES, &arg.max_open_outfiles);
+
 	if (arg.includedirs)
 	{
 	#if defined(HAWK_OOCH_IS_UCH)
@@ -1249,12 +1491,43 @@ static HAWK_INLINE int execute_hawk (int argc, hawk_bch_t* argv[])
 		goto oops;
 	}
 
-	if (hawk_parsestd(hawk, arg.psin, ((arg.osf == HAWK_NULL)? HAWK_NULL: &psout)) <= -1)
+	if (arg.iif && !arg.osf && !arg.cif)
+	{
+		/* the image doesn't hold the source text to deparse */
+		if (hawk_loadimgstd(hawk, arg.psin, arg.iif) <= -1)
+		{
+			print_hawk_error (hawk);
+			goto oops;
+		}
+	}
+	else if (hawk_parsestd(hawk, arg.psin, ((arg.osf == HAWK_NULL)? HAWK_NULL: &psout)) <= -1)
 	{
 		print_hawk_error (hawk);
 		goto oops;
 	}
 
+	if (arg.cif)
+	{
+		if (hawk_saveimgstd(hawk, arg.cif) <= -1)
+		{
+			print_hawk_error (hawk);
+			goto oops;
+		}
+
+		ret = 0;
+		goto oops;
+	}
+
+#if defined(HAVE_PTHREAD)
+	if (can_execute_parallel(hawk, &arg))
+	{
+		ret = execute_parallel(hawk, &arg, argv[0]);
+		goto oops;
+	}
+#else
+	can_execute_parallel (hawk, &arg);
+#endif
+
 	rtx = hawk_rtx_openstdwithbcstr(
 		hawk, 0, argv[0],
 		(arg.call? HAWK_NULL: arg.icf.ptr), /* console input */
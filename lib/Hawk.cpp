@@ -1162,6 +1162,13 @@ Hawk::Value::IndexIterator Hawk::Value::getFirstIndex (Index* idx) const
 	if (iptr == HAWK_NULL) return IndexIterator::END; // no more key
 
 	idx->set (HAWK_VAL_MAP_ITR_KEY(iptr));
+	if (iptr->key.ptr == iptr->_kbuf)
+	{
+		// an integer index in the vector part is formatted into the
+		// iterator. keep it in the index as the iterator is temporary.
+		hawk_copy_oochars (idx->buf, iptr->key.ptr, iptr->key.len);
+		idx->ptr = idx->buf;
+	}
 
 	return itr;
 }
@@ -1181,6 +1188,13 @@ Hawk::Value::IndexIterator Hawk::Value::getNextIndex (Index* idx, const IndexIte
 	if (iptr == HAWK_NULL) return IndexIterator::END; // no more key
 
 	idx->set (HAWK_VAL_MAP_ITR_KEY(iptr));
+	if (iptr->key.ptr == iptr->_kbuf)
+	{
+		// an integer index in the vector part is formatted into the
+		// iterator. keep it in the index as the iterator is temporary.
+		hawk_copy_oochars (idx->buf, iptr->key.ptr, iptr->key.len);
+		idx->ptr = idx->buf;
+	}
 
 	return itr;
 }
@@ -1362,6 +1376,106 @@ int Hawk::Run::getGlobal (int id, Value& g) const
 	return g.setVal ((Run*)this, hawk_rtx_getgbl (this->rtx, id));
 }
 
+void Hawk::Run::getGCStats (hawk_gcstats_t* stats) const
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+	hawk_rtx_getgcstats (this->rtx, stats);
+}
+
+int Hawk::Run::setGCThreshold (int gen, hawk_oow_t threshold)
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+	return hawk_rtx_setgcthreshold(this->rtx, gen, threshold);
+}
+
+int Hawk::Run::loop (Value* ret)
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+
+	hawk_val_t* rv = hawk_rtx_loop(this->rtx);
+	if (rv == HAWK_NULL) return -1;
+
+	ret->setVal (this, rv);
+	hawk_rtx_refdownval (this->rtx, rv);
+	return 0;
+}
+
+int Hawk::Run::call (const hawk_bch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+
+	hawk_val_t* buf[16];
+	hawk_val_t** ptr = HAWK_NULL;
+
+	if (args != HAWK_NULL)
+	{
+		if (nargs <= HAWK_COUNTOF(buf)) ptr = buf;
+		else
+		{
+			ptr = (hawk_val_t**)hawk_rtx_allocmem(this->rtx, HAWK_SIZEOF(hawk_val_t*) * nargs);
+			if (ptr == HAWK_NULL) return -1;
+		}
+
+		for (hawk_oow_t i = 0; i < nargs; i++) ptr[i] = (hawk_val_t*)args[i];
+	}
+
+	hawk_val_t* rv = hawk_rtx_callwithbcstr(this->rtx, name, ptr, nargs);
+
+	if (ptr != HAWK_NULL && ptr != buf) hawk_rtx_freemem (this->rtx, ptr);
+
+	if (rv == HAWK_NULL) return -1;
+
+	ret->setVal (this, rv);
+	hawk_rtx_refdownval (this->rtx, rv);
+	return 0;
+}
+
+int Hawk::Run::call (const hawk_uch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+
+	hawk_val_t* buf[16];
+	hawk_val_t** ptr = HAWK_NULL;
+
+	if (args != HAWK_NULL)
+	{
+		if (nargs <= HAWK_COUNTOF(buf)) ptr = buf;
+		else
+		{
+			ptr = (hawk_val_t**)hawk_rtx_allocmem(this->rtx, HAWK_SIZEOF(hawk_val_t*) * nargs);
+			if (ptr == HAWK_NULL) return -1;
+		}
+
+		for (hawk_oow_t i = 0; i < nargs; i++) ptr[i] = (hawk_val_t*)args[i];
+	}
+
+	hawk_val_t* rv = hawk_rtx_callwithucstr(this->rtx, name, ptr, nargs);
+
+	if (ptr != HAWK_NULL && ptr != buf) hawk_rtx_freemem (this->rtx, ptr);
+
+	if (rv == HAWK_NULL) return -1;
+
+	ret->setVal (this, rv);
+	hawk_rtx_refdownval (this->rtx, rv);
+	return 0;
+}
+
+int Hawk::Run::exec (Value* ret, const Value* args, hawk_oow_t nargs)
+{
+	HAWK_ASSERT (this->rtx != HAWK_NULL);
+
+	int n = (this->rtx->hawk->parse.pragma.entry[0] != '\0')?
+		this->call(this->rtx->hawk->parse.pragma.entry, ret, args, nargs): this->loop(ret);
+
+#if defined(HAWK_ENABLE_GC)
+	/* i assume this function is a usual hawk program starter.
+	 * call garbage collection after a whole program finishes */
+	hawk_rtx_gc (this->rtx, HAWK_RTX_GC_GEN_FULL);
+#endif
+
+	return n;
+}
+
 //////////////////////////////////////////////////////////////////
 // Hawk
 //////////////////////////////////////////////////////////////////
@@ -1720,117 +1834,90 @@ Hawk::Run* Hawk::resetRunContext ()
 	else return HAWK_NULL;
 }
 
-int Hawk::loop (Value* ret)
+void Hawk::freeze ()
 {
 	HAWK_ASSERT (this->hawk != HAWK_NULL);
-	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
-
-	hawk_val_t* rv = hawk_rtx_loop (this->runctx.rtx);
-	if (rv == HAWK_NULL) 
-	{
-		this->retrieveError (&this->runctx);
-		return -1;
-	}
-
-	ret->setVal (&this->runctx, rv);
-	hawk_rtx_refdownval (this->runctx.rtx, rv);
-	
-	return 0;
+	hawk_freeze (this->hawk);
 }
 
-int Hawk::call (const hawk_bch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+bool Hawk::isFrozen () const
 {
 	HAWK_ASSERT (this->hawk != HAWK_NULL);
-	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
+	return !!hawk_isfrozen(this->hawk);
+}
 
-	hawk_val_t* buf[16];
-	hawk_val_t** ptr = HAWK_NULL;
+Hawk::Run* Hawk::openRunContext ()
+{
+	HAWK_ASSERT (this->hawk != HAWK_NULL);
 
-	if (args != HAWK_NULL)
+	// the object lives in the memory of the underlying hawk object
+	// as the Run objects in the values do.
+	void* ptr = hawk_allocmem(this->hawk, HAWK_SIZEOF(Run));
+	if (HAWK_UNLIKELY(!ptr))
 	{
-		if (nargs <= HAWK_COUNTOF(buf)) ptr = buf;
-		else
-		{
-			ptr = (hawk_val_t**)hawk_allocmem(this->hawk, HAWK_SIZEOF(hawk_val_t*) * nargs);
-			if (ptr == HAWK_NULL)
-			{
-				this->runctx.setError (HAWK_ENOMEM);
-				this->retrieveError (&this->runctx);
-				return -1;
-			}
-		}
-
-		for (hawk_oow_t i = 0; i < nargs; i++) ptr[i] = (hawk_val_t*)args[i];
+		this->retrieveError ();
+		return HAWK_NULL;
 	}
 
-	hawk_val_t* rv = hawk_rtx_callwithbcstr(this->runctx.rtx, name, ptr, nargs);
-
-	if (ptr != HAWK_NULL && ptr != buf) hawk_freemem (this->hawk, ptr);
-
-	if (rv == HAWK_NULL) 
+	Run* run = new(this->getMmgr(), ptr) Run(this);
+	hawk_rtx_t* rtx = this->open_rtx(run);
+	if (HAWK_UNLIKELY(!rtx))
 	{
-		this->retrieveError (&this->runctx);
-		return -1;
+		run->~Run ();
+		hawk_freemem (this->hawk, ptr);
+		return HAWK_NULL;
 	}
 
-	ret->setVal (&this->runctx, rv);
+	run->rtx = rtx;
+	return run;
+}
 
-	hawk_rtx_refdownval (this->runctx.rtx, rv);
-	return 0;
+void Hawk::closeRunContext (Run* run)
+{
+	HAWK_ASSERT (run != &this->runctx);
+
+	if (run->rtx) hawk_rtx_close (run->rtx);
+	run->~Run ();
+	hawk_freemem (this->hawk, run);
 }
 
-int Hawk::call (const hawk_uch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+int Hawk::loop (Value* ret)
 {
 	HAWK_ASSERT (this->hawk != HAWK_NULL);
 	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
 
-	hawk_val_t* buf[16];
-	hawk_val_t** ptr = HAWK_NULL;
-
-	if (args != HAWK_NULL)
-	{
-		if (nargs <= HAWK_COUNTOF(buf)) ptr = buf;
-		else
-		{
-			ptr = (hawk_val_t**)hawk_allocmem(this->hawk, HAWK_SIZEOF(hawk_val_t*) * nargs);
-			if (ptr == HAWK_NULL)
-			{
-				this->runctx.setError (HAWK_ENOMEM);
-				this->retrieveError (&this->runctx);
-				return -1;
-			}
-		}
-
-		for (hawk_oow_t i = 0; i < nargs; i++) ptr[i] = (hawk_val_t*)args[i];
-	}
-
-	hawk_val_t* rv = hawk_rtx_callwithucstr(this->runctx.rtx, name, ptr, nargs);
+	int n = this->runctx.loop(ret);
+	if (n <= -1) this->retrieveError (&this->runctx);
+	return n;
+}
 
-	if (ptr != HAWK_NULL && ptr != buf) hawk_freemem (this->hawk, ptr);
+int Hawk::call (const hawk_bch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+{
+	HAWK_ASSERT (this->hawk != HAWK_NULL);
+	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
 
-	if (rv == HAWK_NULL) 
-	{
-		this->retrieveError (&this->runctx);
-		return -1;
-	}
+	int n = this->runctx.call(name, ret, args, nargs);
+	if (n <= -1) this->retrieveError (&this->runctx);
+	return n;
+}
 
-	ret->setVal (&this->runctx, rv);
+int Hawk::call (const hawk_uch_t* name, Value* ret, const Value* args, hawk_oow_t nargs)
+{
+	HAWK_ASSERT (this->hawk != HAWK_NULL);
+	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
 
-	hawk_rtx_refdownval (this->runctx.rtx, rv);
-	return 0;
+	int n = this->runctx.call(name, ret, args, nargs);
+	if (n <= -1) this->retrieveError (&this->runctx);
+	return n;
 }
 
 int Hawk::exec (Value* ret, const Value* args, hawk_oow_t nargs)
 {
-	int n = (this->runctx.rtx->hawk->parse.pragma.entry[0] != '\0')?
-		this->call(this->runctx.rtx->hawk->parse.pragma.entry, ret, args, nargs): this->loop(ret);
-
-#if defined(HAWK_ENABLE_GC)
-        /* i assume this function is a usual hawk program starter.
-         * call garbage collection after a whole program finishes */
-        hawk_rtx_gc (this->runctx.rtx, HAWK_RTX_GC_GEN_FULL);
-#endif
+	HAWK_ASSERT (this->hawk != HAWK_NULL);
+	HAWK_ASSERT (this->runctx.rtx != HAWK_NULL);
 
+	int n = this->runctx.exec(ret, args, nargs);
+	if (n <= -1) this->retrieveError (&this->runctx);
 	return n;
 }
 
@@ -1840,10 +1927,8 @@ void Hawk::halt ()
 	hawk_haltall (this->hawk);
 }
 
-int Hawk::init_runctx () 
+hawk_rtx_t* Hawk::open_rtx (Run* run)
 {
-	if (this->runctx.rtx) return 0;
-
 	hawk_rio_cbs_t rio;
 
 	rio.pipe    = pipeHandler;
@@ -1854,15 +1939,25 @@ int Hawk::init_runctx ()
 	if (HAWK_UNLIKELY(!rtx)) 
 	{
 		this->retrieveError();
-		return -1;
+		return HAWK_NULL;
 	}
 
 	rtx->_instsize += HAWK_SIZEOF(rxtn_t);
-	this->runctx.rtx = rtx;
 
 	rxtn_t* rxtn = GET_RXTN(rtx);
-	rxtn->run = &this->runctx;
+	rxtn->run = run;
+
+	return rtx;
+}
+
+int Hawk::init_runctx () 
+{
+	if (this->runctx.rtx) return 0;
 
+	hawk_rtx_t* rtx = this->open_rtx(&this->runctx);
+	if (HAWK_UNLIKELY(!rtx)) return -1;
+
+	this->runctx.rtx = rtx;
 	return 0;
 }
 
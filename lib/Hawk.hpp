@@ -896,15 +896,6 @@ public:
 			{
 				return this->len;
 			}
-		};
-
-		///
-		/// Represents a numeric index of an arrayed value
-		///
-		class HAWK_EXPORT IntIndex: public Index
-		{
-		public:
-			IntIndex (hawk_int_t num);
 
 		protected:
 			// 2^32: 4294967296
@@ -925,6 +916,15 @@ public:
 		#endif
 		};
 
+		///
+		/// Represents a numeric index of an arrayed value
+		///
+		class HAWK_EXPORT IntIndex: public Index
+		{
+		public:
+			IntIndex (hawk_int_t num);
+		};
+
 		///
 		/// The IndexIterator class is a helper class to make simple
 		/// iteration over array elements.
@@ -946,16 +946,37 @@ public:
 			///
 			IndexIterator ()
 			{
-				hawk_init_map_itr (this, 0);
+				hawk_init_map_itr (&this->_mitr, 0);
+				this->_vi = 0;
+				this->key.ptr = HAWK_NULL;
+				this->key.len = 0;
+				this->val = HAWK_NULL;
+			}
+
+			IndexIterator (const IndexIterator& ii): hawk_val_map_itr_t(ii)
+			{
+				// the key in the vector part points to the buffer inside
+				if (ii.key.ptr == ii._kbuf) this->key.ptr = this->_kbuf;
+			}
+
+			IndexIterator& operator= (const IndexIterator& ii)
+			{
+				hawk_val_map_itr_t::operator= (ii);
+				if (ii.key.ptr == ii._kbuf) this->key.ptr = this->_kbuf;
+				return *this;
 			}
 
 			bool operator== (const IndexIterator& ii) const
 			{
 				// the most common use of this operator is to test it against END
+				if (this->val != ii.val || this->_vi != ii._vi) return false;
+				if (this->_vi != (hawk_oow_t)-1) return true; // in the vector part
 			#if defined(HAWK_MAP_IS_HTB)
-				return this->pair == ii.pair && this->buckno == ii.buckno;
+				return this->_mitr.pair == ii._mitr.pair && this->_mitr.buckno == ii._mitr.buckno;
+			#elif defined(HAWK_MAP_IS_OHT)
+				return this->_mitr.pair == ii._mitr.pair && this->_mitr.slotno == ii._mitr.slotno;
 			#else
-				return this->pair == ii.pair && this->_prev == ii._prev;
+				return this->_mitr.pair == ii._mitr.pair && this->_mitr._prev == ii._mitr._prev;
 			#endif
 			}
 
@@ -1257,6 +1278,59 @@ public:
 		///
 		int getGlobal (int id, Value& v) const;
 
+		///
+		/// The getGCStats() function retrieves the statistics of the
+		/// garbage collector and the value caches.
+		///
+		void getGCStats (hawk_gcstats_t* stats) const;
+
+		///
+		/// The setGCThreshold() function changes the threshold of the
+		/// pressure that triggers the collection of the generation \a gen.
+		/// \return 0 on success, -1 on failure
+		///
+		int setGCThreshold (int gen, hawk_oow_t threshold);
+
+		///
+		/// The loop() function executes the BEGIN block, pattern-action
+		/// blocks, and the END block in this context. The return value
+		/// is stored into \a ret. The error information is kept in this
+		/// context on failure.
+		/// \return 0 on succes, -1 on failure
+		///
+		int loop (
+			Value* ret  ///< return value holder
+		);
+
+		///
+		/// The call() function invokes a function named \a name in
+		/// this context.
+		/// \return 0 on succes, -1 on failure
+		///
+		int call (
+			const hawk_bch_t*  name,  ///< function name
+			Value*             ret,   ///< return value holder
+			const Value*       args,  ///< argument array
+			hawk_oow_t         nargs  ///< number of arguments
+		);
+
+		int call (
+			const hawk_uch_t*  name,  ///< function name
+			Value*             ret,   ///< return value holder
+			const Value*       args,  ///< argument array
+			hawk_oow_t         nargs  ///< number of arguments
+		);
+
+		///
+		/// The exec() function is the same as loop() if no @pragma entry
+		/// is specified. It is the same as call() if it is specifed.
+		///
+		int exec (
+			Value*             ret,   ///< return value holder
+			const Value*       args,  ///< argument array
+			hawk_oow_t         nargs  ///< number of arguments
+		);
+
 	protected:
 		Hawk* hawk;
 		hawk_rtx_t* rtx;
@@ -1363,6 +1437,37 @@ public:
 	/// reset it without calling the parse() function again
 	/// after the first call to it. 
 	Hawk::Run* resetRunContext ();
+
+	///
+	/// The freeze() function makes the parsed program read-only so that
+	/// the contexts created with openRunContext() can run on different
+	/// threads at the same time. See hawk_freeze() for details.
+	///
+	void freeze ();
+
+	///
+	/// The isFrozen() function tells if freeze() has been called.
+	///
+	bool isFrozen () const;
+
+	///
+	/// The openRunContext() function creates an execution context
+	/// in addition to the one returned by parse(). Use Run::exec(),
+	/// Run::loop(), and Run::call() to execute it and closeRunContext()
+	/// to destroy it. After freeze(), each context can run on its own
+	/// thread. Note that the I/O handlers such as openPipe(), openFile(),
+	/// openConsole() and the functions added with addFunction() are
+	/// shared by all contexts and must be safe to call on multiple
+	/// threads at the same time.
+	/// \return Run object on success, #HAWK_NULL on failure
+	///
+	virtual Hawk::Run* openRunContext ();
+
+	///
+	/// The closeRunContext() function destroys a context created with
+	/// openRunContext().
+	///
+	void closeRunContext (Hawk::Run* run);
 	
 	///
 	/// The loop() function executes the BEGIN block, pattern-action blocks,
@@ -1816,6 +1921,7 @@ private:
 	hawk_cmgr_t* _cmgr;
 	Run runctx;
 
+	hawk_rtx_t* open_rtx (Run* run);
 	int init_runctx ();
 	void fini_runctx ();
 	int dispatch_function (Run* run, const hawk_fnc_info_t* fi);
@@ -1928,6 +2034,13 @@ public:
 
 	Run* parse (Source& in, Source& out);
 
+	/// The openRunContext() function creates an additional execution
+	/// context with ARGV and ENVIRON set up. The console handlers of this
+	/// class keep the position in the console files in the object.
+	/// Override them if the contexts on different threads read from
+	/// or write to the console.
+	Run* openRunContext ();
+
 	/// The setConsoleCmgr() function sets the encoding type of 
 	/// the console streams. They include both the input and the output
 	/// streams. It provides no way to specify a different encoding
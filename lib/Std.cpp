@@ -243,6 +243,18 @@ HawkStd::Run* HawkStd::parse (Source& in, Source& out)
 	return run;
 }
 
+HawkStd::Run* HawkStd::openRunContext ()
+{
+	Run* run = Hawk::openRunContext();
+	if (run && make_additional_globals(run) <= -1)
+	{
+		this->retrieveError (run);
+		this->closeRunContext (run);
+		return HAWK_NULL;
+	}
+	return run;
+}
+
 int HawkStd::build_argcv (Run* run)
 {
 	Value argv (run);
@@ -283,9 +295,9 @@ int HawkStd::build_environ (Run* run, env_char_t* envarr[])
 			eq = hawk_find_bchar_in_bcstr(envarr[count], HAWK_BT('='));
 			if (eq == HAWK_NULL || eq == envarr[count]) continue;
 
-			*eq = HAWK_BT('\0');
-
-			kptr = hawk_rtx_dupbtoucstr(rtx, envarr[count], &klen, 1);
+			// the environment is shared by the contexts on other
+			// threads. don't terminate the key in place
+			kptr = hawk_rtx_dupbtouchars(rtx, envarr[count], eq - envarr[count], &klen, 1);
 			vptr = hawk_rtx_dupbtoucstr(rtx, eq + 1, HAWK_NULL, 1);
 			if (kptr == HAWK_NULL || vptr == HAWK_NULL)
 			{
@@ -298,15 +310,11 @@ int HawkStd::build_environ (Run* run, env_char_t* envarr[])
 				this->setError (HAWK_ENOMEM);
 				return -1;
 			}
-
-			*eq = HAWK_BT('=');
 		#else
 			eq = hawk_find_uchar_in_ucstr(envarr[count], HAWK_UT('='));
 			if (eq == HAWK_NULL || eq == envarr[count]) continue;
 
-			*eq = HAWK_UT('\0');
-
-			kptr = hawk_rtx_duputobcstr(rtx, envarr[count], &klen);
+			kptr = hawk_rtx_duputobchars(rtx, envarr[count], eq - envarr[count], &klen);
 			vptr = hawk_rtx_duputobcstr(rtx, eq + 1, HAWK_NULL);
 			if (kptr == HAWK_NULL || vptr == HAWK_NULL)
 			{
@@ -321,8 +329,6 @@ int HawkStd::build_environ (Run* run, env_char_t* envarr[])
 				this->setError (HAWK_ENOMEM);
 				return -1;
 			}
-
-			*eq = HAWK_UT('=');
 		#endif
 
 			// numeric string
@@ -882,8 +888,6 @@ int HawkStd::open_console_in (Console& io)
 	hawk_val_t* v_argc, * v_argv, * v_pair;
 	hawk_int_t i_argc;
 	const hawk_ooch_t* file;
-	hawk_map_t* map;
-	hawk_map_pair_t* pair;
 	hawk_ooch_t ibuf[128];
 	hawk_oow_t ibuflen;
 	hawk_oocs_t as;
@@ -911,9 +915,6 @@ int HawkStd::open_console_in (Console& io)
 		return -1;
 	}
 
-	map = ((hawk_val_map_t*)v_argv)->map;
-	HAWK_ASSERT (map != HAWK_NULL);
-
 nextfile:
 	if ((hawk_int_t)this->runarg_index >= (i_argc - 1))  /* ARGV is a kind of 0-based array unlike other normal arrays or substring indexing scheme */
 	{
@@ -937,16 +938,13 @@ nextfile:
 	}
 
 	ibuflen = hawk_int_to_oocstr(this->runarg_index + 1, 10, HAWK_NULL, ibuf, HAWK_COUNTOF(ibuf));
-	pair = hawk_map_search(map, ibuf, ibuflen);
-	if (!pair) 
+	v_pair = hawk_rtx_getmapvalfld(rtx, v_argv, ibuf, ibuflen);
+	if (!v_pair) 
 	{
 		if (this->runarg_count <= 0) goto console_open_stdin;
 		return 0;
 	}
 
-	v_pair = (hawk_val_t*)HAWK_HTB_VPTR(pair);
-	HAWK_ASSERT (v_pair != HAWK_NULL);
-
 	as.ptr = hawk_rtx_getvaloocstr(rtx, v_pair, &as.len);
 	if (HAWK_UNLIKELY(!as.ptr)) return -1;
 
@@ -0,0 +1,508 @@
+/*
+    Copyright (c) 2006-2020 Chung, Hyung-Hwan. All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hawk-prv.h"
+
+/*
+ * This file lowers operator expressions in the parse tree to register
+ * code executed by eval_code() in run.c. The largest subtree made of
+ * assignments and binary, unary and conditional operators is replaced
+ * by a HAWK_NDE_CODE node. The operands are loaded into registers and
+ * the operators work on the registers. A field whose position is an
+ * integer literal is loaded directly. An operand that the code doesn't
+ * handle is evaluated by the tree walker with HAWK_CODE_EVAL. The
+ * original subtree is kept in the new node for deparsing.
+ *
+ *   s += $1 * 2       LDFLD r0, $1
+ *                     LDINT r1, 2
+ *                     BIN   r0, r0 * r1
+ *                     LDGBL r1, s
+ *                     BIN   r0, r1 + r0
+ *                     ASS   r0, s = r0
+ */
+
+#define MAX_INSNS 0xFFFF
+
+typedef struct comp_t comp_t;
+struct comp_t
+{
+	hawk_t* hawk;
+	hawk_code_insn_t* buf;
+	hawk_oow_t len;
+	hawk_oow_t capa;
+	hawk_oow_t nregs;
+	int overflow;
+};
+
+static int compile_list (comp_t* c, hawk_nde_t** pp);
+static int compile_children (comp_t* c, hawk_nde_t* nde);
+
+static int assop_to_binop[] =
+{
+	/* this table must match hawk_assop_type_t in run-prv.h */
+	HAWK_BINOP_LOR, /* HAWK_ASSOP_NONE - not used */
+	HAWK_BINOP_PLUS,
+	HAWK_BINOP_MINUS,
+	HAWK_BINOP_MUL,
+	HAWK_BINOP_DIV,
+	HAWK_BINOP_IDIV,
+	HAWK_BINOP_MOD,
+	HAWK_BINOP_EXP,
+	HAWK_BINOP_CONCAT,
+	HAWK_BINOP_RS,
+	HAWK_BINOP_LS,
+	HAWK_BINOP_BAND,
+	HAWK_BINOP_BXOR,
+	HAWK_BINOP_BOR
+};
+
+static int is_compilable (hawk_nde_t* nde)
+{
+	switch (nde->type)
+	{
+		case HAWK_NDE_ASS:
+		{
+			/* eval_assignment() appends to a variable in place.
+			 * leave a concatenation assigned to it */
+			hawk_nde_ass_t* ass = (hawk_nde_ass_t*)nde;
+			return ass->opcode != HAWK_ASSOP_CONCAT &&
+			       !(ass->right->type == HAWK_NDE_EXP_BIN && ((hawk_nde_exp_t*)ass->right)->opcode == HAWK_BINOP_CONCAT);
+		}
+
+		case HAWK_NDE_EXP_BIN:
+			/* 'in' and the match operators inspect their operand nodes */
+			return ((hawk_nde_exp_t*)nde)->opcode != HAWK_BINOP_IN &&
+			       ((hawk_nde_exp_t*)nde)->opcode != HAWK_BINOP_MA &&
+			       ((hawk_nde_exp_t*)nde)->opcode != HAWK_BINOP_NM;
+
+		case HAWK_NDE_EXP_UNR:
+		case HAWK_NDE_CND:
+			return 1;
+
+		default:
+			return 0;
+	}
+}
+
+static hawk_oow_t emit (comp_t* c, hawk_code_op_t op, int opx, hawk_oow_t dst, hawk_oow_t a, hawk_oow_t b, hawk_nde_t* nde)
+{
+	hawk_code_insn_t* insn;
+
+	if (c->len >= MAX_INSNS)
+	{
+		c->overflow = 1;
+		return (hawk_oow_t)-1;
+	}
+
+	if (c->len >= c->capa)
+	{
+		hawk_code_insn_t* tmp;
+		hawk_oow_t newcapa;
+
+		newcapa = HAWK_ALIGN_POW2(c->len + 1, 64);
+		tmp = (hawk_code_insn_t*)hawk_reallocmem(c->hawk, c->buf, HAWK_SIZEOF(*tmp) * newcapa);
+		if (HAWK_UNLIKELY(!tmp)) return (hawk_oow_t)-1;
+
+		c->buf = tmp;
+		c->capa = newcapa;
+	}
+
+	insn = &c->buf[c->len];
+	insn->op = op;
+	insn->opx = opx;
+	insn->dst = dst;
+	insn->a = a;
+	insn->b = b;
+	insn->nde = nde;
+
+	return c->len++;
+}
+
+static int gen (comp_t* c, hawk_nde_t* nde, hawk_oow_t r)
+{
+	hawk_code_op_t op;
+
+	if (r >= HAWK_CODE_MAX_REGS)
+	{
+		c->overflow = 1;
+		return -1;
+	}
+	if (r >= c->nregs) c->nregs = r + 1;
+
+	switch (nde->type)
+	{
+		case HAWK_NDE_EXP_BIN:
+		{
+			hawk_nde_exp_t* exp = (hawk_nde_exp_t*)nde;
+
+			if (!is_compilable(nde)) goto eval;
+
+			if (exp->opcode == HAWK_BINOP_LAND || exp->opcode == HAWK_BINOP_LOR)
+			{
+				hawk_oow_t j;
+
+				/* short-circuit evaluation */
+				if (gen(c, exp->left, r) <= -1) return -1;
+				j = emit(c, ((exp->opcode == HAWK_BINOP_LAND)? HAWK_CODE_LAND: HAWK_CODE_LOR), 0, r, r, 0, nde);
+				if (j == (hawk_oow_t)-1) return -1;
+				if (gen(c, exp->right, r) <= -1) return -1;
+				if (emit(c, HAWK_CODE_BOOL, 0, r, r, 0, nde) == (hawk_oow_t)-1) return -1;
+				c->buf[j].b = c->len;
+				return 0;
+			}
+
+			if (gen(c, exp->left, r) <= -1 || gen(c, exp->right, r + 1) <= -1) return -1;
+			return (emit(c, HAWK_CODE_BIN, exp->opcode, r, r, r + 1, nde) == (hawk_oow_t)-1)? -1: 0;
+		}
+
+		case HAWK_NDE_EXP_UNR:
+		{
+			hawk_nde_exp_t* exp = (hawk_nde_exp_t*)nde;
+			if (gen(c, exp->left, r) <= -1) return -1;
+			return (emit(c, HAWK_CODE_UNR, exp->opcode, r, r, 0, nde) == (hawk_oow_t)-1)? -1: 0;
+		}
+
+		case HAWK_NDE_ASS:
+		{
+			hawk_nde_ass_t* ass = (hawk_nde_ass_t*)nde;
+
+			if (!is_compilable(nde)) goto eval;
+
+			/* the right-hand side is evaluated before the variable
+			 * as eval_assignment() does */
+			if (gen(c, ass->right, r) <= -1) return -1;
+			if (ass->opcode != HAWK_ASSOP_NONE)
+			{
+				HAWK_ASSERT (ass->opcode < HAWK_COUNTOF(assop_to_binop));
+				if (gen(c, ass->left, r + 1) <= -1) return -1;
+				if (emit(c, HAWK_CODE_BIN, assop_to_binop[ass->opcode], r, r + 1, r, nde) == (hawk_oow_t)-1) return -1;
+			}
+			return (emit(c, HAWK_CODE_ASS, 0, r, r, 0, nde) == (hawk_oow_t)-1)? -1: 0;
+		}
+
+		case HAWK_NDE_POS:
+		{
+			hawk_nde_pos_t* pos = (hawk_nde_pos_t*)nde;
+
+			/* a negative literal such as the folded $(1-2) is checked by FLD */
+			if (pos->val->type == HAWK_NDE_INT && ((hawk_nde_int_t*)pos->val)->val >= 0)
+			{
+				op = HAWK_CODE_LDFLD;
+				break;
+			}
+
+			if (gen(c, pos->val, r) <= -1) return -1;
+			return (emit(c, HAWK_CODE_FLD, 0, r, r, 0, nde) == (hawk_oow_t)-1)? -1: 0;
+		}
+
+		case HAWK_NDE_CND:
+		{
+			hawk_nde_cnd_t* cnd = (hawk_nde_cnd_t*)nde;
+			hawk_oow_t j1, j2;
+
+			if (gen(c, cnd->test, r) <= -1) return -1;
+			j1 = emit(c, HAWK_CODE_JMPF, 0, r, r, 0, nde);
+			if (j1 == (hawk_oow_t)-1) return -1;
+			if (gen(c, cnd->left, r) <= -1) return -1;
+			j2 = emit(c, HAWK_CODE_JMP, 0, r, r, 0, nde);
+			if (j2 == (hawk_oow_t)-1) return -1;
+			c->buf[j1].b = c->len;
+			if (gen(c, cnd->right, r) <= -1) return -1;
+			c->buf[j2].b = c->len;
+			return 0;
+		}
+
+		case HAWK_NDE_INT:
+			op = HAWK_CODE_LDINT;
+			break;
+
+		case HAWK_NDE_FLT:
+			op = HAWK_CODE_LDFLT;
+			break;
+
+		case HAWK_NDE_STR:
+			op = HAWK_CODE_LDSTR;
+			break;
+
+		case HAWK_NDE_GBL:
+			op = HAWK_CODE_LDGBL;
+			break;
+
+		case HAWK_NDE_LCL:
+			op = HAWK_CODE_LDLCL;
+			break;
+
+		case HAWK_NDE_ARG:
+			op = HAWK_CODE_LDARG;
+			break;
+
+		default:
+		eval:
+			op = HAWK_CODE_EVAL;
+			break;
+	}
+
+	return (emit(c, op, 0, r, 0, 0, nde) == (hawk_oow_t)-1)? -1: 0;
+}
+
+static int compile_expr (comp_t* c, hawk_nde_t** pp)
+{
+	hawk_nde_t* nde = *pp;
+	hawk_nde_code_t* code;
+	hawk_oow_t i;
+
+	c->len = 0;
+	c->nregs = 0;
+	c->overflow = 0;
+
+	if (gen(c, nde, 0) <= -1)
+	{
+		/* leave a too complex expression to the tree walker */
+		return c->overflow? 0: -1;
+	}
+
+	HAWK_ASSERT (c->len > 0);
+	code = (hawk_nde_code_t*)hawk_callocmem(c->hawk, HAWK_SIZEOF(*code) + HAWK_SIZEOF(*code->insn) * (c->len - 1));
+	if (HAWK_UNLIKELY(!code)) return -1;
+
+	code->type = HAWK_NDE_CODE;
+	code->loc = nde->loc;
+	code->next = nde->next;
+	code->expr = nde;
+	code->nregs = c->nregs;
+	code->ninsns = c->len;
+	HAWK_MEMCPY (code->insn, c->buf, HAWK_SIZEOF(*code->insn) * c->len);
+
+	nde->next = HAWK_NULL;
+	*pp = (hawk_nde_t*)code;
+
+	/* the operands left to the tree walker and the index of
+	 * a variable assigned to may contain compilable expressions */
+	for (i = 0; i < code->ninsns; i++)
+	{
+		if (code->insn[i].op == HAWK_CODE_EVAL && compile_children(c, code->insn[i].nde) <= -1) return -1;
+		if (code->insn[i].op == HAWK_CODE_ASS && compile_children(c, ((hawk_nde_ass_t*)code->insn[i].nde)->left) <= -1) return -1;
+	}
+
+	return 1;
+}
+
+static int compile_node (comp_t* c, hawk_nde_t** pp)
+{
+	if (is_compilable(*pp))
+	{
+		int n;
+		n = compile_expr(c, pp);
+		if (n <= -1) return -1;
+		if (n >= 1) return 0;
+	}
+
+	return compile_children(c, *pp);
+}
+
+static int compile_list (comp_t* c, hawk_nde_t** pp)
+{
+	while (*pp)
+	{
+		if (compile_node(c, pp) <= -1) return -1;
+		pp = &(*pp)->next;
+	}
+	return 0;
+}
+
+static int compile_children (comp_t* c, hawk_nde_t* nde)
+{
+	switch (nde->type)
+	{
+		case HAWK_NDE_BLK:
+			return compile_list(c, &((hawk_nde_blk_t*)nde)->body);
+
+		case HAWK_NDE_IF:
+		{
+			hawk_nde_if_t* px = (hawk_nde_if_t*)nde;
+			if (compile_list(c, &px->test) <= -1 ||
+			    compile_list(c, &px->then_part) <= -1 ||
+			    (px->else_part && compile_list(c, &px->else_part) <= -1)) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_WHILE:
+		case HAWK_NDE_DOWHILE:
+		{
+			hawk_nde_while_t* px = (hawk_nde_while_t*)nde;
+			if (compile_list(c, &px->test) <= -1 || compile_list(c, &px->body) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_FOR:
+		{
+			hawk_nde_for_t* px = (hawk_nde_for_t*)nde;
+			if ((px->init && compile_list(c, &px->init) <= -1) ||
+			    (px->test && compile_list(c, &px->test) <= -1) ||
+			    (px->incr && compile_list(c, &px->incr) <= -1) ||
+			    compile_list(c, &px->body) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_FORIN:
+		{
+			/* the test must remain HAWK_NDE_EXP_BIN with HAWK_BINOP_IN.
+			 * only the children are compiled */
+			hawk_nde_forin_t* px = (hawk_nde_forin_t*)nde;
+			if (compile_children(c, px->test) <= -1 || compile_list(c, &px->body) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_RETURN:
+			return ((hawk_nde_return_t*)nde)->val? compile_list(c, &((hawk_nde_return_t*)nde)->val): 0;
+
+		case HAWK_NDE_EXIT:
+			return ((hawk_nde_exit_t*)nde)->val? compile_list(c, &((hawk_nde_exit_t*)nde)->val): 0;
+
+		case HAWK_NDE_DELETE:
+			return compile_children(c, ((hawk_nde_delete_t*)nde)->var);
+
+		case HAWK_NDE_RESET:
+			return compile_children(c, ((hawk_nde_reset_t*)nde)->var);
+
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF:
+		{
+			hawk_nde_print_t* px = (hawk_nde_print_t*)nde;
+			if ((px->args && compile_list(c, &px->args) <= -1) ||
+			    (px->out && compile_list(c, &px->out) <= -1)) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_GRP:
+			return compile_list(c, &((hawk_nde_grp_t*)nde)->body);
+
+		case HAWK_NDE_ASS:
+		{
+			/* the left-hand side is an lvalue. only the index is compiled */
+			hawk_nde_ass_t* px = (hawk_nde_ass_t*)nde;
+			if (compile_children(c, px->left) <= -1 || compile_list(c, &px->right) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_EXP_BIN:
+		{
+			hawk_nde_exp_t* px = (hawk_nde_exp_t*)nde;
+			if (px->opcode == HAWK_BINOP_IN)
+			{
+				/* the left operand can be a group and the right operand must be a variable */
+				if (compile_children(c, px->left) <= -1 || compile_children(c, px->right) <= -1) return -1;
+				return 0;
+			}
+			if (compile_list(c, &px->left) <= -1 || compile_list(c, &px->right) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_EXP_UNR:
+			return compile_list(c, &((hawk_nde_exp_t*)nde)->left);
+
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST:
+			return compile_children(c, ((hawk_nde_exp_t*)nde)->left);
+
+		case HAWK_NDE_CND:
+		{
+			hawk_nde_cnd_t* px = (hawk_nde_cnd_t*)nde;
+			if (compile_list(c, &px->test) <= -1 ||
+			    compile_list(c, &px->left) <= -1 ||
+			    compile_list(c, &px->right) <= -1) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_FNCALL_FNC:
+		case HAWK_NDE_FNCALL_FUN:
+		case HAWK_NDE_FNCALL_VAR:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (nde->type == HAWK_NDE_FNCALL_VAR && compile_children(c, (hawk_nde_t*)px->u.var.var) <= -1) return -1;
+			/* a variable passed by reference is never compiled as it is not an operator */
+			return compile_list(c, &px->args);
+		}
+
+		case HAWK_NDE_XARGVIDX:
+			return compile_list(c, &((hawk_nde_xargvidx_t*)nde)->pos);
+
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX:
+			return compile_list(c, &((hawk_nde_var_t*)nde)->idx);
+
+		case HAWK_NDE_POS:
+			return compile_list(c, &((hawk_nde_pos_t*)nde)->val);
+
+		case HAWK_NDE_GETLINE:
+		{
+			hawk_nde_getline_t* px = (hawk_nde_getline_t*)nde;
+			if ((px->var && compile_children(c, px->var) <= -1) ||
+			    (px->in && compile_list(c, &px->in) <= -1)) return -1;
+			return 0;
+		}
+
+		default:
+			/* leaf nodes and already compiled nodes */
+			return 0;
+	}
+}
+
+int hawk_compilept (hawk_t* hawk)
+{
+	comp_t c;
+	hawk_chain_t* chain;
+	hawk_htb_pair_t* pair;
+	hawk_htb_itr_t itr;
+	int n = -1;
+
+	HAWK_MEMSET (&c, 0, HAWK_SIZEOF(c));
+	c.hawk = hawk;
+
+	if (hawk->tree.begin && compile_list(&c, &hawk->tree.begin) <= -1) goto done;
+
+	for (chain = hawk->tree.chain; chain; chain = chain->next)
+	{
+		if (chain->pattern && compile_list(&c, &chain->pattern) <= -1) goto done;
+		if (chain->action && compile_list(&c, &chain->action) <= -1) goto done;
+	}
+
+	if (hawk->tree.end && compile_list(&c, &hawk->tree.end) <= -1) goto done;
+
+	pair = hawk_htb_getfirstpair(hawk->tree.funs, &itr);
+	while (pair)
+	{
+		hawk_fun_t* fun = (hawk_fun_t*)HAWK_HTB_VPTR(pair);
+		if (compile_list(&c, &fun->body) <= -1) goto done;
+		pair = hawk_htb_getnextpair(hawk->tree.funs, &itr);
+	}
+
+	n = 0;
+
+done:
+	if (c.buf) hawk_freemem (hawk, c.buf);
+	return n;
+}
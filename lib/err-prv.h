@@ -33,6 +33,9 @@ const hawk_ooch_t* hawk_dfl_errstr (hawk_errnum_t errnum);
 
 hawk_errnum_t hawk_syserr_to_errnum (hawk_intptr_t e);
 
+/* the reverse of hawk_rtx_errortohawk() */
+void hawk_rtx_errorfromhawk (hawk_rtx_t* rtx, hawk_t* hawk);
+
 
 #if defined(__cplusplus)
 }
@@ -285,6 +285,14 @@ void hawk_rtx_errortohawk (hawk_rtx_t* rtx, hawk_t* hawk)
 	hawk_copy_oocstr (hawk->_gem.errmsg, HAWK_COUNTOF(hawk->_gem.errmsg), rtx->_gem.errmsg);
 }
 
+void hawk_rtx_errorfromhawk (hawk_rtx_t* rtx, hawk_t* hawk)
+{
+	/* copy error information in the 'hawk' object to 'rtx' */
+	rtx->_gem.errnum = hawk->_gem.errnum;
+	rtx->_gem.errloc = hawk->_gem.errloc;
+	hawk_copy_oocstr (rtx->_gem.errmsg, HAWK_COUNTOF(rtx->_gem.errmsg), hawk->_gem.errmsg);
+}
+
 /* ------------------------------------------------------------------------- */
 
 void hawk_gem_geterrbinf (hawk_gem_t* gem, hawk_errbinf_t* errinf)
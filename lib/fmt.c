@@ -346,6 +346,367 @@ int hawk_fmt_uintmax_to_ucstr (
 	return fmt_uintmax_to_ucstr(buf, size, value, base_and_flags, prec, fillchar, signchar, prefix);
 }
 
+/* ------------------------------------------------------------------------- */
+
+static const hawk_bch_t dec_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+#if (HAWK_SIZEOF_UINTMAX_T > 8)
+typedef hawk_uint64_t dec_word_t;
+#else
+typedef hawk_uintmax_t dec_word_t;
+#endif
+
+/* write the decimal digits of a value backward ending at 'p'.
+ * they return the pointer to the first digit */
+static hawk_bch_t* put_dec_word (hawk_bch_t* p, dec_word_t v)
+{
+	while (v >= 100)
+	{
+		dec_word_t i = (v % 100) * 2;
+		v /= 100;
+		*--p = dec_pairs[i + 1];
+		*--p = dec_pairs[i];
+	}
+	if (v >= 10)
+	{
+		*--p = dec_pairs[v * 2 + 1];
+		*--p = dec_pairs[v * 2];
+	}
+	else *--p = (hawk_bch_t)('0' + v);
+	return p;
+}
+
+static hawk_bch_t* put_dec_digits (hawk_bch_t* p, hawk_uintmax_t value)
+{
+#if (HAWK_SIZEOF_UINTMAX_T > 8)
+	/* take 19 digits at a time while the value is wider than 64 bits.
+	 * the division on the wider integer is much slower */
+	while (value > (dec_word_t)-1)
+	{
+		hawk_bch_t* q = p - 19;
+		p = put_dec_word(p, (dec_word_t)(value % 10000000000000000000ull));
+		while (p > q) *--p = '0';
+		value /= 10000000000000000000ull;
+	}
+#endif
+	return put_dec_word(p, (dec_word_t)value);
+}
+
+/* the buffer must be long enough for the longest value and a sign */
+#define INTMAX_DEC_BUFSIZE (HAWK_SIZEOF_INTMAX_T * 3 + 2)
+
+static hawk_bch_t* put_intmax_dec (hawk_bch_t* end, hawk_intmax_t value)
+{
+	hawk_bch_t* p;
+
+	if (value < 0)
+	{
+		p = put_dec_digits(end, (hawk_uintmax_t)0 - (hawk_uintmax_t)value);
+		*--p = '-';
+	}
+	else p = put_dec_digits(end, value);
+
+	return p;
+}
+
+int hawk_fmt_intmax_to_decbcstr (hawk_bch_t* buf, int bufsize, hawk_intmax_t value)
+{
+	hawk_bch_t tmp[INTMAX_DEC_BUFSIZE], * p;
+	int len;
+
+	p = put_intmax_dec(tmp + HAWK_COUNTOF(tmp), value);
+	len = (int)(tmp + HAWK_COUNTOF(tmp) - p);
+	if (len >= bufsize) return -1;
+	HAWK_MEMCPY (buf, p, len);
+	buf[len] = '\0';
+	return len;
+}
+
+int hawk_fmt_intmax_to_decucstr (hawk_uch_t* buf, int bufsize, hawk_intmax_t value)
+{
+	hawk_bch_t tmp[INTMAX_DEC_BUFSIZE], * p;
+	int len, i;
+
+	p = put_intmax_dec(tmp + HAWK_COUNTOF(tmp), value);
+	len = (int)(tmp + HAWK_COUNTOF(tmp) - p);
+	if (len >= bufsize) return -1;
+	for (i = 0; i < len; i++) buf[i] = p[i];
+	buf[len] = '\0';
+	return len;
+}
+
+/* ------------------------------------------------------------------------- */
+
+#if defined(HAWK_HAVE_UINT128_T) && defined(HAWK_HAVE_UINT64_T)
+
+/* a floating-point value is split to the integral part and the fraction
+ * in units of 2^-128. the digits are then produced with the integer
+ * arithmetic, which gives the same result as snprintf() as long as the
+ * value can be split exactly. */
+
+#define FLT_FAST_MAX_DIGITS 19
+#define FLT_FAST_BUFSIZE 64
+
+static const hawk_uint64_t pow10_tab[FLT_FAST_MAX_DIGITS + 1] =
+{
+	1ull,
+	10ull,
+	100ull,
+	1000ull,
+	10000ull,
+	100000ull,
+	1000000ull,
+	10000000ull,
+	100000000ull,
+	1000000000ull,
+	10000000000ull,
+	100000000000ull,
+	1000000000000ull,
+	10000000000000ull,
+	100000000000000ull,
+	1000000000000000ull,
+	10000000000000000ull,
+	100000000000000000ull,
+	1000000000000000000ull,
+	10000000000000000000ull
+};
+
+static int split_flt (hawk_flt_t x, hawk_uint64_t* ip, hawk_uint128_t* fp)
+{
+	hawk_flt_t f;
+	hawk_uint64_t hi, lo;
+
+	/* this fails for infinity and nan as well */
+	if (!(x >= 0 && x < 18446744073709551616.0)) return -1;
+
+	/* the subtraction and the multiplication by a power of 2 are exact */
+	*ip = (hawk_uint64_t)x;
+	f = (x - (hawk_flt_t)*ip) * 18446744073709551616.0;
+	hi = (hawk_uint64_t)f;
+	f = (f - (hawk_flt_t)hi) * 18446744073709551616.0;
+	lo = (hawk_uint64_t)f;
+	if ((hawk_flt_t)lo != f) return -1; /* bits below 2^-128 */
+
+	*fp = ((hawk_uint128_t)hi << 64) | lo;
+	return 0;
+}
+
+/* get (ip + fp / 2^128) * 10^n rounded to the nearest integer with a tie
+ * rounded to the even number. n must be between -FLT_FAST_MAX_DIGITS and
+ * FLT_FAST_MAX_DIGITS. the result without rounding is stored in *q and
+ * 1 is returned if it must be rounded up. */
+static int scale_flt (hawk_uint64_t ip, hawk_uint128_t fp, int n, hawk_uint128_t* q)
+{
+	if (n >= 0)
+	{
+		hawk_uint64_t t = pow10_tab[n];
+		hawk_uint128_t a, c;
+		hawk_uint64_t rh, rl;
+
+		/* fp * t is 192 bits long. the upper 64 bits go to the integral
+		 * part and the lower 128 bits are the remainder */
+		a = (hawk_uint128_t)(hawk_uint64_t)fp * t;
+		c = (hawk_uint128_t)(hawk_uint64_t)(fp >> 64) * t + (a >> 64);
+		*q = (hawk_uint128_t)ip * t + (c >> 64);
+
+		rh = (hawk_uint64_t)c;
+		rl = (hawk_uint64_t)a;
+		if (rh != ((hawk_uint64_t)1 << 63)) return rh > ((hawk_uint64_t)1 << 63);
+		return (rl > 0 || (*q & 1));
+	}
+	else
+	{
+		hawk_uint64_t d = pow10_tab[-n], r;
+
+		*q = ip / d;
+		r = ip % d;
+		if (r != d / 2) return r > d / 2;
+		return (fp > 0 || (*q & 1));
+	}
+}
+
+static hawk_bch_t* put_dec_digits128 (hawk_bch_t* p, hawk_uint128_t value)
+{
+#if (HAWK_SIZEOF_UINTMAX_T >= 16)
+	return put_dec_digits(p, value);
+#else
+	while (value > (dec_word_t)-1)
+	{
+		hawk_bch_t* q = p - 19;
+		p = put_dec_word(p, (dec_word_t)(value % pow10_tab[19]));
+		while (p > q) *--p = '0';
+		value /= pow10_tab[19];
+	}
+	return put_dec_word(p, (dec_word_t)value);
+#endif
+}
+
+static int fmt_flt_to_dec (hawk_bch_t* buf, hawk_flt_t x, int conv, int prec)
+{
+	hawk_bch_t dig[48], * dend = dig + HAWK_COUNTOF(dig), * d, * p = buf;
+	hawk_uint64_t ip;
+	hawk_uint128_t fp, q;
+	int neg = 0, nd, exp, n;
+
+	if (x < 0)
+	{
+		neg = 1;
+		x = -x;
+	}
+	else if (x == 0 && 1 / x < 0) neg = 1; /* -0.0 */
+
+	if (prec < 0 || split_flt(x, &ip, &fp) <= -1) return -1;
+	if (neg) *p++ = '-';
+
+	if (conv == 'f')
+	{
+		if (prec > FLT_FAST_MAX_DIGITS) return -1;
+		n = scale_flt(ip, fp, prec, &q);
+		d = put_dec_digits128(dend, q + n);
+		nd = (int)(dend - d);
+		while (nd <= prec) { *--d = '0'; nd++; }
+
+		HAWK_MEMCPY (p, d, nd - prec); p += nd - prec;
+		if (prec > 0)
+		{
+			*p++ = '.';
+			HAWK_MEMCPY (p, d + nd - prec, prec); p += prec;
+		}
+		return (int)(p - buf);
+	}
+
+	/* conv == 'g' */
+	if (prec == 0) prec = 1;
+	if (prec > FLT_FAST_MAX_DIGITS) return -1;
+
+	if (ip == 0 && fp == 0)
+	{
+		*p++ = '0';
+		return (int)(p - buf);
+	}
+
+	/* find the exponent before rounding */
+	if (ip > 0)
+	{
+		exp = 0;
+		while (exp < FLT_FAST_MAX_DIGITS && ip >= pow10_tab[exp + 1]) exp++;
+	}
+	else
+	{
+		for (exp = -1; ; exp--)
+		{
+			if (exp < -FLT_FAST_MAX_DIGITS) return -1;
+			scale_flt(0, fp, -exp, &q);
+			if (q > 0) break;
+		}
+	}
+
+	/* round to 'prec' significant digits. the exponent goes up by 1
+	 * if the rounding carries over to a new digit */
+	n = prec - 1 - exp;
+	if (n < -FLT_FAST_MAX_DIGITS || n > FLT_FAST_MAX_DIGITS) return -1;
+	q += scale_flt(ip, fp, n, &q);
+	if (q >= pow10_tab[prec])
+	{
+		exp++;
+		n--;
+		if (n < -FLT_FAST_MAX_DIGITS) return -1;
+		q += scale_flt(ip, fp, n, &q);
+	}
+
+	d = put_dec_digits128(dend, q);
+	nd = (int)(dend - d);
+	HAWK_ASSERT (nd == prec);
+	while (nd > 1 && d[nd - 1] == '0') nd--; /* drop the trailing zeros */
+
+	if (exp < -4 || exp >= prec)
+	{
+		/* d.ddde+xx */
+		*p++ = d[0];
+		if (nd > 1)
+		{
+			*p++ = '.';
+			HAWK_MEMCPY (p, d + 1, nd - 1); p += nd - 1;
+		}
+		*p++ = 'e';
+		if (exp < 0) { *p++ = '-'; exp = -exp; }
+		else *p++ = '+';
+		if (exp < 10) *p++ = '0';
+		d = put_dec_digits(dend, exp);
+		HAWK_MEMCPY (p, d, dend - d); p += dend - d;
+	}
+	else if (exp >= 0)
+	{
+		/* ddd.ddd */
+		if (nd <= exp + 1)
+		{
+			HAWK_MEMCPY (p, d, nd); p += nd;
+			while (nd <= exp) { *p++ = '0'; nd++; }
+		}
+		else
+		{
+			HAWK_MEMCPY (p, d, exp + 1); p += exp + 1;
+			*p++ = '.';
+			HAWK_MEMCPY (p, d + exp + 1, nd - exp - 1); p += nd - exp - 1;
+		}
+	}
+	else
+	{
+		/* 0.000ddd */
+		*p++ = '0';
+		*p++ = '.';
+		for (n = exp + 1; n < 0; n++) *p++ = '0';
+		HAWK_MEMCPY (p, d, nd); p += nd;
+	}
+
+	return (int)(p - buf);
+}
+#endif
+
+int hawk_fmt_flt_to_bcstr (hawk_bch_t* buf, int bufsize, hawk_flt_t value, int conv, int precision)
+{
+#if defined(FLT_FAST_BUFSIZE)
+	hawk_bch_t tmp[FLT_FAST_BUFSIZE];
+	int len;
+
+	if (conv != 'f' && conv != 'g') return -1;
+	len = fmt_flt_to_dec(tmp, value, conv, precision);
+	if (len <= -1 || len >= bufsize) return -1;
+	HAWK_MEMCPY (buf, tmp, len);
+	buf[len] = '\0';
+	return len;
+#else
+	return -1;
+#endif
+}
+
+int hawk_fmt_flt_to_ucstr (hawk_uch_t* buf, int bufsize, hawk_flt_t value, int conv, int precision)
+{
+#if defined(FLT_FAST_BUFSIZE)
+	hawk_bch_t tmp[FLT_FAST_BUFSIZE];
+	int len, i;
+
+	if (conv != 'f' && conv != 'g') return -1;
+	len = fmt_flt_to_dec(tmp, value, conv, precision);
+	if (len <= -1 || len >= bufsize) return -1;
+	for (i = 0; i < len; i++) buf[i] = tmp[i];
+	buf[len] = '\0';
+	return len;
+#else
+	return -1;
+#endif
+}
+
 /* ------------------------------------------------------------------------- */
 /*
  * Put a NUL-terminated ASCII number (base <= 36) in a buffer in reverse
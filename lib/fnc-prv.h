@@ -55,6 +55,10 @@ hawk_fnc_t* hawk_findfncwithucs (hawk_t* hawk, const hawk_ucs_t* name);
 #	define hawk_findfncwithoocs hawk_findfncwithucs
 #endif
 
+/* finds an intrinsic function for a runtime context and reports a failure
+ * through the runtime context. referenced by mod-hawk.c */
+HAWK_EXPORT hawk_fnc_t* hawk_rtx_findfncwithoocs (hawk_rtx_t* rtx, const hawk_oocs_t* name);
+
 /* EXPORT is required for linking on windows as they are referenced by mod-str.c */
 HAWK_EXPORT int hawk_fnc_gsub    (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi);
 HAWK_EXPORT int hawk_fnc_index   (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi);
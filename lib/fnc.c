@@ -333,6 +333,21 @@ hawk_fnc_t* hawk_findfncwithucs (hawk_t* hawk, const hawk_ucs_t* name)
 #endif
 }
 
+hawk_fnc_t* hawk_rtx_findfncwithoocs (hawk_rtx_t* rtx, const hawk_oocs_t* name)
+{
+	hawk_t* hawk = hawk_rtx_gethawk(rtx);
+	hawk_fnc_t* fnc;
+
+	/* find_fnc() sets the error in the hawk object shared by
+	 * the runtime contexts. move it to rtx under the lock */
+	hawk_mtx_lock (&hawk->mtx, HAWK_NULL);
+	fnc = find_fnc(hawk, name);
+	if (!fnc) hawk_rtx_errorfromhawk (rtx, hawk);
+	hawk_mtx_unlock (&hawk->mtx);
+
+	return fnc;
+}
+
 static int fnc_close (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
 	hawk_oow_t nargs;
@@ -702,7 +717,7 @@ int hawk_fnc_length (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 		{
 			case HAWK_VAL_MAP:
 				/* map size */
-				len = HAWK_MAP_SIZE(((hawk_val_map_t*)v)->map);
+				len = HAWK_VAL_MAP_SIZE(v);
 				break;
 
 			case HAWK_VAL_ARR: /* returns the number of set items instead of the last index + 1 */
@@ -823,9 +838,9 @@ static int fnc_split (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi, int use_array)
 
 	hawk_oow_t org_len;
 	hawk_tre_t* fs_rex = HAWK_NULL;
-	hawk_tre_t* fs_rex_free = HAWK_NULL;
 
-	hawk_oocs_t tok;
+	hawk_oocs_t tok[32];
+	hawk_oow_t ntoks, i;
 	hawk_int_t nflds;
 	int x, byte_str, do_fld = 0;
 	int switch_fs_to_bchr = 0;
@@ -877,12 +892,9 @@ static int fnc_split (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi, int use_array)
 		{
 			if (a2)
 			{
-				x = rtx->gbl.ignorecase?
-					hawk_rtx_buildrex(rtx, fs.ptr, fs.len, HAWK_NULL, &fs_rex):
-					hawk_rtx_buildrex(rtx, fs.ptr, fs.len, &fs_rex, HAWK_NULL);
-				if (x <= -1) goto oops;
-
-				fs_rex_free = fs_rex;
+				/* the expression is owned by the cache. no need to free it */
+				fs_rex = hawk_rtx_getcachedrex(rtx, fs.ptr, fs.len, rtx->gbl.ignorecase);
+				if (HAWK_UNLIKELY(!fs_rex)) goto oops;
 			}
 			else
 			{
@@ -939,64 +951,82 @@ static int fnc_split (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi, int use_array)
 
 	while (p)
 	{
+		ntoks = 1;
 		if (fs_rex)
 		{
-			p = byte_str? (hawk_ooch_t*)hawk_rtx_tokbcharsbyrex(rtx, (hawk_bch_t*)str.ptr, org_len, (hawk_bch_t*)p, str.len, fs_rex, (hawk_bcs_t*)&tok):
-			              hawk_rtx_tokoocharsbyrex(rtx, str.ptr, org_len, p, str.len, fs_rex, &tok);
+			p = byte_str? (hawk_ooch_t*)hawk_rtx_tokbcharsbyrex(rtx, (hawk_bch_t*)str.ptr, org_len, (hawk_bch_t*)p, str.len, fs_rex, (hawk_bcs_t*)&tok[0]):
+			              hawk_rtx_tokoocharsbyrex(rtx, str.ptr, org_len, p, str.len, fs_rex, &tok[0]);
 			if (p && hawk_rtx_geterrnum(rtx) != HAWK_ENOERR) goto oops;
 		}
 		else if (do_fld)
 		{
 			/* [NOTE] even if byte_str is true, the field seperator is of the ooch type.
 			 *        there may be some data truncation and related issues */
-			p = byte_str? (hawk_ooch_t*)hawk_rtx_fldbchars(rtx, (hawk_bch_t*)p, str.len, fs.ptr[1], fs.ptr[2], fs.ptr[3], fs.ptr[4], (hawk_bcs_t*)&tok):
-			              hawk_rtx_fldoochars(rtx, p, str.len, fs.ptr[1], fs.ptr[2], fs.ptr[3], fs.ptr[4], &tok);
+			p = byte_str? (hawk_ooch_t*)hawk_rtx_fldbchars(rtx, (hawk_bch_t*)p, str.len, fs.ptr[1], fs.ptr[2], fs.ptr[3], fs.ptr[4], (hawk_bcs_t*)&tok[0]):
+			              hawk_rtx_fldoochars(rtx, p, str.len, fs.ptr[1], fs.ptr[2], fs.ptr[3], fs.ptr[4], &tok[0]);
+		}
+		else if (fs.len == 1)
+		{
+			/* find a batch of fields at a time */
+			if (byte_str)
+			{
+				hawk_bch_t* rest;
+				ntoks = hawk_rtx_splbchars(rtx, (hawk_bch_t*)p, str.len, ((hawk_bch_t*)fs.ptr)[0], (hawk_bcs_t*)tok, HAWK_COUNTOF(tok), &rest);
+				p = (hawk_ooch_t*)rest;
+			}
+			else
+			{
+				ntoks = hawk_rtx_sploochars(rtx, p, str.len, fs.ptr[0], tok, HAWK_COUNTOF(tok), &p);
+			}
 		}
 		else
 		{
-			p = byte_str? (hawk_ooch_t*)hawk_rtx_tokbcharswithbchars(rtx, (hawk_bch_t*)p, str.len, (hawk_bch_t*)fs.ptr, fs.len, (hawk_bcs_t*)&tok):
-			              hawk_rtx_tokoocharswithoochars(rtx, p, str.len, fs.ptr, fs.len, &tok);
+			p = byte_str? (hawk_ooch_t*)hawk_rtx_tokbcharswithbchars(rtx, (hawk_bch_t*)p, str.len, (hawk_bch_t*)fs.ptr, fs.len, (hawk_bcs_t*)&tok[0]):
+			              hawk_rtx_tokoocharswithoochars(rtx, p, str.len, fs.ptr, fs.len, &tok[0]);
 		}
 
-		if (nflds == 0 && !p && tok.len == 0)
+		if (nflds == 0 && !p && ntoks == 1 && tok[0].len == 0)
 		{
 			/* no field at all*/
 			break;
 		}
 
-		HAWK_ASSERT ((tok.ptr && tok.len > 0) || tok.len == 0);
+		for (i = 0; i < ntoks; i++)
+		{
+			HAWK_ASSERT ((tok[i].ptr && tok[i].len > 0) || tok[i].len == 0);
 
-		/* create the field string - however, the split function must
-		 * create a numeric value if the string is a number */
-		/*t2 = hawk_rtx_makestrvalwithoocs (rtx, &tok);*/
-		/*t2 = hawk_rtx_makenstrvalwithoocs(rtx, &tok); */
-		t2 = byte_str? hawk_rtx_makenumormbsvalwithbchars(rtx, (hawk_bch_t*)tok.ptr, tok.len):
-		               hawk_rtx_makenumorstrvalwithoochars(rtx, tok.ptr, tok.len);
-		if (HAWK_UNLIKELY(!t2)) goto oops;
+			/* create the field string - however, the split function must
+			 * create a numeric value if the string is a number */
+			/*t2 = hawk_rtx_makestrvalwithoocs (rtx, &tok[i]);*/
+			/*t2 = hawk_rtx_makenstrvalwithoocs(rtx, &tok[i]); */
+			t2 = byte_str? hawk_rtx_makenumormbsvalwithbchars(rtx, (hawk_bch_t*)tok[i].ptr, tok[i].len):
+			               hawk_rtx_makenumorstrvalwithoochars(rtx, tok[i].ptr, tok[i].len);
+			if (HAWK_UNLIKELY(!t2)) goto oops;
 
-		if (use_array)
-		{
-			if (!hawk_rtx_setarrvalfld(rtx, t1, ++nflds, t2))
+			if (use_array)
 			{
-				hawk_rtx_refupval (rtx, t2);
-				hawk_rtx_refdownval (rtx, t2);
-				goto oops;
+				if (!hawk_rtx_setarrvalfld(rtx, t1, ++nflds, t2))
+				{
+					hawk_rtx_refupval (rtx, t2);
+					hawk_rtx_refdownval (rtx, t2);
+					goto oops;
+				}
 			}
-		}
-		else
-		{
-			/* put it into the map */
-			hawk_ooch_t key_buf[HAWK_SIZEOF(hawk_int_t)*8+2];
-			hawk_oow_t key_len;
+			else
+			{
+				/* put it into the map */
+				hawk_ooch_t key_buf[HAWK_SIZEOF(hawk_int_t)*8+2];
+				hawk_oow_t key_len;
 
-			key_len = hawk_int_to_oocstr(++nflds, 10, HAWK_NULL, key_buf, HAWK_COUNTOF(key_buf));
-			HAWK_ASSERT (key_len != (hawk_oow_t)-1);
+				key_len = hawk_int_to_oocstr(++nflds, 10, HAWK_NULL, key_buf, HAWK_COUNTOF(key_buf));
+				HAWK_ASSERT (key_len != (hawk_oow_t)-1);
 
-			if (!hawk_rtx_setmapvalfld(rtx, t1, key_buf, key_len, t2))
-			{
-				hawk_rtx_refupval (rtx, t2);
-				hawk_rtx_refdownval (rtx, t2);
-				goto oops;
+				if (!hawk_rtx_setmapvalfld(rtx, t1, key_buf, key_len, t2))
+				{
+					hawk_rtx_refupval (rtx, t2);
+					hawk_rtx_refdownval (rtx, t2);
+					goto oops;
+				}
 			}
 		}
 
@@ -1018,14 +1048,6 @@ static int fnc_split (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi, int use_array)
 			hawk_rtx_freevaloocstr (rtx, t0, fs_free);
 	}
 
-	if (fs_rex_free)
-	{
-		if (rtx->gbl.ignorecase)
-			hawk_rtx_freerex (rtx, HAWK_NULL, fs_rex_free);
-		else
-			hawk_rtx_freerex (rtx, fs_rex_free, HAWK_NULL);
-	}
-
 	t1 = hawk_rtx_makeintval(rtx, nflds);
 	if (HAWK_UNLIKELY(!t1)) return -1;
 
@@ -1047,14 +1069,6 @@ oops:
 		else
 			hawk_rtx_freevaloocstr (rtx, t0, fs_free);
 	}
-
-	if (fs_rex_free)
-	{
-		if (rtx->gbl.ignorecase)
-			hawk_rtx_freerex (rtx, HAWK_NULL, fs_rex_free);
-		else
-			hawk_rtx_freerex (rtx, fs_rex_free, HAWK_NULL);
-	}
 	return -1;
 }
 
@@ -1118,7 +1132,15 @@ int hawk_fnc_tolower (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 			if (HAWK_UNLIKELY(!r)) return -1;
 			str.ptr = ((hawk_val_str_t*)r)->val.ptr;
 			str.len = ((hawk_val_str_t*)r)->val.len;
-			for (i = 0; i < str.len; i++) str.ptr[i] = hawk_to_ooch_lower(str.ptr[i]);
+			if (rtx->hawk->opt.trait & HAWK_BYTEIO)
+			{
+				/* a character above 0x7F is a part of a multi-byte sequence */
+				for (i = 0; i < str.len; i++) if (str.ptr[i] <= 0x7F) str.ptr[i] = hawk_to_ooch_lower(str.ptr[i]);
+			}
+			else
+			{
+				for (i = 0; i < str.len; i++) str.ptr[i] = hawk_to_ooch_lower(str.ptr[i]);
+			}
 			break;
 		}
 	}
@@ -1177,7 +1199,15 @@ int hawk_fnc_toupper (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 			if (HAWK_UNLIKELY(!r)) return -1;
 			str.ptr = ((hawk_val_str_t*)r)->val.ptr;
 			str.len = ((hawk_val_str_t*)r)->val.len;
-			for (i = 0; i < str.len; i++) str.ptr[i] = hawk_to_ooch_upper(str.ptr[i]);
+			if (rtx->hawk->opt.trait & HAWK_BYTEIO)
+			{
+				/* a character above 0x7F is a part of a multi-byte sequence */
+				for (i = 0; i < str.len; i++) if (str.ptr[i] <= 0x7F) str.ptr[i] = hawk_to_ooch_upper(str.ptr[i]);
+			}
+			else
+			{
+				for (i = 0; i < str.len; i++) str.ptr[i] = hawk_to_ooch_upper(str.ptr[i]);
+			}
 			break;
 		}
 	}
@@ -1410,7 +1440,6 @@ static int __substitute (hawk_rtx_t* rtx, hawk_oow_t max_count)
 	int s2_free = 0;
 
 	hawk_tre_t* rex = HAWK_NULL;
-	hawk_tre_t* rex_free = HAWK_NULL;
 	hawk_oow_t sub_count;
 
 	s0.ptr = HAWK_NULL;
@@ -1478,14 +1507,9 @@ static int __substitute (hawk_rtx_t* rtx, hawk_oow_t max_count)
 
 	if (a0_vtype != HAWK_VAL_REX)
 	{
-		int x;
-
-		x = rtx->gbl.ignorecase?
-			hawk_rtx_buildrex(rtx, s0.ptr, s0.len, HAWK_NULL, &rex):
-			hawk_rtx_buildrex(rtx, s0.ptr, s0.len, &rex, HAWK_NULL);
-		if (HAWK_UNLIKELY(x <= -1)) goto oops;
-
-		rex_free = rex;
+		/* the expression is owned by the cache. no need to free it */
+		rex = hawk_rtx_getcachedrex(rtx, s0.ptr, s0.len, rtx->gbl.ignorecase);
+		if (HAWK_UNLIKELY(!rex)) goto oops;
 	}
 
 	sub_count = max_count;
@@ -1500,15 +1524,6 @@ static int __substitute (hawk_rtx_t* rtx, hawk_oow_t max_count)
 		if (__substitute_oocs(rtx, &sub_count, rex, (hawk_oocs_t*)&s1, (hawk_oocs_t*)&s2, &rtx->fnc.oout) <= -1) goto oops;
 	}
 
-	if (rex_free)
-	{
-		if (rtx->gbl.ignorecase)
-			hawk_rtx_freerex (rtx, HAWK_NULL, rex_free);
-		else
-			hawk_rtx_freerex (rtx, rex_free, HAWK_NULL);
-		rex_free = HAWK_NULL;
-	}
-
 	switch (s2_free)
 	{
 		case 1:
@@ -1565,14 +1580,6 @@ static int __substitute (hawk_rtx_t* rtx, hawk_oow_t max_count)
 	return 0;
 
 oops:
-	if (rex_free)
-	{
-		if (rtx->gbl.ignorecase)
-			hawk_rtx_freerex (rtx, HAWK_NULL, rex_free);
-		else
-			hawk_rtx_freerex (rtx, rex_free, HAWK_NULL);
-	}
-
 	if (s2.ptr)
 	{
 		switch (s2_free)
@@ -2029,7 +2036,7 @@ val_map:
 
 		if (!hawk_rtx_getfirstmapvalitr(rtx, a0_val, &itr)) goto done; /* map empty */
 
-		msz = hawk_map_getsize(((hawk_val_map_t*)a0_val)->map);
+		msz = HAWK_VAL_MAP_SIZE(a0_val);
 		HAWK_ASSERT (msz > 0);
 
 		va = (hawk_val_t**)hawk_rtx_allocmem(rtx, msz * HAWK_SIZEOF(*va));
@@ -347,7 +347,76 @@ HAWK_EXPORT int hawk_fmt_uintmax_to_ucstr (
 #	define hawk_fmt_uintmax_to_oocstr hawk_fmt_uintmax_to_ucstr
 #endif
 
-/* TODO: hawk_fmt_fltmax_to_bcstr()... hawk_fmt_fltmax_to_ucstr() */
+/**
+ * The hawk_fmt_intmax_to_decbcstr() function formats an integer \a value
+ * in decimal without any padding. It is faster than hawk_fmt_intmax_to_bcstr()
+ * as it produces two digits at a time from a table.
+ *
+ * \return
+ *  - -1 if \a bufsize is too small for the digits and a terminating null.
+ *  - number of characters written to the buffer excluding a terminating
+ *    null in all other cases.
+ */
+HAWK_EXPORT int hawk_fmt_intmax_to_decbcstr (
+	hawk_bch_t*       buf,             /**< buffer pointer */
+	int               bufsize,         /**< buffer size */
+	hawk_intmax_t     value            /**< integer to format */
+);
+
+/**
+ * The hawk_fmt_intmax_to_decucstr() function formats an integer \a value
+ * in decimal to a unicode string buffer. It behaves the same as
+ * hawk_fmt_intmax_to_decbcstr().
+ */
+HAWK_EXPORT int hawk_fmt_intmax_to_decucstr (
+	hawk_uch_t*       buf,             /**< buffer pointer */
+	int               bufsize,         /**< buffer size */
+	hawk_intmax_t     value            /**< integer to format */
+);
+
+/**
+ * The hawk_fmt_flt_to_bcstr() function formats a floating-point \a value
+ * as snprintf() does with the '%.Nf' or '%.Ng' format where N is
+ * \a precision. \a conv must be 'f' or 'g'. It produces the digits
+ * with integer arithmetic and handles a value only if it can produce
+ * the exact result. A value whose magnitude is 2^64 or greater, a value
+ * with bits below 2^-128, infinity and nan are not handled, nor is a
+ * precision greater than 19.
+ *
+ * \return
+ *  - -1 if the value, the conversion or the precision is not handled or
+ *    \a bufsize is too small. The caller should fall back to a generic
+ *    formatter.
+ *  - number of characters written to the buffer excluding a terminating
+ *    null in all other cases.
+ */
+HAWK_EXPORT int hawk_fmt_flt_to_bcstr (
+	hawk_bch_t*       buf,             /**< buffer pointer */
+	int               bufsize,         /**< buffer size */
+	hawk_flt_t        value,           /**< number to format */
+	int               conv,            /**< 'f' or 'g' */
+	int               precision        /**< precision */
+);
+
+/**
+ * The hawk_fmt_flt_to_ucstr() function formats a floating-point \a value
+ * to a unicode string buffer. It behaves the same as hawk_fmt_flt_to_bcstr().
+ */
+HAWK_EXPORT int hawk_fmt_flt_to_ucstr (
+	hawk_uch_t*       buf,             /**< buffer pointer */
+	int               bufsize,         /**< buffer size */
+	hawk_flt_t        value,           /**< number to format */
+	int               conv,            /**< 'f' or 'g' */
+	int               precision        /**< precision */
+);
+
+#if defined(HAWK_OOCH_IS_BCH)
+#	define hawk_fmt_intmax_to_decoocstr hawk_fmt_intmax_to_decbcstr
+#	define hawk_fmt_flt_to_oocstr hawk_fmt_flt_to_bcstr
+#else
+#	define hawk_fmt_intmax_to_decoocstr hawk_fmt_intmax_to_decucstr
+#	define hawk_fmt_flt_to_oocstr hawk_fmt_flt_to_ucstr
+#endif
 
 /* =========================================================================
  * FORMATTED OUTPUT
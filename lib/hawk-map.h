@@ -27,8 +27,8 @@
 
 /*
  * it is a convenience header file to switch easily between a red-black tree
- * and a hash table. You must define either HAWK_MAP_IS_HTB or HAWK_MAP_IS_RBT
- * before including this file.
+ * and hash tables. You must define one of HAWK_MAP_IS_HTB, HAWK_MAP_IS_OHT and
+ * HAWK_MAP_IS_RBT before including this file.
  */
 
 #if defined(HAWK_MAP_IS_HTB)
@@ -94,6 +94,69 @@
 #	define HAWK_MAP_KLEN(p)                          HAWK_HTB_KLEN(p)
 #	define HAWK_MAP_VPTR(p)                          HAWK_HTB_VPTR(p)
 #	define HAWK_MAP_VLEN(p)                          HAWK_HTB_VLEN(p)
+#elif defined(HAWK_MAP_IS_OHT)
+#	include <hawk-oht.h>
+#	define HAWK_MAP_STYLE_DEFAULT                    HAWK_OHT_STYLE_DEFAULT
+#	define HAWK_MAP_STYLE_INLINE_COPIERS             HAWK_OHT_STYLE_INLINE_COPIERS
+#	define HAWK_MAP_STYLE_INLINE_KEY_COPIER          HAWK_OHT_STYLE_INLINE_KEY_COPIER
+#	define HAWK_MAP_STYLE_INLINE_VALUE_COPIER        HAWK_OHT_STYLE_INLINE_VALUE_COPIER
+#	define hawk_get_map_style(kind)                  hawk_get_oht_style(kind)
+#	define hawk_map_open(mmgr,ext,capa,factor,ks,vs) hawk_oht_open(mmgr,ext,capa,factor,ks,vs)
+#	define hawk_map_close(map)                       hawk_oht_close(map)
+#	define hawk_map_init(map,mmgr,capa,factor,ks,vs) hawk_oht_init(map,mmgr,capa,factor,ks,vs)
+#	define hawk_map_fini(map)                        hawk_oht_fini(map)
+#	define hawk_map_getxtn(map)                      hawk_oht_getxtn(map)
+#	define hawk_map_getsize(map)                     hawk_oht_getsize(map)
+#	define hawk_map_getcapa(map)                     hawk_oht_getcapa(map)
+#	define hawk_map_getstyle(map)                    hawk_oht_getstyle(map)
+#	define hawk_map_setstyle(map,cbs)                hawk_oht_setstyle(map,cbs)
+#	define hawk_map_search(map,kptr,klen)            hawk_oht_search(map,kptr,klen)
+#	define hawk_map_upsert(map,kptr,klen,vptr,vlen)  hawk_oht_upsert(map,kptr,klen,vptr,vlen)
+#	define hawk_map_ensert(map,kptr,klen,vptr,vlen)  hawk_oht_ensert(map,kptr,klen,vptr,vlen)
+#	define hawk_map_insert(map,kptr,klen,vptr,vlen)  hawk_oht_insert(map,kptr,klen,vptr,vlen)
+#	define hawk_map_update(map,kptr,klen,vptr,vlen)  hawk_oht_update(map,kptr,klen,vptr,vlen)
+#	define hawk_map_cbsert(map,kptr,klen,cb,ctx)     hawk_oht_cbsert(map,kptr,klen,cb,ctx)
+#	define hawk_map_delete(map,kptr,klen)            hawk_oht_delete(map,kptr,klen)
+#	define hawk_map_clear(map)                       hawk_oht_clear(map)
+#	define hawk_init_map_itr(itr,dir)                hawk_init_oht_itr(itr) /* dir not used. not supported */
+#	define hawk_map_getfirstpair(map,itr)            hawk_oht_getfirstpair(map,itr)
+#	define hawk_map_getnextpair(map,itr)             hawk_oht_getnextpair(map,itr)
+#	define hawk_map_walk(map,walker,ctx)             hawk_oht_walk(map,walker,ctx)
+#	define HAWK_MAP_WALK_STOP                        HAWK_OHT_WALK_STOP
+#	define HAWK_MAP_WALK_FORWARD                     HAWK_OHT_WALK_FORWARD
+#	define hawk_map_walk_t                           hawk_oht_walk_t
+#	define HAWK_MAP_KEY                              HAWK_OHT_KEY
+#	define HAWK_MAP_VAL                              HAWK_OHT_VAL
+#	define hawk_map_id_t                             hawk_oht_id_t
+#	define hawk_map_t                                hawk_oht_t
+#	define hawk_map_pair_t                           hawk_oht_pair_t
+#	define hawk_map_style_t                          hawk_oht_style_t
+#	define hawk_map_cbserter_t                       hawk_oht_cbserter_t
+#	define hawk_map_itr_t                            hawk_oht_itr_t
+#	define hawk_map_walker_t                         hawk_oht_walker_t
+#	define HAWK_MAP_COPIER_SIMPLE                    HAWK_OHT_COPIER_SIMPLE
+#	define HAWK_MAP_COPIER_INLINE                    HAWK_OHT_COPIER_INLINE
+#	define HAWK_MAP_COPIER_DEFAULT                   HAWK_OHT_COPIER_DEFAULT
+#	define HAWK_MAP_FREEER_DEFAULT                   HAWK_OHT_FREEER_DEFAULT
+#	define HAWK_MAP_COMPER_DEFAULT                   HAWK_OHT_COMPER_DEFAULT
+#	define HAWK_MAP_KEEPER_DEFAULT                   HAWK_OHT_KEEPER_DEFAULT
+#	define HAWK_MAP_SIZER_DEFAULT                    HAWK_OHT_SIZER_DEFAULT
+#	define HAWK_MAP_HASHER_DEFAULT                   HAWK_OHT_HASHER_DEFAULT
+#	define HAWK_MAP_SIZE(map)                        HAWK_OHT_SIZE(map)
+#	define HAWK_MAP_KCOPIER(map)                     HAWK_OHT_KCOPIER(map)
+#	define HAWK_MAP_VCOPIER(map)                     HAWK_OHT_VCOPIER(map)
+#	define HAWK_MAP_KFREEER(map)                     HAWK_OHT_KFREEER(map)
+#	define HAWK_MAP_VFREEER(map)                     HAWK_OHT_VFREEER(map)
+#	define HAWK_MAP_COMPER(map)                      HAWK_OHT_COMPER(map)
+#	define HAWK_MAP_KEEPER(map)                      HAWK_OHT_KEEPER(map)
+#	define HAWK_MAP_KSCALE(map)                      HAWK_OHT_KSCALE(map)
+#	define HAWK_MAP_VSCALE(map)                      HAWK_OHT_VSCALE(map)
+#	define HAWK_MAP_KPTL(p)                          HAWK_OHT_KPTL(p)
+#	define HAWK_MAP_VPTL(p)                          HAWK_OHT_VPTL(p)
+#	define HAWK_MAP_KPTR(p)                          HAWK_OHT_KPTR(p)
+#	define HAWK_MAP_KLEN(p)                          HAWK_OHT_KLEN(p)
+#	define HAWK_MAP_VPTR(p)                          HAWK_OHT_VPTR(p)
+#	define HAWK_MAP_VLEN(p)                          HAWK_OHT_VLEN(p)
 #elif defined(HAWK_MAP_IS_RBT)
 #	include <hawk-rbt.h>
 #	define HAWK_MAP_STYLE_DEFAULT                    HAWK_RBT_STYLE_DEFAULT
@@ -158,7 +221,7 @@
 #	define HAWK_MAP_VPTR(p)                          HAWK_RBT_VPTR(p)
 #	define HAWK_MAP_VLEN(p)                          HAWK_RBT_VLEN(p)
 #else
-#	error define HAWK_MAP_IS_HTB or HAWK_MAP_IS_RBT before including this file
+#	error define HAWK_MAP_IS_HTB, HAWK_MAP_IS_OHT or HAWK_MAP_IS_RBT before including this file
 #endif
 
 #endif
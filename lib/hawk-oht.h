@@ -0,0 +1,570 @@
+/*
+    Copyright (c) 2006-2020 Chung, Hyung-Hwan. All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _HAWK_OHT_H_
+#define _HAWK_OHT_H_
+
+#include <hawk-cmn.h>
+
+/**@file
+ * This file provides an open-addressing hash table encapsulated in the
+ * #hawk_oht_t type. Unlike #hawk_htb_t, it keeps the hash value and the
+ * pointer to a key/value pair in a flat slot array and resolves collisions
+ * with robin hood linear probing. A pair is still allocated separately so
+ * that a pair pointer remains valid until the pair is deleted.
+ * Its interface is the same as #hawk_htb_t except the iterator.
+ *
+ * @code
+ * #include <hawk-oht.h>
+ *
+ * int main ()
+ * {
+ *   hawk_oht_t* s1;
+ *   int i;
+ *
+ *   s1 = hawk_oht_open (gem, 0, 30, 75, 1, 1); // error handling skipped
+ *   hawk_oht_setstyle (s1, hawk_get_oht_style(HAWK_OHT_STYLE_INLINE_COPIERS));
+ *
+ *   for (i = 0; i < 20; i++)
+ *   {
+ *     int x = i * 20;
+ *     hawk_oht_insert (s1, &i, HAWK_SIZEOF(i), &x, HAWK_SIZEOF(x)); // eror handling skipped
+ *   }
+ *
+ *   hawk_oht_close (s1);
+ *   return 0;
+ * }
+ * @endcode
+ */
+
+typedef struct hawk_oht_t hawk_oht_t;
+typedef struct hawk_oht_pair_t hawk_oht_pair_t;
+typedef struct hawk_oht_slot_t hawk_oht_slot_t;
+
+/**
+ * The hawk_oht_walk_t type defines values that the walker can return.
+ */
+enum hawk_oht_walk_t
+{
+	HAWK_OHT_WALK_STOP    = 0,
+	HAWK_OHT_WALK_FORWARD = 1
+};
+typedef enum hawk_oht_walk_t hawk_oht_walk_t;
+
+/**
+ * The hawk_oht_id_t type defines IDs to indicate a key or a value in various
+ * functions.
+ */
+enum hawk_oht_id_t
+{
+	HAWK_OHT_KEY = 0,
+	HAWK_OHT_VAL = 1
+};
+typedef enum hawk_oht_id_t hawk_oht_id_t;
+
+/**
+ * The hawk_oht_copier_t type defines a pair contruction callback.
+ */
+typedef void* (*hawk_oht_copier_t) (
+	hawk_oht_t* oht  /* hash table */,
+	void*       dptr /* pointer to a key or a value */,
+	hawk_oow_t  dlen /* length of a key or a value */
+);
+
+/**
+ * The hawk_oht_freeer_t defines a key/value destruction callback.
+ */
+typedef void (*hawk_oht_freeer_t) (
+	hawk_oht_t* oht,  /**< hash table */
+	void*       dptr, /**< pointer to a key or a value */
+	hawk_oow_t  dlen  /**< length of a key or a value */
+);
+
+/**
+ * The hawk_oht_comper_t type defines a key comparator that is called when
+ * the table needs to compare keys whose hash values are the same.
+ * It must return 0 if the keys are the same and a non-zero value otherwise.
+ */
+typedef int (*hawk_oht_comper_t) (
+	const hawk_oht_t* oht,    /**< hash table */
+	const void*       kptr1,  /**< key pointer */
+	hawk_oow_t        klen1,  /**< key length */
+	const void*       kptr2,  /**< key pointer */
+	hawk_oow_t        klen2   /**< key length */
+);
+
+/**
+ * The hawk_oht_keeper_t type defines a value keeper that is called when
+ * a value is retained in the context that it should be destroyed because
+ * it is identical to a new value. Two values are identical if their
+ * pointers and lengths are equal.
+ */
+typedef void (*hawk_oht_keeper_t) (
+	hawk_oht_t* oht,    /**< hash table */
+	void*       vptr,   /**< value pointer */
+	hawk_oow_t  vlen    /**< value length */
+);
+
+/**
+ * The hawk_oht_sizer_t type defines a slot capacity calculator that is called
+ * when the table needs to grow. The returned value is rounded up to a power
+ * of 2.
+ */
+typedef hawk_oow_t (*hawk_oht_sizer_t) (
+	hawk_oht_t* oht,  /**< oht */
+	hawk_oow_t  hint  /**< sizing hint */
+);
+
+/**
+ * The hawk_oht_hasher_t type defines a key hash function
+ */
+typedef hawk_oow_t (*hawk_oht_hasher_t) (
+	const hawk_oht_t*  oht,   /**< hash table */
+	const void*        kptr,  /**< key pointer */
+	hawk_oow_t         klen   /**< key length */
+);
+
+/**
+ * The hawk_oht_walker_t defines a pair visitor.
+ */
+typedef hawk_oht_walk_t (*hawk_oht_walker_t) (
+	hawk_oht_t*      oht,   /**< oht */
+	hawk_oht_pair_t* pair,  /**< pointer to a key/value pair */
+	void*            ctx    /**< pointer to user-defined data */
+);
+
+/**
+ * The hawk_oht_cbserter_t type defines a callback function for hawk_oht_cbsert().
+ * It works like the callback of hawk_htb_cbsert(). When a new pair is created,
+ * the callback must allocate it with hawk_oht_allocpair() and the table takes
+ * it over. When it returns a pair different from the given existing pair,
+ * the table replaces the existing pair with the returned pair.
+ */
+typedef hawk_oht_pair_t* (*hawk_oht_cbserter_t) (
+	hawk_oht_t*      oht,    /**< hash table */
+	hawk_oht_pair_t* pair,   /**< pair pointer */
+	void*            kptr,   /**< key pointer */
+	hawk_oow_t       klen,   /**< key length */
+	void*            ctx     /**< callback context */
+);
+
+/**
+ * The hawk_oht_pair_t type defines a hash table pair. A pair is composed of
+ * a key and a value.
+ */
+struct hawk_oht_pair_t
+{
+	hawk_ptl_t key;
+	hawk_ptl_t val;
+};
+
+/**
+ * The hawk_oht_slot_t type defines a slot in the probing array. A slot
+ * is empty if \a pair is #HAWK_NULL.
+ */
+struct hawk_oht_slot_t
+{
+	hawk_oow_t       hash; /**< hash value of the key returned by the hasher */
+	hawk_oht_pair_t* pair;
+};
+
+typedef struct hawk_oht_style_t hawk_oht_style_t;
+
+struct hawk_oht_style_t
+{
+	hawk_oht_copier_t copier[2];
+	hawk_oht_freeer_t freeer[2];
+	hawk_oht_comper_t comper;   /**< key comparator */
+	hawk_oht_keeper_t keeper;   /**< value keeper */
+	hawk_oht_sizer_t  sizer;    /**< slot capacity recalculator */
+	hawk_oht_hasher_t hasher;   /**< key hasher */
+};
+
+/**
+ * The hawk_oht_style_kind_t type defines the type of predefined
+ * callback set for pair manipulation.
+ */
+enum hawk_oht_style_kind_t
+{
+	/** store the key and the value pointer */
+	HAWK_OHT_STYLE_DEFAULT,
+	/** copy both key and value into the pair */
+	HAWK_OHT_STYLE_INLINE_COPIERS,
+	/** copy the key into the pair but store the value pointer */
+	HAWK_OHT_STYLE_INLINE_KEY_COPIER,
+	/** copy the value into the pair but store the key pointer */
+	HAWK_OHT_STYLE_INLINE_VALUE_COPIER
+};
+
+typedef enum hawk_oht_style_kind_t  hawk_oht_style_kind_t;
+
+/**
+ * The hawk_oht_t type defines an open-addressing hash table.
+ */
+struct hawk_oht_t
+{
+	hawk_gem_t* gem;
+
+	const hawk_oht_style_t* style;
+
+	hawk_uint8_t     scale[2]; /**< length scale */
+	hawk_uint8_t     factor;   /**< load factor in percentage */
+	hawk_uint8_t     shift;    /**< bits to shift a mixed hash value right to get a slot index */
+
+	hawk_oow_t       size;
+	hawk_oow_t       capa;      /**< number of slots. 0 or a power of 2 */
+	hawk_oow_t       threshold;
+
+	hawk_oht_slot_t* slot;     /**< allocated upon the first insertion */
+};
+
+/**
+ * The hawk_oht_itr_t type defines an iterator over a hash table.
+ */
+struct hawk_oht_itr_t
+{
+	hawk_oht_pair_t* pair;
+	hawk_oow_t       slotno;
+};
+
+typedef struct hawk_oht_itr_t hawk_oht_itr_t;
+
+/**
+ * The HAWK_OHT_COPIER_SIMPLE macros defines a copier that remembers the
+ * pointer and length of data in a pair.
+ **/
+#define HAWK_OHT_COPIER_SIMPLE ((hawk_oht_copier_t)1)
+
+/**
+ * The HAWK_OHT_COPIER_INLINE macros defines a copier that copies data into
+ * a pair.
+ **/
+#define HAWK_OHT_COPIER_INLINE ((hawk_oht_copier_t)2)
+
+#define HAWK_OHT_COPIER_DEFAULT (HAWK_OHT_COPIER_SIMPLE)
+#define HAWK_OHT_FREEER_DEFAULT (HAWK_NULL)
+#define HAWK_OHT_COMPER_DEFAULT (hawk_oht_dflcomp)
+#define HAWK_OHT_KEEPER_DEFAULT (HAWK_NULL)
+#define HAWK_OHT_SIZER_DEFAULT  (HAWK_NULL)
+#define HAWK_OHT_HASHER_DEFAULT (hawk_oht_dflhash)
+
+/**
+ * The HAWK_OHT_SIZE() macro returns the number of pairs in a hash table.
+ */
+#define HAWK_OHT_SIZE(m) (*(const hawk_oow_t*)&(m)->size)
+
+/**
+ * The HAWK_OHT_CAPA() macro returns the number of slots in a hash table.
+ */
+#define HAWK_OHT_CAPA(m) (*(const hawk_oow_t*)&(m)->capa)
+
+#define HAWK_OHT_FACTOR(m) (*(const int*)&(m)->factor)
+#define HAWK_OHT_KSCALE(m) (*(const int*)&(m)->scale[HAWK_OHT_KEY])
+#define HAWK_OHT_VSCALE(m) (*(const int*)&(m)->scale[HAWK_OHT_VAL])
+
+#define HAWK_OHT_KPTL(p) (&(p)->key)
+#define HAWK_OHT_VPTL(p) (&(p)->val)
+
+#define HAWK_OHT_KPTR(p) ((p)->key.ptr)
+#define HAWK_OHT_KLEN(p) ((p)->key.len)
+#define HAWK_OHT_VPTR(p) ((p)->val.ptr)
+#define HAWK_OHT_VLEN(p) ((p)->val.len)
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * The hawk_get_oht_style() functions returns a predefined callback set for
+ * pair manipulation.
+ */
+HAWK_EXPORT const hawk_oht_style_t* hawk_get_oht_style (
+	hawk_oht_style_kind_t kind
+);
+
+/**
+ * The hawk_oht_open() function creates a hash table with a dynamic array
+ * slot. The slot array is allocated when the first pair is inserted.
+ * The \a capa parameter is the number of slots allocated then and it is
+ * rounded up to a power of 2. The table grows twice as large when the
+ * number of pairs reaches \a factor percent of the slots.
+ * @return #hawk_oht_t pointer on success, #HAWK_NULL on failure.
+ */
+HAWK_EXPORT hawk_oht_t* hawk_oht_open (
+	hawk_gem_t* gem,
+	hawk_oow_t  xtnsize, /**< extension size in bytes */
+	hawk_oow_t  capa,    /**< initial capacity */
+	int         factor,  /**< load factor */
+	int         kscale,  /**< key scale - 1 to 255 */
+	int         vscale   /**< value scale - 1 to 255 */
+);
+
+/**
+ * The hawk_oht_close() function destroys a hash table.
+ */
+HAWK_EXPORT void hawk_oht_close (
+	hawk_oht_t* oht /**< hash table */
+);
+
+/**
+ * The hawk_oht_init() function initializes a hash table
+ */
+HAWK_EXPORT int hawk_oht_init (
+	hawk_oht_t* oht,    /**< hash table */
+	hawk_gem_t* gem,
+	hawk_oow_t  capa,    /**< initial capacity */
+	int         factor,  /**< load factor */
+	int         kscale,  /**< key scale */
+	int         vscale   /**< value scale */
+);
+
+/**
+ * The hawk_oht_fini() funtion finalizes a hash table
+ */
+HAWK_EXPORT void hawk_oht_fini (
+	hawk_oht_t* oht
+);
+
+#if defined(HAWK_HAVE_INLINE)
+static HAWK_INLINE void* hawk_oht_getxtn (hawk_oht_t* oht) { return (void*)(oht + 1); }
+#else
+#define hawk_oht_getxtn(oht) ((void*)((hawk_oht_t*)(oht) + 1))
+#endif
+
+/**
+ * The hawk_oht_getstyle() function gets manipulation callback function set.
+ */
+HAWK_EXPORT const hawk_oht_style_t* hawk_oht_getstyle (
+	const hawk_oht_t* oht /**< hash table */
+);
+
+/**
+ * The hawk_oht_setstyle() function sets internal manipulation callback
+ * functions for data construction, destruction, resizing, hashing, etc.
+ * The callback structure pointed to by \a style must outlive the hash
+ * table pointed to by \a oht as the hash table doesn't copy the contents
+ * of the structure.
+ */
+HAWK_EXPORT void hawk_oht_setstyle (
+	hawk_oht_t*              oht,  /**< hash table */
+	const hawk_oht_style_t*  style /**< callback function set */
+);
+
+/**
+ * The hawk_oht_getsize() function gets the number of pairs in hash table.
+ */
+HAWK_EXPORT hawk_oow_t hawk_oht_getsize (
+	const hawk_oht_t* oht
+);
+
+/**
+ * The hawk_oht_getcapa() function gets the number of slots allocated.
+ */
+HAWK_EXPORT hawk_oow_t hawk_oht_getcapa (
+	const hawk_oht_t* oht /**< hash table */
+);
+
+/**
+ * The hawk_oht_search() function searches a hash table to find a pair with a
+ * matching key. It returns the pointer to the pair found. If it fails
+ * to find one, it returns HAWK_NULL.
+ * @return pointer to the pair with a maching key,
+ *         or HAWK_NULL if no match is found.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_search (
+	const hawk_oht_t* oht,   /**< hash table */
+	const void*       kptr,  /**< key pointer */
+	hawk_oow_t        klen   /**< key length */
+);
+
+/**
+ * The hawk_oht_upsert() function searches a hash table for the pair with a
+ * matching key. If one is found, it updates the pair. Otherwise, it inserts
+ * a new pair with the key and value given. It returns the pointer to the
+ * pair updated or inserted.
+ * @return pointer to the updated or inserted pair on success,
+ *         HAWK_NULL on failure.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_upsert (
+	hawk_oht_t* oht,   /**< hash table */
+	void*       kptr,  /**< key pointer */
+	hawk_oow_t  klen,  /**< key length */
+	void*       vptr,  /**< value pointer */
+	hawk_oow_t  vlen   /**< value length */
+);
+
+/**
+ * The hawk_oht_ensert() function inserts a new pair with the key and the value
+ * given. If there exists a pair with the key given, the function returns
+ * the pair containing the key.
+ * @return pointer to a pair on success, HAWK_NULL on failure.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_ensert (
+	hawk_oht_t* oht,   /**< hash table */
+	void*       kptr,  /**< key pointer */
+	hawk_oow_t  klen,  /**< key length */
+	void*       vptr,  /**< value pointer */
+	hawk_oow_t  vlen   /**< value length */
+);
+
+/**
+ * The hawk_oht_insert() function inserts a new pair with the key and the value
+ * given. If there exists a pair with the key given, the function returns
+ * HAWK_NULL without channging the value.
+ * @return pointer to the pair created on success, HAWK_NULL on failure.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_insert (
+	hawk_oht_t* oht,   /**< hash table */
+	void*       kptr,  /**< key pointer */
+	hawk_oow_t  klen,  /**< key length */
+	void*       vptr,  /**< value pointer */
+	hawk_oow_t  vlen   /**< value length */
+);
+
+/**
+ * The hawk_oht_update() function updates the value of an existing pair
+ * with a matching key.
+ * @return pointer to the pair on success, HAWK_NULL on no matching pair
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_update (
+	hawk_oht_t* oht,   /**< hash table */
+	void*       kptr,  /**< key pointer */
+	hawk_oow_t  klen,  /**< key length */
+	void*       vptr,  /**< value pointer */
+	hawk_oow_t  vlen   /**< value length */
+);
+
+/**
+ * The hawk_oht_cbsert() function inserts a key/value pair by delegating pair
+ * allocation to a callback function. Depending on the callback function,
+ * it may behave like hawk_oht_insert(), hawk_oht_upsert(), hawk_oht_update(),
+ * hawk_oht_ensert(), or totally differently. See hawk_htb_cbsert() for
+ * an example of the callback function.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_cbsert (
+	hawk_oht_t*         oht,      /**< hash table */
+	void*               kptr,     /**< key pointer */
+	hawk_oow_t          klen,     /**< key length */
+	hawk_oht_cbserter_t cbserter, /**< callback function */
+	void*               ctx       /**< callback context */
+);
+
+/**
+ * The hawk_oht_delete() function deletes a pair with a matching key
+ * @return 0 on success, -1 on failure
+ */
+HAWK_EXPORT int hawk_oht_delete (
+	hawk_oht_t* oht,   /**< hash table */
+	const void* kptr,  /**< key pointer */
+	hawk_oow_t  klen   /**< key length */
+);
+
+/**
+ * The hawk_oht_clear() function empties a hash table
+ */
+HAWK_EXPORT void hawk_oht_clear (
+	hawk_oht_t* oht /**< hash table */
+);
+
+/**
+ * The hawk_oht_walk() function traverses a hash table. The walker
+ * must not insert or delete a pair.
+ */
+HAWK_EXPORT void hawk_oht_walk (
+	hawk_oht_t*       oht,    /**< hash table */
+	hawk_oht_walker_t walker, /**< callback function for each pair */
+	void*             ctx     /**< pointer to user-specific data */
+);
+
+HAWK_EXPORT void hawk_init_oht_itr (
+	hawk_oht_itr_t* itr
+);
+
+/**
+ * The hawk_oht_getfirstpair() function returns the pointer to the first pair
+ * in a hash table.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_getfirstpair (
+	hawk_oht_t*     oht,   /**< hash table */
+	hawk_oht_itr_t* itr    /**< iterator*/
+);
+
+/**
+ * The hawk_oht_getnextpair() function returns the pointer to the next pair
+ * to the current pair in a hash table. The table must not be changed
+ * while it's being iterated.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_getnextpair (
+	hawk_oht_t*      oht,    /**< hash table */
+	hawk_oht_itr_t*  itr     /**< iterator*/
+);
+
+/**
+ * The hawk_oht_allocpair() function allocates a pair for a key and a value
+ * given. But it does not chain the pair allocated into the hash table \a oht.
+ * Use this function at your own risk.
+ */
+HAWK_EXPORT hawk_oht_pair_t* hawk_oht_allocpair (
+	hawk_oht_t* oht,
+	void*       kptr,
+	hawk_oow_t  klen,
+	void*       vptr,
+	hawk_oow_t  vlen
+);
+
+/**
+ * The hawk_oht_freepair() function destroys a pair. But it does not detach
+ * the pair destroyed from the hash table \a oht. Use this function at your
+ * own risk.
+ */
+HAWK_EXPORT void hawk_oht_freepair (
+	hawk_oht_t*      oht,
+	hawk_oht_pair_t* pair
+);
+
+/**
+ * The hawk_oht_dflhash() function is a default hash function.
+ */
+HAWK_EXPORT hawk_oow_t hawk_oht_dflhash (
+	const hawk_oht_t*  oht,
+	const void*        kptr,
+	hawk_oow_t         klen
+);
+
+/**
+ * The hawk_oht_dflcomp() function is default comparator.
+ */
+HAWK_EXPORT int hawk_oht_dflcomp (
+	const hawk_oht_t* oht,
+	const void*       kptr1,
+	hawk_oow_t        klen1,
+	const void*       kptr2,
+	hawk_oow_t        klen2
+);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
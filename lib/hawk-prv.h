@@ -30,11 +30,17 @@
 #include <hawk-ecs.h>
 #include <hawk-fmt.h>
 #include <hawk-htb.h>
+#include <hawk-mtx.h>
 #include <hawk-rbt.h>
 #include <hawk-utl.h>
 
 typedef struct hawk_chain_t hawk_chain_t;
 typedef struct hawk_tree_t hawk_tree_t;
+typedef struct hawk_rexcache_ent_t hawk_rexcache_ent_t;
+typedef struct hawk_fmtseg_t hawk_fmtseg_t;
+typedef struct hawk_fmtcache_ent_t hawk_fmtcache_ent_t;
+typedef struct hawk_srcdgst_t hawk_srcdgst_t;
+typedef struct hawk_rtx_modinst_t hawk_rtx_modinst_t;
 
 #include <hawk.h>
 #include "tree-prv.h"
@@ -70,6 +76,23 @@ typedef struct hawk_tree_t hawk_tree_t;
 /* gc configuration */
 #define HAWK_GC_NUM_GENS (3)
 
+/* work a slice of the incremental collection owes for each unit of work
+ * the collection of the young generations spent on the values promoted
+ * to the oldest generation */
+#define HAWK_GC_INC_PACE (8)
+
+/* phases of the incremental collection */
+enum hawk_gc_inc_phase_t
+{
+	GC_INC_IDLE,
+	GC_INC_COPY,
+	GC_INC_SUBTRACT,
+	GC_INC_REACH,
+	GC_INC_MARK,
+	GC_INC_CLEAR,
+	GC_INC_FREE
+};
+
 /* string cache configuration */
 #define HAWK_STR_CACHE_NUM_BLOCKS (16)
 #define HAWK_STR_CACHE_BLOCK_UNIT (16)
@@ -80,6 +103,15 @@ typedef struct hawk_tree_t hawk_tree_t;
 #define HAWK_MBS_CACHE_BLOCK_UNIT (16)
 #define HAWK_MBS_CACHE_BLOCK_SIZE (128)
 
+/* dynamic regular expression cache configuration.
+ * the number of buckets must be a power of 2 */
+#define HAWK_REX_CACHE_SIZE (64)
+#define HAWK_REX_CACHE_BUCKETS (128)
+
+/* number of the format strings of printf and sprintf kept parsed.
+ * it must be a power of 2 */
+#define HAWK_FMT_CACHE_SIZE (32)
+
 /* maximum number of globals, locals, parameters allowed in parsing */
 #define HAWK_MAX_GBLS    (9999)
 #define HAWK_MAX_LCLS    (9999)
@@ -117,7 +149,7 @@ typedef struct hawk_tree_t hawk_tree_t;
 
 #if defined(__has_builtin)
 
-#	if (!__has_builtin(__builtin_memset) || !__has_builtin(__builtin_memcpy) || !__has_builtin(__builtin_memmove) || !__has_builtin(__builtin_memcmp))
+#	if (!__has_builtin(__builtin_memset) || !__has_builtin(__builtin_memcpy) || !__has_builtin(__builtin_memmove) || !__has_builtin(__builtin_memcmp) || !__has_builtin(__builtin_memchr))
 #	include <string.h>
 #	endif
 
@@ -141,6 +173,11 @@ typedef struct hawk_tree_t hawk_tree_t;
 #	else
 #		define HAWK_MEMCMP(dst,src,size)  memcmp(dst,src,size)
 #	endif
+#	if __has_builtin(__builtin_memchr)
+#		define HAWK_MEMCHR(src,c,size)  __builtin_memchr(src,c,size)
+#	else
+#		define HAWK_MEMCHR(src,c,size)  memchr(src,c,size)
+#	endif
 
 #else
 
@@ -151,12 +188,14 @@ typedef struct hawk_tree_t hawk_tree_t;
 #		undef HAVE___BUILTIN_MEMCPY
 #		undef HAVE___BUILTIN_MEMMOVE
 #		undef HAVE___BUILTIN_MEMCMP
+#		undef HAVE___BUILTIN_MEMCHR
 #	endif
 
 #	if !defined(HAVE___BUILTIN_MEMSET) || \
 	   !defined(HAVE___BUILTIN_MEMCPY) || \
 	   !defined(HAVE___BUILTIN_MEMMOVE) || \
-	   !defined(HAVE___BUILTIN_MEMCMP)
+	   !defined(HAVE___BUILTIN_MEMCMP) || \
+	   !defined(HAVE___BUILTIN_MEMCHR)
 #		include <string.h>
 #	endif
 
@@ -180,10 +219,33 @@ typedef struct hawk_tree_t hawk_tree_t;
 #	else
 #		define HAWK_MEMCMP(dst,src,size)  memcmp(dst,src,size)
 #	endif
+#	if defined(HAVE___BUILTIN_MEMCHR)
+#		define HAWK_MEMCHR(src,c,size)  __builtin_memchr(src,c,size)
+#	else
+#		define HAWK_MEMCHR(src,c,size)  memchr(src,c,size)
+#	endif
 
 #endif
 
 
+/* reduction operators of @pragma reduce */
+enum hawk_reduce_op_t
+{
+	HAWK_REDUCE_SUM,
+	HAWK_REDUCE_MIN,
+	HAWK_REDUCE_MAX,
+	HAWK_REDUCE_CONCAT,
+	HAWK_REDUCE_UNION
+};
+typedef enum hawk_reduce_op_t hawk_reduce_op_t;
+
+typedef struct hawk_reduce_t hawk_reduce_t;
+struct hawk_reduce_t
+{
+	hawk_oow_t gbl; /* global variable index */
+	hawk_reduce_op_t op;
+};
+
 struct hawk_tree_t
 {
 	hawk_oow_t ngbls; /* total number of globals */
@@ -201,6 +263,17 @@ struct hawk_tree_t
 	hawk_chain_t* chain_tail;
 	hawk_oow_t chain_size; /* number of nodes in the chain */
 
+	hawk_oow_t maxfld; /* highest constant field index used. 4 for $4 */
+	int dynfld; /* NF or a field with a non-constant index is used */
+
+	/* global variables to merge from other runtime contexts */
+	struct
+	{
+		hawk_reduce_t* ptr;
+		hawk_oow_t count;
+		hawk_oow_t capa;
+	} reduce;
+
 	int ok;
 };
 
@@ -252,6 +325,10 @@ struct hawk_t
 		} depth;
 
 		hawk_oow_t rtx_stack_limit;
+		hawk_oow_t rtx_gc_slice_work;
+		hawk_oow_t rtx_gc_slice_time;
+		hawk_oow_t rtx_arena_size;
+		hawk_oow_t rtx_max_open_outfiles;
 		hawk_oow_t log_mask;
 		hawk_oow_t log_maxcapa;
 	} opt;
@@ -319,6 +396,15 @@ struct hawk_t
 			hawk_oow_t count;
 			hawk_oow_t capa;
 		} incl_hist;
+
+		/* digests of the source streams read to the end.
+		 * hawk_saveimg() keeps them to find a stale image */
+		struct
+		{
+			hawk_srcdgst_t* ptr;
+			hawk_oow_t count;
+			hawk_oow_t capa;
+		} srcs;
 	} parse;
 
 	/* source code management */
@@ -373,8 +459,77 @@ struct hawk_t
 	hawk_ecb_t* ecb;
 
 	hawk_rbt_t* modtab;
+
+	/* set by hawk_freeze(). the runtime contexts opened over a frozen
+	 * hawk object may run on different threads at the same time. */
+	int frozen;
+	/* guards the module table while it's shared by the runtime contexts */
+	hawk_mtx_t mtx;
 };
 
+/* a regular expression built from a string value and kept for reuse */
+struct hawk_rexcache_ent_t
+{
+	hawk_oow_t hash;
+	hawk_ooch_t* ptn;
+	hawk_oow_t len;
+	int flags; /* HAWK_REXCACHE_IGNORECASE | HAWK_REXCACHE_NOBOUND */
+	hawk_tre_t* code;
+
+	hawk_rexcache_ent_t* link; /* next entry in the same bucket */
+	hawk_rexcache_ent_t* prev; /* more recently used entry */
+	hawk_rexcache_ent_t* next; /* less recently used entry */
+};
+
+/* a segment of a format string parsed for hawk_rtx_format() and
+ * hawk_rtx_formatmbs(). the positions are in characters from the
+ * beginning of the format string */
+enum hawk_fmtseg_type_t
+{
+	HAWK_FMTSEG_LITERAL, /* text copied as it is */
+	HAWK_FMTSEG_SPEC,    /* conversion specification ending at off + len */
+	HAWK_FMTSEG_TAIL     /* conversion specification cut at the end */
+};
+
+struct hawk_fmtseg_t
+{
+	int type;
+	int flags;
+	int wp_idx; /* 1 if the precision is given */
+	hawk_oow_t off; /* position of the literal text or the leading % */
+	hawk_oow_t len; /* length of the text. the conversion character follows a specification */
+	hawk_oow_t star[2]; /* position of * for the width and the precision. (hawk_oow_t)-1 if none */
+	hawk_int_t wp[2]; /* width and precision given in digits */
+};
+
+struct hawk_fmtcache_ent_t
+{
+	hawk_oow_t hash;
+	hawk_oow_t len;
+	int mbs;
+	int busy; /* number of the calls using the segments */
+	hawk_oow_t nsegs;
+	hawk_fmtseg_t* seg; /* followed by a copy of the format string */
+};
+
+/* the digest of a source stream. see get_char() in parse.c */
+struct hawk_srcdgst_t
+{
+	const hawk_ooch_t* path; /* HAWK_NULL for the top-level stream */
+	hawk_oow_t nchars;
+	hawk_oow_t digest;
+};
+
+/* a module initialized for a runtime context. see hawk_rtx_getmodinst() */
+struct hawk_rtx_modinst_t
+{
+	hawk_mod_t* mod;
+	void* inst;
+};
+
+#define HAWK_REXCACHE_IGNORECASE (1 << 0)
+#define HAWK_REXCACHE_NOBOUND    (1 << 1)
+
 struct hawk_chain_t
 {
 	hawk_nde_t* pattern;
@@ -427,6 +582,40 @@ struct hawk_rtx_t
 		hawk_val_chunk_t* rchunk;
 	} vmgr;
 
+	/* hits and misses of the value caches above */
+	struct
+	{
+		hawk_oow_t str_hits;
+		hawk_oow_t str_misses;
+		hawk_oow_t mbs_hits;
+		hawk_oow_t mbs_misses;
+		hawk_oow_t int_hits;
+		hawk_oow_t int_misses;
+		hawk_oow_t flt_hits;
+		hawk_oow_t flt_misses;
+		hawk_oow_t ref_hits;
+		hawk_oow_t ref_misses;
+	} vstat;
+
+	/* the per-record arena for short-lived string values. see val.c */
+	struct
+	{
+		int active; /* set while the pattern-action blocks run */
+		hawk_oow_t capa; /* size of a block. 0 disables the arena */
+		hawk_val_arena_blk_t* cur;
+		hawk_val_arena_blk_t* spare;
+		hawk_val_arena_blk_t pinned; /* list head of the blocks with live values */
+	} arena;
+
+	/* modules initialized for this runtime context in the order of
+	 * initialization and the instance data each module attached */
+	struct
+	{
+		hawk_rtx_modinst_t* ptr;
+		hawk_oow_t count;
+		hawk_oow_t capa;
+	} modinst;
+
 	struct
 	{
 #if defined(HAWK_OOCH_IS_UCH)
@@ -457,8 +646,45 @@ struct hawk_rtx_t
 
 		/* threshold to trigger generational collection. */
 		hawk_oow_t threshold[HAWK_GC_NUM_GENS];
+
+		/* incremental collection of the oldest generation. a round
+		 * takes the values in the oldest generation and moves them
+		 * between the lists below in slices. see val.c for details */
+		struct
+		{
+			int phase; /* one of GC_INC_XXX */
+			hawk_gch_t todo;
+			hawk_gch_t done;
+			hawk_gch_t reach;
+			hawk_oow_t work; /* work budget per slice. 0 for stop-the-world collection */
+			hawk_oow_t time; /* time budget per slice in microseconds. 0 for no limit */
+			hawk_oow_t debt; /* work owed for the values promoted during the round */
+			hawk_oow_t pay; /* part of the debt a slice pays off */
+		} inc;
+
+		/* statistics reported by hawk_rtx_getgcstats() */
+		struct
+		{
+			hawk_oow_t collections[HAWK_GC_NUM_GENS];
+			hawk_oow_t slices;
+			hawk_oow_t rounds;
+			hawk_oow_t freed;
+			hawk_oow_t pause_total; /* in microseconds */
+			hawk_oow_t pause_max;
+		} stat;
 	} gc;
 
+	struct
+	{
+		hawk_rexcache_ent_t ent[HAWK_REX_CACHE_SIZE];
+		hawk_rexcache_ent_t* bucket[HAWK_REX_CACHE_BUCKETS];
+		hawk_rexcache_ent_t* head; /* most recently used */
+		hawk_rexcache_ent_t* tail; /* least recently used */
+		hawk_oow_t count;
+		hawk_oow_t hits;
+		hawk_oow_t misses;
+	} rexcache;
+
 	hawk_nde_blk_t* active_block;
 	hawk_uint8_t* pattern_range_state;
 
@@ -484,6 +710,20 @@ struct hawk_rtx_t
 			hawk_oow_t         len;
 			hawk_val_t*        val; /* $1 .. $NF */
 		}* flds;
+
+		/* a record is split only up to the number of fields the program
+		 * needs. the state below resumes splitting when more is needed */
+		struct
+		{
+			hawk_oow_t max; /* number of fields to split when a record is set */
+			int pending; /* the record has not been split to the end. NF is not set yet */
+			int how;
+			int prefer_number;
+			hawk_oow_t pos; /* where to resume splitting */
+			hawk_ooch_t fs[5];
+			hawk_oow_t fs_len;
+			void* rex;
+		} split;
 	} inrec;
 
 	hawk_nrflt_t nrflt;
@@ -512,6 +752,18 @@ struct hawk_rtx_t
 	{
 		hawk_rio_impl_t handler[HAWK_RIO_NUM];
 		hawk_rio_arg_t* chain;
+		hawk_htb_t index; /* name to the streams of the name */
+
+		struct
+		{
+			hawk_rio_arg_t* head; /* most recently used output file */
+			hawk_rio_arg_t* tail; /* least recently used output file */
+			hawk_oow_t count;
+			hawk_oow_t max;
+			hawk_oow_t hits;
+			hawk_oow_t evictions;
+			hawk_oow_t reopens;
+		} lru;
 	} rio;
 
 	struct
@@ -540,12 +792,22 @@ struct hawk_rtx_t
 		} tmp;
 	} formatmbs;
 
+	struct
+	{
+		hawk_fmtcache_ent_t ent[HAWK_FMT_CACHE_SIZE];
+	} fmtcache;
+
 	struct
 	{
 		hawk_becs_t bout;
 		hawk_ooecs_t oout;
 	} fnc; /* output buffer simple functions like gsub, sub, match*/
 
+	struct
+	{
+		hawk_ooecs_t line; /* output line assembled by print */
+	} print;
+
 	struct
 	{
 		hawk_oow_t block;
@@ -604,7 +866,9 @@ static HAWK_INLINE void HAWK_RTX_STACK_POP (hawk_rtx_t* rtx)
 		(refval)->v_type = HAWK_VAL_REF; \
 		(refval)->v_static = 0; \
 		(refval)->v_nstr = 0; \
+		(refval)->v_ncache = 0; \
 		(refval)->v_gc = 0; \
+		(refval)->v_arena = 0; \
 		(refval)->id = (_id); \
 		(refval)->adr = (_adr); \
 	} while(0);
@@ -171,6 +171,29 @@ HAWK_EXPORT int hawk_parsestd (
 	hawk_parsestd_t* out
 );
 
+/**
+ * The hawk_saveimgstd() function writes the image of the parse tree
+ * built by hawk_parsestd() to the file \a path.
+ * \return 0 on success, -1 on failure.
+ */
+HAWK_EXPORT int hawk_saveimgstd (
+	hawk_t*            hawk,
+	const hawk_bch_t*  path
+);
+
+/**
+ * The hawk_loadimgstd() function loads the parse tree from the image
+ * file \a path written by hawk_saveimgstd(). It parses the source
+ * script in \a in as hawk_parsestd() does if the image file doesn't
+ * exist or is stale.
+ * \return 1 if loaded from the image, 0 if parsed, -1 on failure.
+ */
+HAWK_EXPORT int hawk_loadimgstd (
+	hawk_t*            hawk,
+	hawk_parsestd_t    in[],
+	const hawk_bch_t*  path
+);
+
 /**
  * The hawk_rtx_openstdwithbcstr() function creates a standard runtime context.
  * The caller should keep the contents of \a icf and \a ocf valid throughout
@@ -70,7 +70,12 @@ enum hawk_tre_eflag_t
 {
 	HAWK_TRE_BACKTRACKING = (1 << 0),
 	HAWK_TRE_NOTBOL       = (1 << 1),
-	HAWK_TRE_NOTEOL       = (1 << 2)
+	HAWK_TRE_NOTEOL       = (1 << 2),
+
+	/* the expression may be matched on other threads at the same time.
+	 * the lazy dfa built in the expression is used by one thread at a time
+	 * and the others fall back to the slower matcher */
+	HAWK_TRE_SHARED       = (1 << 3)
 };
 
 #if defined(__cplusplus)
@@ -194,6 +194,8 @@ int hawk_init (hawk_t* hawk, hawk_mmgr_t* mmgr, hawk_cmgr_t* cmgr, const hawk_pr
 	hawk->tree.chain = HAWK_NULL;
 	hawk->tree.chain_tail = HAWK_NULL;
 	hawk->tree.chain_size = 0;
+	hawk->tree.maxfld = 0;
+	hawk->tree.dynfld = 0;
 
 	/* TODO: initial map size?? */
 	hawk->tree.funs = hawk_htb_open(hawk_getgem(hawk), HAWK_SIZEOF(hawk), 512, 70, HAWK_SIZEOF(hawk_ooch_t), 1);
@@ -247,7 +249,12 @@ int hawk_init (hawk_t* hawk, hawk_mmgr_t* mmgr, hawk_cmgr_t* cmgr, const hawk_pr
 
 	hawk_rbt_setstyle (hawk->modtab, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_COPIERS));
 
-	if (hawk_initgbls(hawk) <= -1) goto oops;
+	if (hawk_mtx_init(&hawk->mtx, hawk_getgem(hawk)) <= -1) goto oops;
+	if (hawk_initgbls(hawk) <= -1)
+	{
+		hawk_mtx_fini (&hawk->mtx);
+		goto oops;
+	}
 	return 0;
 
 oops:
@@ -296,6 +303,7 @@ void hawk_fini (hawk_t* hawk)
 
 	hawk_rbt_close (hawk->modtab);
 	hawk_htb_close (hawk->fnc.user);
+	hawk_mtx_fini (&hawk->mtx);
 
 	hawk_arr_close (hawk->parse.params);
 	hawk_arr_close (hawk->parse.lcls);
@@ -310,6 +318,8 @@ void hawk_fini (hawk_t* hawk)
 	fini_token (&hawk->ptok);
 
 	if (hawk->parse.incl_hist.ptr) hawk_freemem (hawk, hawk->parse.incl_hist.ptr);
+	if (hawk->parse.srcs.ptr) hawk_freemem (hawk, hawk->parse.srcs.ptr);
+	if (hawk->tree.reduce.ptr) hawk_freemem (hawk, hawk->tree.reduce.ptr);
 	hawk_clearsionames (hawk);
 
 	/* destroy dynamically allocated options */
@@ -376,6 +386,7 @@ void hawk_clear (hawk_t* hawk)
 	/* hawk_clear() this doesn't pop event callbacks */
 
 	hawk->haltall = 0;
+	hawk->frozen = 0;
 
 	clear_token (&hawk->tok);
 	clear_token (&hawk->ntok);
@@ -401,11 +412,12 @@ void hawk_clear (hawk_t* hawk)
 	hawk->parse.depth.loop = 0;
 	hawk->parse.depth.expr = 0;
 	hawk->parse.depth.incl = 0;
-	hawk->parse.pragma.trait = (hawk->opt.trait & (HAWK_IMPLICIT | HAWK_MULTILINESTR | HAWK_STRIPRECSPC | HAWK_STRIPSTRSPC)); /* implicit on if you didn't mask it off in hawk->opt.trait with hawk_setopt */
+	hawk->parse.pragma.trait = (hawk->opt.trait & (HAWK_IMPLICIT | HAWK_MULTILINESTR | HAWK_STRIPRECSPC | HAWK_STRIPSTRSPC | HAWK_BYTECODE)); /* implicit on if you didn't mask it off in hawk->opt.trait with hawk_setopt */
 	hawk->parse.pragma.rtx_stack_limit = 0;
 	hawk->parse.pragma.entry[0] = '\0';
 
 	hawk->parse.incl_hist.count =0;
+	hawk->parse.srcs.count = 0;
 
 	/* clear parse trees */
 	/*hawk->tree.ngbls_base = 0;
@@ -441,6 +453,9 @@ void hawk_clear (hawk_t* hawk)
 
 	hawk->tree.chain_tail = HAWK_NULL;
 	hawk->tree.chain_size = 0;
+	hawk->tree.maxfld = 0;
+	hawk->tree.dynfld = 0;
+	hawk->tree.reduce.count = 0;
 
 	/* this table must not be cleared here as there can be a reference
 	 * to an entry of this table from errinf.loc.file when hawk_parse()
@@ -477,6 +492,13 @@ static int dup_str_opt (hawk_t* hawk, const void* value, hawk_oocs_t* tmp)
 
 int hawk_setopt (hawk_t* hawk, hawk_opt_t id, const void* value)
 {
+	if (hawk->frozen)
+	{
+		/* the runtime contexts may be reading the options */
+		hawk_seterrnum (hawk, HAWK_NULL, HAWK_EPERM);
+		return -1;
+	}
+
 	switch (id)
 	{
 		case HAWK_OPT_TRAIT:
@@ -524,6 +546,22 @@ int hawk_setopt (hawk_t* hawk, hawk_opt_t id, const void* value)
 			else if (hawk->opt.rtx_stack_limit > HAWK_MAX_RTX_STACK_LIMIT) hawk->opt.rtx_stack_limit = HAWK_MAX_RTX_STACK_LIMIT;
 			return 0;
 
+		case HAWK_OPT_RTX_GC_SLICE_WORK:
+			hawk->opt.rtx_gc_slice_work = *(const hawk_oow_t*)value;
+			return 0;
+
+		case HAWK_OPT_RTX_GC_SLICE_TIME:
+			hawk->opt.rtx_gc_slice_time = *(const hawk_oow_t*)value;
+			return 0;
+
+		case HAWK_OPT_RTX_ARENA_SIZE:
+			hawk->opt.rtx_arena_size = *(const hawk_oow_t*)value;
+			return 0;
+
+		case HAWK_OPT_RTX_MAX_OPEN_OUTFILES:
+			hawk->opt.rtx_max_open_outfiles = *(const hawk_oow_t*)value;
+			return 0;
+
 
 		case HAWK_OPT_LOG_MASK:
 			hawk->opt.log_mask = *(hawk_bitmask_t*)value;
@@ -571,6 +609,22 @@ int hawk_getopt (hawk_t* hawk, hawk_opt_t id, void* value)
 			*(hawk_oow_t*)value = hawk->opt.rtx_stack_limit;
 			return 0;
 
+		case HAWK_OPT_RTX_GC_SLICE_WORK:
+			*(hawk_oow_t*)value = hawk->opt.rtx_gc_slice_work;
+			return 0;
+
+		case HAWK_OPT_RTX_GC_SLICE_TIME:
+			*(hawk_oow_t*)value = hawk->opt.rtx_gc_slice_time;
+			return 0;
+
+		case HAWK_OPT_RTX_ARENA_SIZE:
+			*(hawk_oow_t*)value = hawk->opt.rtx_arena_size;
+			return 0;
+
+		case HAWK_OPT_RTX_MAX_OPEN_OUTFILES:
+			*(hawk_oow_t*)value = hawk->opt.rtx_max_open_outfiles;
+			return 0;
+
 		case HAWK_OPT_LOG_MASK:
 			*(hawk_bitmask_t*)value = hawk->opt.log_mask;
 			return 0;
@@ -590,6 +644,22 @@ void hawk_haltall (hawk_t* hawk)
 	hawk->haltall = 1;
 }
 
+void hawk_freeze (hawk_t* hawk)
+{
+	hawk->frozen = 1;
+}
+
+int hawk_isfrozen (hawk_t* hawk)
+{
+	return hawk->frozen;
+}
+
+int hawk_isreducible (hawk_t* hawk)
+{
+	return hawk->tree.reduce.count > 0 && hawk->parse.pragma.entry[0] == '\0' &&
+	       (hawk->tree.chain != HAWK_NULL || hawk->tree.end != HAWK_NULL);
+}
+
 void hawk_killecb (hawk_t* hawk, hawk_ecb_t* ecb)
 {
 	hawk_ecb_t* prev, * cur;
@@ -32,7 +32,14 @@
 #include <hawk-utl.h>
 
 #include <hawk-htb.h> /* for rtx->named */
-#define HAWK_MAP_IS_RBT
+#if !defined(HAWK_MAP_IS_HTB) && !defined(HAWK_MAP_IS_OHT) && !defined(HAWK_MAP_IS_RBT)
+#	if defined(HAWK_USE_OHTMAP)
+		/* open-addressing hash table. faster but for-in is not ordered */
+#		define HAWK_MAP_IS_OHT
+#	else
+#		define HAWK_MAP_IS_RBT
+#	endif
+#endif
 #include <hawk-map.h>
 #include <hawk-arr.h>
 #include <stdarg.h>
@@ -162,6 +169,8 @@ static HAWK_INLINE hawk_gch_t* hawk_val_to_gch(hawk_val_t* v)
  * - v_static - static value indicator
  * - v_nstr - numeric string marker, 1 -> integer, 2 -> floating-point number
  * - v_gc - used for garbage collection together with v_refs
+ * - v_arena - allocated in the per-record arena of a runtime context
+ * - v_ncache - number cached in a string, 1 -> integer, 2 -> floating-point number
  *
  *  [IMPORTANT]
  *   if you change the order of these fields, you must ensure that statically
@@ -190,7 +199,9 @@ static HAWK_INLINE hawk_gch_t* hawk_val_to_gch(hawk_val_t* v)
 	hawk_uint8_t v_type: 4; \
 	hawk_uint8_t v_static: 1; \
 	hawk_uint8_t v_nstr: 2; \
-	hawk_uint8_t v_gc: 1
+	hawk_uint8_t v_gc: 1; \
+	hawk_uint8_t v_arena: 1; \
+	hawk_uint8_t v_ncache: 2
 
 /**
  * The hawk_val_t type is an abstract value type. A value commonly contains:
@@ -245,6 +256,11 @@ struct hawk_val_str_t
 {
 	HAWK_VAL_HDR;
 	hawk_oocs_t val;
+	union
+	{
+		hawk_int_t l;
+		hawk_flt_t r;
+	} num; /* valid if v_ncache is not 0 */
 };
 typedef struct hawk_val_str_t  hawk_val_str_t;
 
@@ -279,14 +295,31 @@ struct hawk_val_map_t
 {
 	HAWK_VAL_HDR;
 
-	/* TODO: make val_map to array if the indices used are all
-	 *       integers switch to map dynamically once the
-	 *       non-integral index is seen.
-	 */
+	/* the values at the non-negative integer indices from 0 up to
+	 * the number of chunks times #HAWK_VAL_MAP_VEC_CHUNK_SIZE are kept
+	 * in the vector part. the chunks are never moved once allocated.
+	 * all other indices are kept in the map by their string forms.
+	 * spill counts the integer indices that went into the map as they
+	 * were beyond the vector part when inserted. */
+	struct
+	{
+		hawk_val_t*** chunk;
+		hawk_oow_t nchunks;
+		hawk_oow_t capa;
+		hawk_oow_t count;
+		hawk_oow_t spill;
+	} vec;
 	hawk_map_t* map;
 };
 typedef struct hawk_val_map_t  hawk_val_map_t;
 
+#define HAWK_VAL_MAP_VEC_CHUNK_SIZE 32
+
+/**
+ * The #HAWK_VAL_MAP_SIZE macro returns the number of fields in a map value.
+ */
+#define HAWK_VAL_MAP_SIZE(v) (((hawk_val_map_t*)(v))->vec.count + HAWK_MAP_SIZE(((hawk_val_map_t*)(v))->map))
+
 /**
  * The hawk_val_arr_t type defines a arr type. The type field is
  * #HAWK_VAL_MAP.
@@ -336,20 +369,30 @@ typedef struct hawk_val_ref_t  hawk_val_ref_t;
 
 /**
  * The hawk_val_map_itr_t type defines the iterator to map value fields.
+ * The fields in the vector part are visited in the ascending order of
+ * the indices before the fields in the map.
  */
-typedef hawk_map_itr_t hawk_val_map_itr_t;
+struct hawk_val_map_itr_t
+{
+	hawk_map_itr_t _mitr;
+	hawk_oow_t _vi; /* next index in the vector part. (hawk_oow_t)-1 if in the map */
+	hawk_oocs_t key;
+	const hawk_val_t* val;
+	hawk_ooch_t _kbuf[HAWK_SIZEOF_INT_T * 3 + 2];
+};
+typedef struct hawk_val_map_itr_t hawk_val_map_itr_t;
 
 /**
  * The #HAWK_VAL_MAP_ITR_KEY macro get the pointer to the key part
  * of a map value.
  */
-#define HAWK_VAL_MAP_ITR_KEY(itr) ((const hawk_oocs_t*)HAWK_MAP_KPTL((itr)->pair))
+#define HAWK_VAL_MAP_ITR_KEY(itr) ((const hawk_oocs_t*)&(itr)->key)
 
 /**
  * The #HAWK_VAL_MAP_ITR_VAL macro get the pointer to the value part
  * of a map value.
  */
-#define HAWK_VAL_MAP_ITR_VAL(itr) ((const hawk_val_t*)HAWK_MAP_VPTR((itr)->pair))
+#define HAWK_VAL_MAP_ITR_VAL(itr) ((itr)->val)
 
 
 /**
@@ -385,6 +428,66 @@ struct hawk_val_map_data_t
 
 typedef struct hawk_val_map_data_t hawk_val_map_data_t;
 
+/**
+ * The hawk_rexcache_stats_t type defines the usage statistics of the cache
+ * of regular expressions built from string values at runtime.
+ */
+struct hawk_rexcache_stats_t
+{
+	hawk_oow_t capa;   /**< maximum number of expressions kept */
+	hawk_oow_t size;   /**< number of expressions kept */
+	hawk_oow_t hits;   /**< number of lookups served from the cache */
+	hawk_oow_t misses; /**< number of lookups that built an expression */
+};
+typedef struct hawk_rexcache_stats_t hawk_rexcache_stats_t;
+
+/**
+ * The hawk_riostats_t type defines the usage statistics of the output
+ * files kept open by a runtime context.
+ */
+struct hawk_riostats_t
+{
+	hawk_oow_t max_open_outfiles; /**< limit on the open output files. 0 for no limit */
+	hawk_oow_t open_outfiles;     /**< number of output files open */
+	hawk_oow_t hits;              /**< number of writes to an open output file */
+	hawk_oow_t evictions;         /**< number of output files closed for the limit */
+	hawk_oow_t reopens;           /**< number of output files opened again */
+};
+typedef struct hawk_riostats_t hawk_riostats_t;
+
+#define HAWK_GCSTATS_MAX_GENS (4)
+
+/**
+ * The hawk_gcstats_t type defines the statistics of the garbage collector
+ * and the value caches of a runtime context. The pause times are measured
+ * in microseconds. A cache miss is counted when a value of the size the
+ * cache handles has to be allocated from the memory manager.
+ */
+struct hawk_gcstats_t
+{
+	int ngens; /**< number of generations filled in gen */
+	struct
+	{
+		hawk_oow_t count;       /**< number of values in the generation */
+		hawk_oow_t collections; /**< number of collections of the generation */
+		hawk_oow_t pressure;    /**< allocations for generation 0, collections of the previous generation for others */
+		hawk_oow_t threshold;   /**< pressure to trigger the collection of the generation */
+	} gen[HAWK_GCSTATS_MAX_GENS];
+
+	hawk_oow_t collections; /**< number of collections of all generations */
+	hawk_oow_t slices;      /**< number of slices of the incremental collection */
+	hawk_oow_t rounds;      /**< number of rounds of the incremental collection completed */
+	hawk_oow_t freed;       /**< number of values freed by the collector */
+	hawk_oow_t pause_total; /**< cumulative time spent in the collector */
+	hawk_oow_t pause_max;   /**< longest time spent in a single invocation of the collector */
+
+	struct
+	{
+		hawk_oow_t hits;
+		hawk_oow_t misses;
+	} str_cache, mbs_cache, int_cache, flt_cache, ref_cache;
+};
+typedef struct hawk_gcstats_t hawk_gcstats_t;
 
 /* ------------------------------------------------------------------------ */
 
@@ -456,7 +559,10 @@ enum hawk_nde_type_t
 
 	HAWK_NDE_GETLINE,
 	HAWK_NDE_PRINT,
-	HAWK_NDE_PRINTF
+	HAWK_NDE_PRINTF,
+
+	/* an expression compiled to register code. see #HAWK_BYTECODE */
+	HAWK_NDE_CODE
 };
 typedef enum hawk_nde_type_t hawk_nde_type_t;
 
@@ -656,6 +762,10 @@ struct hawk_sio_arg_t
 
 	hawk_sio_lxc_t last;
 	int pragma_trait;
+
+	hawk_oow_t nchars; /* number of characters read */
+	hawk_oow_t digest; /* hash of the characters read */
+	int digested; /* the digest has been recorded upon the end of the stream */
 };
 
 /**
@@ -760,7 +870,14 @@ struct hawk_rio_arg_t
 		int eos;
 	} out;
 
+	struct hawk_rio_arg_t* prev;
 	struct hawk_rio_arg_t* next;
+	struct hawk_rio_arg_t* nnext; /* next stream of the same name */
+
+	/* output files in the order of the most recent use */
+	struct hawk_rio_arg_t* lprev;
+	struct hawk_rio_arg_t* lnext;
+	int evicted; /* closed to keep the open output files under the limit */
 };
 typedef struct hawk_rio_arg_t hawk_rio_arg_t;
 
@@ -1230,6 +1347,41 @@ enum hawk_opt_t
 	HAWK_OPT_DEPTH_REX_MATCH,
 
 	HAWK_OPT_RTX_STACK_LIMIT,
+
+	/**
+	 * the amount of work a slice of the incremental garbage collection
+	 * performs on the oldest generation. the work is counted in the
+	 * number of values and container slots looked at. a slice performs
+	 * more work in proportion to the values promoted to the oldest
+	 * generation for a round of the collection to keep up with them.
+	 * 0 makes the collection of the oldest generation done in a single
+	 * pass.
+	 */
+	HAWK_OPT_RTX_GC_SLICE_WORK,
+
+	/**
+	 * the maximum time in microseconds a slice of the incremental
+	 * garbage collection takes. 0 means no limit. it takes effect
+	 * only when #HAWK_OPT_RTX_GC_SLICE_WORK is not 0. it doesn't cut
+	 * the work owed for the values promoted to the oldest generation.
+	 */
+	HAWK_OPT_RTX_GC_SLICE_TIME,
+
+	/**
+	 * the size of a block of the per-record arena in bytes. the string
+	 * values created while the pattern-action blocks run are carved
+	 * out of the arena blocks when it is not 0.
+	 */
+	HAWK_OPT_RTX_ARENA_SIZE,
+
+	/**
+	 * the maximum number of output files a runtime context keeps open.
+	 * when the limit is reached, the least recently written file is
+	 * closed and opened again for appending when it is written to
+	 * again. 0 means no limit.
+	 */
+	HAWK_OPT_RTX_MAX_OPEN_OUTFILES,
+
 	HAWK_OPT_LOG_MASK,
 	HAWK_OPT_LOG_MAXCAPA
 };
@@ -1351,6 +1503,31 @@ enum hawk_trait_t
 	 */
 	HAWK_NUMSTRDETECT = (1 << 18),
 
+	/**
+	 * compiles arithmetic, comparison and logical expressions to
+	 * register code after parsing. the code is executed by a small
+	 * virtual machine instead of walking the expression tree.
+	 */
+	HAWK_BYTECODE = (1 << 19),
+
+	/**
+	 * folds constant expressions and drops unreachable statements
+	 * after parsing. the deparsed output shows the optimized tree.
+	 */
+	HAWK_OPTIMIZE = (1 << 20),
+
+	/**
+	 * makes the standard console, file and pipe I/O handle each byte
+	 * as a character. the input is not decoded and the output is not
+	 * encoded. length() counts bytes and tolower()/toupper() change
+	 * ASCII letters only. an encoding given explicitly for the console
+	 * or for an I/O name with setioattr() takes precedence. the script
+	 * read by hawk_parsestd() without an explicit encoding is read
+	 * the same way for a non-ASCII literal to hold the bytes found in
+	 * the data. it is effective only if #HAWK_OOCH_IS_UCH is defined.
+	 */
+	HAWK_BYTEIO = (1 << 21),
+
 	/**
 	 * makes #hawk_t to behave compatibly with classical AWK
 	 * implementations
@@ -1362,7 +1539,7 @@ enum hawk_trait_t
 
 	HAWK_MODERN =
 		HAWK_CLASSIC | HAWK_FLEXMAP | HAWK_REXBOUND |
-		HAWK_RWPIPE | HAWK_TOLERANT | HAWK_NEXTOFILE  | HAWK_NUMSTRDETECT /*| HAWK_NCMPONSTR*/
+		HAWK_RWPIPE | HAWK_TOLERANT | HAWK_NEXTOFILE  | HAWK_NUMSTRDETECT | HAWK_OPTIMIZE /*| HAWK_NCMPONSTR*/
 };
 typedef enum hawk_trait_t hawk_trait_t;
 
@@ -1413,6 +1590,19 @@ enum hawk_gbl_id_t
 };
 typedef enum hawk_gbl_id_t hawk_gbl_id_t;
 
+/**
+ * The hawk_rtx_phase_t type defines the parts of the BEGIN-pattern
+ * action-END loop executed by hawk_rtx_loopwithphases().
+ */
+enum hawk_rtx_phase_t
+{
+	HAWK_RTX_PHASE_BEGIN = (1 << 0), /**< BEGIN blocks */
+	HAWK_RTX_PHASE_MAIN  = (1 << 1), /**< pattern-action blocks */
+	HAWK_RTX_PHASE_END   = (1 << 2), /**< END blocks */
+	HAWK_RTX_PHASE_ALL   = (HAWK_RTX_PHASE_BEGIN | HAWK_RTX_PHASE_MAIN | HAWK_RTX_PHASE_END)
+};
+typedef enum hawk_rtx_phase_t hawk_rtx_phase_t;
+
 /**
  * The hawk_val_type_t type defines types of AWK values. Each value
  * allocated is tagged with a value type in the \a type field.
@@ -1937,6 +2127,37 @@ HAWK_EXPORT int hawk_parse (
 	hawk_sio_cbs_t* sio  /**< source script I/O handler */
 );
 
+/**
+ * The hawk_saveimg() function writes the parse tree built by the last
+ * successful call to hawk_parse() to an image that hawk_loadimg() can
+ * restore the tree from without parsing the source script again.
+ * The image records the engine version, the trait option and the digest
+ * of each source stream read.
+ *
+ * \return pointer to the image allocated with hawk_allocmem() on success,
+ *         #HAWK_NULL on failure.
+ */
+HAWK_EXPORT void* hawk_saveimg (
+	hawk_t*         hawk,
+	hawk_oow_t*     len  /**< length of the image returned */
+);
+
+/**
+ * The hawk_loadimg() function restores the parse tree from an image
+ * produced by hawk_saveimg(). It reads the source streams via \a sio->in
+ * to make sure that they haven't changed since the image was made.
+ * The tree is cleared if the image is unusable.
+ *
+ * \return 1 if the tree has been loaded, 0 if the image is stale or
+ *         malformed, -1 on failure.
+ */
+HAWK_EXPORT int hawk_loadimg (
+	hawk_t*         hawk,
+	hawk_sio_cbs_t* sio,  /**< source script I/O handler */
+	const void*     img,  /**< image */
+	hawk_oow_t      len   /**< length of the image */
+);
+
 
 HAWK_EXPORT int hawk_isvalidident (
 	hawk_t*            hawk,
@@ -2221,6 +2442,11 @@ HAWK_EXPORT int hawk_concatoochartosbuf (
  * hawk_rtx_getxtn(). The block is destroyed when the runtime context is
  * destroyed.
  *
+ * If \a hawk has been frozen with hawk_freeze(), this function may be
+ * called on multiple threads at the same time. The error information of
+ * a failure is still reported through \a hawk and can be overwritten by
+ * a failure on another thread.
+ *
  * \return new runtime context on success, #HAWK_NULL on failure
  */
 HAWK_EXPORT hawk_rtx_t* hawk_rtx_open (
@@ -2276,6 +2502,35 @@ HAWK_EXPORT hawk_val_t* hawk_rtx_loop (
 	hawk_rtx_t* rtx /**< runtime context */
 );
 
+/**
+ * The hawk_rtx_loopwithphases() function is the same as hawk_rtx_loop()
+ * except that it executes the parts of the loop selected in \a phases only.
+ * A program run on several runtime contexts can execute
+ * #HAWK_RTX_PHASE_BEGIN and #HAWK_RTX_PHASE_MAIN on each of them,
+ * merge them with hawk_rtx_reduce() and execute #HAWK_RTX_PHASE_END
+ * on the one that the others have been merged into.
+ *
+ * \return return value on success, #HAWK_NULL on failure.
+ */
+HAWK_EXPORT hawk_val_t* hawk_rtx_loopwithphases (
+	hawk_rtx_t* rtx,   /**< runtime context */
+	int         phases /**< bitwise-ORed of #hawk_rtx_phase_t enumerators */
+);
+
+/**
+ * The hawk_rtx_reduce() function merges the global variables declared
+ * with \@pragma reduce in the runtime context \a from into \a rtx.
+ * The values of a map are merged element by element. It also adds
+ * NR of \a from to NR of \a rtx. Both runtime contexts must belong
+ * to the same hawk object.
+ *
+ * \return 0 on success, -1 on failure.
+ */
+HAWK_EXPORT int hawk_rtx_reduce (
+	hawk_rtx_t* rtx, /**< runtime context to merge into */
+	hawk_rtx_t* from /**< runtime context to merge */
+);
+
 /**
  * The hawk_rtx_findfunwithbcstr() function finds the function structure by
  * name and returns the pointer to it if one is found. It returns #HAWK_NULL
@@ -2445,6 +2700,50 @@ HAWK_EXPORT void hawk_haltall (
 	hawk_t* hawk /**< hawk */
 );
 
+/**
+ * The hawk_freeze() function marks the parsed program in \a hawk as
+ * read-only so that the runtime contexts opened over it can run on
+ * different threads at the same time. Each runtime context keeps its
+ * own error information and module instance data. A frozen hawk object
+ * rejects hawk_parse(), hawk_loadimg() and hawk_setopt() with #HAWK_EPERM.
+ * hawk_clear() unfreezes it. Call it after closing all runtime contexts.
+ *
+ * \code
+ * hawk_parsestd (hawk, in, HAWK_NULL);
+ * hawk_freeze (hawk);
+ * // on each thread
+ * rtx = hawk_rtx_openstd(hawk, 0, id, icf, ocf, HAWK_NULL);
+ * retv = hawk_rtx_loop(rtx);
+ * ...
+ * hawk_rtx_close (rtx);
+ * \endcode
+ *
+ * The functions taking \a hawk other than hawk_rtx_open(),
+ * hawk_rtx_openstd() and hawk_haltall() must not be called while the
+ * runtime contexts run on other threads.
+ */
+HAWK_EXPORT void hawk_freeze (
+	hawk_t* hawk /**< hawk */
+);
+
+/**
+ * The hawk_isfrozen() function tells if \a hawk has been frozen
+ * with hawk_freeze().
+ */
+HAWK_EXPORT int hawk_isfrozen (
+	hawk_t* hawk /**< hawk */
+);
+
+/**
+ * The hawk_isreducible() function tells if the program in \a hawk
+ * declares global variables to merge with \@pragma reduce and has
+ * pattern-action blocks or END blocks to process input over several
+ * runtime contexts. A program with \@pragma entry is not reducible.
+ */
+HAWK_EXPORT int hawk_isreducible (
+	hawk_t* hawk /**< hawk */
+);
+
 /**
  * The hawk_rtx_ishalt() function tests if hawk_rtx_halt() has been
  * called.
@@ -2622,6 +2921,33 @@ HAWK_EXPORT int hawk_rtx_setscriptnamewithbchars (
 #	define hawk_rtx_setscriptnamewithoochars hawk_rtx_setscriptnamewithbchars
 #endif
 
+/**
+ * The hawk_rtx_getmodinst() function returns the instance data that the
+ * module \a mod attached to \a rtx with hawk_rtx_setmodinst(). A module
+ * keeps the data for a runtime context here instead of the module
+ * context shared by all runtime contexts.
+ *
+ * \return instance data on success, #HAWK_NULL if none is attached
+ */
+HAWK_EXPORT void* hawk_rtx_getmodinst (
+	hawk_rtx_t* rtx,
+	hawk_mod_t* mod
+);
+
+/**
+ * The hawk_rtx_setmodinst() function attaches the instance data \a inst
+ * of the module \a mod to \a rtx. It's usually called by the init
+ * callback of a module. The fini callback of the module must free the
+ * data. Passing #HAWK_NULL to \a inst detaches the data.
+ *
+ * \return 0 on success, -1 on failure
+ */
+HAWK_EXPORT int hawk_rtx_setmodinst (
+	hawk_rtx_t* rtx,
+	hawk_mod_t* mod,
+	void*       inst
+);
+
 /**
  * The hawk_rtx_getnvmap() gets the map of named variables
  */
@@ -3234,6 +3560,26 @@ HAWK_EXPORT int hawk_rtx_gc (
 	int         gen
 );
 
+/**
+ * The hawk_rtx_getgcstats() function retrieves the statistics of the
+ * garbage collector and the value caches.
+ */
+HAWK_EXPORT void hawk_rtx_getgcstats (
+	hawk_rtx_t*     rtx,
+	hawk_gcstats_t* stats
+);
+
+/**
+ * The hawk_rtx_setgcthreshold() function changes the threshold of the
+ * pressure that triggers the collection of the generation \a gen.
+ * \return 0 on success, -1 if \a gen is not a valid generation.
+ */
+HAWK_EXPORT int hawk_rtx_setgcthreshold (
+	hawk_rtx_t* rtx,
+	int         gen,
+	hawk_oow_t  threshold
+);
+
 /**
  * The hawk_rtx_valtobool() function converts a value \a val to a boolean
  * value.
@@ -3674,6 +4020,40 @@ static HAWK_INLINE void hawk_rtx_freerex (hawk_rtx_t* rtx, hawk_tre_t* code, haw
 #define hawk_rtx_freerex(rtx, code, icode) hawk_gem_freerex(hawk_rtx_getgem(rtx), code, icode)
 #endif
 
+/**
+ * The hawk_rtx_getcachedrex() function returns a regular expression
+ * built from the pattern \a ptn. The expression is kept in a small cache
+ * owned by the runtime context and reused when the same pattern is
+ * requested again with the same \a ignorecase value. The caller must not
+ * free the returned expression. It stays valid until the next call to
+ * this function as an older entry is evicted when the cache is full.
+ * \return regular expression on success, #HAWK_NULL on failure
+ */
+HAWK_EXPORT hawk_tre_t* hawk_rtx_getcachedrex (
+	hawk_rtx_t*        rtx,
+	const hawk_ooch_t* ptn,
+	hawk_oow_t         len,
+	int                ignorecase
+);
+
+/**
+ * The hawk_rtx_getrexcachestats() function retrieves the usage statistics
+ * of the regular expression cache.
+ */
+HAWK_EXPORT void hawk_rtx_getrexcachestats (
+	hawk_rtx_t*             rtx,
+	hawk_rexcache_stats_t*  stats
+);
+
+/**
+ * The hawk_rtx_getriostats() function retrieves the usage statistics
+ * of the output files.
+ */
+HAWK_EXPORT void hawk_rtx_getriostats (
+	hawk_rtx_t*             rtx,
+	hawk_riostats_t*        stats
+);
+
 
 /* ----------------------------------------------------------------------- */
 
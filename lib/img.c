@@ -0,0 +1,1390 @@
+/*
+    Copyright (c) 2006-2020 Chung, Hyung-Hwan. All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hawk-prv.h"
+
+/*
+ * This file saves the parse tree to a flat image and builds the tree
+ * back from the image without parsing the source script. The image is
+ * laid out as shown below.
+ *
+ *   stamp - magic, image format, engine version, type sizes, byte order
+ *   sum   - hash of all the bytes following it
+ *   trait - the trait option the tree was built with
+ *   srcs  - the length and the digest of each source stream read
+ *   files - the file names the node locations refer to
+ *   tree  - pragmas, globals, functions, BEGIN, pattern-action blocks, END
+ *
+ * An integer is written in 7 bits per byte with the highest bit set for
+ * continuation. A string is written as its length followed by the raw
+ * characters. A node is written as its type, its location, the lists
+ * of the child nodes and the remaining fields in that order.
+ *
+ * The image is usable only when it has the same stamp, the same trait
+ * and the same source streams. hawk_loadimg() reopens the streams
+ * via the source input handler to compare them.
+ */
+
+#define IMG_MAGIC "HAWKIMG"
+#define IMG_FORMAT 2
+#define IMG_STAMP_CAPA 64
+
+typedef struct imgw_t imgw_t;
+struct imgw_t
+{
+	hawk_t* hawk;
+	hawk_uint8_t* ptr;
+	hawk_oow_t len;
+	hawk_oow_t capa;
+
+	struct
+	{
+		const hawk_ooch_t** ptr;
+		hawk_oow_t count;
+		hawk_oow_t capa;
+	} files;
+};
+
+typedef struct imgr_t imgr_t;
+struct imgr_t
+{
+	hawk_t* hawk;
+	const hawk_uint8_t* ptr;
+	const hawk_uint8_t* end;
+
+	hawk_ooch_t** files;
+	hawk_oow_t nfiles;
+};
+
+static hawk_oow_t make_stamp (hawk_uint8_t* buf)
+{
+#if defined(HAWK_PACKAGE_VERSION)
+	static const hawk_bch_t version[] = HAWK_PACKAGE_VERSION;
+#else
+	static const hawk_bch_t version[] = "";
+#endif
+	hawk_uint32_t probe = 0x01020304;
+	hawk_oow_t len = 0;
+
+	HAWK_ASSERT (HAWK_SIZEOF(version) + 20 <= IMG_STAMP_CAPA);
+
+	HAWK_MEMCPY (&buf[len], IMG_MAGIC, 8); len += 8;
+	buf[len++] = IMG_FORMAT;
+	buf[len++] = HAWK_NDE_CODE; /* changes if a node type is added */
+	buf[len++] = HAWK_SIZEOF(hawk_ooch_t);
+	buf[len++] = HAWK_SIZEOF(hawk_uint_t);
+	buf[len++] = HAWK_SIZEOF(hawk_flt_t);
+	buf[len++] = HAWK_SIZEOF(hawk_oow_t);
+	HAWK_MEMCPY (&buf[len], &probe, HAWK_SIZEOF(probe)); len += HAWK_SIZEOF(probe);
+	buf[len++] = HAWK_SIZEOF(version) - 1;
+	HAWK_MEMCPY (&buf[len], version, HAWK_SIZEOF(version) - 1); len += HAWK_SIZEOF(version) - 1;
+
+	return len;
+}
+
+/* ------------------------------------------------------------------------ */
+
+static hawk_oow_t node_size (int type)
+{
+	switch (type)
+	{
+		case HAWK_NDE_NULL:
+		case HAWK_NDE_XNIL:
+		case HAWK_NDE_XARGC:
+		case HAWK_NDE_XARGV:
+			return HAWK_SIZEOF(hawk_nde_t);
+
+		case HAWK_NDE_BLK: return HAWK_SIZEOF(hawk_nde_blk_t);
+		case HAWK_NDE_IF: return HAWK_SIZEOF(hawk_nde_if_t);
+		case HAWK_NDE_WHILE:
+		case HAWK_NDE_DOWHILE: return HAWK_SIZEOF(hawk_nde_while_t);
+		case HAWK_NDE_FOR: return HAWK_SIZEOF(hawk_nde_for_t);
+		case HAWK_NDE_FORIN: return HAWK_SIZEOF(hawk_nde_forin_t);
+		case HAWK_NDE_BREAK: return HAWK_SIZEOF(hawk_nde_break_t);
+		case HAWK_NDE_CONTINUE: return HAWK_SIZEOF(hawk_nde_continue_t);
+		case HAWK_NDE_RETURN: return HAWK_SIZEOF(hawk_nde_return_t);
+		case HAWK_NDE_EXIT: return HAWK_SIZEOF(hawk_nde_exit_t);
+		case HAWK_NDE_NEXT: return HAWK_SIZEOF(hawk_nde_next_t);
+		case HAWK_NDE_NEXTFILE: return HAWK_SIZEOF(hawk_nde_nextfile_t);
+		case HAWK_NDE_DELETE: return HAWK_SIZEOF(hawk_nde_delete_t);
+		case HAWK_NDE_RESET: return HAWK_SIZEOF(hawk_nde_reset_t);
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF: return HAWK_SIZEOF(hawk_nde_print_t);
+		case HAWK_NDE_GRP: return HAWK_SIZEOF(hawk_nde_grp_t);
+		case HAWK_NDE_ASS: return HAWK_SIZEOF(hawk_nde_ass_t);
+		case HAWK_NDE_EXP_BIN:
+		case HAWK_NDE_EXP_UNR:
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST: return HAWK_SIZEOF(hawk_nde_exp_t);
+		case HAWK_NDE_CND: return HAWK_SIZEOF(hawk_nde_cnd_t);
+		case HAWK_NDE_FNCALL_FNC:
+		case HAWK_NDE_FNCALL_FUN:
+		case HAWK_NDE_FNCALL_VAR: return HAWK_SIZEOF(hawk_nde_fncall_t);
+		case HAWK_NDE_CHAR: return HAWK_SIZEOF(hawk_nde_char_t);
+		case HAWK_NDE_BCHR: return HAWK_SIZEOF(hawk_nde_bchr_t);
+		case HAWK_NDE_INT: return HAWK_SIZEOF(hawk_nde_int_t);
+		case HAWK_NDE_FLT: return HAWK_SIZEOF(hawk_nde_flt_t);
+		case HAWK_NDE_STR: return HAWK_SIZEOF(hawk_nde_str_t);
+		case HAWK_NDE_MBS: return HAWK_SIZEOF(hawk_nde_mbs_t);
+		case HAWK_NDE_REX: return HAWK_SIZEOF(hawk_nde_rex_t);
+		case HAWK_NDE_XARGVIDX: return HAWK_SIZEOF(hawk_nde_xargvidx_t);
+		case HAWK_NDE_FUN: return HAWK_SIZEOF(hawk_nde_fun_t);
+		case HAWK_NDE_NAMED:
+		case HAWK_NDE_GBL:
+		case HAWK_NDE_LCL:
+		case HAWK_NDE_ARG:
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX: return HAWK_SIZEOF(hawk_nde_var_t);
+		case HAWK_NDE_POS: return HAWK_SIZEOF(hawk_nde_pos_t);
+		case HAWK_NDE_GETLINE: return HAWK_SIZEOF(hawk_nde_getline_t);
+
+		default:
+			/* HAWK_NDE_CODE is never saved. it is saved as the original expression */
+			return 0;
+	}
+}
+
+/* the number of nodes a child node list must have */
+#define KID_ANY  0
+#define KID_ONE  1 /* exactly one */
+#define KID_SOME 2 /* one or more */
+
+#define KID(n,field,req) do { kid[n] = (hawk_nde_t**)&(field); need[n] = (req); } while (0)
+
+/* get the addresses of the fields holding the child node lists. the
+ * evaluator assumes the shape of the lists for some node types. */
+static int node_kids (hawk_nde_t* nde, hawk_nde_t** kid[4], int need[4])
+{
+	switch (nde->type)
+	{
+		case HAWK_NDE_BLK:
+			KID (0, ((hawk_nde_blk_t*)nde)->body, KID_ANY);
+			return 1;
+
+		case HAWK_NDE_IF:
+			KID (0, ((hawk_nde_if_t*)nde)->test, KID_ONE);
+			KID (1, ((hawk_nde_if_t*)nde)->then_part, KID_ONE);
+			KID (2, ((hawk_nde_if_t*)nde)->else_part, KID_ANY);
+			return 3;
+
+		case HAWK_NDE_WHILE:
+		case HAWK_NDE_DOWHILE:
+			KID (0, ((hawk_nde_while_t*)nde)->test, KID_ONE);
+			KID (1, ((hawk_nde_while_t*)nde)->body, KID_ANY);
+			return 2;
+
+		case HAWK_NDE_FOR:
+			KID (0, ((hawk_nde_for_t*)nde)->init, KID_ANY);
+			KID (1, ((hawk_nde_for_t*)nde)->test, KID_ANY);
+			KID (2, ((hawk_nde_for_t*)nde)->incr, KID_ANY);
+			KID (3, ((hawk_nde_for_t*)nde)->body, KID_ANY);
+			return 4;
+
+		case HAWK_NDE_FORIN:
+			KID (0, ((hawk_nde_forin_t*)nde)->test, KID_ONE);
+			KID (1, ((hawk_nde_forin_t*)nde)->body, KID_ANY);
+			return 2;
+
+		case HAWK_NDE_RETURN:
+			KID (0, ((hawk_nde_return_t*)nde)->val, KID_ANY);
+			return 1;
+
+		case HAWK_NDE_EXIT:
+			KID (0, ((hawk_nde_exit_t*)nde)->val, KID_ANY);
+			return 1;
+
+		case HAWK_NDE_DELETE:
+			KID (0, ((hawk_nde_delete_t*)nde)->var, KID_ONE);
+			return 1;
+
+		case HAWK_NDE_RESET:
+			KID (0, ((hawk_nde_reset_t*)nde)->var, KID_ONE);
+			return 1;
+
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF:
+			KID (0, ((hawk_nde_print_t*)nde)->args, KID_ANY);
+			KID (1, ((hawk_nde_print_t*)nde)->out, KID_ANY);
+			return 2;
+
+		case HAWK_NDE_GRP:
+			KID (0, ((hawk_nde_grp_t*)nde)->body, KID_SOME);
+			return 1;
+
+		case HAWK_NDE_ASS:
+			KID (0, ((hawk_nde_ass_t*)nde)->left, KID_ONE);
+			KID (1, ((hawk_nde_ass_t*)nde)->right, KID_ONE);
+			return 2;
+
+		case HAWK_NDE_EXP_BIN:
+			KID (0, ((hawk_nde_exp_t*)nde)->left, KID_ONE);
+			KID (1, ((hawk_nde_exp_t*)nde)->right, KID_ONE);
+			return 2;
+
+		case HAWK_NDE_EXP_UNR:
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST:
+			KID (0, ((hawk_nde_exp_t*)nde)->left, KID_ONE);
+			return 1;
+
+		case HAWK_NDE_CND:
+			KID (0, ((hawk_nde_cnd_t*)nde)->test, KID_ONE);
+			KID (1, ((hawk_nde_cnd_t*)nde)->left, KID_ONE);
+			KID (2, ((hawk_nde_cnd_t*)nde)->right, KID_ONE);
+			return 3;
+
+		case HAWK_NDE_FNCALL_FNC:
+		case HAWK_NDE_FNCALL_FUN:
+			KID (0, ((hawk_nde_fncall_t*)nde)->args, KID_ANY);
+			return 1;
+
+		case HAWK_NDE_FNCALL_VAR:
+			KID (0, ((hawk_nde_fncall_t*)nde)->u.var.var, KID_ONE);
+			KID (1, ((hawk_nde_fncall_t*)nde)->args, KID_ANY);
+			return 2;
+
+		case HAWK_NDE_XARGVIDX:
+			KID (0, ((hawk_nde_xargvidx_t*)nde)->pos, KID_ONE);
+			return 1;
+
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX:
+			KID (0, ((hawk_nde_var_t*)nde)->idx, KID_SOME);
+			return 1;
+
+		case HAWK_NDE_POS:
+			KID (0, ((hawk_nde_pos_t*)nde)->val, KID_ONE);
+			return 1;
+
+		case HAWK_NDE_GETLINE:
+			KID (0, ((hawk_nde_getline_t*)nde)->var, KID_ANY);
+			KID (1, ((hawk_nde_getline_t*)nde)->in, KID_ANY);
+			return 2;
+
+		default:
+			return 0;
+	}
+}
+
+#undef KID
+
+/* ------------------------------------------------------------------------ */
+
+static int write_bytes (imgw_t* w, const void* ptr, hawk_oow_t len)
+{
+	if (len > w->capa - w->len)
+	{
+		hawk_uint8_t* tmp;
+		hawk_oow_t newcapa;
+
+		newcapa = HAWK_ALIGN_POW2(w->len + len + w->len / 2, 4096);
+		tmp = (hawk_uint8_t*)hawk_reallocmem(w->hawk, w->ptr, newcapa);
+		if (HAWK_UNLIKELY(!tmp)) return -1;
+
+		w->ptr = tmp;
+		w->capa = newcapa;
+	}
+
+	HAWK_MEMCPY (&w->ptr[w->len], ptr, len);
+	w->len += len;
+	return 0;
+}
+
+static int write_uint (imgw_t* w, hawk_uint_t v)
+{
+	hawk_uint8_t buf[HAWK_SIZEOF(v) * 8 / 7 + 1];
+	hawk_oow_t len = 0;
+
+	while (v >= 0x80)
+	{
+		buf[len++] = (hawk_uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	buf[len++] = (hawk_uint8_t)v;
+
+	return write_bytes(w, buf, len);
+}
+
+static int write_int (imgw_t* w, hawk_int_t v)
+{
+	/* interleave negative numbers with positive numbers to keep a
+	 * small negative number short */
+	return write_uint(w, (v < 0)? ((~(hawk_uint_t)v << 1) | 1): ((hawk_uint_t)v << 1));
+}
+
+/* write a string that can be HAWK_NULL */
+static int write_oochars (imgw_t* w, const hawk_ooch_t* ptr, hawk_oow_t len)
+{
+	if (!ptr) return write_uint(w, 0);
+	if (write_uint(w, (hawk_uint_t)len + 1) <= -1) return -1;
+	return write_bytes(w, ptr, len * HAWK_SIZEOF(*ptr));
+}
+
+static int write_bchars (imgw_t* w, const hawk_bch_t* ptr, hawk_oow_t len)
+{
+	if (!ptr) return write_uint(w, 0);
+	if (write_uint(w, (hawk_uint_t)len + 1) <= -1) return -1;
+	return write_bytes(w, ptr, len * HAWK_SIZEOF(*ptr));
+}
+
+static int write_loc (imgw_t* w, const hawk_loc_t* loc)
+{
+	hawk_oow_t i = 0;
+
+	if (loc->file)
+	{
+		/* the location of most nodes refers to the same file as the
+		 * previous one. search backward */
+		for (i = w->files.count; i > 0; i--)
+		{
+			if (w->files.ptr[i - 1] == loc->file) break;
+		}
+
+		if (i <= 0)
+		{
+			if (w->files.count >= w->files.capa)
+			{
+				const hawk_ooch_t** tmp;
+				hawk_oow_t newcapa;
+
+				newcapa = w->files.capa + 16;
+				tmp = (const hawk_ooch_t**)hawk_reallocmem(w->hawk, w->files.ptr, newcapa * HAWK_SIZEOF(*tmp));
+				if (HAWK_UNLIKELY(!tmp)) return -1;
+
+				w->files.ptr = tmp;
+				w->files.capa = newcapa;
+			}
+
+			w->files.ptr[w->files.count++] = loc->file;
+			i = w->files.count;
+		}
+	}
+
+	/* 0 for no file. the index to the file table plus 1 otherwise */
+	if (write_uint(w, loc->line) <= -1 ||
+	    write_uint(w, loc->colm) <= -1 ||
+	    write_uint(w, i) <= -1) return -1;
+	return 0;
+}
+
+static const hawk_ooch_t* find_module_name (hawk_t* hawk, hawk_mod_t* mod, hawk_oow_t* len)
+{
+	hawk_rbt_pair_t* pair;
+	hawk_rbt_itr_t itr;
+
+	for (pair = hawk_rbt_getfirstpair(hawk->modtab, &itr); pair; pair = hawk_rbt_getnextpair(hawk->modtab, &itr))
+	{
+		if (&((hawk_mod_data_t*)HAWK_RBT_VPTR(pair))->mod == mod)
+		{
+			*len = HAWK_RBT_KLEN(pair);
+			return (const hawk_ooch_t*)HAWK_RBT_KPTR(pair);
+		}
+	}
+
+	return HAWK_NULL;
+}
+
+static int write_list (imgw_t* w, hawk_nde_t* list);
+
+static int write_node (imgw_t* w, hawk_nde_t* nde)
+{
+	hawk_nde_t** kid[4];
+	int need[4], nkids, i;
+
+	/* the register code is built again upon loading */
+	if (nde->type == HAWK_NDE_CODE) nde = ((hawk_nde_code_t*)nde)->expr;
+	HAWK_ASSERT (node_size(nde->type) > 0);
+
+	if (write_uint(w, nde->type) <= -1 || write_loc(w, &nde->loc) <= -1) return -1;
+
+	nkids = node_kids(nde, kid, need);
+	for (i = 0; i < nkids; i++)
+	{
+		if (write_list(w, *kid[i]) <= -1) return -1;
+	}
+
+	switch (nde->type)
+	{
+		case HAWK_NDE_BLK:
+		{
+			hawk_nde_blk_t* px = (hawk_nde_blk_t*)nde;
+			if (write_uint(w, px->nlcls) <= -1 ||
+			    write_uint(w, px->org_nlcls) <= -1 ||
+			    write_uint(w, px->outer_nlcls) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_EXIT:
+			return write_uint(w, ((hawk_nde_exit_t*)nde)->abort);
+
+		case HAWK_NDE_NEXTFILE:
+			return write_uint(w, ((hawk_nde_nextfile_t*)nde)->out);
+
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF:
+			return write_uint(w, ((hawk_nde_print_t*)nde)->out_type);
+
+		case HAWK_NDE_ASS:
+			return write_uint(w, ((hawk_nde_ass_t*)nde)->opcode);
+
+		case HAWK_NDE_EXP_BIN:
+		case HAWK_NDE_EXP_UNR:
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST:
+			return write_uint(w, ((hawk_nde_exp_t*)nde)->opcode);
+
+		case HAWK_NDE_FNCALL_FNC:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			const hawk_ooch_t* modname = HAWK_NULL;
+			hawk_oow_t modlen = 0;
+
+			if (px->u.fnc.info.mod)
+			{
+				hawk_fnc_t* fnc;
+
+				/* a module function is looked up again by the module name */
+				fnc = hawk_findfncwithoocs(w->hawk, &px->u.fnc.info.name);
+				if (!fnc || fnc->mod != px->u.fnc.info.mod || fnc->spec.arg.min > fnc->spec.arg.max)
+				{
+					modname = find_module_name(w->hawk, px->u.fnc.info.mod, &modlen);
+					if (!modname)
+					{
+						hawk_seterrfmt (w->hawk, &nde->loc, HAWK_EINTERN, HAWK_T("unable to find the module of '%.*js'"), px->u.fnc.info.name.len, px->u.fnc.info.name.ptr);
+						return -1;
+					}
+				}
+			}
+
+			if (write_oochars(w, px->u.fnc.info.name.ptr, px->u.fnc.info.name.len) <= -1 ||
+			    write_oochars(w, modname, modlen) <= -1 ||
+			    write_uint(w, px->nargs) <= -1 ||
+			    write_uint(w, px->arg_base) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FNCALL_FUN:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (write_oochars(w, px->u.fun.name.ptr, px->u.fun.name.len) <= -1 ||
+			    write_uint(w, px->nargs) <= -1 ||
+			    write_uint(w, px->arg_base) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FNCALL_VAR:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (write_uint(w, px->nargs) <= -1 ||
+			    write_uint(w, px->arg_base) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_CHAR:
+			return write_uint(w, (hawk_uint_t)(hawk_oochu_t)((hawk_nde_char_t*)nde)->val);
+
+		case HAWK_NDE_BCHR:
+			return write_uint(w, (hawk_uint_t)(hawk_bchu_t)((hawk_nde_bchr_t*)nde)->val);
+
+		case HAWK_NDE_INT:
+		{
+			hawk_nde_int_t* px = (hawk_nde_int_t*)nde;
+			if (write_int(w, px->val) <= -1 ||
+			    write_oochars(w, px->str, px->len) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FLT:
+		{
+			hawk_nde_flt_t* px = (hawk_nde_flt_t*)nde;
+			if (write_bytes(w, &px->val, HAWK_SIZEOF(px->val)) <= -1 ||
+			    write_oochars(w, px->str, px->len) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_STR:
+			return write_oochars(w, ((hawk_nde_str_t*)nde)->ptr, ((hawk_nde_str_t*)nde)->len);
+
+		case HAWK_NDE_MBS:
+			return write_bchars(w, ((hawk_nde_mbs_t*)nde)->ptr, ((hawk_nde_mbs_t*)nde)->len);
+
+		case HAWK_NDE_REX:
+			/* the compiled expression is not saved. the text is */
+			return write_oochars(w, ((hawk_nde_rex_t*)nde)->str.ptr, ((hawk_nde_rex_t*)nde)->str.len);
+
+		case HAWK_NDE_FUN:
+			return write_oochars(w, ((hawk_nde_fun_t*)nde)->name.ptr, ((hawk_nde_fun_t*)nde)->name.len);
+
+		case HAWK_NDE_NAMED:
+		case HAWK_NDE_GBL:
+		case HAWK_NDE_LCL:
+		case HAWK_NDE_ARG:
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX:
+		{
+			hawk_nde_var_t* px = (hawk_nde_var_t*)nde;
+			if (write_oochars(w, px->id.name.ptr, px->id.name.len) <= -1 ||
+			    write_uint(w, px->id.idxa) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_GETLINE:
+		{
+			hawk_nde_getline_t* px = (hawk_nde_getline_t*)nde;
+			if (write_uint(w, px->mbs) <= -1 ||
+			    write_uint(w, px->in_type) <= -1) return -1;
+			break;
+		}
+
+		default:
+			/* no other fields */
+			break;
+	}
+
+	return 0;
+}
+
+static int write_list (imgw_t* w, hawk_nde_t* list)
+{
+	hawk_nde_t* p;
+	hawk_oow_t count = 0;
+
+	for (p = list; p; p = p->next) count++;
+	if (write_uint(w, count) <= -1) return -1;
+
+	for (p = list; p; p = p->next)
+	{
+		if (write_node(w, p) <= -1) return -1;
+	}
+
+	return 0;
+}
+
+static int write_tree (imgw_t* w)
+{
+	hawk_t* hawk = w->hawk;
+	hawk_htb_pair_t* pair;
+	hawk_htb_itr_t itr;
+	hawk_chain_t* chain;
+	hawk_oow_t i;
+
+	if (write_uint(w, (hawk_uint_t)hawk->parse.pragma.trait) <= -1 ||
+	    write_uint(w, hawk->parse.pragma.rtx_stack_limit) <= -1 ||
+	    write_oochars(w, hawk->parse.pragma.entry, hawk_count_oocstr(hawk->parse.pragma.entry)) <= -1) return -1;
+
+	/* the intrinsic globals are written to detect the difference in the
+	 * globals added with hawk_addgbl() and the trait option */
+	if (write_uint(w, hawk->tree.ngbls_base) <= -1 ||
+	    write_uint(w, hawk->tree.ngbls) <= -1) return -1;
+	for (i = 0; i < hawk->tree.ngbls; i++)
+	{
+		if (write_oochars(w, HAWK_ARR_DPTR(hawk->parse.gbls, i), HAWK_ARR_DLEN(hawk->parse.gbls, i)) <= -1) return -1;
+	}
+
+	if (write_uint(w, hawk->tree.reduce.count) <= -1) return -1;
+	for (i = 0; i < hawk->tree.reduce.count; i++)
+	{
+		if (write_uint(w, hawk->tree.reduce.ptr[i].gbl) <= -1 ||
+		    write_uint(w, (hawk_uint_t)hawk->tree.reduce.ptr[i].op) <= -1) return -1;
+	}
+
+	if (write_uint(w, hawk_htb_getsize(hawk->tree.funs)) <= -1) return -1;
+	for (pair = hawk_htb_getfirstpair(hawk->tree.funs, &itr); pair; pair = hawk_htb_getnextpair(hawk->tree.funs, &itr))
+	{
+		hawk_fun_t* fun = (hawk_fun_t*)HAWK_HTB_VPTR(pair);
+		if (write_oochars(w, HAWK_HTB_KPTR(pair), HAWK_HTB_KLEN(pair)) <= -1 ||
+		    write_uint(w, fun->nargs) <= -1 ||
+		    write_uint(w, fun->variadic) <= -1 ||
+		    write_oochars(w, fun->argspec, fun->argspeclen) <= -1 ||
+		    write_list(w, fun->body) <= -1) return -1;
+	}
+
+	if (write_list(w, hawk->tree.begin) <= -1) return -1;
+
+	for (i = 0, chain = hawk->tree.chain; chain; chain = chain->next) i++;
+	if (write_uint(w, i) <= -1) return -1;
+	for (chain = hawk->tree.chain; chain; chain = chain->next)
+	{
+		if (write_list(w, chain->pattern) <= -1 ||
+		    write_list(w, chain->action) <= -1) return -1;
+	}
+
+	if (write_list(w, hawk->tree.end) <= -1 ||
+	    write_uint(w, hawk->tree.chain_size) <= -1 ||
+	    write_uint(w, hawk->tree.maxfld) <= -1 ||
+	    write_uint(w, hawk->tree.dynfld) <= -1) return -1;
+
+	return 0;
+}
+
+void* hawk_saveimg (hawk_t* hawk, hawk_oow_t* len)
+{
+	imgw_t body, head;
+	hawk_uint8_t stamp[IMG_STAMP_CAPA];
+	hawk_oow_t stamp_len, sum, i;
+
+	HAWK_MEMSET (&body, 0, HAWK_SIZEOF(body));
+	HAWK_MEMSET (&head, 0, HAWK_SIZEOF(head));
+	body.hawk = hawk;
+	head.hawk = hawk;
+
+	/* the tree is written first to collect the file names */
+	if (write_tree(&body) <= -1) goto oops;
+
+	stamp_len = make_stamp(stamp);
+	sum = 0;
+	if (write_bytes(&head, stamp, stamp_len) <= -1 ||
+	    write_bytes(&head, &sum, HAWK_SIZEOF(sum)) <= -1 ||
+	    write_uint(&head, (hawk_uint_t)hawk->opt.trait) <= -1 ||
+	    write_uint(&head, hawk->parse.srcs.count) <= -1) goto oops;
+
+	for (i = 0; i < hawk->parse.srcs.count; i++)
+	{
+		hawk_srcdgst_t* dgst = &hawk->parse.srcs.ptr[i];
+		if (write_oochars(&head, dgst->path, (dgst->path? hawk_count_oocstr(dgst->path): 0)) <= -1 ||
+		    write_uint(&head, dgst->nchars) <= -1 ||
+		    write_uint(&head, dgst->digest) <= -1) goto oops;
+	}
+
+	if (write_uint(&head, body.files.count) <= -1) goto oops;
+	for (i = 0; i < body.files.count; i++)
+	{
+		if (write_oochars(&head, body.files.ptr[i], hawk_count_oocstr(body.files.ptr[i])) <= -1) goto oops;
+	}
+
+	if (write_bytes(&head, body.ptr, body.len) <= -1) goto oops;
+
+	HAWK_HASH_BYTES (sum, &head.ptr[stamp_len + HAWK_SIZEOF(sum)], head.len - stamp_len - HAWK_SIZEOF(sum));
+	HAWK_MEMCPY (&head.ptr[stamp_len], &sum, HAWK_SIZEOF(sum));
+
+	if (body.files.ptr) hawk_freemem (hawk, body.files.ptr);
+	if (body.ptr) hawk_freemem (hawk, body.ptr);
+
+	*len = head.len;
+	return head.ptr;
+
+oops:
+	if (body.files.ptr) hawk_freemem (hawk, body.files.ptr);
+	if (body.ptr) hawk_freemem (hawk, body.ptr);
+	if (head.ptr) hawk_freemem (hawk, head.ptr);
+	return HAWK_NULL;
+}
+
+/* ------------------------------------------------------------------------ */
+
+static int read_uint (imgr_t* r, hawk_uint_t* v)
+{
+	hawk_uint_t x = 0;
+	int shift = 0;
+
+	while (r->ptr < r->end)
+	{
+		hawk_uint8_t b = *r->ptr++;
+		x |= (hawk_uint_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+		{
+			*v = x;
+			return 0;
+		}
+
+		shift += 7;
+		if (shift >= HAWK_SIZEOF(x) * 8) break;
+	}
+
+	return -1;
+}
+
+static int read_oow (imgr_t* r, hawk_oow_t* v)
+{
+	hawk_uint_t x;
+	if (read_uint(r, &x) <= -1 || x > HAWK_TYPE_MAX(hawk_oow_t)) return -1;
+	*v = (hawk_oow_t)x;
+	return 0;
+}
+
+static int read_small (imgr_t* r, int* v)
+{
+	hawk_uint_t x;
+	if (read_uint(r, &x) <= -1 || x > HAWK_TYPE_MAX(int)) return -1;
+	*v = (int)x;
+	return 0;
+}
+
+static int read_int (imgr_t* r, hawk_int_t* v)
+{
+	hawk_uint_t x;
+	if (read_uint(r, &x) <= -1) return -1;
+	*v = (x & 1)? (hawk_int_t)~(x >> 1): (hawk_int_t)(x >> 1);
+	return 0;
+}
+
+static int read_bytes (imgr_t* r, void* ptr, hawk_oow_t len)
+{
+	if (len > (hawk_oow_t)(r->end - r->ptr)) return -1;
+	HAWK_MEMCPY (ptr, r->ptr, len);
+	r->ptr += len;
+	return 0;
+}
+
+/* read a string written by write_oochars(). the string read is
+ * null-terminated and allocated with hawk_allocmem() */
+static int read_oochars (imgr_t* r, hawk_ooch_t** ptr, hawk_oow_t* len)
+{
+	hawk_oow_t x;
+	hawk_ooch_t* tmp;
+
+	if (read_oow(r, &x) <= -1) return -1;
+	if (x == 0)
+	{
+		*ptr = HAWK_NULL;
+		*len = 0;
+		return 0;
+	}
+
+	x--;
+	if (x > (hawk_oow_t)(r->end - r->ptr) / HAWK_SIZEOF(*tmp)) return -1;
+
+	tmp = (hawk_ooch_t*)hawk_allocmem(r->hawk, (x + 1) * HAWK_SIZEOF(*tmp));
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+
+	HAWK_MEMCPY (tmp, r->ptr, x * HAWK_SIZEOF(*tmp));
+	tmp[x] = '\0';
+	r->ptr += x * HAWK_SIZEOF(*tmp);
+
+	*ptr = tmp;
+	*len = x;
+	return 0;
+}
+
+static int read_bchars (imgr_t* r, hawk_bch_t** ptr, hawk_oow_t* len)
+{
+	hawk_oow_t x;
+	hawk_bch_t* tmp;
+
+	if (read_oow(r, &x) <= -1) return -1;
+	if (x == 0)
+	{
+		*ptr = HAWK_NULL;
+		*len = 0;
+		return 0;
+	}
+
+	x--;
+	if (x > (hawk_oow_t)(r->end - r->ptr)) return -1;
+
+	tmp = (hawk_bch_t*)hawk_allocmem(r->hawk, (x + 1) * HAWK_SIZEOF(*tmp));
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+
+	HAWK_MEMCPY (tmp, r->ptr, x);
+	tmp[x] = '\0';
+	r->ptr += x;
+
+	*ptr = tmp;
+	*len = x;
+	return 0;
+}
+
+static int read_loc (imgr_t* r, hawk_loc_t* loc)
+{
+	hawk_oow_t file;
+
+	if (read_oow(r, &loc->line) <= -1 ||
+	    read_oow(r, &loc->colm) <= -1 ||
+	    read_oow(r, &file) <= -1 || file > r->nfiles) return -1;
+
+	loc->file = (file > 0)? r->files[file - 1]: HAWK_NULL;
+	return 0;
+}
+
+static int resolve_fnc (imgr_t* r, hawk_nde_fncall_t* call, hawk_ooch_t* modname, hawk_oow_t modlen)
+{
+	hawk_t* hawk = r->hawk;
+
+	if (modname)
+	{
+		const hawk_ooch_t* sym;
+		hawk_ooch_t* full;
+		hawk_mod_sym_t msym;
+		hawk_mod_t* mod;
+		hawk_oow_t i;
+
+		/* the call to a function like sin() that the engine relays to
+		 * a module keeps the short name. take the last segment */
+		sym = call->u.fnc.info.name.ptr;
+		for (i = call->u.fnc.info.name.len; i >= 2; i--)
+		{
+			if (sym[i - 1] == ':' && sym[i - 2] == ':')
+			{
+				sym += i;
+				break;
+			}
+		}
+
+		full = (hawk_ooch_t*)hawk_allocmem(hawk, (modlen + hawk_count_oocstr(sym) + 3) * HAWK_SIZEOF(*full));
+		if (HAWK_UNLIKELY(!full)) return -1;
+		i = hawk_copy_oochars_to_oocstr_unlimited(full, modname, modlen);
+		i += hawk_copy_oocstr_unlimited(&full[i], HAWK_T("::"));
+		hawk_copy_oocstr_unlimited (&full[i], sym);
+
+		mod = hawk_querymodulewithname(hawk, full, &msym);
+		hawk_freemem (hawk, full);
+
+		if (!mod || msym.type != HAWK_MOD_FNC ||
+		    (hawk->opt.trait & msym.u.fnc_.trait) != msym.u.fnc_.trait) return -1;
+
+		call->u.fnc.info.mod = mod;
+		call->u.fnc.spec = msym.u.fnc_;
+	}
+	else
+	{
+		hawk_fnc_t* fnc;
+
+		fnc = hawk_findfncwithoocs(hawk, &call->u.fnc.info.name);
+		if (!fnc || fnc->spec.arg.min > fnc->spec.arg.max) return -1;
+
+		call->u.fnc.info.mod = fnc->mod;
+		call->u.fnc.spec = fnc->spec;
+	}
+
+	if (call->nargs < call->u.fnc.spec.arg.min || call->nargs > call->u.fnc.spec.arg.max) return -1;
+	return 0;
+}
+
+static int read_list (imgr_t* r, hawk_nde_t** list);
+
+static int read_fields (imgr_t* r, hawk_nde_t* nde)
+{
+	switch (nde->type)
+	{
+		case HAWK_NDE_BLK:
+		{
+			hawk_nde_blk_t* px = (hawk_nde_blk_t*)nde;
+			if (read_oow(r, &px->nlcls) <= -1 ||
+			    read_oow(r, &px->org_nlcls) <= -1 ||
+			    read_oow(r, &px->outer_nlcls) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_EXIT:
+			return read_small(r, &((hawk_nde_exit_t*)nde)->abort);
+
+		case HAWK_NDE_NEXTFILE:
+			return read_small(r, &((hawk_nde_nextfile_t*)nde)->out);
+
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF:
+		{
+			int x;
+			if (read_small(r, &x) <= -1 || x > HAWK_OUT_CONSOLE) return -1;
+			((hawk_nde_print_t*)nde)->out_type = (hawk_out_type_t)x;
+			break;
+		}
+
+		case HAWK_NDE_ASS:
+			return read_small(r, &((hawk_nde_ass_t*)nde)->opcode);
+
+		case HAWK_NDE_EXP_BIN:
+		case HAWK_NDE_EXP_UNR:
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST:
+			return read_small(r, &((hawk_nde_exp_t*)nde)->opcode);
+
+		case HAWK_NDE_FNCALL_FNC:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			hawk_ooch_t* modname;
+			hawk_oow_t modlen;
+			int n;
+
+			if (read_oochars(r, &px->u.fnc.info.name.ptr, &px->u.fnc.info.name.len) <= -1 || !px->u.fnc.info.name.ptr ||
+			    read_oochars(r, &modname, &modlen) <= -1) return -1;
+
+			if (read_oow(r, &px->nargs) <= -1 ||
+			    read_oow(r, &px->arg_base) <= -1) n = -1;
+			else n = resolve_fnc(r, px, modname, modlen);
+
+			if (modname) hawk_freemem (r->hawk, modname);
+			return n;
+		}
+
+		case HAWK_NDE_FNCALL_FUN:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (read_oochars(r, &px->u.fun.name.ptr, &px->u.fun.name.len) <= -1 || !px->u.fun.name.ptr ||
+			    read_oow(r, &px->nargs) <= -1 ||
+			    read_oow(r, &px->arg_base) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FNCALL_VAR:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (read_oow(r, &px->nargs) <= -1 ||
+			    read_oow(r, &px->arg_base) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_CHAR:
+		{
+			hawk_uint_t x;
+			if (read_uint(r, &x) <= -1) return -1;
+			((hawk_nde_char_t*)nde)->val = (hawk_ooch_t)x;
+			break;
+		}
+
+		case HAWK_NDE_BCHR:
+		{
+			hawk_uint_t x;
+			if (read_uint(r, &x) <= -1) return -1;
+			((hawk_nde_bchr_t*)nde)->val = (hawk_bch_t)x;
+			break;
+		}
+
+		case HAWK_NDE_INT:
+		{
+			hawk_nde_int_t* px = (hawk_nde_int_t*)nde;
+			if (read_int(r, &px->val) <= -1 ||
+			    read_oochars(r, &px->str, &px->len) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FLT:
+		{
+			hawk_nde_flt_t* px = (hawk_nde_flt_t*)nde;
+			if (read_bytes(r, &px->val, HAWK_SIZEOF(px->val)) <= -1 ||
+			    read_oochars(r, &px->str, &px->len) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_STR:
+		{
+			hawk_nde_str_t* px = (hawk_nde_str_t*)nde;
+			if (read_oochars(r, &px->ptr, &px->len) <= -1 || !px->ptr) return -1;
+			break;
+		}
+
+		case HAWK_NDE_MBS:
+		{
+			hawk_nde_mbs_t* px = (hawk_nde_mbs_t*)nde;
+			if (read_bchars(r, &px->ptr, &px->len) <= -1 || !px->ptr) return -1;
+			break;
+		}
+
+		case HAWK_NDE_REX:
+		{
+			hawk_nde_rex_t* px = (hawk_nde_rex_t*)nde;
+			if (read_oochars(r, &px->str.ptr, &px->str.len) <= -1 || !px->str.ptr ||
+			    hawk_buildrex(r->hawk, px->str.ptr, px->str.len, &px->code[0], &px->code[1]) <= -1) return -1;
+			break;
+		}
+
+		case HAWK_NDE_FUN:
+		{
+			hawk_nde_fun_t* px = (hawk_nde_fun_t*)nde;
+			/* the function is looked up at runtime as funptr is HAWK_NULL */
+			if (read_oochars(r, &px->name.ptr, &px->name.len) <= -1 || !px->name.ptr) return -1;
+			break;
+		}
+
+		case HAWK_NDE_NAMED:
+		case HAWK_NDE_GBL:
+		case HAWK_NDE_LCL:
+		case HAWK_NDE_ARG:
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX:
+		{
+			hawk_nde_var_t* px = (hawk_nde_var_t*)nde;
+			if (read_oochars(r, &px->id.name.ptr, &px->id.name.len) <= -1 ||
+			    read_oow(r, &px->id.idxa) <= -1) return -1;
+			if ((nde->type == HAWK_NDE_GBL || nde->type == HAWK_NDE_GBLIDX) && px->id.idxa >= r->hawk->tree.ngbls) return -1;
+			break;
+		}
+
+		case HAWK_NDE_GETLINE:
+		{
+			hawk_nde_getline_t* px = (hawk_nde_getline_t*)nde;
+			int x;
+			if (read_small(r, &px->mbs) <= -1 ||
+			    read_small(r, &x) <= -1 || x > HAWK_IN_CONSOLE) return -1;
+			px->in_type = (hawk_in_type_t)x;
+			break;
+		}
+
+		default:
+			/* no other fields */
+			break;
+	}
+
+	return 0;
+}
+
+static int read_node (imgr_t* r, hawk_nde_t** out)
+{
+	hawk_nde_t* nde;
+	hawk_nde_t* tmp[4];
+	hawk_nde_t** kid[4];
+	hawk_oow_t size;
+	hawk_loc_t loc;
+	int type, need[4], nkids, i;
+
+	if (read_small(r, &type) <= -1 || read_loc(r, &loc) <= -1) return -1;
+
+	size = node_size(type);
+	if (size <= 0) return -1;
+
+	nde = (hawk_nde_t*)hawk_callocmem(r->hawk, size);
+	if (HAWK_UNLIKELY(!nde)) return -1;
+	nde->type = (hawk_nde_type_t)type;
+	nde->loc = loc;
+
+	/* the child nodes are attached after all of them have been read
+	 * so that a node is never left with a missing child */
+	nkids = node_kids(nde, kid, need);
+	for (i = 0; i < nkids; i++)
+	{
+		if (read_list(r, &tmp[i]) <= -1) goto oops;
+		if ((need[i] != KID_ANY && !tmp[i]) || (need[i] == KID_ONE && tmp[i]->next))
+		{
+			hawk_clrpt (r->hawk, tmp[i]);
+			goto oops;
+		}
+	}
+	for (i = 0; i < nkids; i++) *kid[i] = tmp[i];
+
+	if (read_fields(r, nde) <= -1)
+	{
+		hawk_clrpt (r->hawk, nde);
+		return -1;
+	}
+
+	*out = nde;
+	return 0;
+
+oops:
+	while (i > 0) hawk_clrpt (r->hawk, tmp[--i]);
+	hawk_freemem (r->hawk, nde);
+	return -1;
+}
+
+static int read_list (imgr_t* r, hawk_nde_t** list)
+{
+	hawk_nde_t* head = HAWK_NULL;
+	hawk_nde_t* tail = HAWK_NULL;
+	hawk_nde_t* nde;
+	hawk_oow_t count;
+
+	/* a node takes at least a byte */
+	if (read_oow(r, &count) <= -1 || count > (hawk_oow_t)(r->end - r->ptr)) return -1;
+
+	while (count > 0)
+	{
+		if (read_node(r, &nde) <= -1)
+		{
+			if (head) hawk_clrpt (r->hawk, head);
+			return -1;
+		}
+
+		if (tail) tail->next = nde;
+		else head = nde;
+		tail = nde;
+		count--;
+	}
+
+	*list = head;
+	return 0;
+}
+
+static int read_tree (imgr_t* r)
+{
+	hawk_t* hawk = r->hawk;
+	hawk_oow_t ngbls_base, ngbls, nfuns, nchains, i;
+	hawk_ooch_t* ptr;
+	hawk_oow_t len;
+	hawk_nde_t* tail;
+
+	if (read_small(r, &hawk->parse.pragma.trait) <= -1 ||
+	    read_oow(r, &hawk->parse.pragma.rtx_stack_limit) <= -1 ||
+	    read_oochars(r, &ptr, &len) <= -1) return -1;
+	if (ptr)
+	{
+		if (len >= HAWK_COUNTOF(hawk->parse.pragma.entry))
+		{
+			hawk_freemem (hawk, ptr);
+			return -1;
+		}
+		hawk_copy_oochars_to_oocstr_unlimited (hawk->parse.pragma.entry, ptr, len);
+		hawk_freemem (hawk, ptr);
+	}
+
+	/* the intrinsic globals must match. the others are added */
+	hawk_adjustgbls (hawk);
+	if (read_oow(r, &ngbls_base) <= -1 || ngbls_base != hawk->tree.ngbls_base ||
+	    read_oow(r, &ngbls) <= -1 || ngbls < ngbls_base) return -1;
+	for (i = 0; i < ngbls; i++)
+	{
+		int same;
+
+		if (read_oochars(r, &ptr, &len) <= -1) return -1;
+
+		if (i < ngbls_base)
+		{
+			same = (len == HAWK_ARR_DLEN(hawk->parse.gbls, i) &&
+			        (len <= 0 || hawk_comp_oochars(ptr, len, HAWK_ARR_DPTR(hawk->parse.gbls, i), len, 0) == 0));
+			if (ptr) hawk_freemem (hawk, ptr);
+			if (!same) return -1;
+		}
+		else
+		{
+			same = (ptr && hawk_arr_insert(hawk->parse.gbls, HAWK_ARR_SIZE(hawk->parse.gbls), ptr, len) != HAWK_ARR_NIL);
+			if (ptr) hawk_freemem (hawk, ptr);
+			if (!same) return -1;
+			hawk->tree.ngbls = HAWK_ARR_SIZE(hawk->parse.gbls);
+		}
+	}
+
+	if (read_oow(r, &len) <= -1) return -1;
+	if (len > 0)
+	{
+		hawk->tree.reduce.ptr = (hawk_reduce_t*)hawk_reallocmem(hawk, hawk->tree.reduce.ptr, HAWK_SIZEOF(*hawk->tree.reduce.ptr) * len);
+		if (HAWK_UNLIKELY(!hawk->tree.reduce.ptr))
+		{
+			hawk->tree.reduce.capa = 0;
+			return -1;
+		}
+		hawk->tree.reduce.capa = len;
+
+		for (i = 0; i < len; i++)
+		{
+			hawk_oow_t gbl;
+			int op;
+
+			if (read_oow(r, &gbl) <= -1 || gbl < ngbls_base || gbl >= ngbls ||
+			    read_small(r, &op) <= -1 || op < HAWK_REDUCE_SUM || op > HAWK_REDUCE_UNION) return -1;
+			hawk->tree.reduce.ptr[i].gbl = gbl;
+			hawk->tree.reduce.ptr[i].op = (hawk_reduce_op_t)op;
+			hawk->tree.reduce.count++;
+		}
+	}
+
+	if (read_oow(r, &nfuns) <= -1) return -1;
+	for (i = 0; i < nfuns; i++)
+	{
+		hawk_fun_t* fun;
+		hawk_htb_pair_t* pair;
+
+		fun = (hawk_fun_t*)hawk_callocmem(hawk, HAWK_SIZEOF(*fun));
+		if (HAWK_UNLIKELY(!fun)) return -1;
+
+		ptr = HAWK_NULL;
+		if (read_oochars(r, &ptr, &len) <= -1 || !ptr ||
+		    read_oow(r, &fun->nargs) <= -1 ||
+		    read_small(r, &fun->variadic) <= -1 ||
+		    read_oochars(r, &fun->argspec, &fun->argspeclen) <= -1 ||
+		    read_list(r, &fun->body) <= -1) goto fun_oops;
+
+		pair = hawk_htb_insert(hawk->tree.funs, ptr, len, fun, 0);
+		if (!pair) goto fun_oops;
+
+		/* the function name points to the key like parse_function() does */
+		fun->name.ptr = HAWK_HTB_KPTR(pair);
+		fun->name.len = HAWK_HTB_KLEN(pair);
+		hawk_freemem (hawk, ptr);
+		continue;
+
+	fun_oops:
+		if (ptr) hawk_freemem (hawk, ptr);
+		if (fun->body) hawk_clrpt (hawk, fun->body);
+		if (fun->argspec) hawk_freemem (hawk, fun->argspec);
+		hawk_freemem (hawk, fun);
+		return -1;
+	}
+
+	if (read_list(r, &hawk->tree.begin) <= -1) return -1;
+	for (tail = hawk->tree.begin; tail && tail->next; tail = tail->next) /* nothing */;
+	hawk->tree.begin_tail = tail;
+
+	if (read_oow(r, &nchains) <= -1) return -1;
+	for (i = 0; i < nchains; i++)
+	{
+		hawk_chain_t* chain;
+
+		chain = (hawk_chain_t*)hawk_callocmem(hawk, HAWK_SIZEOF(*chain));
+		if (HAWK_UNLIKELY(!chain)) return -1;
+
+		/* link it first for hawk_clear() to destroy it on failure */
+		if (hawk->tree.chain_tail) hawk->tree.chain_tail->next = chain;
+		else hawk->tree.chain = chain;
+		hawk->tree.chain_tail = chain;
+
+		if (read_list(r, &chain->pattern) <= -1 ||
+		    read_list(r, &chain->action) <= -1) return -1;
+	}
+
+	if (read_list(r, &hawk->tree.end) <= -1) return -1;
+	for (tail = hawk->tree.end; tail && tail->next; tail = tail->next) /* nothing */;
+	hawk->tree.end_tail = tail;
+
+	if (read_oow(r, &hawk->tree.chain_size) <= -1 ||
+	    read_oow(r, &hawk->tree.maxfld) <= -1 ||
+	    read_small(r, &hawk->tree.dynfld) <= -1) return -1;
+
+	return 0;
+}
+
+/* check if a source stream still produces the same characters */
+static int check_source (hawk_t* hawk, const hawk_ooch_t* path, hawk_oow_t nchars, hawk_oow_t digest)
+{
+	hawk_sio_arg_t* arg;
+	hawk_oow_t count = 0, hv = HAWK_HASH_INIT;
+	hawk_ooi_t n;
+
+	if (path)
+	{
+		/* open an included stream by the path resolved. an includer
+		 * without a handle makes the path to be taken as it is */
+		arg = (hawk_sio_arg_t*)hawk_callocmem(hawk, HAWK_SIZEOF(*arg) * 2);
+		if (HAWK_UNLIKELY(!arg)) return -1;
+		arg[0].name = path;
+		arg[0].prev = &arg[1];
+	}
+	else
+	{
+		HAWK_MEMSET (&hawk->sio.arg, 0, HAWK_SIZEOF(hawk->sio.arg));
+		arg = &hawk->sio.arg;
+	}
+	arg->line = 1;
+	arg->colm = 1;
+
+	hawk->sio.inp = arg;
+	n = hawk->sio.inf(hawk, HAWK_SIO_CMD_OPEN, arg, HAWK_NULL, 0);
+	if (n >= 0)
+	{
+		while ((n = hawk->sio.inf(hawk, HAWK_SIO_CMD_READ, arg, arg->b.buf, HAWK_COUNTOF(arg->b.buf))) > 0)
+		{
+			HAWK_HASH_MORE_VPTL (hv, arg->b.buf, n, const hawk_ooch_t);
+			count += n;
+			if (count > nchars) break;
+		}
+		hawk->sio.inf (hawk, HAWK_SIO_CMD_CLOSE, arg, HAWK_NULL, 0);
+	}
+	hawk->sio.inp = &hawk->sio.arg;
+
+	if (path) hawk_freemem (hawk, arg);
+	return (n == 0 && count == nchars && hv == digest)? 0: -1;
+}
+
+int hawk_loadimg (hawk_t* hawk, hawk_sio_cbs_t* sio, const void* img, hawk_oow_t len)
+{
+	imgr_t r;
+	hawk_uint8_t stamp[IMG_STAMP_CAPA];
+	hawk_oow_t stamp_len, sum, hv, count, i;
+	hawk_uint_t trait;
+
+	if (!sio || !sio->in)
+	{
+		hawk_seterrnum (hawk, HAWK_NULL, HAWK_EINVAL);
+		return -1;
+	}
+
+	if (hawk->frozen)
+	{
+		hawk_seterrnum (hawk, HAWK_NULL, HAWK_EPERM);
+		return -1;
+	}
+
+	HAWK_MEMSET (&r, 0, HAWK_SIZEOF(r));
+	r.hawk = hawk;
+	r.ptr = (const hawk_uint8_t*)img;
+	r.end = r.ptr + len;
+
+	/* reject an image from a different engine or a corrupt image */
+	stamp_len = make_stamp(stamp);
+	if (len < stamp_len + HAWK_SIZEOF(sum) || HAWK_MEMCMP(r.ptr, stamp, stamp_len) != 0) return 0;
+	r.ptr += stamp_len;
+	read_bytes (&r, &sum, HAWK_SIZEOF(sum));
+	HAWK_HASH_BYTES (hv, r.ptr, r.end - r.ptr);
+	if (hv != sum) return 0;
+
+	if (read_uint(&r, &trait) <= -1 || trait != (hawk_uint_t)hawk->opt.trait) return 0;
+
+	hawk_clear (hawk);
+	hawk_clearsionames (hawk);
+
+	HAWK_MEMSET (&hawk->sio, 0, HAWK_SIZEOF(hawk->sio));
+	hawk->sio.inf = sio->in;
+	hawk->sio.outf = sio->out;
+	hawk->sio.last.c = HAWK_OOCI_EOF;
+	hawk->sio.inp = &hawk->sio.arg;
+
+	/* the same source streams must produce the same characters */
+	if (read_oow(&r, &count) <= -1) goto stale;
+	for (i = 0; i < count; i++)
+	{
+		hawk_ooch_t* path;
+		hawk_oow_t plen, nchars, digest;
+		int x;
+
+		if (read_oochars(&r, &path, &plen) <= -1) goto stale;
+		x = (read_oow(&r, &nchars) <= -1 || read_oow(&r, &digest) <= -1)? -1: check_source(hawk, path, nchars, digest);
+		if (path) hawk_freemem (hawk, path);
+		if (x <= -1) goto stale;
+	}
+
+	/* restore the file names that the node locations refer to */
+	if (read_oow(&r, &r.nfiles) <= -1 || r.nfiles > len) goto stale;
+	if (r.nfiles > 0)
+	{
+		r.files = (hawk_ooch_t**)hawk_callocmem(hawk, r.nfiles * HAWK_SIZEOF(*r.files));
+		if (HAWK_UNLIKELY(!r.files)) goto stale;
+	}
+	for (i = 0; i < r.nfiles; i++)
+	{
+		hawk_ooch_t* ptr;
+		hawk_oow_t plen;
+
+		if (read_oochars(&r, &ptr, &plen) <= -1 || !ptr) goto stale;
+		r.files[i] = hawk_addsionamewithoochars(hawk, ptr, plen);
+		hawk_freemem (hawk, ptr);
+		if (!r.files[i]) goto stale;
+	}
+
+	if (read_tree(&r) <= -1 || r.ptr != r.end) goto stale;
+	if ((hawk->parse.pragma.trait & HAWK_BYTECODE) && hawk_compilept(hawk) <= -1) goto stale;
+
+	if (r.files) hawk_freemem (hawk, r.files);
+	return 1;
+
+stale:
+	if (r.files) hawk_freemem (hawk, r.files);
+	hawk_clear (hawk);
+	return 0;
+}
@@ -298,6 +298,78 @@ exit_loop:
 }
 
 
+hawk_oow_t split_xchars_by_xchar (hawk_rtx_t* rtx, const char_t* s, hawk_oow_t len, char_t fs, xcs_t* tok, hawk_oow_t max, char_t** rest)
+{
+	const char_t* p = s, * sp;
+	const char_t* end = s + len;
+	hawk_oow_t n = 0;
+
+	/* this produces the same tokens as tokenize_xchars() called repeatedly
+	 * with a single character delimiter, but finds as many of them as
+	 * requested in one go. */
+	HAWK_ASSERT (max > 0);
+
+	if (fs == ' ')
+	{
+		/* each token is delimited by space characters. all leading
+		 * and trailing spaces are removed. */
+		while (n < max)
+		{
+			while (p < end && is_xch_space_fast(*p)) p++;
+			sp = p;
+			while (p < end && !is_xch_space_fast(*p)) p++;
+
+			tok[n].ptr = (p > sp)? (char_t*)sp: HAWK_NULL;
+			tok[n].len = p - sp;
+			n++;
+
+			while (p < end && is_xch_space_fast(*p)) p++;
+			if (p >= end) goto done;
+		}
+	}
+	else if (rtx->gbl.ignorecase)
+	{
+		char_t ufs = to_xch_upper(fs);
+
+		while (n < max)
+		{
+			sp = p;
+			while (p < end && to_xch_upper(*p) != ufs) p++;
+
+			tok[n].ptr = (p > sp)? (char_t*)sp: HAWK_NULL;
+			tok[n].len = p - sp;
+			n++;
+
+			if (p >= end) goto done;
+			p++; /* skip the delimiter */
+		}
+	}
+	else
+	{
+		while (n < max)
+		{
+			sp = p;
+			p = find_xchar_in_xchars(sp, end - sp, fs);
+			if (!p) p = end;
+
+			tok[n].ptr = (p > sp)? (char_t*)sp: HAWK_NULL;
+			tok[n].len = p - sp;
+			n++;
+
+			if (p >= end) goto done;
+			p++; /* skip the delimiter */
+		}
+	}
+
+	*rest = (char_t*)p;
+	return n;
+
+done:
+	/* no more tokens */
+	*rest = HAWK_NULL;
+	return n;
+}
+
 char_t* tokenize_xchars_by_rex (hawk_rtx_t* rtx, const char_t* str, hawk_oow_t len, const char_t* substr, hawk_oow_t sublen, hawk_tre_t* rex, xcs_t* tok)
 {
 	int n;
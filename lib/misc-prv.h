@@ -61,6 +61,21 @@ hawk_bch_t* hawk_rtx_tokbcharswithbchars (
 	hawk_rtx_t* rtx, const hawk_bch_t* s, hawk_oow_t len,
 	const hawk_bch_t* delim, hawk_oow_t delim_len, hawk_bcs_t* tok);
 
+/**
+ * The hawk_rtx_spluchars() function splits a string by a single character
+ * separator into as many as \a max tokens at a time. A space separator
+ * splits the string by runs of space characters. It sets \a rest to the
+ * position to resume splitting from, or #HAWK_NULL if no tokens are left.
+ * \return number of tokens stored into \a tok
+ */
+hawk_oow_t hawk_rtx_spluchars (
+	hawk_rtx_t* rtx, const hawk_uch_t* s, hawk_oow_t len,
+	hawk_uch_t fs, hawk_ucs_t* tok, hawk_oow_t max, hawk_uch_t** rest);
+
+hawk_oow_t hawk_rtx_splbchars (
+	hawk_rtx_t* rtx, const hawk_bch_t* s, hawk_oow_t len,
+	hawk_bch_t fs, hawk_bcs_t* tok, hawk_oow_t max, hawk_bch_t** rest);
+
 
 hawk_uch_t* hawk_rtx_tokucharsbyrex (
 	hawk_rtx_t*       rtx,
@@ -86,10 +101,12 @@ hawk_bch_t* hawk_rtx_tokbcharsbyrex (
 #if defined(HAWK_OOCH_IS_UCH)
 #	define hawk_rtx_fldoochars hawk_rtx_flduchars
 #	define hawk_rtx_tokoocharswithoochars hawk_rtx_tokucharswithuchars
+#	define hawk_rtx_sploochars hawk_rtx_spluchars
 #	define hawk_rtx_tokoocharsbyrex hawk_rtx_tokucharsbyrex
 #else
 #	define hawk_rtx_fldoochars hawk_rtx_fldbchars
 #	define hawk_rtx_tokoocharswithoochars hawk_rtx_tokbcharswithbchars
+#	define hawk_rtx_sploochars hawk_rtx_splbchars
 #	define hawk_rtx_tokoocharsbyrex hawk_rtx_tokbcharsbyrex
 #endif
 
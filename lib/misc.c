@@ -28,20 +28,26 @@
 #undef char_t
 #undef xcs_t
 #undef is_xch_space
+#undef is_xch_space_fast
+#undef find_xchar_in_xchars
 #undef to_xch_space
 #undef match_rex_with_xcs
 #undef split_xchars_to_fields
 #undef tokenize_xchars
+#undef split_xchars_by_xchar
 #undef tokenize_xchars_by_rex
 
 #define char_t hawk_bch_t
 #define xcs_t hawk_bcs_t
 #define is_xch_space hawk_is_bch_space
+#define is_xch_space_fast hawk_is_bch_space
+#define find_xchar_in_xchars hawk_find_bchar_in_bchars
 #define to_xch_upper hawk_to_bch_upper
 #define match_rex_with_xcs hawk_rtx_matchrexwithbcs
 
 #define split_xchars_to_fields hawk_rtx_fldbchars
 #define tokenize_xchars hawk_rtx_tokbcharswithbchars
+#define split_xchars_by_xchar hawk_rtx_splbchars
 #define tokenize_xchars_by_rex hawk_rtx_tokbcharsbyrex
 
 #include "misc-imp.h"
@@ -49,20 +55,27 @@
 #undef char_t
 #undef xcs_t
 #undef is_xch_space
+#undef is_xch_space_fast
+#undef find_xchar_in_xchars
 #undef to_xch_upper
 #undef match_rex_with_xcs
 #undef split_xchars_to_fields
 #undef tokenize_xchars
+#undef split_xchars_by_xchar
 #undef tokenize_xchars_by_rex
 
 #define char_t hawk_uch_t
 #define xcs_t hawk_ucs_t
 #define is_xch_space hawk_is_uch_space
+/* all space characters outside the ascii range are above 0x7F */
+#define is_xch_space_fast(c) ((c) == ' ' || (hawk_oow_t)(hawk_uchu_t)(c) - '\t' < 5 || ((hawk_uchu_t)(c) >= 0x80 && hawk_is_uch_space(c)))
+#define find_xchar_in_xchars hawk_find_uchar_in_uchars
 #define to_xch_upper hawk_to_uch_upper
 #define match_rex_with_xcs hawk_rtx_matchrexwithucs
 
 #define split_xchars_to_fields hawk_rtx_flduchars
 #define tokenize_xchars hawk_rtx_tokucharswithuchars
+#define split_xchars_by_xchar hawk_rtx_spluchars
 #define tokenize_xchars_by_rex hawk_rtx_tokucharsbyrex
 
 #include "misc-imp.h"
@@ -75,7 +88,9 @@ static int matchtre_ucs (hawk_tre_t* tre, int opt, const hawk_ucs_t* str, hawk_u
 	hawk_tre_match_t match[10];
 
 	HAWK_MEMSET (match, 0, HAWK_SIZEOF(match));
-	n = hawk_tre_execuchars(tre, str->ptr, str->len, match, HAWK_COUNTOF(match), opt, errgem);
+	/* no match positions are needed for a simple test. it lets the matcher
+	 * answer without locating the match */
+	n = hawk_tre_execuchars(tre, str->ptr, str->len, match, ((mat || submat)? HAWK_COUNTOF(match): 0), opt, errgem);
 	if (n <= -1)
 	{
 		if (hawk_gem_geterrnum(errgem) == HAWK_EREXNOMAT) return 0;
@@ -114,7 +129,9 @@ static int matchtre_bcs (hawk_tre_t* tre, int opt, const hawk_bcs_t* str, hawk_b
 	hawk_tre_match_t match[10];
 
 	HAWK_MEMSET (match, 0, HAWK_SIZEOF(match));
-	n = hawk_tre_execbchars(tre, str->ptr, str->len, match, HAWK_COUNTOF(match), opt, errgem);
+	/* no match positions are needed for a simple test. it lets the matcher
+	 * answer without locating the match */
+	n = hawk_tre_execbchars(tre, str->ptr, str->len, match, ((mat || submat)? HAWK_COUNTOF(match): 0), opt, errgem);
 	if (n <= -1)
 	{
 		if (hawk_gem_geterrnum(errgem) == HAWK_EREXNOMAT) return 0;
@@ -148,7 +165,7 @@ static int matchtre_bcs (hawk_tre_t* tre, int opt, const hawk_bcs_t* str, hawk_b
 
 int hawk_rtx_matchvalwithucs (hawk_rtx_t* rtx, hawk_val_t* val, const hawk_ucs_t* str, const hawk_ucs_t* substr, hawk_ucs_t* match, hawk_ucs_t submat[9])
 {
-	int ignorecase, x;
+	int ignorecase;
 	int opt = HAWK_TRE_BACKTRACKING; /* TODO: option... HAWK_TRE_BACKTRACKING ??? */
 	hawk_tre_t* code;
 	hawk_val_type_t v_type;
@@ -159,43 +176,35 @@ int hawk_rtx_matchvalwithucs (hawk_rtx_t* rtx, hawk_val_t* val, const hawk_ucs_t
 	if (v_type == HAWK_VAL_REX)
 	{
 		code = ((hawk_val_rex_t*)val)->code[ignorecase];
+		/* the expression in the parse tree of a frozen hawk object
+		 * may be in use by another runtime context */
+		if (rtx->hawk->frozen) opt |= HAWK_TRE_SHARED;
 	}
 	else
 	{
-		/* convert to a string and build a regular expression */
+		/* convert to a string and get a regular expression built
+		 * from it. the expression is owned by the cache */
 		hawk_oocs_t tmp;
 
 		tmp.ptr = hawk_rtx_getvaloocstr(rtx, val, &tmp.len);
 		if (tmp.ptr == HAWK_NULL) return -1;
 
-		x = ignorecase? hawk_rtx_buildrex(rtx, tmp.ptr, tmp.len, HAWK_NULL, &code):
-		                hawk_rtx_buildrex(rtx, tmp.ptr, tmp.len, &code, HAWK_NULL);
+		code = hawk_rtx_getcachedrex(rtx, tmp.ptr, tmp.len, ignorecase);
 		hawk_rtx_freevaloocstr (rtx, val, tmp.ptr);
-		if (x <= -1) return -1;
+		if (HAWK_UNLIKELY(!code)) return -1;
 	}
 
 
-	x = matchtre_ucs(
+	return matchtre_ucs(
 		code, ((str->ptr == substr->ptr)? opt: (opt | HAWK_TRE_NOTBOL)),
 		substr, match, submat, hawk_rtx_getgem(rtx)
 	);
-
-	if (v_type == HAWK_VAL_REX)
-	{
-		/* nothing to free */
-	}
-	else
-	{
-		hawk_tre_close (code);
-	}
-
-	return x;
 }
 
 
 int hawk_rtx_matchvalwithbcs (hawk_rtx_t* rtx, hawk_val_t* val, const hawk_bcs_t* str, const hawk_bcs_t* substr, hawk_bcs_t* match, hawk_bcs_t submat[9])
 {
-	int ignorecase, x;
+	int ignorecase;
 	int opt = HAWK_TRE_BACKTRACKING; /* TODO: option... HAWK_TRE_BACKTRACKING ??? */
 	hawk_tre_t* code;
 	hawk_val_type_t v_type;
@@ -206,42 +215,35 @@ int hawk_rtx_matchvalwithbcs (hawk_rtx_t* rtx, hawk_val_t* val, const hawk_bcs_t
 	if (v_type == HAWK_VAL_REX)
 	{
 		code = ((hawk_val_rex_t*)val)->code[ignorecase];
+		/* the expression in the parse tree of a frozen hawk object
+		 * may be in use by another runtime context */
+		if (rtx->hawk->frozen) opt |= HAWK_TRE_SHARED;
 	}
 	else
 	{
-		/* convert to a string and build a regular expression */
+		/* convert to a string and get a regular expression built
+		 * from it. the expression is owned by the cache */
 		hawk_oocs_t tmp;
 
 		tmp.ptr = hawk_rtx_getvaloocstr(rtx, val, &tmp.len);
 		if (HAWK_UNLIKELY(!tmp.ptr)) return -1;
 
-		x = ignorecase? hawk_rtx_buildrex(rtx, tmp.ptr, tmp.len, HAWK_NULL, &code):
-		                hawk_rtx_buildrex(rtx, tmp.ptr, tmp.len, &code, HAWK_NULL);
+		code = hawk_rtx_getcachedrex(rtx, tmp.ptr, tmp.len, ignorecase);
 		hawk_rtx_freevaloocstr (rtx, val, tmp.ptr);
-		if (x <= -1) return -1;
+		if (HAWK_UNLIKELY(!code)) return -1;
 	}
 
-	x = matchtre_bcs(
+	return matchtre_bcs(
 		code, ((str->ptr == substr->ptr)? opt: (opt | HAWK_TRE_NOTBOL)),
 		substr, match, submat, hawk_rtx_getgem(rtx)
 	);
-
-	if (v_type == HAWK_VAL_REX)
-	{
-		/* nothing to free */
-	}
-	else
-	{
-		hawk_tre_close (code);
-	}
-
-	return x;
 }
 
 
 int hawk_rtx_matchrexwithucs (hawk_rtx_t* rtx, hawk_tre_t* code, const hawk_ucs_t* str, const hawk_ucs_t* substr, hawk_ucs_t* match, hawk_ucs_t submat[9])
 {
 	int opt = HAWK_TRE_BACKTRACKING; /* TODO: option... HAWK_TRE_BACKTRACKING or others??? */
+	if (rtx->hawk->frozen) opt |= HAWK_TRE_SHARED;
 	return matchtre_ucs(
 		code, ((str->ptr == substr->ptr)? opt: (opt | HAWK_TRE_NOTBOL)),
 		substr, match, submat, hawk_rtx_getgem(rtx)
@@ -251,6 +253,7 @@ int hawk_rtx_matchrexwithucs (hawk_rtx_t* rtx, hawk_tre_t* code, const hawk_ucs_
 int hawk_rtx_matchrexwithbcs (hawk_rtx_t* rtx, hawk_tre_t* code, const hawk_bcs_t* str, const hawk_bcs_t* substr, hawk_bcs_t* match, hawk_bcs_t submat[9])
 {
 	int opt = HAWK_TRE_BACKTRACKING; /* TODO: option... HAWK_TRE_BACKTRACKING or others??? */
+	if (rtx->hawk->frozen) opt |= HAWK_TRE_SHARED;
 	return matchtre_bcs(
 		code, ((str->ptr == substr->ptr)? opt: (opt | HAWK_TRE_NOTBOL)),
 		substr, match, submat, hawk_rtx_getgem(rtx)
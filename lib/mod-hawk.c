@@ -24,14 +24,7 @@
 
 #include "mod-hawk.h"
 #include "hawk-prv.h"
-#include <hawk-mtx.h>
 
-
-struct mod_data_t
-{
-	hawk_mtx_t mq_mtx;
-};
-typedef struct mod_data_t mod_data_t;
 /* ----------------------------------------------------------------- */
 
 /*
@@ -133,19 +126,10 @@ static int fnc_call (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 	{
 		/* find the name in the modules */
 		hawk_fnc_t fnc, * fncp;
-		mod_data_t* md;
 
-		md = (mod_data_t*)fi->mod->ctx;
-
-		/* hawk_querymodulewithname() called by hawk_rtx_valtofnc()
-		 * may update some shared data under the hawk object.
-		 * use a mutex for shared data safety */
-		/* TODO: this mutex protection is wrong in that if a call to hawk_querymodulewithname()
-		 *       is made outside this hawk module, the call is not protected under
-		 *       the same mutex. FIX THIS */
-		hawk_mtx_lock (&md->mq_mtx, HAWK_NULL);
+		/* hawk_rtx_valtofnc() guards the module table shared
+		 * under the hawk object by itself */
 		fncp = hawk_rtx_valtofnc(rtx, hawk_rtx_getarg(rtx, 0), &fnc);
-		hawk_mtx_unlock (&md->mq_mtx);
 		if (!fncp) return -1; /* hard failure */
 
 		if (f_nargs < fnc.spec.arg.min  || f_nargs > fnc.spec.arg.max)
@@ -202,18 +186,11 @@ static int fnc_function_exists (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 			rx = (hawk_rtx_findfunwithoocstr(rtx, name.ptr) != HAWK_NULL);
 			if (!rx)
 			{
-				rx = (hawk_findfncwithoocs(hawk_rtx_gethawk(rtx), &name) != HAWK_NULL);
+				rx = (hawk_rtx_findfncwithoocs(rtx, &name) != HAWK_NULL);
 				if (!rx)
 				{
 					hawk_mod_sym_t sym;
-					mod_data_t* md;
-
-					md = (mod_data_t*)fi->mod->ctx;
-					/* hawk_query_module_with_name() may update some shared data under
-					 * the hawk object. use a mutex for shared data safety */
-					hawk_mtx_lock (&md->mq_mtx, HAWK_NULL);
-					rx = (hawk_querymodulewithname(hawk_rtx_gethawk(rtx), name.ptr, &sym) != HAWK_NULL);
-					hawk_mtx_unlock (&md->mq_mtx);
+					rx = (hawk_rtx_querymodulewithname(rtx, name.ptr, &sym) != HAWK_NULL);
 				}
 			}
 		}
@@ -254,6 +231,7 @@ static int fnc_cmgr_exists (hawk_rtx_t* rtx, const hawk_fnc_info_t*  fi)
    hawk::gc();
    hawk::gc_get_threshold(gen)
    hawk::gc_set_threshold(gen, threshold)
+   hawk::gcstats()
    hawk::GC_NUM_GENS
  */
 
@@ -329,6 +307,91 @@ static int fnc_gc_set_threshold (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 	return 0;
 }
 
+/*
+   s = hawk::gcstats();
+   print s["collections"], s["pause_max"], s["str_cache_hits"];
+   for (g = 0; g < hawk::GC_NUM_GENS; g++) print s["gen"][g]["count"], s["gen"][g]["threshold"];
+ */
+static int fnc_gcstats (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
+{
+	hawk_gcstats_t stats;
+	hawk_val_map_data_t md[16];
+	hawk_val_t* tmp, * gen, * v;
+	hawk_ooch_t idx[16];
+	hawk_oow_t len;
+	int i;
+
+	hawk_rtx_getgcstats (rtx, &stats);
+
+	HAWK_MEMSET (md, 0, HAWK_SIZEOF(md));
+
+#define SET_MD(n,k,f) do { \
+	md[n].key.ptr = HAWK_T(k); \
+	md[n].key.len = HAWK_COUNTOF(k) - 1; \
+	md[n].type = HAWK_VAL_MAP_DATA_INT; \
+	md[n].type_size = HAWK_SIZEOF(f); \
+	md[n].vptr = &(f); \
+} while(0)
+
+	SET_MD (0, "collections", stats.collections);
+	SET_MD (1, "slices", stats.slices);
+	SET_MD (2, "rounds", stats.rounds);
+	SET_MD (3, "freed", stats.freed);
+	SET_MD (4, "pause_total", stats.pause_total);
+	SET_MD (5, "pause_max", stats.pause_max);
+	SET_MD (6, "str_cache_hits", stats.str_cache.hits);
+	SET_MD (7, "str_cache_misses", stats.str_cache.misses);
+	SET_MD (8, "mbs_cache_hits", stats.mbs_cache.hits);
+	SET_MD (9, "mbs_cache_misses", stats.mbs_cache.misses);
+	SET_MD (10, "int_cache_hits", stats.int_cache.hits);
+	SET_MD (11, "int_cache_misses", stats.int_cache.misses);
+	SET_MD (12, "flt_cache_hits", stats.flt_cache.hits);
+	SET_MD (13, "flt_cache_misses", stats.flt_cache.misses);
+	SET_MD (14, "ref_cache_hits", stats.ref_cache.hits);
+	SET_MD (15, "ref_cache_misses", stats.ref_cache.misses);
+
+	tmp = hawk_rtx_makemapvalwithdata(rtx, md, 16);
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+	hawk_rtx_refupval (rtx, tmp); /* protect it from the collection triggered by the allocations below */
+
+	gen = hawk_rtx_makemapval(rtx);
+	if (HAWK_UNLIKELY(!gen)) goto oops;
+	if (HAWK_UNLIKELY(!hawk_rtx_setmapvalfld(rtx, tmp, HAWK_T("gen"), 3, gen)))
+	{
+		hawk_rtx_freeval (rtx, gen, 0);
+		goto oops;
+	}
+
+	for (i = 0; i < stats.ngens; i++)
+	{
+		HAWK_MEMSET (md, 0, HAWK_SIZEOF(md));
+		SET_MD (0, "count", stats.gen[i].count);
+		SET_MD (1, "collections", stats.gen[i].collections);
+		SET_MD (2, "pressure", stats.gen[i].pressure);
+		SET_MD (3, "threshold", stats.gen[i].threshold);
+
+		v = hawk_rtx_makemapvalwithdata(rtx, md, 4);
+		if (HAWK_UNLIKELY(!v)) goto oops;
+
+		len = hawk_fmt_uintmax_to_oocstr(idx, HAWK_COUNTOF(idx), i, 10, 0, '\0', HAWK_NULL);
+		if (HAWK_UNLIKELY(!hawk_rtx_setmapvalfld(rtx, gen, idx, len, v)))
+		{
+			hawk_rtx_freeval (rtx, v, 0);
+			goto oops;
+		}
+	}
+
+#undef SET_MD
+
+	hawk_rtx_refdownval_nofree (rtx, tmp);
+	hawk_rtx_setretval (rtx, tmp);
+	return 0;
+
+oops:
+	hawk_rtx_refdownval (rtx, tmp);
+	return -1;
+}
+
 static int fnc_gcrefs (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
 	hawk_val_t* a0;
@@ -339,6 +402,109 @@ static int fnc_gcrefs (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 
 /* -------------------------------------------------------------------------- */
 
+/*
+   s = hawk::rexcache_stats();
+   print s["hits"], s["misses"], s["size"], s["capa"];
+ */
+static int fnc_rexcache_stats (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
+{
+	hawk_rexcache_stats_t stats;
+	hawk_val_map_data_t md[4];
+	hawk_val_t* tmp;
+
+	hawk_rtx_getrexcachestats (rtx, &stats);
+
+	HAWK_MEMSET (md, 0, HAWK_SIZEOF(md));
+
+	md[0].key.ptr = HAWK_T("capa");
+	md[0].key.len = 4;
+	md[0].type = HAWK_VAL_MAP_DATA_INT;
+	md[0].type_size = HAWK_SIZEOF(stats.capa);
+	md[0].vptr = &stats.capa;
+
+	md[1].key.ptr = HAWK_T("size");
+	md[1].key.len = 4;
+	md[1].type = HAWK_VAL_MAP_DATA_INT;
+	md[1].type_size = HAWK_SIZEOF(stats.size);
+	md[1].vptr = &stats.size;
+
+	md[2].key.ptr = HAWK_T("hits");
+	md[2].key.len = 4;
+	md[2].type = HAWK_VAL_MAP_DATA_INT;
+	md[2].type_size = HAWK_SIZEOF(stats.hits);
+	md[2].vptr = &stats.hits;
+
+	md[3].key.ptr = HAWK_T("misses");
+	md[3].key.len = 6;
+	md[3].type = HAWK_VAL_MAP_DATA_INT;
+	md[3].type_size = HAWK_SIZEOF(stats.misses);
+	md[3].vptr = &stats.misses;
+
+	tmp = hawk_rtx_makemapvalwithdata(rtx, md, HAWK_COUNTOF(md));
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+
+	hawk_rtx_setretval (rtx, tmp);
+	return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+   hawk::set_max_open_outfiles(10);
+   s = hawk::iostats();
+   print s["open_outfiles"], s["hits"], s["evictions"], s["reopens"];
+ */
+static int fnc_iostats (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
+{
+	hawk_riostats_t stats;
+	hawk_val_map_data_t md[5];
+	hawk_val_t* tmp;
+
+	hawk_rtx_getriostats (rtx, &stats);
+
+	HAWK_MEMSET (md, 0, HAWK_SIZEOF(md));
+
+#define SET_MD(n,k,f) do { \
+	md[n].key.ptr = HAWK_T(k); \
+	md[n].key.len = HAWK_COUNTOF(k) - 1; \
+	md[n].type = HAWK_VAL_MAP_DATA_INT; \
+	md[n].type_size = HAWK_SIZEOF(f); \
+	md[n].vptr = &(f); \
+} while(0)
+
+	SET_MD (0, "max_open_outfiles", stats.max_open_outfiles);
+	SET_MD (1, "open_outfiles", stats.open_outfiles);
+	SET_MD (2, "hits", stats.hits);
+	SET_MD (3, "evictions", stats.evictions);
+	SET_MD (4, "reopens", stats.reopens);
+
+#undef SET_MD
+
+	tmp = hawk_rtx_makemapvalwithdata(rtx, md, HAWK_COUNTOF(md));
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+
+	hawk_rtx_setretval (rtx, tmp);
+	return 0;
+}
+
+static int fnc_set_max_open_outfiles (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
+{
+	hawk_int_t max;
+
+	if (hawk_rtx_valtoint(rtx, hawk_rtx_getarg(rtx, 0), &max) <= -1) max = -1;
+
+	/* a negative number retrieves the existing value without an update.
+	 * the files open over a lower limit are closed when another file
+	 * needs to be opened */
+	if (max >= 0) rtx->rio.lru.max = max;
+	else max = rtx->rio.lru.max;
+
+	hawk_rtx_setretval (rtx, hawk_rtx_makeintval(rtx, max));
+	return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 static int fnc_array (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
 	hawk_val_t* tmp;
@@ -528,12 +694,16 @@ static hawk_mod_fnc_tab_t fnctab[] =
 	{ HAWK_T("gc_get_threshold"), { { 1, 1,     HAWK_NULL     },  fnc_gc_get_threshold,      0 } },
 	{ HAWK_T("gc_set_threshold"), { { 2, 2,     HAWK_NULL     },  fnc_gc_set_threshold,      0 } },
 	{ HAWK_T("gcrefs"),           { { 1, 1,     HAWK_NULL     },  fnc_gcrefs,                0 } },
+	{ HAWK_T("gcstats"),          { { 0, 0,     HAWK_NULL     },  fnc_gcstats,               0 } },
 	{ HAWK_T("hash"),             { { 1, 1,     HAWK_NULL     },  fnc_hash,                  0 } },
+	{ HAWK_T("iostats"),          { { 0, 0,     HAWK_NULL     },  fnc_iostats,               0 } },
 	{ HAWK_T("isarray"),          { { 1, 1,     HAWK_NULL     },  fnc_isarr,                 0 } },
 	{ HAWK_T("ismap"),            { { 1, 1,     HAWK_NULL     },  fnc_ismap,                 0 } },
 	{ HAWK_T("isnil"),            { { 1, 1,     HAWK_NULL     },  fnc_isnil,                 0 } },
 	{ HAWK_T("map"),              { { 0, A_MAX, HAWK_NULL     },  fnc_map,                   0 } },
 	{ HAWK_T("modlibdirs"),       { { 0, 0,     HAWK_NULL     },  fnc_modlibdirs,            0 } },
+	{ HAWK_T("rexcache_stats"),   { { 0, 0,     HAWK_NULL     },  fnc_rexcache_stats,        0 } },
+	{ HAWK_T("set_max_open_outfiles"), { { 1, 1, HAWK_NULL     },  fnc_set_max_open_outfiles, 0 } },
 	{ HAWK_T("type"),             { { 1, 1,     HAWK_NULL     },  fnc_type,                  0 } },
 	{ HAWK_T("typename"),         { { 1, 1,     HAWK_NULL     },  fnc_typename,              0 } }
 };
@@ -579,27 +749,16 @@ static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 
 static void unload (hawk_mod_t* mod, hawk_t* hawk)
 {
-	mod_data_t* md = (mod_data_t*)mod->ctx;
-
-	hawk_mtx_fini (&md->mq_mtx);
-	hawk_freemem (hawk, md);
+	/* nothing to do */
 }
 
 int hawk_mod_hawk (hawk_mod_t* mod, hawk_t* hawk)
 {
-	mod_data_t* md;
-
-	md = hawk_allocmem(hawk, HAWK_SIZEOF(*md));
-	if (HAWK_UNLIKELY(!md)) return -1;
-
-	hawk_mtx_init (&md->mq_mtx, hawk_getgem(hawk));
-
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
-	mod->ctx = md;
 
 	return 0;
 }
@@ -554,7 +554,7 @@ static int fnc_rand (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 	hawk_int32_t randv;
 	modctx_t* modctx;
 
-	modctx = (modctx_t*)fi->mod->ctx;
+	modctx = (modctx_t*)hawk_rtx_getmodinst(rtx, fi->mod);
 #if defined(HAVE_INITSTATE_R) && defined(HAVE_SRANDOM_R) && defined(HAVE_RANDOM_R)
 	random_r (&modctx->prand, &randv);
 #elif defined(HAVE_RANDOM)
@@ -581,7 +581,7 @@ static int fnc_srand (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 	hawk_int_t prev;
 	modctx_t* modctx;
 
-	modctx = (modctx_t*)fi->mod->ctx;
+	modctx = (modctx_t*)hawk_rtx_getmodinst(rtx, fi->mod);
 	nargs = hawk_rtx_getnargs(rtx);
 	HAWK_ASSERT (nargs == 0 || nargs == 1);
 
@@ -656,32 +656,19 @@ static int query (hawk_mod_t* mod, hawk_t* hawk, const hawk_ooch_t* name, hawk_m
 /* TODO: proper resource management */
 
 static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
-{
-	return 0;
-}
-
-static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
-{
-	/* TODO: anything */
-}
-
-static void unload (hawk_mod_t* mod, hawk_t* hawk)
-{
-	modctx_t* modctx;
-
-	modctx = (modctx_t*)mod->ctx;
-	hawk_freemem (hawk, modctx);
-}
-
-int hawk_mod_math (hawk_mod_t* mod, hawk_t* hawk)
 {
 	modctx_t* modctx;
 	hawk_ntime_t tv;
 
-	modctx = hawk_allocmem(hawk, HAWK_SIZEOF(*modctx));
-	if (modctx == HAWK_NULL) return -1;
+	/* the random number generator state is kept per runtime context */
+	modctx = hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*modctx));
+	if (HAWK_UNLIKELY(!modctx)) return -1;
 
-	HAWK_MEMSET (modctx, 0, HAWK_SIZEOF(*modctx));
+	if (hawk_rtx_setmodinst(rtx, mod, modctx) <= -1)
+	{
+		hawk_rtx_freemem (rtx, modctx);
+		return -1;
+	}
 
 	hawk_get_ntime (&tv);
 	modctx->seed = tv.sec + tv.nsec;
@@ -694,12 +681,33 @@ int hawk_mod_math (hawk_mod_t* mod, hawk_t* hawk)
 	srand (modctx->seed);
 #endif
 
+	return 0;
+}
+
+static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
+{
+	modctx_t* modctx;
+
+	modctx = (modctx_t*)hawk_rtx_getmodinst(rtx, mod);
+	if (modctx)
+	{
+		hawk_rtx_setmodinst (rtx, mod, HAWK_NULL);
+		hawk_rtx_freemem (rtx, modctx);
+	}
+}
+
+static void unload (hawk_mod_t* mod, hawk_t* hawk)
+{
+	/* nothing to do */
+}
+
+int hawk_mod_math (hawk_mod_t* mod, hawk_t* hawk)
+{
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
-	mod->ctx = modctx;
 
 	return 0;
 }
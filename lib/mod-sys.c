@@ -129,12 +129,6 @@ enum syslog_type_t
 	SYSLOG_REMOTE,
 };
 
-struct mod_ctx_t
-{
-	hawk_rbt_t* rtxtab;
-};
-typedef struct mod_ctx_t mod_ctx_t;
-
 /* ------------------------------------------------------------------------ */
 
 enum sys_node_data_type_t
@@ -498,11 +492,10 @@ static void free_sys_node (hawk_rtx_t* rtx, sys_list_t* list, sys_node_t* node)
 
 static HAWK_INLINE rtx_data_t* rtx_to_data (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-        mod_ctx_t* mctx = (mod_ctx_t*)fi->mod->ctx;
-        hawk_rbt_pair_t* pair;
-        pair = hawk_rbt_search(mctx->rtxtab, &rtx, HAWK_SIZEOF(rtx));
-        HAWK_ASSERT (pair != HAWK_NULL);
-        return (rtx_data_t*)HAWK_RBT_VPTR(pair);
+	rtx_data_t* rdp;
+	rdp = (rtx_data_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (rdp != HAWK_NULL);
+	return rdp;
 }
 
 static HAWK_INLINE sys_list_t* rtx_to_sys_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
@@ -1299,8 +1292,7 @@ static int fnc_tcsetattr (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi) /* this is
 	if (sys_node)
 	{
 		struct termios t;
-		hawk_map_itr_t itr;
-		hawk_map_pair_t* pair;
+		hawk_val_map_itr_t itr, * iptr;
 		hawk_val_t* a2;
 		hawk_int_t action, flag;
 
@@ -1321,16 +1313,15 @@ static int fnc_tcsetattr (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi) /* this is
 		rx = tcgetattr(sys_node->ctx.u.file.fd, &t);
 		if (rx <= -1) goto fail_with_errno;
 
-		hawk_init_map_itr (&itr, 0);
-		pair = hawk_map_getfirstpair(((hawk_val_map_t*)a2)->map, &itr);
-		while (pair)
+		iptr = hawk_rtx_getfirstmapvalitr(rtx, a2, &itr);
+		while (iptr)
 		{
-			if (hawk_comp_oochars_bcstr(HAWK_MAP_KPTR(pair), HAWK_MAP_KLEN(pair), "cc", 0) == 0)
+			if (hawk_comp_oochars_bcstr(itr.key.ptr, itr.key.len, "cc", 0) == 0)
 			{
 				hawk_bch_t* ptr;
 				hawk_oow_t len;
 
-				ptr = hawk_rtx_getvalbcstr(rtx, HAWK_MAP_VPTR(pair), &len);
+				ptr = hawk_rtx_getvalbcstr(rtx, (hawk_val_t*)itr.val, &len);
 				if (!ptr)
 				{
 					rx = copy_error_to_sys_list(rtx, sys_list);
@@ -1339,36 +1330,36 @@ static int fnc_tcsetattr (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi) /* this is
 
 				if (len >= HAWK_COUNTOF(t.c_cc)) len = HAWK_COUNTOF(t.c_cc);
 				HAWK_MEMCPY (t.c_cc, ptr, len);
-				hawk_rtx_freevalbcstr (rtx, HAWK_MAP_VPTR(pair), ptr);
+				hawk_rtx_freevalbcstr (rtx, (hawk_val_t*)itr.val, ptr);
 			}
 			else
 			{
-				if (hawk_rtx_valtoint(rtx, HAWK_MAP_VPTR(pair), &flag) <= -1)
+				if (hawk_rtx_valtoint(rtx, (hawk_val_t*)itr.val, &flag) <= -1)
 				{
 					rx = copy_error_to_sys_list(rtx, sys_list);
 					goto done;
 				}
 
-				if (hawk_comp_oochars_bcstr(HAWK_MAP_KPTR(pair), HAWK_MAP_KLEN(pair), "iflag", 0) == 0)
+				if (hawk_comp_oochars_bcstr(itr.key.ptr, itr.key.len, "iflag", 0) == 0)
 				{
 					t.c_iflag = flag;
 				}
-				else if (hawk_comp_oochars_bcstr(HAWK_MAP_KPTR(pair), HAWK_MAP_KLEN(pair), "oflag", 0) == 0)
+				else if (hawk_comp_oochars_bcstr(itr.key.ptr, itr.key.len, "oflag", 0) == 0)
 				{
 					t.c_oflag = flag;
 				}
-				else if (hawk_comp_oochars_bcstr(HAWK_MAP_KPTR(pair), HAWK_MAP_KLEN(pair), "cflag", 0) == 0)
+				else if (hawk_comp_oochars_bcstr(itr.key.ptr, itr.key.len, "cflag", 0) == 0)
 				{
 					t.c_cflag = flag;
 				}
-				else if (hawk_comp_oochars_bcstr(HAWK_MAP_KPTR(pair), HAWK_MAP_KLEN(pair), "lflag", 0) == 0)
+				else if (hawk_comp_oochars_bcstr(itr.key.ptr, itr.key.len, "lflag", 0) == 0)
 				{
 					t.c_lflag = flag;
 				}
 			}
 
 
-			pair = hawk_map_getnextpair(((hawk_val_map_t*)a2)->map, &itr);
+			iptr = hawk_rtx_getnextmapvalitr(rtx, a2, &itr);
 		}
 
 		rx = tcsetattr(sys_node->ctx.u.file.fd, action, &t);
@@ -2985,6 +2976,9 @@ static int fnc_system (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 		goto done;
 	}
 
+	/* the command may write to the same output as this program does */
+	hawk_rtx_flushallios (rtx);
+
 #if defined(_WIN32)
 	rx = _tsystem(str);
 	if (rx <= -1) rx = set_error_on_sys_list_with_errno(rtx, sys_list, HAWK_NULL);
@@ -6273,15 +6267,18 @@ static int query (hawk_mod_t* mod, hawk_t* hawk, const hawk_ooch_t* name, hawk_m
 
 static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	mod_ctx_t* mctx = (mod_ctx_t*)mod->ctx;
-	rtx_data_t rd, * rdp;
-	hawk_rbt_pair_t* pair;
+	rtx_data_t* rdp;
 
-	HAWK_MEMSET (&rd, 0, HAWK_SIZEOF(rd));
-	pair = hawk_rbt_insert(mctx->rtxtab, &rtx, HAWK_SIZEOF(rtx), &rd, HAWK_SIZEOF(rd));
-	if (HAWK_UNLIKELY(!pair)) return -1;
+	rdp = (rtx_data_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*rdp));
+	if (HAWK_UNLIKELY(!rdp)) return -1;
+
+	/* keep the data in rtx to run multiple runtime contexts at the same time */
+	if (hawk_rtx_setmodinst(rtx, mod, rdp) <= -1)
+	{
+		hawk_rtx_freemem (rtx, rdp);
+		return -1;
+	}
 
-	rdp = (rtx_data_t*)HAWK_RBT_VPTR(pair);
 	__init_sys_list (rtx, &rdp->sys_list);
 
 	rdp->pack.ptr = rdp->pack.__static_buf;
@@ -6340,17 +6337,12 @@ static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 	for (each pid for rtx) waitpid (pid, HAWK_NULL, 0);
 	*/
 
-	mod_ctx_t* mctx = (mod_ctx_t*)mod->ctx;
-	hawk_rbt_pair_t* pair;
+	rtx_data_t* rdp;
 
 	/* garbage clean-up */
-	pair = hawk_rbt_search(mctx->rtxtab, &rtx, HAWK_SIZEOF(rtx));
-	if (pair)
+	rdp = (rtx_data_t*)hawk_rtx_getmodinst(rtx, mod);
+	if (rdp)
 	{
-		rtx_data_t* rdp;
-
-		rdp = (rtx_data_t*)HAWK_RBT_VPTR(pair);
-
 		__fini_log (rtx, rdp);
 
 		if (rdp->pack.ptr != rdp->pack.__static_buf) hawk_rtx_freemem (rtx, rdp->pack.ptr);
@@ -6364,41 +6356,23 @@ static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 
 		__fini_sys_list (rtx, &rdp->sys_list);
 
-		hawk_rbt_delete (mctx->rtxtab, &rtx, HAWK_SIZEOF(rtx));
+		hawk_rtx_setmodinst (rtx, mod, HAWK_NULL);
+		hawk_rtx_freemem (rtx, rdp);
 	}
 }
 
 static void unload (hawk_mod_t* mod, hawk_t* hawk)
 {
-	mod_ctx_t* mctx = (mod_ctx_t*)mod->ctx;
-
-	HAWK_ASSERT (HAWK_RBT_SIZE(mctx->rtxtab) == 0);
-	hawk_rbt_close (mctx->rtxtab);
-
-	hawk_freemem (hawk, mctx);
+	/* nothing to do */
 }
 
 int hawk_mod_sys (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
 
-	mod->ctx = hawk_callocmem(hawk, HAWK_SIZEOF(mod_ctx_t));
-	if (HAWK_UNLIKELY(!mod->ctx)) return -1;
-
-	rbt = hawk_rbt_open(hawk_getgem(hawk), 0, 1, 1);
-	if (HAWK_UNLIKELY(!rbt))
-	{
-		hawk_freemem (hawk, mod->ctx);
-		return -1;
-	}
-	hawk_rbt_setstyle (rbt, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_COPIERS));
-
-	((mod_ctx_t*)mod->ctx)->rtxtab = rbt;
 	return 0;
 }
@@ -0,0 +1,702 @@
+/*
+    Copyright (c) 2006-2020 Chung, Hyung-Hwan. All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <hawk-oht.h>
+#include "hawk-prv.h"
+
+#define pair_t          hawk_oht_pair_t
+#define slot_t          hawk_oht_slot_t
+#define copier_t        hawk_oht_copier_t
+#define freeer_t        hawk_oht_freeer_t
+#define hasher_t        hawk_oht_hasher_t
+#define comper_t        hawk_oht_comper_t
+#define keeper_t        hawk_oht_keeper_t
+#define sizer_t         hawk_oht_sizer_t
+#define walker_t        hawk_oht_walker_t
+#define cbserter_t      hawk_oht_cbserter_t
+#define style_t         hawk_oht_style_t
+#define style_kind_t    hawk_oht_style_kind_t
+
+#define KPTR(p)  HAWK_OHT_KPTR(p)
+#define KLEN(p)  HAWK_OHT_KLEN(p)
+#define VPTR(p)  HAWK_OHT_VPTR(p)
+#define VLEN(p)  HAWK_OHT_VLEN(p)
+
+#define KTOB(oht,len) ((len)*(oht)->scale[HAWK_OHT_KEY])
+#define VTOB(oht,len) ((len)*(oht)->scale[HAWK_OHT_VAL])
+
+#define MIN_CAPA 8
+
+/* the hash value returned by the hasher is multiplied by the golden ratio
+ * and the top bits are taken as the home slot index so that a weak hasher
+ * doesn't cluster pairs in the slot array */
+#if (HAWK_SIZEOF_OOW_T >= 8)
+#	define HOME(oht,hv) ((hawk_oow_t)((hv) * (hawk_oow_t)0x9E3779B97F4A7C15ull) >> (oht)->shift)
+#else
+#	define HOME(oht,hv) ((hawk_oow_t)((hv) * (hawk_oow_t)0x9E3779B9ul) >> (oht)->shift)
+#endif
+
+/* distance of the slot at the given index from the home slot of its pair */
+#define DIST(oht,idx) (((idx) - HOME(oht, (oht)->slot[idx].hash)) & ((oht)->capa - 1))
+
+HAWK_INLINE pair_t* hawk_oht_allocpair (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen)
+{
+	pair_t* n;
+	copier_t kcop, vcop;
+	hawk_oow_t as;
+
+	kcop = oht->style->copier[HAWK_OHT_KEY];
+	vcop = oht->style->copier[HAWK_OHT_VAL];
+
+	as = HAWK_SIZEOF(pair_t);
+	if (kcop == HAWK_OHT_COPIER_INLINE) as += HAWK_ALIGN_POW2(KTOB(oht,klen), HAWK_SIZEOF_VOID_P);
+	if (vcop == HAWK_OHT_COPIER_INLINE) as += VTOB(oht,vlen);
+
+	n = (pair_t*)hawk_gem_allocmem(oht->gem, as);
+	if (HAWK_UNLIKELY(!n)) return HAWK_NULL;
+
+	KLEN(n) = klen;
+	if (kcop == HAWK_OHT_COPIER_SIMPLE)
+	{
+		KPTR(n) = kptr;
+	}
+	else if (kcop == HAWK_OHT_COPIER_INLINE)
+	{
+		KPTR(n) = n + 1;
+		/* if kptr is HAWK_NULL, the inline copier does not fill
+		 * the actual key area */
+		if (kptr) HAWK_MEMCPY (KPTR(n), kptr, KTOB(oht,klen));
+	}
+	else
+	{
+		KPTR(n) = kcop(oht, kptr, klen);
+		if (KPTR(n) == HAWK_NULL)
+		{
+			hawk_gem_freemem (oht->gem, n);
+			return HAWK_NULL;
+		}
+	}
+
+	VLEN(n) = vlen;
+	if (vcop == HAWK_OHT_COPIER_SIMPLE)
+	{
+		VPTR(n) = vptr;
+	}
+	else if (vcop == HAWK_OHT_COPIER_INLINE)
+	{
+		VPTR(n) = n + 1;
+		if (kcop == HAWK_OHT_COPIER_INLINE)
+			VPTR(n) = (hawk_uint8_t*)VPTR(n) + HAWK_ALIGN_POW2(KTOB(oht,klen), HAWK_SIZEOF_VOID_P);
+		/* if vptr is HAWK_NULL, the inline copier does not fill
+		 * the actual value area */
+		if (vptr) HAWK_MEMCPY (VPTR(n), vptr, VTOB(oht,vlen));
+	}
+	else
+	{
+		VPTR(n) = vcop(oht, vptr, vlen);
+		if (VPTR(n) == HAWK_NULL)
+		{
+			if (oht->style->freeer[HAWK_OHT_KEY] != HAWK_NULL)
+				oht->style->freeer[HAWK_OHT_KEY] (oht, KPTR(n), KLEN(n));
+			hawk_gem_freemem (oht->gem, n);
+			return HAWK_NULL;
+		}
+	}
+
+	return n;
+}
+
+HAWK_INLINE void hawk_oht_freepair (hawk_oht_t* oht, pair_t* pair)
+{
+	if (oht->style->freeer[HAWK_OHT_KEY] != HAWK_NULL)
+		oht->style->freeer[HAWK_OHT_KEY] (oht, KPTR(pair), KLEN(pair));
+	if (oht->style->freeer[HAWK_OHT_VAL] != HAWK_NULL)
+		oht->style->freeer[HAWK_OHT_VAL] (oht, VPTR(pair), VLEN(pair));
+	hawk_gem_freemem (oht->gem, pair);
+}
+
+static HAWK_INLINE pair_t* change_pair_val (hawk_oht_t* oht, pair_t* pair, void* vptr, hawk_oow_t vlen)
+{
+	if (VPTR(pair) == vptr && VLEN(pair) == vlen)
+	{
+		/* if the old value and the new value are the same,
+		 * it just calls the handler for this condition.
+		 * No value replacement occurs. */
+		if (oht->style->keeper != HAWK_NULL)
+		{
+			oht->style->keeper (oht, vptr, vlen);
+		}
+	}
+	else
+	{
+		copier_t vcop = oht->style->copier[HAWK_OHT_VAL];
+		void* ovptr = VPTR(pair);
+		hawk_oow_t ovlen = VLEN(pair);
+
+		/* place the new value according to the copier */
+		if (vcop == HAWK_OHT_COPIER_SIMPLE)
+		{
+			VPTR(pair) = vptr;
+			VLEN(pair) = vlen;
+		}
+		else if (vcop == HAWK_OHT_COPIER_INLINE)
+		{
+			if (ovlen == vlen)
+			{
+				if (vptr) HAWK_MEMCPY (VPTR(pair), vptr, VTOB(oht,vlen));
+			}
+			else
+			{
+				/* need to reconstruct the pair */
+				pair_t* p = hawk_oht_allocpair(oht, KPTR(pair), KLEN(pair), vptr, vlen);
+				if (HAWK_UNLIKELY(!p)) return HAWK_NULL;
+				hawk_oht_freepair (oht, pair);
+				return p;
+			}
+		}
+		else
+		{
+			void* nvptr = vcop(oht, vptr, vlen);
+			if (HAWK_UNLIKELY(!nvptr)) return HAWK_NULL;
+			VPTR(pair) = nvptr;
+			VLEN(pair) = vlen;
+		}
+
+		/* free up the old value */
+		if (oht->style->freeer[HAWK_OHT_VAL] != HAWK_NULL)
+		{
+			oht->style->freeer[HAWK_OHT_VAL] (oht, ovptr, ovlen);
+		}
+	}
+
+	return pair;
+}
+
+static style_t style[] =
+{
+	/* == HAWK_OHT_STYLE_DEFAULT == */
+	{
+		{
+			HAWK_OHT_COPIER_DEFAULT,
+			HAWK_OHT_COPIER_DEFAULT
+		},
+		{
+			HAWK_OHT_FREEER_DEFAULT,
+			HAWK_OHT_FREEER_DEFAULT
+		},
+		HAWK_OHT_COMPER_DEFAULT,
+		HAWK_OHT_KEEPER_DEFAULT,
+		HAWK_OHT_SIZER_DEFAULT,
+		HAWK_OHT_HASHER_DEFAULT
+	},
+
+	/* == HAWK_OHT_STYLE_INLINE_COPIERS == */
+	{
+		{
+			HAWK_OHT_COPIER_INLINE,
+			HAWK_OHT_COPIER_INLINE
+		},
+		{
+			HAWK_OHT_FREEER_DEFAULT,
+			HAWK_OHT_FREEER_DEFAULT
+		},
+		HAWK_OHT_COMPER_DEFAULT,
+		HAWK_OHT_KEEPER_DEFAULT,
+		HAWK_OHT_SIZER_DEFAULT,
+		HAWK_OHT_HASHER_DEFAULT
+	},
+
+	/* == HAWK_OHT_STYLE_INLINE_KEY_COPIER == */
+	{
+		{
+			HAWK_OHT_COPIER_INLINE,
+			HAWK_OHT_COPIER_DEFAULT
+		},
+		{
+			HAWK_OHT_FREEER_DEFAULT,
+			HAWK_OHT_FREEER_DEFAULT
+		},
+		HAWK_OHT_COMPER_DEFAULT,
+		HAWK_OHT_KEEPER_DEFAULT,
+		HAWK_OHT_SIZER_DEFAULT,
+		HAWK_OHT_HASHER_DEFAULT
+	},
+
+	/* == HAWK_OHT_STYLE_INLINE_VALUE_COPIER == */
+	{
+		{
+			HAWK_OHT_COPIER_DEFAULT,
+			HAWK_OHT_COPIER_INLINE
+		},
+		{
+			HAWK_OHT_FREEER_DEFAULT,
+			HAWK_OHT_FREEER_DEFAULT
+		},
+		HAWK_OHT_COMPER_DEFAULT,
+		HAWK_OHT_KEEPER_DEFAULT,
+		HAWK_OHT_SIZER_DEFAULT,
+		HAWK_OHT_HASHER_DEFAULT
+	}
+};
+
+const style_t* hawk_get_oht_style (style_kind_t kind)
+{
+	return &style[kind];
+}
+
+hawk_oht_t* hawk_oht_open (hawk_gem_t* gem, hawk_oow_t xtnsize, hawk_oow_t capa, int factor, int kscale, int vscale)
+{
+	hawk_oht_t* oht;
+
+	oht = (hawk_oht_t*)hawk_gem_allocmem(gem, HAWK_SIZEOF(hawk_oht_t) + xtnsize);
+	if (HAWK_UNLIKELY(!oht)) return HAWK_NULL;
+
+	if (hawk_oht_init(oht, gem, capa, factor, kscale, vscale) <= -1)
+	{
+		hawk_gem_freemem (gem, oht);
+		return HAWK_NULL;
+	}
+
+	HAWK_MEMSET (oht + 1, 0, xtnsize);
+	return oht;
+}
+
+void hawk_oht_close (hawk_oht_t* oht)
+{
+	hawk_oht_fini (oht);
+	hawk_gem_freemem (oht->gem, oht);
+}
+
+int hawk_oht_init (hawk_oht_t* oht, hawk_gem_t* gem, hawk_oow_t capa, int factor, int kscale, int vscale)
+{
+	HAWK_ASSERT (factor >= 0 && factor <= 100);
+	HAWK_ASSERT (kscale >= 0 && kscale <= HAWK_TYPE_MAX(hawk_uint8_t));
+	HAWK_ASSERT (vscale >= 0 && vscale <= HAWK_TYPE_MAX(hawk_uint8_t));
+
+	/* some initial adjustment. linear probing degrades sharply
+	 * when the table is nearly full */
+	if (factor <= 0 || factor > 90) factor = 90;
+
+	/* do not zero out the extension */
+	HAWK_MEMSET (oht, 0, HAWK_SIZEOF(*oht));
+	oht->gem = gem;
+
+	oht->factor = factor;
+	oht->scale[HAWK_OHT_KEY] = (kscale < 1)? 1: kscale;
+	oht->scale[HAWK_OHT_VAL] = (vscale < 1)? 1: vscale;
+
+	/* the slot array is not allocated until the first insertion. remember
+	 * the initial capacity in the threshold field till then */
+	oht->size = 0;
+	oht->capa = 0;
+	oht->threshold = (capa < MIN_CAPA)? MIN_CAPA: capa;
+	oht->slot = HAWK_NULL;
+
+	oht->style = &style[0];
+	return 0;
+}
+
+void hawk_oht_fini (hawk_oht_t* oht)
+{
+	hawk_oht_clear (oht);
+	if (oht->slot)
+	{
+		hawk_gem_freemem (oht->gem, oht->slot);
+		oht->slot = HAWK_NULL;
+	}
+}
+
+const style_t* hawk_oht_getstyle (const hawk_oht_t* oht)
+{
+	return oht->style;
+}
+
+void hawk_oht_setstyle (hawk_oht_t* oht, const style_t* style)
+{
+	HAWK_ASSERT (style != HAWK_NULL);
+	oht->style = style;
+}
+
+hawk_oow_t hawk_oht_getsize (const hawk_oht_t* oht)
+{
+	return oht->size;
+}
+
+hawk_oow_t hawk_oht_getcapa (const hawk_oht_t* oht)
+{
+	return oht->capa;
+}
+
+/* returns the index of the slot holding the matching key or
+ * the capacity if no matching key is found */
+static HAWK_INLINE hawk_oow_t find_slot (const hawk_oht_t* oht, hawk_oow_t hv, const void* kptr, hawk_oow_t klen)
+{
+	hawk_oow_t idx, dist, mask;
+
+	if (oht->size <= 0) return oht->capa;
+
+	mask = oht->capa - 1;
+	idx = HOME(oht, hv);
+	dist = 0;
+
+	while (oht->slot[idx].pair)
+	{
+		/* a pair farther away from its home than the key being searched
+		 * would have been displaced by the key. the key is not in the table */
+		if (DIST(oht, idx) < dist) break;
+
+		if (oht->slot[idx].hash == hv &&
+		    oht->style->comper(oht, KPTR(oht->slot[idx].pair), KLEN(oht->slot[idx].pair), kptr, klen) == 0) return idx;
+
+		idx = (idx + 1) & mask;
+		dist++;
+	}
+
+	return oht->capa;
+}
+
+/* places a pair known to be absent from the table */
+static HAWK_INLINE void place_pair (hawk_oht_t* oht, hawk_oow_t hv, pair_t* pair)
+{
+	hawk_oow_t idx, dist, mask;
+
+	mask = oht->capa - 1;
+	idx = HOME(oht, hv);
+	dist = 0;
+
+	while (oht->slot[idx].pair)
+	{
+		hawk_oow_t d = DIST(oht, idx);
+		if (d < dist)
+		{
+			/* robin hood - take the slot from the pair closer to
+			 * its home and carry that pair forward instead */
+			hawk_oow_t thv = oht->slot[idx].hash;
+			pair_t* tpair = oht->slot[idx].pair;
+			oht->slot[idx].hash = hv;
+			oht->slot[idx].pair = pair;
+			hv = thv;
+			pair = tpair;
+			dist = d;
+		}
+
+		idx = (idx + 1) & mask;
+		dist++;
+	}
+
+	oht->slot[idx].hash = hv;
+	oht->slot[idx].pair = pair;
+}
+
+static int reorganize (hawk_oht_t* oht)
+{
+	hawk_oow_t i, new_capa, old_capa, bits;
+	slot_t* new_slot, * old_slot;
+
+	if (oht->capa <= 0)
+	{
+		/* the first allocation. the threshold field holds the initial capacity */
+		new_capa = oht->threshold;
+	}
+	else if (oht->style->sizer)
+	{
+		new_capa = oht->style->sizer(oht, oht->capa + 1);
+		if (new_capa <= oht->capa) new_capa = oht->capa << 1;
+	}
+	else
+	{
+		new_capa = oht->capa << 1;
+	}
+
+	/* round it up to a power of 2 */
+	bits = 0;
+	while (((hawk_oow_t)1 << bits) < new_capa)
+	{
+		if (bits >= HAWK_SIZEOF_OOW_T * 8 - 1) goto nomem;
+		bits++;
+	}
+	if (bits < 3) bits = 3; /* MIN_CAPA */
+	new_capa = (hawk_oow_t)1 << bits;
+	if (new_capa > HAWK_TYPE_MAX(hawk_oow_t) / HAWK_SIZEOF(slot_t)) goto nomem;
+
+	new_slot = (slot_t*)hawk_gem_callocmem(oht->gem, new_capa * HAWK_SIZEOF(slot_t));
+	if (HAWK_UNLIKELY(!new_slot)) return -1;
+
+	old_slot = oht->slot;
+	old_capa = oht->capa;
+
+	oht->slot = new_slot;
+	oht->capa = new_capa;
+	oht->shift = HAWK_SIZEOF_OOW_T * 8 - bits;
+	oht->threshold = new_capa * oht->factor / 100;
+	if (oht->threshold >= new_capa) oht->threshold = new_capa - 1;
+
+	/* the hash values kept in the slots save calling the hasher again */
+	for (i = 0; i < old_capa; i++)
+	{
+		if (old_slot[i].pair) place_pair (oht, old_slot[i].hash, old_slot[i].pair);
+	}
+
+	if (old_slot) hawk_gem_freemem (oht->gem, old_slot);
+	return 0;
+
+nomem:
+	hawk_gem_seterrnum (oht->gem, HAWK_NULL, HAWK_ENOMEM);
+	return -1;
+}
+
+static HAWK_INLINE int ensure_room (hawk_oht_t* oht)
+{
+	if (oht->capa <= 0 || oht->size >= oht->threshold)
+	{
+		if (reorganize(oht) <= -1)
+		{
+			/* carry on without growing as long as there is a free slot
+			 * left. an empty slot terminates probing */
+			if (oht->capa <= 0 || oht->size >= oht->capa - 1) return -1;
+		}
+	}
+	return 0;
+}
+
+pair_t* hawk_oht_search (const hawk_oht_t* oht, const void* kptr, hawk_oow_t klen)
+{
+	hawk_oow_t idx;
+
+	idx = find_slot(oht, oht->style->hasher(oht, kptr, klen), kptr, klen);
+	if (idx < oht->capa) return oht->slot[idx].pair;
+
+	hawk_gem_seterrnum (oht->gem, HAWK_NULL, HAWK_ENOENT);
+	return HAWK_NULL;
+}
+
+/* insert options */
+#define UPSERT 1
+#define UPDATE 2
+#define ENSERT 3
+#define INSERT 4
+
+static HAWK_INLINE pair_t* insert (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen, int opt)
+{
+	pair_t* pair;
+	hawk_oow_t hv, idx;
+
+	hv = oht->style->hasher(oht, kptr, klen);
+	idx = find_slot(oht, hv, kptr, klen);
+	if (idx < oht->capa)
+	{
+		/* found a pair with a matching key */
+		switch (opt)
+		{
+			case UPSERT:
+			case UPDATE:
+				pair = change_pair_val(oht, oht->slot[idx].pair, vptr, vlen);
+				if (HAWK_UNLIKELY(!pair)) return HAWK_NULL; /* error in changing the value */
+				/* the pair may have been reallocated */
+				oht->slot[idx].pair = pair;
+				return pair;
+
+			case ENSERT:
+				/* return existing pair */
+				return oht->slot[idx].pair;
+
+			case INSERT:
+				/* return failure */
+				hawk_gem_seterrnum (oht->gem, HAWK_NULL, HAWK_EEXIST);
+				return HAWK_NULL;
+		}
+	}
+
+	if (opt == UPDATE)
+	{
+		hawk_gem_seterrnum (oht->gem, HAWK_NULL, HAWK_ENOENT);
+		return HAWK_NULL;
+	}
+
+	if (ensure_room(oht) <= -1) return HAWK_NULL;
+
+	pair = hawk_oht_allocpair(oht, kptr, klen, vptr, vlen);
+	if (HAWK_UNLIKELY(!pair)) return HAWK_NULL; /* error */
+
+	place_pair (oht, hv, pair);
+	oht->size++;
+
+	return pair; /* new key added */
+}
+
+pair_t* hawk_oht_upsert (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen)
+{
+	return insert(oht, kptr, klen, vptr, vlen, UPSERT);
+}
+
+pair_t* hawk_oht_ensert (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen)
+{
+	return insert(oht, kptr, klen, vptr, vlen, ENSERT);
+}
+
+pair_t* hawk_oht_insert (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen)
+{
+	return insert(oht, kptr, klen, vptr, vlen, INSERT);
+}
+
+pair_t* hawk_oht_update (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, void* vptr, hawk_oow_t vlen)
+{
+	return insert(oht, kptr, klen, vptr, vlen, UPDATE);
+}
+
+pair_t* hawk_oht_cbsert (hawk_oht_t* oht, void* kptr, hawk_oow_t klen, cbserter_t cbserter, void* ctx)
+{
+	pair_t* pair;
+	hawk_oow_t hv, idx;
+
+	hv = oht->style->hasher(oht, kptr, klen);
+	idx = find_slot(oht, hv, kptr, klen);
+	if (idx < oht->capa)
+	{
+		/* found a pair with a matching key */
+		pair = cbserter(oht, oht->slot[idx].pair, kptr, klen, ctx);
+		if (HAWK_UNLIKELY(!pair)) return HAWK_NULL; /* error returned by the callback function */
+		/* the old pair may have been destroyed and a new pair reallocated */
+		oht->slot[idx].pair = pair;
+		return pair;
+	}
+
+	if (ensure_room(oht) <= -1) return HAWK_NULL;
+
+	pair = cbserter(oht, HAWK_NULL, kptr, klen, ctx);
+	if (HAWK_UNLIKELY(!pair)) return HAWK_NULL; /* error */
+
+	place_pair (oht, hv, pair);
+	oht->size++;
+
+	return pair; /* new key added */
+}
+
+int hawk_oht_delete (hawk_oht_t* oht, const void* kptr, hawk_oow_t klen)
+{
+	hawk_oow_t idx, next, mask;
+
+	idx = find_slot(oht, oht->style->hasher(oht, kptr, klen), kptr, klen);
+	if (idx >= oht->capa)
+	{
+		hawk_gem_seterrnum (oht->gem, HAWK_NULL, HAWK_ENOENT);
+		return -1;
+	}
+
+	hawk_oht_freepair (oht, oht->slot[idx].pair);
+	oht->size--;
+
+	/* shift the following pairs back by one slot until an empty slot
+	 * or a pair at its home is met. no tombstone is needed */
+	mask = oht->capa - 1;
+	next = (idx + 1) & mask;
+	while (oht->slot[next].pair && DIST(oht, next) > 0)
+	{
+		oht->slot[idx] = oht->slot[next];
+		idx = next;
+		next = (next + 1) & mask;
+	}
+	oht->slot[idx].pair = HAWK_NULL;
+
+	return 0;
+}
+
+void hawk_oht_clear (hawk_oht_t* oht)
+{
+	hawk_oow_t i;
+
+	for (i = 0; i < oht->capa && oht->size > 0; i++)
+	{
+		if (oht->slot[i].pair)
+		{
+			hawk_oht_freepair (oht, oht->slot[i].pair);
+			oht->slot[i].pair = HAWK_NULL;
+			oht->size--;
+		}
+	}
+}
+
+void hawk_oht_walk (hawk_oht_t* oht, walker_t walker, void* ctx)
+{
+	hawk_oow_t i;
+
+	for (i = 0; i < oht->capa; i++)
+	{
+		if (oht->slot[i].pair && walker(oht, oht->slot[i].pair, ctx) == HAWK_OHT_WALK_STOP) return;
+	}
+}
+
+void hawk_init_oht_itr (hawk_oht_itr_t* itr)
+{
+	itr->pair = HAWK_NULL;
+	itr->slotno = 0;
+}
+
+pair_t* hawk_oht_getfirstpair (hawk_oht_t* oht, hawk_oht_itr_t* itr)
+{
+	hawk_oow_t i;
+
+	for (i = 0; i < oht->capa; i++)
+	{
+		if (oht->slot[i].pair)
+		{
+			itr->slotno = i;
+			itr->pair = oht->slot[i].pair;
+			return itr->pair;
+		}
+	}
+
+	return HAWK_NULL;
+}
+
+pair_t* hawk_oht_getnextpair (hawk_oht_t* oht, hawk_oht_itr_t* itr)
+{
+	hawk_oow_t i;
+
+	for (i = itr->slotno + 1; i < oht->capa; i++)
+	{
+		if (oht->slot[i].pair)
+		{
+			itr->slotno = i;
+			itr->pair = oht->slot[i].pair;
+			return itr->pair;
+		}
+	}
+
+	return HAWK_NULL;
+}
+
+hawk_oow_t hawk_oht_dflhash (const hawk_oht_t* oht, const void* kptr, hawk_oow_t klen)
+{
+	hawk_oow_t h;
+	HAWK_HASH_BYTES (h, kptr, KTOB(oht,klen));
+	return h;
+}
+
+int hawk_oht_dflcomp (const hawk_oht_t* oht, const void* kptr1, hawk_oow_t klen1, const void* kptr2, hawk_oow_t klen2)
+{
+	if (klen1 == klen2) return HAWK_MEMCMP(kptr1, kptr2, KTOB(oht,klen1));
+	/* it just returns 1 to indicate that they are different. */
+	return 1;
+}
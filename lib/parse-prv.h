@@ -94,6 +94,21 @@ int hawk_initgbls (
 	hawk_t* hawk
 );
 
+/* looks up a module symbol for a runtime context. it initializes the
+ * module for the runtime context if the module is loaded for the first
+ * time and reports a failure through the runtime context. referenced
+ * by mod-hawk.c */
+HAWK_EXPORT hawk_mod_t* hawk_rtx_querymodulewithname (
+	hawk_rtx_t*     rtx,
+	hawk_ooch_t*    name,
+	hawk_mod_sym_t* sym
+);
+
+/* enable or disable the intrinsic global variables by the trait option */
+void hawk_adjustgbls (
+	hawk_t* hawk
+);
+
 hawk_ooch_t* hawk_addsionamewithuchars (
 	hawk_t*            hawk,
 	const hawk_uch_t* ptr,
@@ -198,8 +198,8 @@ struct binmap_t
 
 static int parse_progunit (hawk_t* hawk);
 static hawk_t* collect_globals (hawk_t* hawk);
-static void adjust_static_globals (hawk_t* hawk);
 static hawk_oow_t find_global (hawk_t* hawk, const hawk_oocs_t* name);
+static int parse_pragma_reduce (hawk_t* hawk);
 static hawk_t* collect_locals (hawk_t* hawk, hawk_oow_t nlcls, int istop);
 
 static hawk_nde_t* parse_function (hawk_t* hawk);
@@ -249,6 +249,7 @@ static int skip_spaces (hawk_t* hawk);
 static int skip_comment (hawk_t* hawk);
 static int classify_ident (hawk_t* hawk, const hawk_oocs_t* name);
 
+static int optimize (hawk_t* hawk);
 static int deparse (hawk_t* hawk);
 static hawk_htb_walk_t deparse_func (hawk_htb_t* map, hawk_htb_pair_t* pair, void* arg);
 static int put_char (hawk_t* hawk, hawk_ooch_t c);
@@ -464,6 +465,32 @@ static HAWK_INLINE int is_var (hawk_nde_t* nde)
 	       nde->type == HAWK_NDE_NAMEDIDX;
 }
 
+static int record_source_digest (hawk_t* hawk, hawk_sio_arg_t* arg)
+{
+	hawk_srcdgst_t* dgst;
+
+	if (hawk->parse.srcs.count >= hawk->parse.srcs.capa)
+	{
+		hawk_srcdgst_t* tmp;
+		hawk_oow_t newcapa;
+
+		newcapa = hawk->parse.srcs.capa + 16;
+		tmp = (hawk_srcdgst_t*)hawk_reallocmem(hawk, hawk->parse.srcs.ptr, newcapa * HAWK_SIZEOF(*tmp));
+		if (HAWK_UNLIKELY(!tmp)) return -1;
+
+		hawk->parse.srcs.ptr = tmp;
+		hawk->parse.srcs.capa = newcapa;
+	}
+
+	dgst = &hawk->parse.srcs.ptr[hawk->parse.srcs.count++];
+	/* the top-level stream is identified by the caller of hawk_parse().
+	 * an included stream is identified by the path resolved */
+	dgst->path = (arg == &hawk->sio.arg)? HAWK_NULL: (arg->path? arg->path: arg->name);
+	dgst->nchars = arg->nchars;
+	dgst->digest = arg->digest;
+	return 0;
+}
+
 static int get_char (hawk_t* hawk)
 {
 	hawk_ooi_t n;
@@ -485,6 +512,12 @@ static int get_char (hawk_t* hawk)
 
 		if (n == 0)
 		{
+			if (!hawk->sio.inp->digested)
+			{
+				if (record_source_digest(hawk, hawk->sio.inp) <= -1) return -1;
+				hawk->sio.inp->digested = 1;
+			}
+
 			hawk->sio.inp->last.c = HAWK_OOCI_EOF;
 			hawk->sio.inp->last.line = hawk->sio.inp->line;
 			hawk->sio.inp->last.colm = hawk->sio.inp->colm;
@@ -495,6 +528,9 @@ static int get_char (hawk_t* hawk)
 
 		hawk->sio.inp->b.pos = 0;
 		hawk->sio.inp->b.len = n;
+
+		HAWK_HASH_MORE_VPTL (hawk->sio.inp->digest, hawk->sio.inp->b.buf, n, const hawk_ooch_t);
+		hawk->sio.inp->nchars += n;
 	}
 
 	if (hawk->sio.inp->last.c == HAWK_T('\n'))
@@ -551,7 +587,7 @@ static int parse (hawk_t* hawk)
 		return -1;
 	}
 
-	adjust_static_globals (hawk);
+	hawk_adjustgbls (hawk);
 
 	/* get the first character and the first token */
 	if (get_char(hawk) <= -1 || get_token(hawk)) goto oops;
@@ -719,6 +755,13 @@ int hawk_parse (hawk_t* hawk, hawk_sio_cbs_t* sio)
 		return -1;
 	}
 
+	if (hawk->frozen)
+	{
+		/* hawk_clear() must be called after closing all runtime contexts */
+		hawk_seterrnum (hawk, HAWK_NULL, HAWK_EPERM);
+		return -1;
+	}
+
 	HAWK_ASSERT (hawk->parse.depth.loop == 0);
 	HAWK_ASSERT (hawk->parse.depth.expr == 0);
 
@@ -735,9 +778,12 @@ int hawk_parse (hawk_t* hawk, hawk_sio_cbs_t* sio)
 	hawk->sio.arg.line = 1;
 	hawk->sio.arg.colm = 1;
 	hawk->sio.arg.pragma_trait = 0;
+	hawk->sio.arg.digest = HAWK_HASH_INIT;
 	hawk->sio.inp = &hawk->sio.arg;
 
 	n = parse(hawk);
+	if (n == 0 && (hawk->opt.trait & HAWK_OPTIMIZE)) n = optimize(hawk);
+	if (n == 0 && (hawk->parse.pragma.trait & HAWK_BYTECODE)) n = hawk_compilept(hawk);
 	if (n == 0  && hawk->sio.outf != HAWK_NULL) n = deparse(hawk);
 
 	HAWK_ASSERT (hawk->parse.depth.loop == 0);
@@ -852,6 +898,7 @@ static int begin_include (hawk_t* hawk, int once)
 	arg->name = sio_name;
 	arg->line = 1;
 	arg->colm = 1;
+	arg->digest = HAWK_HASH_INIT;
 
 	/* let the argument's prev field point to the current */
 	arg->prev = hawk->sio.inp;
@@ -1042,7 +1089,8 @@ static int parse_progunit (hawk_t* hawk)
 		/* NOTE: trait = is an intended assignment */
 		else if (((trait = HAWK_STRIPRECSPC) && hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("striprecspc"), 0) == 0) ||
 		         ((trait = HAWK_STRIPSTRSPC) && hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("stripstrspc"), 0) == 0) ||
-		         ((trait = HAWK_NUMSTRDETECT) && hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("numstrdetect"), 0) == 0))
+		         ((trait = HAWK_NUMSTRDETECT) && hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("numstrdetect"), 0) == 0) ||
+		         ((trait = HAWK_BYTECODE) && hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("bytecode"), 0) == 0))
 		{
 			/* @pragma striprecspc on
 			 * @pragma striprecspc off
@@ -1050,6 +1098,8 @@ static int parse_progunit (hawk_t* hawk)
 			 * @pragma stripstrspc off
 			 * @pragma numstrdetect on
 			 * @pragma numstrdetect off
+			 * @pragma bytecode on
+			 * @pragma bytecode off
 			 *
 			 * Take note the global STRIPRECSPC is available for context based change.
 			 * STRIPRECSPC takes precedence over this pragma.
@@ -1102,6 +1152,12 @@ static int parse_progunit (hawk_t* hawk)
 			/* take the specified value if it's greater than the existing value */
 			if (sl > hawk->parse.pragma.rtx_stack_limit) hawk->parse.pragma.rtx_stack_limit = sl;
 		}
+		else if (hawk_comp_oochars_oocstr(name.ptr, name.len, HAWK_T("reduce"), 0) == 0)
+		{
+			/* @pragma reduce total sum
+			 * @pragma reduce seen union */
+			if (parse_pragma_reduce(hawk) <= -1) return -1;
+		}
 		else
 		{
 			hawk_seterrfmt (hawk, &hawk->ptok.loc, HAWK_EIDENT, HAWK_T("unknown @pragma identifier - %.*js"), name.len, name.ptr);
@@ -1910,7 +1966,7 @@ int hawk_initgbls (hawk_t* hawk)
 	return 0;
 }
 
-static void adjust_static_globals (hawk_t* hawk)
+void hawk_adjustgbls (hawk_t* hawk)
 {
 	int id;
 
@@ -2030,6 +2086,101 @@ static int add_global (hawk_t* hawk, const hawk_oocs_t* name, hawk_loc_t* xloc,
 	return (int)ngbls;
 }
 
+static int parse_pragma_reduce (hawk_t* hawk)
+{
+	static struct
+	{
+		const hawk_ooch_t* name;
+		hawk_reduce_op_t op;
+	} optab[] =
+	{
+		{ HAWK_T("sum"),    HAWK_REDUCE_SUM    },
+		{ HAWK_T("min"),    HAWK_REDUCE_MIN    },
+		{ HAWK_T("max"),    HAWK_REDUCE_MAX    },
+		{ HAWK_T("concat"), HAWK_REDUCE_CONCAT },
+		{ HAWK_T("union"),  HAWK_REDUCE_UNION  }
+	};
+
+	hawk_oocs_t name;
+	hawk_oow_t gbl, i;
+
+	if (get_token(hawk) <= -1) return -1;
+	if (!MATCH(hawk, TOK_IDENT))
+	{
+		hawk_seterrfmt (hawk, &hawk->tok.loc, HAWK_EIDENT, HAWK_T("variable name expected for 'reduce'"));
+		return -1;
+	}
+
+	name.len = HAWK_OOECS_LEN(hawk->tok.name);
+	name.ptr = HAWK_OOECS_PTR(hawk->tok.name);
+
+	/* the variable becomes a global variable unless it is one already.
+	 * it must not have been used as a named variable before */
+	gbl = find_global(hawk, &name);
+	if (gbl == HAWK_ARR_NIL)
+	{
+		int n;
+
+		if (hawk_htb_search(hawk->parse.named, name.ptr, name.len) != HAWK_NULL)
+		{
+			hawk_seterrfmt (hawk, &hawk->tok.loc, HAWK_EVARRED, HAWK_T("variable '%.*js' used before '@pragma reduce'"), name.len, name.ptr);
+			return -1;
+		}
+
+		n = add_global(hawk, &name, &hawk->tok.loc, 0);
+		if (n <= -1) return -1;
+		gbl = n;
+	}
+	else if (gbl < hawk->tree.ngbls_base)
+	{
+		hawk_seterrfmt (hawk, &hawk->tok.loc, HAWK_EGBLRED, HAWK_T("intrinsic global variable '%.*js' not reducible"), name.len, name.ptr);
+		return -1;
+	}
+
+	for (i = 0; i < hawk->tree.reduce.count; i++)
+	{
+		if (hawk->tree.reduce.ptr[i].gbl == gbl)
+		{
+			hawk_seterrfmt (hawk, &hawk->tok.loc, HAWK_EEXIST, HAWK_T("reduction for '%.*js' already set"), name.len, name.ptr);
+			return -1;
+		}
+	}
+
+	if (get_token(hawk) <= -1) return -1;
+	if (MATCH(hawk, TOK_IDENT))
+	{
+		for (i = 0; i < HAWK_COUNTOF(optab); i++)
+		{
+			if (hawk_comp_oochars_oocstr(HAWK_OOECS_PTR(hawk->tok.name), HAWK_OOECS_LEN(hawk->tok.name), optab[i].name, 0) == 0) break;
+		}
+	}
+	else i = HAWK_COUNTOF(optab);
+
+	if (i >= HAWK_COUNTOF(optab))
+	{
+		hawk_seterrfmt (hawk, &hawk->tok.loc, HAWK_EIDENT, HAWK_T("'sum', 'min', 'max', 'concat' or 'union' expected for 'reduce'"));
+		return -1;
+	}
+
+	if (hawk->tree.reduce.count >= hawk->tree.reduce.capa)
+	{
+		hawk_reduce_t* tmp;
+		hawk_oow_t newcapa;
+
+		newcapa = HAWK_ALIGN_POW2(hawk->tree.reduce.count + 1, 8);
+		tmp = (hawk_reduce_t*)hawk_reallocmem(hawk, hawk->tree.reduce.ptr, HAWK_SIZEOF(*tmp) * newcapa);
+		if (HAWK_UNLIKELY(!tmp)) return -1;
+
+		hawk->tree.reduce.ptr = tmp;
+		hawk->tree.reduce.capa = newcapa;
+	}
+
+	hawk->tree.reduce.ptr[hawk->tree.reduce.count].gbl = gbl;
+	hawk->tree.reduce.ptr[hawk->tree.reduce.count].op = optab[i].op;
+	hawk->tree.reduce.count++;
+	return 0;
+}
+
 int hawk_addgblwithbcstr (hawk_t* hawk, const hawk_bch_t* name)
 {
 	int n;
@@ -2475,9 +2626,9 @@ static hawk_nde_t* parse_if (hawk_t* hawk, const hawk_loc_t* xloc)
 		goto oops;
 	}
 
-/* TODO: optimization. if you know 'test' evaluates to true or false,
- *       you can drop the 'if' statement and take either the 'then_part'
- *       or 'else_part'. */
+/* NOTE: the 'if' statement whose 'test' is known to be true or false
+ *       is replaced by either 'then_part' or 'else_part' in optimize()
+ *       when HAWK_OPTIMIZE is set. */
 
 	if (get_token(hawk) <= -1) goto oops;
 
@@ -3661,6 +3812,13 @@ static int fold_constants_for_binop (
 
 	if (left->type == HAWK_NDE_INT && right->type == HAWK_NDE_INT)
 	{
+		if ((opcode == HAWK_BINOP_DIV || opcode == HAWK_BINOP_IDIV || opcode == HAWK_BINOP_MOD) &&
+		    ((hawk_nde_int_t*)left)->val == HAWK_TYPE_MIN(hawk_int_t) && ((hawk_nde_int_t*)right)->val == -1)
+		{
+			/* the result overflows. leave it to the run-time */
+			return -1;
+		}
+
 		fold = HAWK_NDE_INT;
 		switch (opcode)
 		{
@@ -3707,7 +3865,15 @@ static int fold_constants_for_binop (
 				break;
 
 			case HAWK_BINOP_MOD:
-				folded->l = INT_BINOP_INT(left,%,right);
+				if (((hawk_nde_int_t*)right)->val == 0)
+				{
+					hawk_seterrnum (hawk, HAWK_NULL, HAWK_EDIVBY0);
+					fold = -2; /* error */
+				}
+				else
+				{
+					folded->l = INT_BINOP_INT(left,%,right);
+				}
 				break;
 
 			default:
@@ -4326,7 +4492,9 @@ static hawk_nde_t* parse_unary (hawk_t* hawk, const hawk_loc_t* xloc)
 				break;
 
 			case HAWK_UNROP_MINUS:
-				folded.l = -((hawk_nde_int_t*)left)->val;
+				/* negating the minimum overflows. leave it to the run-time */
+				if (((hawk_nde_int_t*)left)->val == HAWK_TYPE_MIN(hawk_int_t)) fold = -1;
+				else folded.l = -((hawk_nde_int_t*)left)->val;
 				break;
 
 			case HAWK_UNROP_LNOT:
@@ -4897,6 +5065,15 @@ static hawk_nde_t* parse_primary_positional (hawk_t* hawk, const hawk_loc_t* xlo
 	nde->val = parse_primary(hawk, &ploc);
 	if (HAWK_UNLIKELY(!nde->val)) goto oops;
 
+	/* record the highest field index for the runtime to split
+	 * a record only as far as needed */
+	if (nde->val->type == HAWK_NDE_INT && ((hawk_nde_int_t*)nde->val)->val >= 0)
+	{
+		if ((hawk_oow_t)((hawk_nde_int_t*)nde->val)->val > hawk->tree.maxfld)
+			hawk->tree.maxfld = (hawk_oow_t)((hawk_nde_int_t*)nde->val)->val;
+	}
+	else hawk->tree.dynfld = 1;
+
 	return (hawk_nde_t*)nde;
 
 oops:
@@ -5572,6 +5749,7 @@ static hawk_nde_t* parse_primary_ident_noseg (hawk_t* hawk, const hawk_loc_t* xl
 	{
 		/* global variable */
 		nde = parse_variable(hawk, xloc, HAWK_NDE_GBL, name, idxa);
+		if (idxa == HAWK_GBL_NF) hawk->tree.dynfld = 1; /* NF requires a record split fully */
 	}
 	else
 	{
@@ -7153,6 +7331,524 @@ int hawk_isvalidident (hawk_t* hawk, const hawk_ooch_t* name)
 	return 0;
 }
 
+/* ---------------------------------------------------------------------
+ * optimization over the parse tree. it folds the constant expressions
+ * the parser couldn't fold while building the tree and drops the
+ * statements never executed.
+ * --------------------------------------------------------------------- */
+
+static int optimize_list (hawk_t* hawk, hawk_nde_t** pp);
+
+static hawk_nde_t* new_null_node (hawk_t* hawk, const hawk_loc_t* loc)
+{
+	hawk_nde_t* tmp;
+
+	tmp = (hawk_nde_t*)hawk_callocmem(hawk, HAWK_SIZEOF(*tmp));
+	if (HAWK_LIKELY(tmp))
+	{
+		tmp->type = HAWK_NDE_NULL;
+		tmp->loc = *loc;
+	}
+	else ADJERR_LOC (hawk, loc);
+
+	return tmp;
+}
+
+static hawk_nde_t* new_str_node (hawk_t* hawk, const hawk_ooch_t* ptr1, hawk_oow_t len1, const hawk_ooch_t* ptr2, hawk_oow_t len2, const hawk_loc_t* loc)
+{
+	hawk_nde_str_t* tmp;
+
+	tmp = (hawk_nde_str_t*)hawk_callocmem(hawk, HAWK_SIZEOF(*tmp));
+	if (HAWK_UNLIKELY(!tmp)) goto oops;
+
+	tmp->type = HAWK_NDE_STR;
+	tmp->loc = *loc;
+	tmp->len = len1 + len2;
+	tmp->ptr = (hawk_ooch_t*)hawk_allocmem(hawk, HAWK_SIZEOF(*tmp->ptr) * (tmp->len + 1));
+	if (HAWK_UNLIKELY(!tmp->ptr))
+	{
+		hawk_freemem (hawk, tmp);
+		goto oops;
+	}
+
+	HAWK_MEMCPY (tmp->ptr, ptr1, HAWK_SIZEOF(*ptr1) * len1);
+	HAWK_MEMCPY (&tmp->ptr[len1], ptr2, HAWK_SIZEOF(*ptr2) * len2);
+	tmp->ptr[tmp->len] = '\0';
+	return (hawk_nde_t*)tmp;
+
+oops:
+	ADJERR_LOC (hawk, loc);
+	return HAWK_NULL;
+}
+
+/* replace the node at *pp with a new node and destroy the old one */
+static void replace_node (hawk_t* hawk, hawk_nde_t** pp, hawk_nde_t* nde)
+{
+	hawk_nde_t* old = *pp;
+
+	nde->next = old->next;
+	old->next = HAWK_NULL;
+	*pp = nde;
+	hawk_clrpt (hawk, old);
+}
+
+/* returns the truth value of a literal node or -1 if it's not a literal */
+static int const_to_bool (hawk_nde_t* nde)
+{
+	switch (nde->type)
+	{
+		case HAWK_NDE_INT:
+			return ((hawk_nde_int_t*)nde)->val != 0;
+
+		case HAWK_NDE_FLT:
+			return ((hawk_nde_flt_t*)nde)->val != 0.0;
+
+		case HAWK_NDE_STR:
+			return ((hawk_nde_str_t*)nde)->len > 0;
+
+		default:
+			return -1;
+	}
+}
+
+static int compare_consts (hawk_nde_t* left, hawk_nde_t* right, int* cmp)
+{
+	hawk_flt_t l, r;
+
+	if (left->type == HAWK_NDE_INT && right->type == HAWK_NDE_INT)
+	{
+		hawk_int_t li = ((hawk_nde_int_t*)left)->val, ri = ((hawk_nde_int_t*)right)->val;
+		*cmp = (li > ri)? 1: ((li < ri)? -1: 0);
+		return 0;
+	}
+
+	if (left->type == HAWK_NDE_INT) l = (hawk_flt_t)((hawk_nde_int_t*)left)->val;
+	else if (left->type == HAWK_NDE_FLT) l = ((hawk_nde_flt_t*)left)->val;
+	else return -1;
+
+	if (right->type == HAWK_NDE_INT) r = (hawk_flt_t)((hawk_nde_int_t*)right)->val;
+	else if (right->type == HAWK_NDE_FLT) r = ((hawk_nde_flt_t*)right)->val;
+	else return -1;
+
+	*cmp = (l > r)? 1: ((l < r)? -1: 0);
+	return 0;
+}
+
+static int optimize_exp_bin (hawk_t* hawk, hawk_nde_t** pp)
+{
+	hawk_nde_exp_t* exp = (hawk_nde_exp_t*)*pp;
+	hawk_nde_t* left = exp->left, * right = exp->right;
+	hawk_nde_t* tmp = HAWK_NULL;
+	int lb, rb, cmp, fold;
+	folded_t folded;
+
+	switch (exp->opcode)
+	{
+		case HAWK_BINOP_LAND:
+			/* 0 && x -> 0, 1 && 0 -> 0, 1 && 1 -> 1 */
+			lb = const_to_bool(left);
+			if (lb == 0) tmp = new_int_node(hawk, 0, &exp->loc);
+			else if (lb > 0 && (rb = const_to_bool(right)) >= 0) tmp = new_int_node(hawk, rb, &exp->loc);
+			else return 0;
+			break;
+
+		case HAWK_BINOP_LOR:
+			/* 1 || x -> 1, 0 || 0 -> 0, 0 || 1 -> 1 */
+			lb = const_to_bool(left);
+			if (lb > 0) tmp = new_int_node(hawk, 1, &exp->loc);
+			else if (lb == 0 && (rb = const_to_bool(right)) >= 0) tmp = new_int_node(hawk, rb, &exp->loc);
+			else return 0;
+			break;
+
+		case HAWK_BINOP_EQ:
+		case HAWK_BINOP_NE:
+		case HAWK_BINOP_GT:
+		case HAWK_BINOP_GE:
+		case HAWK_BINOP_LT:
+		case HAWK_BINOP_LE:
+		{
+			int res;
+
+			if (compare_consts(left, right, &cmp) <= -1) return 0;
+			switch (exp->opcode)
+			{
+				case HAWK_BINOP_EQ: res = (cmp == 0); break;
+				case HAWK_BINOP_NE: res = (cmp != 0); break;
+				case HAWK_BINOP_GT: res = (cmp > 0); break;
+				case HAWK_BINOP_GE: res = (cmp >= 0); break;
+				case HAWK_BINOP_LT: res = (cmp < 0); break;
+				default: res = (cmp <= 0); break;
+			}
+			tmp = new_int_node(hawk, res, &exp->loc);
+			break;
+		}
+
+		case HAWK_BINOP_BOR:
+		case HAWK_BINOP_BXOR:
+		case HAWK_BINOP_BAND:
+		case HAWK_BINOP_LS:
+		case HAWK_BINOP_RS:
+		{
+			hawk_int_t l, r, res;
+
+			if (left->type != HAWK_NDE_INT || right->type != HAWK_NDE_INT) return 0;
+			l = ((hawk_nde_int_t*)left)->val;
+			r = ((hawk_nde_int_t*)right)->val;
+			switch (exp->opcode)
+			{
+				case HAWK_BINOP_BOR: res = l | r; break;
+				case HAWK_BINOP_BXOR: res = l ^ r; break;
+				case HAWK_BINOP_BAND: res = l & r; break;
+				default:
+					/* leave a shift the c language doesn't define to the run-time */
+					if (r < 0 || r >= HAWK_SIZEOF(hawk_int_t) * 8) return 0;
+					res = (exp->opcode == HAWK_BINOP_LS)? (l << r): (l >> r);
+					break;
+			}
+			tmp = new_int_node(hawk, res, &exp->loc);
+			break;
+		}
+
+		case HAWK_BINOP_CONCAT:
+			if (left->type != HAWK_NDE_STR || right->type != HAWK_NDE_STR) return 0;
+			tmp = new_str_node(hawk,
+				((hawk_nde_str_t*)left)->ptr, ((hawk_nde_str_t*)left)->len,
+				((hawk_nde_str_t*)right)->ptr, ((hawk_nde_str_t*)right)->len, &exp->loc);
+			break;
+
+		case HAWK_BINOP_DIV:
+		case HAWK_BINOP_IDIV:
+		case HAWK_BINOP_MOD:
+			/* leave division by zero to the run-time. the expression may
+			 * never be evaluated */
+			if ((right->type == HAWK_NDE_INT && ((hawk_nde_int_t*)right)->val == 0) ||
+			    (right->type == HAWK_NDE_FLT && ((hawk_nde_flt_t*)right)->val == 0.0)) return 0;
+			/* fall through */
+
+		default:
+			fold = fold_constants_for_binop(hawk, left, right, exp->opcode, &folded);
+			if (fold == HAWK_NDE_INT) tmp = new_int_node(hawk, folded.l, &exp->loc);
+			else if (fold == HAWK_NDE_FLT) tmp = new_flt_node(hawk, folded.r, &exp->loc);
+			else return 0;
+			break;
+	}
+
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+	replace_node (hawk, pp, tmp);
+	return 0;
+}
+
+static int optimize_exp_unr (hawk_t* hawk, hawk_nde_t** pp)
+{
+	hawk_nde_exp_t* exp = (hawk_nde_exp_t*)*pp;
+	hawk_nde_t* left = exp->left;
+	hawk_nde_t* tmp;
+
+	/* the parser folds a unary operator on a numeric literal.
+	 * a literal produced by this optimization pass and a string
+	 * literal are handled here */
+	if (left->type == HAWK_NDE_INT)
+	{
+		hawk_int_t l = ((hawk_nde_int_t*)left)->val;
+		switch (exp->opcode)
+		{
+			case HAWK_UNROP_PLUS: break;
+			case HAWK_UNROP_MINUS:
+				/* negating the minimum overflows. leave it to the run-time */
+				if (l == HAWK_TYPE_MIN(hawk_int_t)) return 0;
+				l = -l;
+				break;
+			case HAWK_UNROP_LNOT: l = !l; break;
+			case HAWK_UNROP_BNOT: l = ~l; break;
+			default: return 0;
+		}
+		tmp = new_int_node(hawk, l, &exp->loc);
+	}
+	else if (left->type == HAWK_NDE_FLT)
+	{
+		hawk_flt_t r = ((hawk_nde_flt_t*)left)->val;
+		switch (exp->opcode)
+		{
+			case HAWK_UNROP_PLUS: break;
+			case HAWK_UNROP_MINUS: r = -r; break;
+			case HAWK_UNROP_LNOT: r = !r; break;
+			default: return 0;
+		}
+		tmp = new_flt_node(hawk, r, &exp->loc);
+	}
+	else if (left->type == HAWK_NDE_STR && exp->opcode == HAWK_UNROP_LNOT)
+	{
+		tmp = new_int_node(hawk, !(((hawk_nde_str_t*)left)->len > 0), &exp->loc);
+	}
+	else return 0;
+
+	if (HAWK_UNLIKELY(!tmp)) return -1;
+	replace_node (hawk, pp, tmp);
+	return 0;
+}
+
+static int optimize_node (hawk_t* hawk, hawk_nde_t** pp)
+{
+	hawk_nde_t* nde = *pp;
+	int b;
+
+	switch (nde->type)
+	{
+		case HAWK_NDE_BLK:
+		{
+			hawk_nde_t** sp = &((hawk_nde_blk_t*)nde)->body;
+
+			if (optimize_list(hawk, sp) <= -1) return -1;
+
+			/* remove null statements and empty blocks like the parser does.
+			 * drop the statements following an unconditional jump */
+			while (*sp)
+			{
+				hawk_nde_t* s = *sp;
+
+				if (s->type == HAWK_NDE_NULL || (s->type == HAWK_NDE_BLK && ((hawk_nde_blk_t*)s)->body == HAWK_NULL))
+				{
+					*sp = s->next;
+					s->next = HAWK_NULL;
+					hawk_clrpt (hawk, s);
+					continue;
+				}
+
+				if (s->type == HAWK_NDE_BREAK || s->type == HAWK_NDE_CONTINUE ||
+				    s->type == HAWK_NDE_RETURN || s->type == HAWK_NDE_EXIT ||
+				    s->type == HAWK_NDE_NEXT || s->type == HAWK_NDE_NEXTFILE)
+				{
+					if (s->next)
+					{
+						hawk_clrpt (hawk, s->next);
+						s->next = HAWK_NULL;
+					}
+					break;
+				}
+
+				sp = &s->next;
+			}
+			return 0;
+		}
+
+		case HAWK_NDE_IF:
+		{
+			hawk_nde_if_t* px = (hawk_nde_if_t*)nde;
+			hawk_nde_t* keep;
+
+			if (optimize_list(hawk, &px->test) <= -1 ||
+			    optimize_list(hawk, &px->then_part) <= -1 ||
+			    (px->else_part && optimize_list(hawk, &px->else_part) <= -1)) return -1;
+
+			b = const_to_bool(px->test);
+			if (b <= -1) return 0;
+
+			/* take either part and drop the 'if' statement */
+			keep = b? px->then_part: px->else_part;
+			if (!keep)
+			{
+				keep = new_null_node(hawk, &px->loc);
+				if (HAWK_UNLIKELY(!keep)) return -1;
+			}
+			else if (b) px->then_part = HAWK_NULL;
+			else px->else_part = HAWK_NULL;
+
+			hawk_clrpt (hawk, px->test);
+			if (px->then_part) hawk_clrpt (hawk, px->then_part);
+			if (px->else_part) hawk_clrpt (hawk, px->else_part);
+			keep->next = px->next;
+			*pp = keep;
+			hawk_freemem (hawk, px);
+			return 0;
+		}
+
+		case HAWK_NDE_WHILE:
+		case HAWK_NDE_DOWHILE:
+		{
+			hawk_nde_while_t* px = (hawk_nde_while_t*)nde;
+			hawk_nde_t* tmp;
+
+			if (optimize_list(hawk, &px->test) <= -1 || optimize_list(hawk, &px->body) <= -1) return -1;
+
+			if (nde->type == HAWK_NDE_WHILE && const_to_bool(px->test) == 0)
+			{
+				tmp = new_null_node(hawk, &px->loc);
+				if (HAWK_UNLIKELY(!tmp)) return -1;
+				replace_node (hawk, pp, tmp);
+			}
+			return 0;
+		}
+
+		case HAWK_NDE_FOR:
+		{
+			hawk_nde_for_t* px = (hawk_nde_for_t*)nde;
+			hawk_nde_t* keep;
+
+			if ((px->init && optimize_list(hawk, &px->init) <= -1) ||
+			    (px->test && optimize_list(hawk, &px->test) <= -1) ||
+			    (px->incr && optimize_list(hawk, &px->incr) <= -1) ||
+			    optimize_list(hawk, &px->body) <= -1) return -1;
+
+			if (!px->test || const_to_bool(px->test) != 0) return 0;
+
+			/* only the initialization part is executed */
+			keep = px->init;
+			if (!keep)
+			{
+				keep = new_null_node(hawk, &px->loc);
+				if (HAWK_UNLIKELY(!keep)) return -1;
+			}
+			px->init = HAWK_NULL;
+			replace_node (hawk, pp, keep);
+			return 0;
+		}
+
+		case HAWK_NDE_FORIN:
+			if (optimize_list(hawk, &((hawk_nde_forin_t*)nde)->test) <= -1 ||
+			    optimize_list(hawk, &((hawk_nde_forin_t*)nde)->body) <= -1) return -1;
+			return 0;
+
+		case HAWK_NDE_RETURN:
+			return ((hawk_nde_return_t*)nde)->val? optimize_list(hawk, &((hawk_nde_return_t*)nde)->val): 0;
+
+		case HAWK_NDE_EXIT:
+			return ((hawk_nde_exit_t*)nde)->val? optimize_list(hawk, &((hawk_nde_exit_t*)nde)->val): 0;
+
+		case HAWK_NDE_DELETE:
+			return optimize_list(hawk, &((hawk_nde_delete_t*)nde)->var);
+
+		case HAWK_NDE_RESET:
+			return optimize_list(hawk, &((hawk_nde_reset_t*)nde)->var);
+
+		case HAWK_NDE_PRINT:
+		case HAWK_NDE_PRINTF:
+		{
+			hawk_nde_print_t* px = (hawk_nde_print_t*)nde;
+			if ((px->args && optimize_list(hawk, &px->args) <= -1) ||
+			    (px->out && optimize_list(hawk, &px->out) <= -1)) return -1;
+			return 0;
+		}
+
+		case HAWK_NDE_GRP:
+			return optimize_list(hawk, &((hawk_nde_grp_t*)nde)->body);
+
+		case HAWK_NDE_ASS:
+			if (optimize_list(hawk, &((hawk_nde_ass_t*)nde)->left) <= -1 ||
+			    optimize_list(hawk, &((hawk_nde_ass_t*)nde)->right) <= -1) return -1;
+			return 0;
+
+		case HAWK_NDE_EXP_BIN:
+			if (optimize_list(hawk, &((hawk_nde_exp_t*)nde)->left) <= -1 ||
+			    optimize_list(hawk, &((hawk_nde_exp_t*)nde)->right) <= -1) return -1;
+			return optimize_exp_bin(hawk, pp);
+
+		case HAWK_NDE_EXP_UNR:
+			if (optimize_list(hawk, &((hawk_nde_exp_t*)nde)->left) <= -1) return -1;
+			return optimize_exp_unr(hawk, pp);
+
+		case HAWK_NDE_EXP_INCPRE:
+		case HAWK_NDE_EXP_INCPST:
+			return optimize_list(hawk, &((hawk_nde_exp_t*)nde)->left);
+
+		case HAWK_NDE_CND:
+		{
+			hawk_nde_cnd_t* px = (hawk_nde_cnd_t*)nde;
+			hawk_nde_t* keep;
+
+			if (optimize_list(hawk, &px->test) <= -1 ||
+			    optimize_list(hawk, &px->left) <= -1 ||
+			    optimize_list(hawk, &px->right) <= -1) return -1;
+
+			b = const_to_bool(px->test);
+			if (b <= -1) return 0;
+
+			/* a regular expression, a group and a variable behave differently
+			 * when they are not inside the conditional expression. */
+			keep = b? px->left: px->right;
+			if (keep->type == HAWK_NDE_REX || keep->type == HAWK_NDE_GRP ||
+			    (keep->type >= HAWK_NDE_NAMED && keep->type <= HAWK_NDE_POS)) return 0;
+
+			if (b) px->left = HAWK_NULL;
+			else px->right = HAWK_NULL;
+			hawk_clrpt (hawk, px->test);
+			if (px->left) hawk_clrpt (hawk, px->left);
+			if (px->right) hawk_clrpt (hawk, px->right);
+			keep->next = px->next;
+			*pp = keep;
+			hawk_freemem (hawk, px);
+			return 0;
+		}
+
+		case HAWK_NDE_FNCALL_FNC:
+		case HAWK_NDE_FNCALL_FUN:
+		case HAWK_NDE_FNCALL_VAR:
+		{
+			hawk_nde_fncall_t* px = (hawk_nde_fncall_t*)nde;
+			if (nde->type == HAWK_NDE_FNCALL_VAR && optimize_list(hawk, (hawk_nde_t**)&px->u.var.var) <= -1) return -1;
+			return optimize_list(hawk, &px->args);
+		}
+
+		case HAWK_NDE_XARGVIDX:
+			return optimize_list(hawk, &((hawk_nde_xargvidx_t*)nde)->pos);
+
+		case HAWK_NDE_NAMEDIDX:
+		case HAWK_NDE_GBLIDX:
+		case HAWK_NDE_LCLIDX:
+		case HAWK_NDE_ARGIDX:
+			return optimize_list(hawk, &((hawk_nde_var_t*)nde)->idx);
+
+		case HAWK_NDE_POS:
+			return optimize_list(hawk, &((hawk_nde_pos_t*)nde)->val);
+
+		case HAWK_NDE_GETLINE:
+		{
+			hawk_nde_getline_t* px = (hawk_nde_getline_t*)nde;
+			if ((px->var && optimize_list(hawk, &px->var) <= -1) ||
+			    (px->in && optimize_list(hawk, &px->in) <= -1)) return -1;
+			return 0;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+static int optimize_list (hawk_t* hawk, hawk_nde_t** pp)
+{
+	while (*pp)
+	{
+		if (optimize_node(hawk, pp) <= -1) return -1;
+		pp = &(*pp)->next;
+	}
+	return 0;
+}
+
+static int optimize (hawk_t* hawk)
+{
+	hawk_chain_t* chain;
+	hawk_htb_pair_t* pair;
+	hawk_htb_itr_t itr;
+
+	if (hawk->tree.begin && optimize_list(hawk, &hawk->tree.begin) <= -1) return -1;
+
+	for (chain = hawk->tree.chain; chain; chain = chain->next)
+	{
+		if (chain->pattern && optimize_list(hawk, &chain->pattern) <= -1) return -1;
+		if (chain->action && optimize_list(hawk, &chain->action) <= -1) return -1;
+	}
+
+	if (hawk->tree.end && optimize_list(hawk, &hawk->tree.end) <= -1) return -1;
+
+	pair = hawk_htb_getfirstpair(hawk->tree.funs, &itr);
+	while (pair)
+	{
+		if (optimize_list(hawk, &((hawk_fun_t*)HAWK_HTB_VPTR(pair))->body) <= -1) return -1;
+		pair = hawk_htb_getnextpair(hawk->tree.funs, &itr);
+	}
+
+	return 0;
+}
+
 struct deparse_func_t
 {
 	hawk_t* hawk;
@@ -7238,6 +7934,38 @@ static int deparse (hawk_t* hawk)
 		}
 	}
 
+	if (hawk->tree.reduce.count > 0)
+	{
+		static const hawk_ooch_t* opname[] =
+		{
+			HAWK_T(" sum;"),
+			HAWK_T(" min;"),
+			HAWK_T(" max;"),
+			HAWK_T(" concat;"),
+			HAWK_T(" union;")
+		};
+		hawk_oow_t i, len;
+
+		for (i = 0; i < hawk->tree.reduce.count; i++)
+		{
+			hawk_oow_t g = hawk->tree.reduce.ptr[i].gbl;
+
+			if (hawk_putsrcoocstr(hawk, HAWK_T("@pragma reduce ")) <= -1) EXIT_DEPARSE ();
+			if (!(hawk->opt.trait & HAWK_IMPLICIT))
+			{
+				if (hawk_putsrcoochars(hawk, HAWK_ARR_DPTR(hawk->parse.gbls, g), HAWK_ARR_DLEN(hawk->parse.gbls, g)) <= -1) EXIT_DEPARSE ();
+			}
+			else
+			{
+				len = hawk_int_to_oocstr((hawk_int_t)g, 10, HAWK_T("__g"), tmp, HAWK_COUNTOF(tmp));
+				HAWK_ASSERT (len != (hawk_oow_t)-1);
+				if (hawk_putsrcoochars (hawk, tmp, len) <= -1) EXIT_DEPARSE ();
+			}
+			if (hawk_putsrcoocstr(hawk, opname[hawk->tree.reduce.ptr[i].op]) <= -1 ||
+			    hawk_putsrcoocstr(hawk, ((hawk->opt.trait & HAWK_CRLF)? HAWK_T("\r\n"): HAWK_T("\n"))) <= -1) EXIT_DEPARSE ();
+		}
+	}
+
 	df.hawk = hawk;
 	df.tmp = tmp;
 	df.tmp_len = HAWK_COUNTOF(tmp);
@@ -7695,7 +8423,7 @@ done:
 }
 
 
-hawk_mod_t* hawk_querymodulewithname (hawk_t* hawk, hawk_ooch_t* name, hawk_mod_sym_t* sym)
+static hawk_mod_t* query_module_with_name (hawk_t* hawk, hawk_ooch_t* name, hawk_mod_sym_t* sym)
 {
 	const hawk_ooch_t* dc;
 	hawk_oocs_t segs[2];
@@ -7726,3 +8454,30 @@ hawk_mod_t* hawk_querymodulewithname (hawk_t* hawk, hawk_ooch_t* name, hawk_mod_
 	name[segs[0].len] = tmp;
 	return mod;
 }
+
+hawk_mod_t* hawk_querymodulewithname (hawk_t* hawk, hawk_ooch_t* name, hawk_mod_sym_t* sym)
+{
+	hawk_mod_t* mod;
+
+	/* the runtime contexts may look up the module table at the same time */
+	hawk_mtx_lock (&hawk->mtx, HAWK_NULL);
+	mod = query_module_with_name(hawk, name, sym);
+	hawk_mtx_unlock (&hawk->mtx);
+
+	return mod;
+}
+
+hawk_mod_t* hawk_rtx_querymodulewithname (hawk_rtx_t* rtx, hawk_ooch_t* name, hawk_mod_sym_t* sym)
+{
+	hawk_t* hawk = hawk_rtx_gethawk(rtx);
+	hawk_mod_t* mod;
+
+	hawk_mtx_lock (&hawk->mtx, HAWK_NULL);
+	mod = query_module_with_name(hawk, name, sym);
+	if (!mod) hawk_rtx_errorfromhawk (rtx, hawk);
+	hawk_mtx_unlock (&hawk->mtx);
+
+	/* the module may have been loaded after rtx was opened */
+	if (mod && hawk_rtx_initmodule(rtx, mod) <= -1) return HAWK_NULL;
+	return mod;
+}
@@ -25,6 +25,7 @@
 #include "hawk-prv.h"
 
 static int split_record (hawk_rtx_t* run, int prefer_number);
+static int split_fields (hawk_rtx_t* rtx, hawk_oow_t limit);
 static int recomp_record_fields (hawk_rtx_t* run, hawk_oow_t lv, const hawk_oocs_t* str, int prefer_number);
 
 int hawk_rtx_setrec (hawk_rtx_t* rtx, hawk_oow_t idx, const hawk_oocs_t* str, int prefer_number)
@@ -53,6 +54,8 @@ int hawk_rtx_setrec (hawk_rtx_t* rtx, hawk_oow_t idx, const hawk_oocs_t* str, in
 	}
 	else
 	{
+		/* all fields are needed to recompose the record */
+		if (rtx->inrec.split.pending && split_fields(rtx, HAWK_TYPE_MAX(hawk_oow_t)) <= -1) goto oops;
 		if (recomp_record_fields(rtx, idx, str, prefer_number) <= -1) goto oops;
 
 		/* recompose $0 */
@@ -103,10 +106,7 @@ static int merge_fields (hawk_rtx_t* rtx)
 
 static int split_record (hawk_rtx_t* rtx, int prefer_number)
 {
-	hawk_oocs_t tok;
-	hawk_ooch_t* p, * px;
-	hawk_oow_t len, nflds;
-	hawk_val_t* v, * fs;
+	hawk_val_t* fs;
 	hawk_val_type_t fsvtype;
 	hawk_ooch_t* fs_ptr, * fs_free;
 	hawk_oow_t fs_len;
@@ -137,7 +137,6 @@ static int split_record (hawk_rtx_t* rtx, int prefer_number)
 		fs_free = fs_ptr;
 	}
 
-	/* scan the input record to count the fields */
 	if (fs_len == 5 && fs_ptr[0] ==  HAWK_T('?'))
 	{
 		if (hawk_ooecs_ncpy(&rtx->inrec.linew, HAWK_OOECS_PTR(&rtx->inrec.line), HAWK_OOECS_LEN(&rtx->inrec.line)) == (hawk_oow_t)-1)
@@ -146,106 +145,79 @@ static int split_record (hawk_rtx_t* rtx, int prefer_number)
 			return -1;
 		}
 
-		px = HAWK_OOECS_PTR(&rtx->inrec.linew);
 		how = 1;
 	}
 	else
 	{
-		px = HAWK_OOECS_PTR(&rtx->inrec.line);
 		how = (fs_len <= 1)? 0: 2;
 	}
 
-	p = px;
-	len = HAWK_OOECS_LEN(&rtx->inrec.line);
-
-#if 0
-	nflds = 0;
-	while (p != HAWK_NULL)
+	/* remember how to split the record so that splitting can be resumed
+	 * when a field beyond the ones split so far is needed. the separator
+	 * is copied as FS may change before splitting is resumed */
+	rtx->inrec.split.how = how;
+	rtx->inrec.split.prefer_number = prefer_number;
+	rtx->inrec.split.pos = 0;
+	if (how == 2)
 	{
-		switch (how)
-		{
-			case 0:
-				p = hawk_rtx_tokoocharswithoochars (rtx, p, len, fs_ptr, fs_len, &tok);
-				break;
-
-			case 1:
-				break;
-
-			default:
-				p = hawk_rtx_tokoocharsbyrex(
-					rtx,
-					HAWK_OOECS_PTR(&rtx->inrec.line),
-					HAWK_OOECS_LEN(&rtx->inrec.line),
-					p, len,
-					rtx->gbl.fs[rtx->gbl.ignorecase], &tok
-				);
-				if (p == HAWK_NULL && hawk_rtx_geterrnum(rtx) != HAWK_ENOERR)
-				{
-					if (fs_free) hawk_rtx_freemem (rtx, fs_free);
-					return -1;
-				}
-		}
-
-		if (nflds == 0 && p == HAWK_NULL && tok.len == 0)
-		{
-			/* there are no fields. it can just return here
-			 * as hawk_rtx_clrrec has been called before this */
-			if (fs_free) hawk_rtx_freemem (rtx, fs_free);
-			return 0;
-		}
+		rtx->inrec.split.rex = rtx->gbl.fs[rtx->gbl.ignorecase];
+		rtx->inrec.split.fs_len = 0;
+	}
+	else
+	{
+		HAWK_ASSERT (fs_len <= HAWK_COUNTOF(rtx->inrec.split.fs));
+		HAWK_MEMCPY (rtx->inrec.split.fs, fs_ptr, HAWK_SIZEOF(*fs_ptr) * fs_len);
+		rtx->inrec.split.fs_len = fs_len;
+	}
 
-		HAWK_ASSERT ((tok.ptr != HAWK_NULL && tok.len > 0) || tok.len == 0);
+	if (fs_free) hawk_rtx_freemem (rtx, fs_free);
 
-		nflds++;
-		len = HAWK_OOECS_LEN(&rtx->inrec.line) - (p - HAWK_OOECS_PTR(&rtx->inrec.line));
-	}
+	return split_fields(rtx, rtx->inrec.split.max);
+}
 
-	/* allocate space */
-	if (nflds > rtx->inrec.maxflds)
-	{
-		void* tmp = hawk_rtx_allocmem(rtx, HAWK_SIZEOF(*rtx->inrec.flds) * nflds);
-		if (HAWK_UNLIKELY(!tmp))
-		{
-			if (fs_free) hawk_rtx_freemem (rtx, fs_free);
-			return -1;
-		}
+static int split_fields (hawk_rtx_t* rtx, hawk_oow_t limit)
+{
+	hawk_oocs_t tok[32];
+	hawk_ooch_t* p, * px;
+	hawk_oow_t len, nflds, ntoks, i;
+	hawk_val_t* v;
 
-		if (rtx->inrec.flds) hawk_rtx_freemem (rtx, rtx->inrec.flds);
-		rtx->inrec.flds = tmp;
-		rtx->inrec.maxflds = nflds;
-	}
+	px = (rtx->inrec.split.how == 1)? HAWK_OOECS_PTR(&rtx->inrec.linew): HAWK_OOECS_PTR(&rtx->inrec.line);
+	p = px + rtx->inrec.split.pos;
+	len = HAWK_OOECS_LEN(&rtx->inrec.line) - rtx->inrec.split.pos;
 
-	/* scan again and split it */
-	if (how == 1)
+	while (p)
 	{
-		if (hawk_ooecs_ncpy(&rtx->inrec.linew, HAWK_OOECS_PTR(&rtx->inrec.line), HAWK_OOECS_LEN(&rtx->inrec.line)) == (hawk_oow_t)-1)
+		if (rtx->inrec.nflds >= limit)
 		{
-			if (fs_free) hawk_rtx_freemem (rtx, fs_free);
-			return -1;
+			/* stop here. NF is left unset until the rest is split */
+			rtx->inrec.split.pos = p - px;
+			rtx->inrec.split.pending = 1;
+			return 0;
 		}
-		px = HAWK_OOECS_PTR(&rtx->inrec.linew):
-	}
-	else
-	{
-		px = HAWK_OOECS_PTR(&rtx->inrec.line);
-	}
-
-	p = px;
-	len = HAWK_OOECS_LEN(&rtx->inrec.line);
-#endif
 
-	while (p)
-	{
-		switch (how)
+		ntoks = 1;
+		switch (rtx->inrec.split.how)
 		{
 			case 0:
-				/* 1 character FS */
-				p = hawk_rtx_tokoocharswithoochars(rtx, p, len, fs_ptr, fs_len, &tok);
+				if (rtx->inrec.split.fs_len == 1)
+				{
+					/* 1 character FS. find a batch of fields at a time
+					 * but not beyond the limit */
+					ntoks = limit - rtx->inrec.nflds;
+					if (ntoks > HAWK_COUNTOF(tok)) ntoks = HAWK_COUNTOF(tok);
+					ntoks = hawk_rtx_sploochars(rtx, p, len, rtx->inrec.split.fs[0], tok, ntoks, &p);
+				}
+				else
+				{
+					/* empty FS */
+					p = hawk_rtx_tokoocharswithoochars(rtx, p, len, rtx->inrec.split.fs, rtx->inrec.split.fs_len, &tok[0]);
+				}
 				break;
 
 			case 1:
 				/* 5 character FS beginning with ? */
-				p = hawk_rtx_fldoochars(rtx, p, len, fs_ptr[1], fs_ptr[2], fs_ptr[3], fs_ptr[4], &tok);
+				p = hawk_rtx_fldoochars(rtx, p, len, rtx->inrec.split.fs[1], rtx->inrec.split.fs[2], rtx->inrec.split.fs[3], rtx->inrec.split.fs[4], &tok[0]);
 				break;
 
 			default:
@@ -255,38 +227,37 @@ static int split_record (hawk_rtx_t* rtx, int prefer_number)
 					HAWK_OOECS_PTR(&rtx->inrec.line),
 					HAWK_OOECS_LEN(&rtx->inrec.line),
 					p, len,
-					rtx->gbl.fs[rtx->gbl.ignorecase], &tok
+					rtx->inrec.split.rex, &tok[0]
 				);
 				if (p == HAWK_NULL && hawk_rtx_geterrnum(rtx) != HAWK_ENOERR)
 				{
-					if (fs_free) hawk_rtx_freemem (rtx, fs_free);
+					rtx->inrec.split.pending = 0;
 					return -1;
 				}
 		}
 #if 1
-		if (rtx->inrec.nflds == 0 && p == HAWK_NULL && tok.len == 0)
+		if (rtx->inrec.nflds == 0 && p == HAWK_NULL && ntoks == 1 && tok[0].len == 0)
 		{
 			/* there are no fields. it can just return here
 			 * as hawk_rtx_clrrec has been called before this */
-			if (fs_free) hawk_rtx_freemem (rtx, fs_free);
+			rtx->inrec.split.pending = 0;
 			return 0;
 		}
 #endif
 
-		HAWK_ASSERT ((tok.ptr != HAWK_NULL && tok.len > 0) || tok.len == 0);
-
 #if 1
-		if (rtx->inrec.nflds >= rtx->inrec.maxflds)
+		if (rtx->inrec.nflds + ntoks > rtx->inrec.maxflds)
 		{
 			void* tmp;
 
 			if (rtx->inrec.nflds < 16) nflds = 32;
 			else nflds = rtx->inrec.nflds * 2;
+			if (nflds < rtx->inrec.nflds + ntoks) nflds = rtx->inrec.nflds + ntoks;
 
 			tmp = hawk_rtx_allocmem(rtx, HAWK_SIZEOF(*rtx->inrec.flds) * nflds);
 			if (tmp == HAWK_NULL)
 			{
-				if (fs_free) hawk_rtx_freemem (rtx, fs_free);
+				rtx->inrec.split.pending = 0;
 				return -1;
 			}
 
@@ -301,25 +272,30 @@ static int split_record (hawk_rtx_t* rtx, int prefer_number)
 		}
 #endif
 
-		rtx->inrec.flds[rtx->inrec.nflds].ptr = tok.ptr;
-		rtx->inrec.flds[rtx->inrec.nflds].len = tok.len;
-		/*rtx->inrec.flds[rtx->inrec.nflds].val = hawk_rtx_makenstrvalwithoocs(rtx, &tok);*/
-		rtx->inrec.flds[rtx->inrec.nflds].val =
-			prefer_number? hawk_rtx_makenumorstrvalwithoochars(rtx, tok.ptr, tok.len):
-			               hawk_rtx_makestrvalwithoochars(rtx, tok.ptr, tok.len);
-		if (HAWK_UNLIKELY(!rtx->inrec.flds[rtx->inrec.nflds].val))
+		for (i = 0; i < ntoks; i++)
 		{
-			if (fs_free) hawk_rtx_freemem (rtx, fs_free);
-			return -1;
-		}
+			HAWK_ASSERT ((tok[i].ptr != HAWK_NULL && tok[i].len > 0) || tok[i].len == 0);
+
+			rtx->inrec.flds[rtx->inrec.nflds].ptr = tok[i].ptr;
+			rtx->inrec.flds[rtx->inrec.nflds].len = tok[i].len;
+			/*rtx->inrec.flds[rtx->inrec.nflds].val = hawk_rtx_makenstrvalwithoocs(rtx, &tok[i]);*/
+			rtx->inrec.flds[rtx->inrec.nflds].val =
+				rtx->inrec.split.prefer_number? hawk_rtx_makenumorstrvalwithoochars(rtx, tok[i].ptr, tok[i].len):
+				                                hawk_rtx_makestrvalwithoochars(rtx, tok[i].ptr, tok[i].len);
+			if (HAWK_UNLIKELY(!rtx->inrec.flds[rtx->inrec.nflds].val))
+			{
+				rtx->inrec.split.pending = 0;
+				return -1;
+			}
 
-		hawk_rtx_refupval (rtx, rtx->inrec.flds[rtx->inrec.nflds].val);
-		rtx->inrec.nflds++;
+			hawk_rtx_refupval (rtx, rtx->inrec.flds[rtx->inrec.nflds].val);
+			rtx->inrec.nflds++;
+		}
 
 		len = HAWK_OOECS_LEN(&rtx->inrec.line) - (p - px);
 	}
 
-	if (fs_free) hawk_rtx_freemem (rtx, fs_free);
+	rtx->inrec.split.pending = 0;
 
 	/* set the number of fields */
 	v = hawk_rtx_makeintval(rtx, (hawk_int_t)rtx->inrec.nflds);
@@ -335,11 +311,19 @@ static int split_record (hawk_rtx_t* rtx, int prefer_number)
 	return 0;
 }
 
+int hawk_rtx_splitrec (hawk_rtx_t* rtx)
+{
+	return rtx->inrec.split.pending? split_fields(rtx, HAWK_TYPE_MAX(hawk_oow_t)): 0;
+}
+
 int hawk_rtx_clrrec (hawk_rtx_t* rtx, int skip_inrec_line)
 {
 	hawk_oow_t i;
 	int n = 0;
 
+	/* the rest of the record is not needed any more */
+	rtx->inrec.split.pending = 0;
+
 	if (HAWK_RTX_GETVALTYPE(rtx, rtx->inrec.d0) != HAWK_VAL_NIL)
 	{
 		hawk_rtx_refdownval (rtx, rtx->inrec.d0);
@@ -495,6 +479,7 @@ int hawk_rtx_truncrec (hawk_rtx_t* rtx, hawk_oow_t nflds)
 	hawk_ooecs_t tmp;
 	int fini_tmp = 0;
 
+	if (rtx->inrec.split.pending && split_fields(rtx, HAWK_TYPE_MAX(hawk_oow_t)) <= -1) return -1;
 	HAWK_ASSERT (nflds <= rtx->inrec.nflds);
 
 	if (hawk_ooecs_init(&tmp, hawk_rtx_getgem(rtx), HAWK_OOECS_LEN(&rtx->inrec.line)) <= -1) goto oops;
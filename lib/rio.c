@@ -101,11 +101,160 @@ hawk_rio_type_t hawk_rtx_outtoriotype (hawk_rtx_t* rtx, hawk_out_type_t out_type
 	return out_type_map[out_type];
 }
 
+/* the streams are kept in the chain in the order of the most recent first.
+ * the index maps a name to the list of the streams of the name linked with
+ * the nnext field in the same order so that a stream is found without
+ * walking the whole chain */
+static hawk_rio_arg_t* find_rio (hawk_rtx_t* rtx, int type, const hawk_ooch_t* name)
+{
+	hawk_htb_pair_t* pair;
+	hawk_rio_arg_t* p;
+
+	pair = hawk_htb_search(&rtx->rio.index, name, hawk_count_oocstr(name));
+	if (!pair) return HAWK_NULL;
+
+	for (p = (hawk_rio_arg_t*)HAWK_HTB_VPTR(pair); p; p = p->nnext)
+	{
+		if (p->type == type) return p;
+	}
+
+	return HAWK_NULL;
+}
+
+static int chain_rio (hawk_rtx_t* rtx, hawk_rio_arg_t* p)
+{
+	hawk_htb_pair_t* pair;
+	hawk_oow_t len;
+
+	len = hawk_count_oocstr(p->name);
+	pair = hawk_htb_search(&rtx->rio.index, p->name, len);
+	if (pair)
+	{
+		p->nnext = (hawk_rio_arg_t*)HAWK_HTB_VPTR(pair);
+		HAWK_HTB_VPTR(pair) = p;
+	}
+	else
+	{
+		pair = hawk_htb_insert(&rtx->rio.index, p->name, len, p, 0);
+		if (HAWK_UNLIKELY(!pair)) return -1;
+		p->nnext = HAWK_NULL;
+	}
+
+	p->prev = HAWK_NULL;
+	p->next = rtx->rio.chain;
+	if (p->next) p->next->prev = p;
+	rtx->rio.chain = p;
+	return 0;
+}
+
+/* the output files open are kept in the order of the most recent
+ * write. when the number of them reaches the limit, the least recently
+ * written is closed and it is opened again for appending when written
+ * to again */
+#define IS_OUTFILE(p) ((p)->type == (HAWK_RIO_FILE | IO_MASK_WRITE))
+
+static void link_outfile (hawk_rtx_t* rtx, hawk_rio_arg_t* p)
+{
+	p->lprev = HAWK_NULL;
+	p->lnext = rtx->rio.lru.head;
+	if (rtx->rio.lru.head) rtx->rio.lru.head->lprev = p;
+	else rtx->rio.lru.tail = p;
+	rtx->rio.lru.head = p;
+	rtx->rio.lru.count++;
+}
+
+static void unlink_outfile (hawk_rtx_t* rtx, hawk_rio_arg_t* p)
+{
+	if (p->lprev) p->lprev->lnext = p->lnext;
+	else rtx->rio.lru.head = p->lnext;
+	if (p->lnext) p->lnext->lprev = p->lprev;
+	else rtx->rio.lru.tail = p->lprev;
+	rtx->rio.lru.count--;
+}
+
+static int make_room_for_outfile (hawk_rtx_t* rtx, hawk_rio_impl_t handler)
+{
+	while (rtx->rio.lru.max > 0 && rtx->rio.lru.count >= rtx->rio.lru.max)
+	{
+		hawk_rio_arg_t* p = rtx->rio.lru.tail;
+
+		unlink_outfile (rtx, p);
+		p->evicted = 1;
+		rtx->rio.lru.evictions++;
+		if (handler(rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1) return -1;
+	}
+
+	return 0;
+}
+
+static int reopen_outfile (hawk_rtx_t* rtx, hawk_rio_arg_t* p, hawk_rio_impl_t handler)
+{
+	hawk_rio_mode_t mode;
+	hawk_ooi_t n;
+
+	if (make_room_for_outfile(rtx, handler) <= -1) return -1;
+
+	/* the file is not truncated when it is opened again */
+	mode = p->mode;
+	p->mode = HAWK_RIO_FILE_APPEND;
+	n = handler(rtx, HAWK_RIO_CMD_OPEN, p, HAWK_NULL, 0);
+	p->mode = mode;
+	if (n <= -1) return -1;
+
+	p->evicted = 0;
+	rtx->rio.lru.reopens++;
+	link_outfile (rtx, p);
+	return 0;
+}
+
+void hawk_rtx_getriostats (hawk_rtx_t* rtx, hawk_riostats_t* stats)
+{
+	stats->max_open_outfiles = rtx->rio.lru.max;
+	stats->open_outfiles = rtx->rio.lru.count;
+	stats->hits = rtx->rio.lru.hits;
+	stats->evictions = rtx->rio.lru.evictions;
+	stats->reopens = rtx->rio.lru.reopens;
+}
+
+static void unchain_rio (hawk_rtx_t* rtx, hawk_rio_arg_t* p)
+{
+	hawk_htb_pair_t* pair;
+	hawk_oow_t len;
+
+	if (IS_OUTFILE(p) && !p->evicted) unlink_outfile (rtx, p);
+
+	if (p->prev) p->prev->next = p->next;
+	else rtx->rio.chain = p->next;
+	if (p->next) p->next->prev = p->prev;
+
+	len = hawk_count_oocstr(p->name);
+	pair = hawk_htb_search(&rtx->rio.index, p->name, len);
+	HAWK_ASSERT (pair != HAWK_NULL);
+
+	if (HAWK_HTB_VPTR(pair) == p)
+	{
+		if (p->nnext) HAWK_HTB_VPTR(pair) = p->nnext;
+		else hawk_htb_delete (&rtx->rio.index, p->name, len);
+	}
+	else
+	{
+		hawk_rio_arg_t* px = (hawk_rio_arg_t*)HAWK_HTB_VPTR(pair);
+		while (px->nnext != p) px = px->nnext;
+		px->nnext = p->nnext;
+	}
+}
+
+static void free_rio (hawk_rtx_t* rtx, hawk_rio_arg_t* p)
+{
+	hawk_rtx_freemem (rtx, p->name);
+	hawk_rtx_freemem (rtx, p);
+}
+
 static int find_rio_in (
 	hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t* name,
 	int mbs_if_new, hawk_rio_arg_t** rio, hawk_rio_impl_t* fun)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, io_mode, io_mask;
 
@@ -128,13 +277,7 @@ static int find_rio_in (
 	}
 
 	/* search the chain for exiting an existing io name */
-	while (p)
-	{
-		if (p->type == (io_type | io_mask) &&
-		    hawk_comp_oocstr(p->name, name, 0) == 0) break;
-		p = p->next;
-	}
-
+	p = find_rio(rtx, io_type | io_mask, name);
 	if (p == HAWK_NULL)
 	{
 		hawk_ooi_t x;
@@ -171,14 +314,17 @@ static int find_rio_in (
 		x = handler(rtx, HAWK_RIO_CMD_OPEN, p, HAWK_NULL, 0);
 		if (x <= -1)
 		{
-			hawk_rtx_freemem (rtx, p->name);
-			hawk_rtx_freemem (rtx, p);
+			free_rio (rtx, p);
 			return -1;
 		}
 
 		/* chain it */
-		p->next = rtx->rio.chain;
-		rtx->rio.chain = p;
+		if (HAWK_UNLIKELY(chain_rio(rtx, p) <= -1))
+		{
+			handler (rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0);
+			free_rio (rtx, p);
+			return -1;
+		}
 	}
 
 	*rio = p;
@@ -481,42 +627,36 @@ int hawk_rtx_readio (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t*
 		{
 			hawk_oow_t start_pos = p->in.pos;
 			hawk_oow_t end_pos, tmp;
+			const hawk_ooch_t* nl;
 
-			do
+			/* TODO: handle different line terminator */
+			/* separate by a new line */
+			nl = hawk_find_oochar_in_oochars(&p->in.u.buf[start_pos], p->in.len - start_pos, HAWK_T('\n'));
+			if (nl)
 			{
-				pc = c;
-				c = p->in.u.buf[p->in.pos++];
-				end_pos = p->in.pos;
+				end_pos = nl - p->in.u.buf;
+				p->in.pos = end_pos + 1;
 
-				/* TODO: handle different line terminator */
-				/* separate by a new line */
-				if (c == HAWK_T('\n'))
+				if (end_pos > start_pos)
 				{
-					end_pos--;
-					if (pc == HAWK_T('\r'))
-					{
-						if (end_pos > start_pos)
-						{
-							/* CR is the part of the read buffer.
-							 * decrementing the end_pos variable can
-							 * simply drop it */
-							end_pos--;
-						}
-						else
-						{
-							/* CR must have come from the previous
-							 * read. drop CR that must be found  at
-							 * the end of the record buffer. */
-							HAWK_ASSERT (end_pos == start_pos);
-							HAWK_ASSERT (HAWK_OOECS_LEN(buf) > 0);
-							HAWK_ASSERT (HAWK_OOECS_LASTCHAR(buf) == HAWK_T('\r'));
-							HAWK_OOECS_LEN(buf)--;
-						}
-					}
-					break;
+					/* CR is the part of the read buffer.
+					 * decrementing the end_pos variable can
+					 * simply drop it */
+					if (p->in.u.buf[end_pos - 1] == HAWK_T('\r')) end_pos--;
+				}
+				else if (HAWK_OOECS_LEN(buf) > 0 && HAWK_OOECS_LASTCHAR(buf) == HAWK_T('\r'))
+				{
+					/* CR must have come from the previous
+					 * read. drop CR that must be found  at
+					 * the end of the record buffer. */
+					HAWK_OOECS_LEN(buf)--;
 				}
 			}
-			while (p->in.pos < p->in.len);
+			else
+			{
+				end_pos = p->in.len;
+				p->in.pos = p->in.len;
+			}
 
 			tmp = hawk_ooecs_ncat(buf, &p->in.u.buf[start_pos], end_pos - start_pos);
 			if (tmp == (hawk_oow_t)-1)
@@ -525,7 +665,7 @@ int hawk_rtx_readio (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t*
 				break;
 			}
 
-			if (end_pos < p->in.len) break; /* RS found */
+			if (nl) break; /* RS found */
 		}
 		else if (rrs.len == 0)
 		{
@@ -620,17 +760,11 @@ int hawk_rtx_readio (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t*
 			hawk_oow_t start_pos = p->in.pos;
 			hawk_oow_t end_pos, tmp;
 
-			do
-			{
-				c = p->in.u.buf[p->in.pos++];
-				end_pos = p->in.pos;
-				if (c == rrs.ptr[0])
-				{
-					end_pos--;
-					break;
-				}
-			}
-			while (p->in.pos < p->in.len);
+			const hawk_ooch_t* rsp;
+
+			rsp = hawk_find_oochar_in_oochars(&p->in.u.buf[start_pos], p->in.len - start_pos, rrs.ptr[0]);
+			end_pos = rsp? (hawk_oow_t)(rsp - p->in.u.buf): p->in.len;
+			p->in.pos = rsp? end_pos + 1: end_pos;
 
 			tmp = hawk_ooecs_ncat(buf, &p->in.u.buf[start_pos], end_pos - start_pos);
 			if (tmp == (hawk_oow_t)-1)
@@ -639,7 +773,7 @@ int hawk_rtx_readio (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t*
 				break;
 			}
 
-			if (end_pos < p->in.len) break; /* RS found */
+			if (rsp) break; /* RS found */
 		}
 		else
 		{
@@ -799,42 +933,36 @@ int hawk_rtx_readiobytes (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 		{
 			hawk_oow_t start_pos = p->in.pos;
 			hawk_oow_t end_pos, tmp;
+			const hawk_bch_t* nl;
 
-			do
+			/* TODO: handle different line terminator */
+			/* separate by a new line */
+			nl = hawk_find_bchar_in_bchars(&p->in.u.bbuf[start_pos], p->in.len - start_pos, '\n');
+			if (nl)
 			{
-				pc = c;
-				c = p->in.u.bbuf[p->in.pos++];
-				end_pos = p->in.pos;
+				end_pos = nl - p->in.u.bbuf;
+				p->in.pos = end_pos + 1;
 
-				/* TODO: handle different line terminator */
-				/* separate by a new line */
-				if (c == '\n')
+				if (end_pos > start_pos)
 				{
-					end_pos--;
-					if (pc == '\r')
-					{
-						if (end_pos > start_pos)
-						{
-							/* CR is the part of the read buffer.
-							 * decrementing the end_pos variable can
-							 * simply drop it */
-							end_pos--;
-						}
-						else
-						{
-							/* CR must have come from the previous
-							 * read. drop CR that must be found  at
-							 * the end of the record buffer. */
-							HAWK_ASSERT (end_pos == start_pos);
-							HAWK_ASSERT (HAWK_BECS_LEN(buf) > 0);
-							HAWK_ASSERT (HAWK_BECS_LASTCHAR(buf) == '\r');
-							HAWK_BECS_LEN(buf)--;
-						}
-					}
-					break;
+					/* CR is the part of the read buffer.
+					 * decrementing the end_pos variable can
+					 * simply drop it */
+					if (p->in.u.bbuf[end_pos - 1] == '\r') end_pos--;
+				}
+				else if (HAWK_BECS_LEN(buf) > 0 && HAWK_BECS_LASTCHAR(buf) == '\r')
+				{
+					/* CR must have come from the previous
+					 * read. drop CR that must be found  at
+					 * the end of the record buffer. */
+					HAWK_BECS_LEN(buf)--;
 				}
 			}
-			while (p->in.pos < p->in.len);
+			else
+			{
+				end_pos = p->in.len;
+				p->in.pos = p->in.len;
+			}
 
 			tmp = hawk_becs_ncat(buf, &p->in.u.bbuf[start_pos], end_pos - start_pos);
 			if (tmp == (hawk_oow_t)-1)
@@ -843,7 +971,7 @@ int hawk_rtx_readiobytes (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 				break;
 			}
 
-			if (end_pos < p->in.len) break; /* RS found */
+			if (nl) break; /* RS found */
 		}
 		else if (rrs.len == 0)
 		{
@@ -938,17 +1066,13 @@ int hawk_rtx_readiobytes (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 			hawk_oow_t start_pos = p->in.pos;
 			hawk_oow_t end_pos, tmp;
 
-			do
-			{
-				c = p->in.u.bbuf[p->in.pos++];
-				end_pos = p->in.pos;
-				if (c == rrs.ptr[0])
-				{
-					end_pos--;
-					break;
-				}
-			}
-			while (p->in.pos < p->in.len);
+			const hawk_bch_t* rsp;
+
+			/* a byte can't match RS if it's not representable as a byte */
+			rsp = ((hawk_ooch_t)(hawk_bch_t)rrs.ptr[0] == rrs.ptr[0])?
+				hawk_find_bchar_in_bchars(&p->in.u.bbuf[start_pos], p->in.len - start_pos, (hawk_bch_t)rrs.ptr[0]): HAWK_NULL;
+			end_pos = rsp? (hawk_oow_t)(rsp - p->in.u.bbuf): p->in.len;
+			p->in.pos = rsp? end_pos + 1: end_pos;
 
 			tmp = hawk_becs_ncat(buf, &p->in.u.bbuf[start_pos], end_pos - start_pos);
 			if (tmp == (hawk_oow_t)-1)
@@ -957,7 +1081,7 @@ int hawk_rtx_readiobytes (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 				break;
 			}
 
-			if (end_pos < p->in.len) break; /* RS found */
+			if (rsp) break; /* RS found */
 		}
 		else
 		{
@@ -1044,7 +1168,7 @@ typedef struct write_io_data_t write_io_data_t;
 
 static int prepare_for_write_io_data (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* name, write_io_data_t* wid)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, io_mode, io_mask, n;
 
@@ -1065,26 +1189,25 @@ static int prepare_for_write_io_data (hawk_rtx_t* rtx, hawk_out_type_t out_type,
 		return -1;
 	}
 
-	/* look for the corresponding rio for name */
-	while (p)
-	{
-		/* the file "1.tmp", in the following code snippets,
-		 * would be opened by the first print statement, but not by
-		 * the second print statement. this is because
-		 * both HAWK_OUT_FILE and HAWK_OUT_APFILE are
-		 * translated to HAWK_RIO_FILE and it is used to
-		 * keep track of file handles..
-		 *
-		 *    print "1111" >> "1.tmp"
-		 *    print "1111" > "1.tmp"
-		 */
-		if (p->type == (io_type | io_mask) && hawk_comp_oocstr(p->name, name, 0) == 0) break;
-		p = p->next;
-	}
+	/* look for the corresponding rio for name.
+	 *
+	 * the file "1.tmp", in the following code snippets,
+	 * would be opened by the first print statement, but not by
+	 * the second print statement. this is because
+	 * both HAWK_OUT_FILE and HAWK_OUT_APFILE are
+	 * translated to HAWK_RIO_FILE and it is used to
+	 * keep track of file handles..
+	 *
+	 *    print "1111" >> "1.tmp"
+	 *    print "1111" > "1.tmp"
+	 */
+	p = find_rio(rtx, io_type | io_mask, name);
 
 	/* if there is not corresponding rio for name, create one */
 	if (p == HAWK_NULL)
 	{
+		if (io_type == HAWK_RIO_FILE && make_room_for_outfile(rtx, handler) <= -1) return -1;
+
 		p = (hawk_rio_arg_t*)hawk_rtx_allocmem(rtx, HAWK_SIZEOF(hawk_rio_arg_t));
 		if (HAWK_UNLIKELY(!p)) return -1;
 
@@ -1112,14 +1235,35 @@ static int prepare_for_write_io_data (hawk_rtx_t* rtx, hawk_out_type_t out_type,
 		n = handler(rtx, HAWK_RIO_CMD_OPEN, p, HAWK_NULL, 0);
 		if (n <= -1)
 		{
-			hawk_rtx_freemem (rtx, p->name);
-			hawk_rtx_freemem (rtx, p);
+			free_rio (rtx, p);
 			return -1;
 		}
 
 		/* chain it */
-		p->next = rtx->rio.chain;
-		rtx->rio.chain = p;
+		if (HAWK_UNLIKELY(chain_rio(rtx, p) <= -1))
+		{
+			handler (rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0);
+			free_rio (rtx, p);
+			return -1;
+		}
+
+		if (IS_OUTFILE(p)) link_outfile (rtx, p);
+	}
+	else if (IS_OUTFILE(p))
+	{
+		if (p->evicted)
+		{
+			if (reopen_outfile(rtx, p, handler) <= -1) return -1;
+		}
+		else
+		{
+			rtx->rio.lru.hits++;
+			if (p != rtx->rio.lru.head)
+			{
+				unlink_outfile (rtx, p);
+				link_outfile (rtx, p);
+			}
+		}
 	}
 
 	if (p->out.eos) return 0; /* no more streams */
@@ -1186,7 +1330,7 @@ int hawk_rtx_writeiobytes (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 
 int hawk_rtx_flushio (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* name)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, io_mode, io_mask;
 	hawk_ooi_t n;
@@ -1209,22 +1353,38 @@ int hawk_rtx_flushio (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch
 		return -1;
 	}
 
-	/* look for the corresponding rio for name */
-	while (p)
+	/* look for the corresponding rio for name. without the check
+	 * for io_mode and p->mode, HAWK_OUT_FILE and HAWK_OUT_APFILE
+	 * matches the same entry since (io_type | io_mask) has the same
+	 * value for both. */
+	if (name)
 	{
-		/* without the check for io_mode and p->mode,
-		 * HAWK_OUT_FILE and HAWK_OUT_APFILE matches the
-		 * same entry since (io_type | io_mask) has the same value
-		 * for both. */
-		if (p->type == (io_type | io_mask) && p->mode == io_mode &&
-		    (name == HAWK_NULL || hawk_comp_oocstr(p->name, name, 0) == 0))
+		p = find_rio(rtx, io_type | io_mask, name);
+		if (p && p->mode == io_mode)
 		{
-			n = handler(rtx, HAWK_RIO_CMD_FLUSH, p, HAWK_NULL, 0);
-			if (n <= -1) return -1;
+			/* an evicted file has nothing left to flush */
+			if (!p->evicted)
+			{
+				n = handler(rtx, HAWK_RIO_CMD_FLUSH, p, HAWK_NULL, 0);
+				if (n <= -1) return -1;
+			}
 			ok = 1;
 		}
-
-		p = p->next;
+	}
+	else
+	{
+		for (p = rtx->rio.chain; p; p = p->next)
+		{
+			if (p->type == (io_type | io_mask) && p->mode == io_mode)
+			{
+				if (!p->evicted)
+				{
+					n = handler(rtx, HAWK_RIO_CMD_FLUSH, p, HAWK_NULL, 0);
+					if (n <= -1) return -1;
+				}
+				ok = 1;
+			}
+		}
 	}
 
 	if (ok) return 0;
@@ -1236,7 +1396,7 @@ int hawk_rtx_flushio (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch
 
 int hawk_rtx_nextio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t* name)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, /*io_mode,*/ io_mask;
 	hawk_ooi_t n;
@@ -1258,11 +1418,7 @@ int hawk_rtx_nextio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 		return -1;
 	}
 
-	while (p)
-	{
-		if (p->type == (io_type | io_mask) && hawk_comp_oocstr(p->name, name,  0) == 0) break;
-		p = p->next;
-	}
+	p = find_rio(rtx, io_type | io_mask, name);
 
 	if (!p)
 	{
@@ -1305,7 +1461,7 @@ int hawk_rtx_nextio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 
 int hawk_rtx_nextio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* name)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, /*io_mode,*/ io_mask;
 	hawk_ooi_t n;
@@ -1327,11 +1483,7 @@ int hawk_rtx_nextio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 		return -1;
 	}
 
-	while (p)
-	{
-		if (p->type == (io_type | io_mask) && hawk_comp_oocstr(p->name, name, 0) == 0) break;
-		p = p->next;
-	}
+	p = find_rio(rtx, io_type | io_mask, name);
 
 	if (!p)
 	{
@@ -1348,6 +1500,8 @@ int hawk_rtx_nextio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 		return 0;
 	}
 
+	if (p->evicted && reopen_outfile(rtx, p, handler) <= -1) return -1;
+
 	n = handler(rtx, HAWK_RIO_CMD_NEXT, p, HAWK_NULL, 0);
 	if (n <= -1) return -1;
 
@@ -1370,7 +1524,7 @@ int hawk_rtx_nextio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 
 int hawk_rtx_closio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_ooch_t* name)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain, * px = HAWK_NULL;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, /*io_mode,*/ io_mask;
 
@@ -1391,33 +1545,23 @@ int hawk_rtx_closio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 		return -1;
 	}
 
-	while (p)
+	p = find_rio(rtx, io_type | io_mask, name);
+	if (p)
 	{
-		if (p->type == (io_type | io_mask) && hawk_comp_oocstr(p->name, name, 0) == 0)
+		handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
+		if (handler)
 		{
-			hawk_rio_impl_t handler;
-
-			handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
-			if (handler)
+			if (handler (rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1)
 			{
-				if (handler (rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1)
-				{
-					/* this is not a rtx-time error.*/
-					hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EIOIMPL);
-					return -1;
-				}
+				/* this is not a rtx-time error.*/
+				hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EIOIMPL);
+				return -1;
 			}
-
-			if (px) px->next = p->next;
-			else rtx->rio.chain = p->next;
-
-			hawk_rtx_freemem (rtx, p->name);
-			hawk_rtx_freemem (rtx, p);
-			return 0;
 		}
 
-		px = p;
-		p = p->next;
+		unchain_rio (rtx, p);
+		free_rio (rtx, p);
+		return 0;
 	}
 
 	/* the name given is not found */
@@ -1427,7 +1571,7 @@ int hawk_rtx_closio_read (hawk_rtx_t* rtx, hawk_in_type_t in_type, const hawk_oo
 
 int hawk_rtx_closio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* name)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain, * px = HAWK_NULL;
+	hawk_rio_arg_t* p;
 	hawk_rio_impl_t handler;
 	int io_type, /*io_mode,*/ io_mask;
 
@@ -1448,25 +1592,15 @@ int hawk_rtx_closio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 		return -1;
 	}
 
-	while (p)
+	p = find_rio(rtx, io_type | io_mask, name);
+	if (p)
 	{
-		if (p->type == (io_type | io_mask) && hawk_comp_oocstr(p->name, name, 0) == 0)
-		{
-			hawk_rio_impl_t handler;
-
-			handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
-			if (handler && handler(rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1) return -1;
-
-			if (px) px->next = p->next;
-			else rtx->rio.chain = p->next;
-
-			hawk_rtx_freemem (rtx, p->name);
-			hawk_rtx_freemem (rtx, p);
-			return 0;
-		}
+		handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
+		if (handler && !p->evicted && handler(rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1) return -1;
 
-		px = p;
-		p = p->next;
+		unchain_rio (rtx, p);
+		free_rio (rtx, p);
+		return 0;
 	}
 
 	hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EIONMNF);
@@ -1475,87 +1609,84 @@ int hawk_rtx_closio_write (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk
 
 int hawk_rtx_closeio (hawk_rtx_t* rtx, const hawk_ooch_t* name, const hawk_ooch_t* opt)
 {
-	hawk_rio_arg_t* p = rtx->rio.chain, * px = HAWK_NULL;
+	hawk_htb_pair_t* pair;
+	hawk_rio_arg_t* p;
+
+	pair = hawk_htb_search(&rtx->rio.index, name, hawk_count_oocstr(name));
+	p = pair? (hawk_rio_arg_t*)HAWK_HTB_VPTR(pair): HAWK_NULL;
 
+	/* it handles the first that matches the given name
+	 * regardless of the io type. the streams of the same name
+	 * are listed in the same order as in the chain. */
 	while (p)
 	{
-		 /* it handles the first that matches the given name
-		  * regardless of the io type */
-		if (hawk_comp_oocstr(p->name, name, 0) == 0)
-		{
-			hawk_rio_impl_t handler;
-			hawk_rio_rwcmode_t rwcmode = HAWK_RIO_CMD_CLOSE_FULL;
+		hawk_rio_impl_t handler;
+		hawk_rio_rwcmode_t rwcmode = HAWK_RIO_CMD_CLOSE_FULL;
 
-			if (opt)
+		if (opt)
+		{
+			if (opt[0] == HAWK_T('r'))
 			{
-				if (opt[0] == HAWK_T('r'))
+				if (p->type & IO_MASK_RDWR)
 				{
-					if (p->type & IO_MASK_RDWR)
+					if (p->rwcstate != HAWK_RIO_CMD_CLOSE_WRITE)
 					{
-						if (p->rwcstate != HAWK_RIO_CMD_CLOSE_WRITE)
-						{
-							/* if the write end is not
-							 * closed, let io handler close
-							 * the read end only. */
-							rwcmode = HAWK_RIO_CMD_CLOSE_READ;
-						}
+						/* if the write end is not
+						 * closed, let io handler close
+						 * the read end only. */
+						rwcmode = HAWK_RIO_CMD_CLOSE_READ;
 					}
-					else if (!(p->type & IO_MASK_READ)) goto skip;
 				}
-				else
+				else if (!(p->type & IO_MASK_READ)) goto skip;
+			}
+			else
+			{
+				HAWK_ASSERT (opt[0] == HAWK_T('w'));
+				if (p->type & IO_MASK_RDWR)
 				{
-					HAWK_ASSERT (opt[0] == HAWK_T('w'));
-					if (p->type & IO_MASK_RDWR)
+					if (p->rwcstate != HAWK_RIO_CMD_CLOSE_READ)
 					{
-						if (p->rwcstate != HAWK_RIO_CMD_CLOSE_READ)
-						{
-							/* if the read end is not
-							 * closed, let io handler close
-							 * the write end only. */
-							rwcmode = HAWK_RIO_CMD_CLOSE_WRITE;
-						}
+						/* if the read end is not
+						 * closed, let io handler close
+						 * the write end only. */
+						rwcmode = HAWK_RIO_CMD_CLOSE_WRITE;
 					}
-					else if (!(p->type & IO_MASK_WRITE)) goto skip;
 				}
+				else if (!(p->type & IO_MASK_WRITE)) goto skip;
 			}
+		}
 
-			handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
-			if (handler)
+		handler = rtx->rio.handler[p->type & IO_MASK_CLEAR];
+		if (handler && !p->evicted)
+		{
+			p->rwcmode = rwcmode;
+			if (handler(rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1)
 			{
-				p->rwcmode = rwcmode;
-				if (handler(rtx, HAWK_RIO_CMD_CLOSE, p, HAWK_NULL, 0) <= -1)
-				{
-					/* this is not a run-time error.*/
-					return -1;
-				}
+				/* this is not a run-time error.*/
+				return -1;
 			}
+		}
 
-			if (p->type & IO_MASK_RDWR)
+		if (p->type & IO_MASK_RDWR)
+		{
+			p->rwcmode = rwcmode;
+			if (p->rwcstate == 0 && rwcmode != 0)
 			{
-				p->rwcmode = rwcmode;
-				if (p->rwcstate == 0 && rwcmode != 0)
-				{
-					/* if either end has not been closed.
-					 * return success without destroying
-					 * the internal node. rwcstate keeps
-					 * what has been successfully closed */
-					p->rwcstate = rwcmode;
-					return 0;
-				}
+				/* if either end has not been closed.
+				 * return success without destroying
+				 * the internal node. rwcstate keeps
+				 * what has been successfully closed */
+				p->rwcstate = rwcmode;
+				return 0;
 			}
-
-			if (px) px->next = p->next;
-			else rtx->rio.chain = p->next;
-
-			hawk_rtx_freemem (rtx, p->name);
-			hawk_rtx_freemem (rtx, p);
-
-			return 0;
 		}
 
+		unchain_rio (rtx, p);
+		free_rio (rtx, p);
+		return 0;
+
 	skip:
-		px = p;
-		p = p->next;
+		p = p->nnext;
 	}
 
 	hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EIONMNF);
@@ -1570,7 +1701,7 @@ void hawk_rtx_flushallios (hawk_rtx_t* rtx)
 	for (rio = rtx->rio.chain; rio; rio = rio->next)
 	{
 		handler = rtx->rio.handler[rio->type & IO_MASK_CLEAR];
-		if (handler)
+		if (handler && !rio->evicted)
 		{
 			handler (rtx, HAWK_RIO_CMD_FLUSH, rio, HAWK_NULL, 0);
 		}
@@ -1588,7 +1719,7 @@ void hawk_rtx_clearallios (hawk_rtx_t* rtx)
 		handler = rtx->rio.handler[rtx->rio.chain->type & IO_MASK_CLEAR];
 		next = rtx->rio.chain->next;
 
-		if (handler)
+		if (handler && !rtx->rio.chain->evicted)
 		{
 			rtx->rio.chain->rwcmode = 0;
 			n = handler(rtx, HAWK_RIO_CMD_CLOSE, rtx->rio.chain, HAWK_NULL, 0);
@@ -1598,9 +1729,12 @@ void hawk_rtx_clearallios (hawk_rtx_t* rtx)
 			}
 		}
 
-		hawk_rtx_freemem (rtx, rtx->rio.chain->name);
-		hawk_rtx_freemem (rtx, rtx->rio.chain);
-
+		free_rio (rtx, rtx->rio.chain);
 		rtx->rio.chain = next;
 	}
+
+	hawk_htb_clear (&rtx->rio.index);
+	rtx->rio.lru.head = HAWK_NULL;
+	rtx->rio.lru.tail = HAWK_NULL;
+	rtx->rio.lru.count = 0;
 }
@@ -109,6 +109,14 @@ enum hawk_incop_type_t
 extern "C" {
 #endif
 
+/**
+ * The hawk_rtx_splitrec() function splits the rest of the input record
+ * if it has been split partially.
+ */
+int hawk_rtx_splitrec (
+	hawk_rtx_t* rtx
+);
+
 hawk_ooch_t* hawk_rtx_format (
 	hawk_rtx_t*        rtx,
 	hawk_ooecs_t*      out,
@@ -139,6 +147,12 @@ int hawk_rtx_cmpval (
 );
 
 
+/* initializes a module for a runtime context unless it's done already */
+int hawk_rtx_initmodule (
+	hawk_rtx_t* rtx,
+	hawk_mod_t* mod
+);
+
 hawk_val_t* hawk_rtx_evalcall (
 	hawk_rtx_t* rtx,
 	hawk_nde_fncall_t* call,
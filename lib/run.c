@@ -76,6 +76,8 @@ static hawk_oow_t push_arg_from_nde (hawk_rtx_t* rtx, hawk_nde_fncall_t* call, v
 
 static int init_rtx (hawk_rtx_t* rtx, hawk_t* hawk, hawk_rio_cbs_t* rio);
 static void fini_rtx (hawk_rtx_t* rtx, int fini_globals);
+static void clear_rexcache (hawk_rtx_t* rtx);
+static void clear_fmtcache (hawk_rtx_t* rtx);
 
 static int init_globals (hawk_rtx_t* rtx);
 static void refdown_globals (hawk_rtx_t* run, int pop);
@@ -179,10 +181,12 @@ static hawk_val_t* eval_pos (hawk_rtx_t* rtx, hawk_nde_t* nde);
 static hawk_val_t* eval_getline (hawk_rtx_t* rtx, hawk_nde_t* nde);
 static hawk_val_t* eval_print (hawk_rtx_t* rtx, hawk_nde_t* nde);
 static hawk_val_t* eval_printf (hawk_rtx_t* rtx, hawk_nde_t* nde);
+static hawk_val_t* eval_code (hawk_rtx_t* rtx, hawk_nde_t* nde);
 
 static int read_record (hawk_rtx_t* rtx);
 
 static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t* buf, hawk_oow_t* len, hawk_nde_t** remidx, hawk_int_t* firstidxint);
+static hawk_ooch_t* idxnde_to_key (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t* buf, hawk_val_map_key_t* key, hawk_nde_t** remidx);
 static hawk_ooi_t idxnde_to_int (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_nde_t** remidx);
 
 typedef hawk_val_t* (*binop_func_t) (hawk_rtx_t* rtx, hawk_val_t* left, hawk_val_t* right);
@@ -206,6 +210,8 @@ HAWK_INLINE hawk_val_t* hawk_rtx_getarg (hawk_rtx_t* rtx, hawk_oow_t idx)
 HAWK_INLINE hawk_val_t* hawk_rtx_getgbl (hawk_rtx_t* rtx, int id)
 {
 	HAWK_ASSERT (id >= 0 && id < (int)HAWK_ARR_SIZE(rtx->hawk->parse.gbls));
+	/* NF is not known until the record is split to the end */
+	if (HAWK_UNLIKELY(id == HAWK_GBL_NF && rtx->inrec.split.pending)) hawk_rtx_splitrec (rtx);
 	return HAWK_RTX_STACK_GBL(rtx, id);
 }
 
@@ -371,6 +377,9 @@ static int set_global (hawk_rtx_t* rtx, int idx, hawk_nde_var_t* var, hawk_val_t
 			 * regular expression can not be an assigned value */
 			HAWK_ASSERT (vtype != HAWK_VAL_REX);
 
+			/* the current record may be still being split with the old FS */
+			if (rtx->inrec.split.pending && hawk_rtx_splitrec(rtx) <= -1) return -1;
+
 			fs_ptr = hawk_rtx_getvaloocstr(rtx, val, &fs_len);
 			if (HAWK_UNLIKELY(!fs_ptr)) return -1;
 
@@ -427,6 +436,8 @@ static int set_global (hawk_rtx_t* rtx, int idx, hawk_nde_var_t* var, hawk_val_t
 				return -1;
 			}
 
+			if (rtx->inrec.split.pending && hawk_rtx_splitrec(rtx) <= -1) return -1;
+
 			if (lv < (hawk_int_t)rtx->inrec.nflds || (assign && lv == (hawk_int_t)rtx->inrec.nflds))
 			{
 				/* when NF is assigned a value, it should rebuild $X values.
@@ -794,59 +805,112 @@ hawk_htb_t* hawk_rtx_getnvmap (hawk_rtx_t* rtx)
 	return rtx->named;
 }
 
-struct module_init_ctx_t
+static hawk_rtx_modinst_t* find_modinst (hawk_rtx_t* rtx, hawk_mod_t* mod)
 {
-	hawk_oow_t count;
-	hawk_rtx_t* rtx;
-};
+	hawk_oow_t i;
 
-struct module_fini_ctx_t
-{
-	hawk_oow_t limit;
-	hawk_oow_t count;
-	hawk_rtx_t* rtx;
-};
+	/* a runtime context uses a few modules. a linear search is enough */
+	for (i = 0; i < rtx->modinst.count; i++)
+	{
+		if (rtx->modinst.ptr[i].mod == mod) return &rtx->modinst.ptr[i];
+	}
 
-static hawk_rbt_walk_t init_module (hawk_rbt_t* rbt, hawk_rbt_pair_t* pair, void* ctx)
+	return HAWK_NULL;
+}
+
+int hawk_rtx_initmodule (hawk_rtx_t* rtx, hawk_mod_t* mod)
 {
-	hawk_mod_data_t* md;
-	struct module_init_ctx_t* mic;
+	hawk_rtx_modinst_t* mi;
 
-	mic = (struct module_init_ctx_t*)ctx;
+	if (find_modinst(rtx, mod)) return 0;
 
-	md = (hawk_mod_data_t*)HAWK_RBT_VPTR(pair);
-	if (md->mod.init && md->mod.init(&md->mod, mic->rtx) <= -1)
-		return HAWK_RBT_WALK_STOP;
+	if (rtx->modinst.count >= rtx->modinst.capa)
+	{
+		hawk_rtx_modinst_t* tmp;
+		hawk_oow_t newcapa;
+
+		newcapa = HAWK_ALIGN_POW2(rtx->modinst.count + 1, 8);
+		tmp = (hawk_rtx_modinst_t*)hawk_rtx_reallocmem(rtx, rtx->modinst.ptr, HAWK_SIZEOF(*tmp) * newcapa);
+		if (HAWK_UNLIKELY(!tmp)) return -1;
+
+		rtx->modinst.ptr = tmp;
+		rtx->modinst.capa = newcapa;
+	}
+
+	/* add the entry before init() so that init() can attach the instance data */
+	mi = &rtx->modinst.ptr[rtx->modinst.count++];
+	mi->mod = mod;
+	mi->inst = HAWK_NULL;
+
+	if (mod->init && mod->init(mod, rtx) <= -1)
+	{
+		rtx->modinst.count--;
+		return -1;
+	}
 
-	mic->count++;
-	return HAWK_RBT_WALK_FORWARD;
+	return 0;
 }
 
-static hawk_rbt_walk_t fini_module (hawk_rbt_t* rbt, hawk_rbt_pair_t* pair, void* ctx)
+static void fini_modules (hawk_rtx_t* rtx)
 {
-	hawk_mod_data_t* md;
-	struct module_fini_ctx_t* mfc;
+	/* finalize the modules in the reverse order of initialization */
+	while (rtx->modinst.count > 0)
+	{
+		hawk_mod_t* mod;
+
+		mod = rtx->modinst.ptr[rtx->modinst.count - 1].mod;
+		if (mod->fini) mod->fini (mod, rtx);
+		rtx->modinst.count--;
+	}
 
-	mfc = (struct module_fini_ctx_t*)ctx;
+	if (rtx->modinst.ptr)
+	{
+		hawk_rtx_freemem (rtx, rtx->modinst.ptr);
+		rtx->modinst.ptr = HAWK_NULL;
+		rtx->modinst.capa = 0;
+	}
+}
 
-	if (mfc->limit > 0 && mfc->count >= mfc->limit)
-		return HAWK_RBT_WALK_STOP;
+static hawk_rbt_walk_t init_module (hawk_rbt_t* rbt, hawk_rbt_pair_t* pair, void* ctx)
+{
+	hawk_rtx_t* rtx = (hawk_rtx_t*)ctx;
+	hawk_mod_data_t* md;
 
 	md = (hawk_mod_data_t*)HAWK_RBT_VPTR(pair);
-	if (md->mod.fini) md->mod.fini (&md->mod, mfc->rtx);
+	return (hawk_rtx_initmodule(rtx, &md->mod) <= -1)? HAWK_RBT_WALK_STOP: HAWK_RBT_WALK_FORWARD;
+}
+
+void* hawk_rtx_getmodinst (hawk_rtx_t* rtx, hawk_mod_t* mod)
+{
+	hawk_rtx_modinst_t* mi;
+	mi = find_modinst(rtx, mod);
+	return mi? mi->inst: HAWK_NULL;
+}
+
+int hawk_rtx_setmodinst (hawk_rtx_t* rtx, hawk_mod_t* mod, void* inst)
+{
+	hawk_rtx_modinst_t* mi;
+
+	mi = find_modinst(rtx, mod);
+	if (!mi)
+	{
+		/* the module has not been initialized for this runtime context */
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ENOENT);
+		return -1;
+	}
 
-	mfc->count++;
-	return HAWK_RBT_WALK_FORWARD;
+	mi->inst = inst;
+	return 0;
 }
 
 hawk_rtx_t* hawk_rtx_open (hawk_t* hawk, hawk_oow_t xtnsize, hawk_rio_cbs_t* rio)
 {
 	hawk_rtx_t* rtx;
-	struct module_init_ctx_t mic;
-	hawk_oow_t i;
+	hawk_oow_t i, nmods;
 
-	/* clear the hawk error code */
-	hawk_seterrnum (hawk, HAWK_NULL, HAWK_ENOERR);
+	/* clear the hawk error code. the runtime contexts of a frozen
+	 * hawk object can be opened on multiple threads. leave it alone */
+	if (!hawk->frozen) hawk_seterrnum (hawk, HAWK_NULL, HAWK_ENOERR);
 
 	/* check if the code has ever been parsed */
 	if (hawk->tree.ngbls == 0 &&
@@ -890,19 +954,15 @@ hawk_rtx_t* hawk_rtx_open (hawk_t* hawk, hawk_oow_t xtnsize, hawk_rio_cbs_t* rio
 		return HAWK_NULL;
 	}
 
-	mic.count = 0;
-	mic.rtx = rtx;
-	hawk_rbt_walk (rtx->hawk->modtab, init_module, &mic);
-	if (mic.count != HAWK_RBT_SIZE(rtx->hawk->modtab))
+	/* another runtime context may load a module at the same time */
+	hawk_mtx_lock (&hawk->mtx, HAWK_NULL);
+	hawk_rbt_walk (hawk->modtab, init_module, rtx);
+	nmods = HAWK_RBT_SIZE(hawk->modtab);
+	hawk_mtx_unlock (&hawk->mtx);
+	if (rtx->modinst.count != nmods)
 	{
-		if (mic.count > 0)
-		{
-			struct module_fini_ctx_t mfc;
-			mfc.limit = mic.count;
-			mfc.count = 0;
-			hawk_rbt_walk (rtx->hawk->modtab, fini_module, &mfc);
-		}
-
+		hawk_rtx_errortohawk (rtx, hawk);
+		fini_modules (rtx);
 		fini_rtx (rtx, 1);
 		hawk_freemem (hawk, rtx);
 		return HAWK_NULL;
@@ -934,12 +994,8 @@ hawk_rtx_t* hawk_rtx_open (hawk_t* hawk, hawk_oow_t xtnsize, hawk_rio_cbs_t* rio
 void hawk_rtx_close (hawk_rtx_t* rtx)
 {
 	hawk_rtx_ecb_t* ecb, * ecb_next;
-	struct module_fini_ctx_t mfc;
 
-	mfc.limit = 0;
-	mfc.count = 0;
-	mfc.rtx = rtx;
-	hawk_rbt_walk (rtx->hawk->modtab, fini_module, &mfc);
+	fini_modules (rtx);
 
 	for (ecb = rtx->ecb; ecb != (hawk_rtx_ecb_t*)rtx; ecb = ecb_next)
 	{
@@ -1044,7 +1100,11 @@ static int init_rtx (hawk_rtx_t* rtx, hawk_t* hawk, hawk_rio_cbs_t* rio)
 	};
 	hawk_oow_t stack_limit, i;
 
+	/* the error fields of a frozen hawk object get updated by
+	 * other runtime contexts under the lock */
+	hawk_mtx_lock (&hawk->mtx, HAWK_NULL);
 	rtx->_gem = hawk->_gem;
+	hawk_mtx_unlock (&hawk->mtx);
 	rtx->hawk = hawk;
 
 	CLRERR (rtx);
@@ -1078,12 +1138,38 @@ static int init_rtx (hawk_rtx_t* rtx, hawk_t* hawk, hawk_rio_cbs_t* rio)
 
 	rtx->gc.pressure[i] = 0; /* pressure is larger than other elements by 1 in size */
 
+	rtx->gc.inc.phase = GC_INC_IDLE;
+	rtx->gc.inc.todo.gc_next = &rtx->gc.inc.todo;
+	rtx->gc.inc.todo.gc_prev = &rtx->gc.inc.todo;
+	rtx->gc.inc.done.gc_next = &rtx->gc.inc.done;
+	rtx->gc.inc.done.gc_prev = &rtx->gc.inc.done;
+	rtx->gc.inc.reach.gc_next = &rtx->gc.inc.reach;
+	rtx->gc.inc.reach.gc_prev = &rtx->gc.inc.reach;
+	rtx->gc.inc.work = hawk->opt.rtx_gc_slice_work;
+	rtx->gc.inc.time = hawk->opt.rtx_gc_slice_time;
+	rtx->gc.inc.debt = 0;
+	rtx->gc.inc.pay = 0;
+
+	rtx->arena.active = 0;
+	rtx->arena.capa = hawk->opt.rtx_arena_size;
+	rtx->arena.cur = HAWK_NULL;
+	rtx->arena.spare = HAWK_NULL;
+	rtx->arena.pinned.prev = &rtx->arena.pinned;
+	rtx->arena.pinned.next = &rtx->arena.pinned;
+
+	HAWK_MEMSET (&rtx->rexcache, 0, HAWK_SIZEOF(rtx->rexcache));
+	HAWK_MEMSET (&rtx->fmtcache, 0, HAWK_SIZEOF(rtx->fmtcache));
+	HAWK_MEMSET (&rtx->rio.lru, 0, HAWK_SIZEOF(rtx->rio.lru));
+	rtx->rio.lru.max = hawk->opt.rtx_max_open_outfiles;
+
 	rtx->inrec.buf_pos = 0;
 	rtx->inrec.buf_len = 0;
 	rtx->inrec.flds = HAWK_NULL;
 	rtx->inrec.nflds = 0;
 	rtx->inrec.maxflds = 0;
 	rtx->inrec.d0 = hawk_val_nil;
+	rtx->inrec.split.max = hawk->tree.dynfld? HAWK_TYPE_MAX(hawk_oow_t): hawk->tree.maxfld;
+	rtx->inrec.split.pending = 0;
 
 	if (HAWK_UNLIKELY(hawk_ooecs_init(&rtx->inrec.line, hawk_rtx_getgem(rtx), DEF_BUF_CAPA) <= -1)) goto oops_1;
 	if (HAWK_UNLIKELY(hawk_ooecs_init(&rtx->inrec.linew, hawk_rtx_getgem(rtx), DEF_BUF_CAPA) <= -1)) goto oops_2;
@@ -1097,27 +1183,30 @@ static int init_rtx (hawk_rtx_t* rtx, hawk_t* hawk, hawk_rio_cbs_t* rio)
 
 	if (HAWK_UNLIKELY(hawk_becs_init(&rtx->fnc.bout, hawk_rtx_getgem(rtx), 256) <= -1)) goto oops_9;
 	if (HAWK_UNLIKELY(hawk_ooecs_init(&rtx->fnc.oout, hawk_rtx_getgem(rtx), 256) <= -1)) goto oops_10;
+	if (HAWK_UNLIKELY(hawk_ooecs_init(&rtx->print.line, hawk_rtx_getgem(rtx), 256) <= -1)) goto oops_11;
+	if (HAWK_UNLIKELY(hawk_htb_init(&rtx->rio.index, hawk_rtx_getgem(rtx), 64, 70, HAWK_SIZEOF(hawk_ooch_t), 1) <= -1)) goto oops_12;
+	hawk_htb_setstyle (&rtx->rio.index, hawk_get_htb_style(HAWK_HTB_STYLE_INLINE_KEY_COPIER));
 
 
 	rtx->named = hawk_htb_open(hawk_rtx_getgem(rtx), HAWK_SIZEOF(rtx), 1024, 70, HAWK_SIZEOF(hawk_ooch_t), 1);
-	if (HAWK_UNLIKELY(!rtx->named)) goto oops_11;
+	if (HAWK_UNLIKELY(!rtx->named)) goto oops_13;
 	*(hawk_rtx_t**)hawk_htb_getxtn(rtx->named) = rtx;
 	hawk_htb_setstyle (rtx->named, &style_for_named);
 
 	rtx->format.tmp.ptr = (hawk_ooch_t*)hawk_rtx_allocmem(rtx, 4096 * HAWK_SIZEOF(hawk_ooch_t));
-	if (HAWK_UNLIKELY(!rtx->format.tmp.ptr)) goto oops_12; /* the error is set on the hawk object after this jump is made */
+	if (HAWK_UNLIKELY(!rtx->format.tmp.ptr)) goto oops_14; /* the error is set on the hawk object after this jump is made */
 	rtx->format.tmp.len = 4096;
 	rtx->format.tmp.inc = 4096 * 2;
 
 	rtx->formatmbs.tmp.ptr = (hawk_bch_t*)hawk_rtx_allocmem(rtx, 4096 * HAWK_SIZEOF(hawk_bch_t));
-	if (HAWK_UNLIKELY(!rtx->formatmbs.tmp.ptr)) goto oops_13;
+	if (HAWK_UNLIKELY(!rtx->formatmbs.tmp.ptr)) goto oops_15;
 	rtx->formatmbs.tmp.len = 4096;
 	rtx->formatmbs.tmp.inc = 4096 * 2;
 
 	if (rtx->hawk->tree.chain_size > 0)
 	{
 		rtx->pattern_range_state = (hawk_oob_t*)hawk_rtx_allocmem(rtx, rtx->hawk->tree.chain_size * HAWK_SIZEOF(hawk_oob_t));
-		if (HAWK_UNLIKELY(!rtx->pattern_range_state)) goto oops_14;
+		if (HAWK_UNLIKELY(!rtx->pattern_range_state)) goto oops_16;
 		HAWK_MEMSET (rtx->pattern_range_state, 0, rtx->hawk->tree.chain_size * HAWK_SIZEOF(hawk_oob_t));
 	}
 	else rtx->pattern_range_state = HAWK_NULL;
@@ -1141,12 +1230,16 @@ static int init_rtx (hawk_rtx_t* rtx, hawk_t* hawk, hawk_rio_cbs_t* rio)
 
 	return 0;
 
-oops_14:
+oops_16:
 	hawk_rtx_freemem (rtx, rtx->formatmbs.tmp.ptr);
-oops_13:
+oops_15:
 	hawk_rtx_freemem (rtx, rtx->format.tmp.ptr);
-oops_12:
+oops_14:
 	hawk_htb_close (rtx->named);
+oops_13:
+	hawk_htb_fini (&rtx->rio.index);
+oops_12:
+	hawk_ooecs_fini (&rtx->print.line);
 oops_11:
 	hawk_ooecs_fini (&rtx->fnc.oout);
 oops_10:
@@ -1193,6 +1286,7 @@ static void fini_rtx (hawk_rtx_t* rtx, int fini_globals)
 	/* TODO: what if this operation fails? */
 	hawk_rtx_clearallios (rtx);
 	HAWK_ASSERT (rtx->rio.chain == HAWK_NULL);
+	hawk_htb_fini (&rtx->rio.index);
 
 	if (rtx->gbl.rs[0])
 	{
@@ -1207,6 +1301,9 @@ static void fini_rtx (hawk_rtx_t* rtx, int fini_globals)
 		rtx->gbl.fs[1] = HAWK_NULL;
 	}
 
+	clear_rexcache (rtx);
+	clear_fmtcache (rtx);
+
 	if (rtx->gbl.convfmt.ptr != HAWK_NULL &&
 	    rtx->gbl.convfmt.ptr != DEFAULT_CONVFMT)
 	{
@@ -1248,6 +1345,7 @@ static void fini_rtx (hawk_rtx_t* rtx, int fini_globals)
 		rtx->gbl.subsep.len = 0;
 	}
 
+	hawk_ooecs_fini (&rtx->print.line);
 	hawk_ooecs_fini (&rtx->fnc.oout);
 	hawk_becs_fini (&rtx->fnc.bout);
 
@@ -1339,6 +1437,8 @@ static void fini_rtx (hawk_rtx_t* rtx, int fini_globals)
 	hawk_rtx_freevalchunk (rtx, rtx->vmgr.rchunk);
 	rtx->vmgr.ichunk = HAWK_NULL;
 	rtx->vmgr.rchunk = HAWK_NULL;
+
+	hawk_rtx_finiarena (rtx);
 }
 
 static int update_fnr (hawk_rtx_t* rtx, hawk_int_t fnr, hawk_int_t nr)
@@ -1517,7 +1617,7 @@ static void capture_retval_on_exit (void* arg)
 	hawk_rtx_refupval (data->rtx, data->val);
 }
 
-static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx)
+static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx, int phases)
 {
 	hawk_nde_t* nde;
 	hawk_oow_t nargs, i;
@@ -1529,7 +1629,7 @@ static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx)
 	HAWK_RTX_STACK_NARGS(rtx) = (void*)nargs;
 
 	/* execute the BEGIN block */
-	for (nde = rtx->hawk->tree.begin;
+	for (nde = ((phases & HAWK_RTX_PHASE_BEGIN)? rtx->hawk->tree.begin: HAWK_NULL);
 	     ret == 0 && nde != HAWK_NULL && rtx->exit_level < EXIT_GLOBAL;
 	     nde = nde->next)
 	{
@@ -1554,7 +1654,7 @@ static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx)
 	}
 
 	/* run pattern block loops */
-	if (ret == 0 &&
+	if (ret == 0 && (phases & HAWK_RTX_PHASE_MAIN) &&
 	    (rtx->hawk->tree.chain != HAWK_NULL ||
 	     rtx->hawk->tree.end != HAWK_NULL) &&
 	     rtx->exit_level < EXIT_GLOBAL)
@@ -1574,7 +1674,7 @@ static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx)
 
 	/* execute END blocks. the first END block is executed if the
 	 * program is not explicitly aborted with hawk_rtx_halt().*/
-	for (nde = rtx->hawk->tree.end;
+	for (nde = ((phases & HAWK_RTX_PHASE_END)? rtx->hawk->tree.end: HAWK_NULL);
 	     ret == 0 && nde != HAWK_NULL && rtx->exit_level < EXIT_ABORT;
 	     nde = nde->next)
 	{
@@ -1627,6 +1727,11 @@ static hawk_val_t* run_bpae_loop (hawk_rtx_t* rtx)
 
 /* start the BEGIN-pattern block-END loop */
 hawk_val_t* hawk_rtx_loop (hawk_rtx_t* rtx)
+{
+	return hawk_rtx_loopwithphases(rtx, HAWK_RTX_PHASE_ALL);
+}
+
+hawk_val_t* hawk_rtx_loopwithphases (hawk_rtx_t* rtx, int phases)
 {
 	hawk_val_t* retv = HAWK_NULL;
 	hawk_oow_t saved_stack_top;
@@ -1654,7 +1759,7 @@ hawk_val_t* hawk_rtx_loop (hawk_rtx_t* rtx)
 	rtx->stack_base = saved_stack_top; /* let the stack top remembered be the base of a new stack frame */
 
 	/* run the BEGIN/pattern-action/END loop */
-	retv = run_bpae_loop(rtx);
+	retv = run_bpae_loop(rtx, phases);
 
 	/* exit the stack frame */
 	HAWK_ASSERT ((rtx->stack_top - rtx->stack_base) == 4); /* at this point, the current stack frame should have the 4 entries pushed above */
@@ -1704,12 +1809,333 @@ hawk_val_t* hawk_rtx_execwithbcstrarr (hawk_rtx_t* rtx, const hawk_bch_t* args[]
 	return v;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* a map value referencing itself must not make the copy loop forever */
+#define REDUCE_DEPTH_MAX 256
+
+static void dispose_val (hawk_rtx_t* rtx, hawk_val_t* val)
+{
+	hawk_rtx_refupval (rtx, val);
+	hawk_rtx_refdownval (rtx, val);
+}
+
+static void copy_err_from (hawk_rtx_t* rtx, hawk_rtx_t* from)
+{
+	hawk_errinf_t ei;
+	hawk_rtx_geterrinf (from, &ei);
+	hawk_rtx_seterrinf (rtx, &ei);
+}
+
+/* copy a value in the runtime context 'from' to a new value in 'rtx' */
+static hawk_val_t* copy_val_from (hawk_rtx_t* rtx, hawk_rtx_t* from, hawk_val_t* val, int depth)
+{
+	hawk_val_t* v, * e;
+
+	if (depth >= REDUCE_DEPTH_MAX)
+	{
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ESTACK);
+		return HAWK_NULL;
+	}
+
+	switch (HAWK_RTX_GETVALTYPE(from, val))
+	{
+		case HAWK_VAL_NIL:
+			return hawk_val_nil;
+
+		case HAWK_VAL_CHAR:
+			return hawk_rtx_makecharval(rtx, HAWK_RTX_GETCHARFROMVAL(from, val));
+
+		case HAWK_VAL_BCHR:
+			return hawk_rtx_makebchrval(rtx, HAWK_RTX_GETBCHRFROMVAL(from, val));
+
+		case HAWK_VAL_INT:
+			return hawk_rtx_makeintval(rtx, HAWK_RTX_GETINTFROMVAL(from, val));
+
+		case HAWK_VAL_FLT:
+			return hawk_rtx_makefltval(rtx, ((hawk_val_flt_t*)val)->val);
+
+		case HAWK_VAL_STR:
+			return val->v_nstr?
+				hawk_rtx_makenstrvalwithoochars(rtx, ((hawk_val_str_t*)val)->val.ptr, ((hawk_val_str_t*)val)->val.len):
+				hawk_rtx_makestrvalwithoochars(rtx, ((hawk_val_str_t*)val)->val.ptr, ((hawk_val_str_t*)val)->val.len);
+
+		case HAWK_VAL_MBS:
+			return hawk_rtx_makembsvalwithbchars(rtx, ((hawk_val_mbs_t*)val)->val.ptr, ((hawk_val_mbs_t*)val)->val.len);
+
+		case HAWK_VAL_FUN:
+			/* both runtime contexts share the same program */
+			return hawk_rtx_makefunval(rtx, ((hawk_val_fun_t*)val)->fun);
+
+		case HAWK_VAL_MAP:
+		{
+			hawk_val_map_itr_t itr, * iptr;
+			const hawk_oocs_t* key;
+
+			v = hawk_rtx_makemapval(rtx);
+			if (HAWK_UNLIKELY(!v)) return HAWK_NULL;
+			hawk_rtx_refupval (rtx, v);
+
+			iptr = hawk_rtx_getfirstmapvalitr(from, val, &itr);
+			while (iptr)
+			{
+				key = HAWK_VAL_MAP_ITR_KEY(iptr);
+				e = copy_val_from(rtx, from, (hawk_val_t*)HAWK_VAL_MAP_ITR_VAL(iptr), depth + 1);
+				if (HAWK_UNLIKELY(!e)) goto oops;
+				if (HAWK_UNLIKELY(!hawk_rtx_setmapvalfld(rtx, v, key->ptr, key->len, e)))
+				{
+					dispose_val (rtx, e);
+					goto oops;
+				}
+				iptr = hawk_rtx_getnextmapvalitr(from, val, iptr);
+			}
+
+			hawk_rtx_refdownval_nofree (rtx, v);
+			return v;
+		}
+
+		case HAWK_VAL_ARR:
+		{
+			hawk_arr_t* arr;
+			hawk_oow_t i;
+
+			arr = ((hawk_val_arr_t*)val)->arr;
+			v = hawk_rtx_makearrval(rtx, HAWK_ARR_SIZE(arr));
+			if (HAWK_UNLIKELY(!v)) return HAWK_NULL;
+			hawk_rtx_refupval (rtx, v);
+
+			for (i = 0; i < HAWK_ARR_SIZE(arr); i++)
+			{
+				if (!HAWK_ARR_SLOT(arr, i)) continue;
+				e = copy_val_from(rtx, from, (hawk_val_t*)HAWK_ARR_DPTR(arr, i), depth + 1);
+				if (HAWK_UNLIKELY(!e)) goto oops;
+				if (HAWK_UNLIKELY(!hawk_rtx_setarrvalfld(rtx, v, i, e)))
+				{
+					dispose_val (rtx, e);
+					goto oops;
+				}
+			}
+
+			hawk_rtx_refdownval_nofree (rtx, v);
+			return v;
+		}
+
+		default:
+			/* a regular expression and a reference can't be carried over */
+			hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
+			return HAWK_NULL;
+	}
+
+oops:
+	hawk_rtx_refdownval (rtx, v);
+	return HAWK_NULL;
+}
+
+/* merge the value 'sv' in 'from' into the value 'dv' in 'rtx'. a map is
+ * updated in place and returned. for a scalar, a new value is returned
+ * unless 'dv' is kept as it is. */
+static int reduce_val (hawk_rtx_t* rtx, hawk_rtx_t* from, hawk_reduce_op_t op, hawk_val_t* dv, hawk_val_t* sv, hawk_val_t** rv, int depth)
+{
+	hawk_val_type_t dvt, svt;
+	hawk_val_t* nv;
+
+	dvt = HAWK_RTX_GETVALTYPE(rtx, dv);
+	svt = HAWK_RTX_GETVALTYPE(from, sv);
+
+	if (svt == HAWK_VAL_NIL)
+	{
+		*rv = dv;
+		return 0;
+	}
+
+	if (dvt == HAWK_VAL_NIL)
+	{
+		*rv = copy_val_from(rtx, from, sv, depth);
+		return *rv? 0: -1;
+	}
+
+	if (dvt == HAWK_VAL_MAP && svt == HAWK_VAL_MAP)
+	{
+		hawk_val_map_itr_t itr, * iptr;
+		const hawk_oocs_t* key;
+		hawk_val_t* sev, * dev;
+
+		if (depth >= REDUCE_DEPTH_MAX)
+		{
+			hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ESTACK);
+			return -1;
+		}
+
+		iptr = hawk_rtx_getfirstmapvalitr(from, sv, &itr);
+		while (iptr)
+		{
+			key = HAWK_VAL_MAP_ITR_KEY(iptr);
+			sev = (hawk_val_t*)HAWK_VAL_MAP_ITR_VAL(iptr);
+
+			dev = hawk_rtx_getmapvalfld(rtx, dv, key->ptr, key->len);
+			if (!dev)
+			{
+				nv = copy_val_from(rtx, from, sev, depth + 1);
+				if (HAWK_UNLIKELY(!nv)) return -1;
+			}
+			else
+			{
+				if (reduce_val(rtx, from, op, dev, sev, &nv, depth + 1) <= -1) return -1;
+			}
+
+			if (nv != dev && HAWK_UNLIKELY(!hawk_rtx_setmapvalfld(rtx, dv, key->ptr, key->len, nv)))
+			{
+				dispose_val (rtx, nv);
+				return -1;
+			}
+
+			iptr = hawk_rtx_getnextmapvalitr(from, sv, iptr);
+		}
+
+		*rv = dv;
+		return 0;
+	}
+
+	if (dvt == HAWK_VAL_MAP || dvt == HAWK_VAL_ARR)
+	{
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ENONSCATOSCALAR);
+		return -1;
+	}
+	if (svt == HAWK_VAL_MAP || svt == HAWK_VAL_ARR)
+	{
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ESCALARTONONSCA);
+		return -1;
+	}
+
+	switch (op)
+	{
+		case HAWK_REDUCE_SUM:
+		{
+			hawk_int_t l1, l2;
+			hawk_flt_t r1, r2;
+			int n1, n2;
+
+			n1 = hawk_rtx_valtonum(rtx, dv, &l1, &r1);
+			if (n1 <= -1) return -1;
+			n2 = hawk_rtx_valtonum(from, sv, &l2, &r2);
+			if (n2 <= -1)
+			{
+				copy_err_from (rtx, from);
+				return -1;
+			}
+
+			nv = (n1 == 0 && n2 == 0)?
+				hawk_rtx_makeintval(rtx, l1 + l2):
+				hawk_rtx_makefltval(rtx, ((n1 == 0)? (hawk_flt_t)l1: r1) + ((n2 == 0)? (hawk_flt_t)l2: r2));
+			if (HAWK_UNLIKELY(!nv)) return -1;
+			break;
+		}
+
+		case HAWK_REDUCE_MIN:
+		case HAWK_REDUCE_MAX:
+		{
+			int n;
+
+			nv = copy_val_from(rtx, from, sv, depth);
+			if (HAWK_UNLIKELY(!nv)) return -1;
+
+			hawk_rtx_refupval (rtx, nv);
+			if (hawk_rtx_cmpval(rtx, dv, nv, &n) <= -1)
+			{
+				hawk_rtx_refdownval (rtx, nv);
+				return -1;
+			}
+
+			if ((op == HAWK_REDUCE_MIN && n > 0) || (op == HAWK_REDUCE_MAX && n < 0))
+			{
+				hawk_rtx_refdownval_nofree (rtx, nv);
+			}
+			else
+			{
+				hawk_rtx_refdownval (rtx, nv);
+				nv = dv;
+			}
+			break;
+		}
+
+		case HAWK_REDUCE_CONCAT:
+		{
+			hawk_ooch_t* p1, * p2;
+			hawk_oow_t l1, l2;
+
+			p1 = hawk_rtx_getvaloocstr(rtx, dv, &l1);
+			if (HAWK_UNLIKELY(!p1)) return -1;
+			p2 = hawk_rtx_getvaloocstr(from, sv, &l2);
+			if (HAWK_UNLIKELY(!p2))
+			{
+				copy_err_from (rtx, from);
+				hawk_rtx_freevaloocstr (rtx, dv, p1);
+				return -1;
+			}
+
+			nv = hawk_rtx_makestrvalwithoochars2(rtx, p1, l1, p2, l2);
+			hawk_rtx_freevaloocstr (from, sv, p2);
+			hawk_rtx_freevaloocstr (rtx, dv, p1);
+			if (HAWK_UNLIKELY(!nv)) return -1;
+			break;
+		}
+
+		default: /* HAWK_REDUCE_UNION */
+			/* the value set first is kept */
+			nv = dv;
+			break;
+	}
+
+	*rv = nv;
+	return 0;
+}
+
+int hawk_rtx_reduce (hawk_rtx_t* rtx, hawk_rtx_t* from)
+{
+	hawk_tree_t* tree = &rtx->hawk->tree;
+	hawk_val_t* dv, * nv;
+	hawk_oow_t i;
+	int n;
+
+	if (from->hawk != rtx->hawk)
+	{
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
+		return -1;
+	}
+
+	for (i = 0; i < tree->reduce.count; i++)
+	{
+		hawk_reduce_t* r = &tree->reduce.ptr[i];
+
+		dv = HAWK_RTX_STACK_GBL(rtx, r->gbl);
+		if (reduce_val(rtx, from, r->op, dv, HAWK_RTX_STACK_GBL(from, r->gbl), &nv, 0) <= -1) return -1;
+		if (nv == dv) continue;
+
+		hawk_rtx_refupval (rtx, nv);
+		n = hawk_rtx_setgbl(rtx, r->gbl, nv);
+		hawk_rtx_refdownval (rtx, nv);
+		if (n <= -1) return -1;
+	}
+
+	/* NR of the END blocks is the number of records read by all */
+	nv = hawk_rtx_makeintval(rtx, rtx->gbl.nr + from->gbl.nr);
+	if (HAWK_UNLIKELY(!nv)) return -1;
+	hawk_rtx_refupval (rtx, nv);
+	n = hawk_rtx_setgbl(rtx, HAWK_GBL_NR, nv);
+	hawk_rtx_refdownval (rtx, nv);
+	return n;
+}
+
 /* find an AWK function by name */
 static hawk_fun_t* find_fun (hawk_rtx_t* rtx, const hawk_ooch_t* name)
 {
 	hawk_htb_pair_t* pair;
 
+	/* the table sets the error in the hawk object shared by
+	 * the runtime contexts upon a miss */
+	hawk_mtx_lock (&rtx->hawk->mtx, HAWK_NULL);
 	pair = hawk_htb_search(rtx->hawk->tree.funs, name, hawk_count_oocstr(name));
+	hawk_mtx_unlock (&rtx->hawk->mtx);
 	if (!pair)
 	{
 		hawk_rtx_seterrfmt (rtx, HAWK_NULL, HAWK_EFUNNF, HAWK_T("unable to find function '%js'"), name);
@@ -1996,6 +2422,11 @@ static int run_pblocks (hawk_rtx_t* rtx)
 	rtx->inrec.buf_len = 0;
 	rtx->inrec.eof = 0;
 
+	/* the string values made from here on are carved out of the arena
+	 * blocks. a block is reused once all the values in it are freed,
+	 * which mostly happens when the next record replaces the fields */
+	rtx->arena.active = (rtx->arena.capa > 0);
+
 	/* run each pattern block */
 	while (rtx->exit_level < EXIT_GLOBAL)
 	{
@@ -2005,16 +2436,23 @@ static int run_pblocks (hawk_rtx_t* rtx)
 		if (n <= -1)
 		{
 			ADJUST_ERROR (rtx);
+			rtx->arena.active = 0;
 			return -1; /* error */
 		}
 		if (n == 0) break; /* end of input */
 
 		if (rtx->hawk->tree.chain)
 		{
-			if (run_pblock_chain(rtx, rtx->hawk->tree.chain) <= -1) return -1;
+			if (run_pblock_chain(rtx, rtx->hawk->tree.chain) <= -1)
+			{
+				rtx->arena.active = 0;
+				return -1;
+			}
 		}
 	}
 
+	rtx->arena.active = 0;
+
 #undef ADJUST_ERROR
 	return 0;
 }
@@ -2576,20 +3014,16 @@ static int run_forin (hawk_rtx_t* rtx, hawk_nde_forin_t* nde)
 
 		case HAWK_VAL_MAP:
 		{
-			hawk_map_t* map;
-			hawk_map_pair_t* pair;
-			hawk_map_itr_t itr;
+			hawk_val_map_itr_t itr;
 			hawk_oow_t old_forin_size, i;
 
-			map = ((hawk_val_map_t*)rv)->map;
-
 			old_forin_size = rtx->forin.size;
-			if (rtx->forin.capa - rtx->forin.size < hawk_map_getsize(map))
+			if (rtx->forin.capa - rtx->forin.size < HAWK_VAL_MAP_SIZE(rv))
 			{
 				hawk_val_t** tmp;
 				hawk_oow_t newcapa;
 
-				newcapa = rtx->forin.size + hawk_map_getsize(map);
+				newcapa = rtx->forin.size + HAWK_VAL_MAP_SIZE(rv);
 				newcapa = HAWK_ALIGN_POW2(newcapa, 128);
 				tmp = hawk_rtx_reallocmem(rtx, rtx->forin.ptr, newcapa * HAWK_SIZEOF(*tmp));
 				if (HAWK_UNLIKELY(!tmp))
@@ -2605,24 +3039,24 @@ static int run_forin (hawk_rtx_t* rtx, hawk_nde_forin_t* nde)
 
 			/* take a snapshot of the keys first so that the actual pairs become mutation safe
 			 * this proctection is needed in case the body contains destructive statements like 'delete' or '@reset'*/
-			hawk_init_map_itr (&itr, 0);
-			pair = hawk_map_getfirstpair(map, &itr);
-			while (pair)
+			if (hawk_rtx_getfirstmapvalitr(rtx, rv, &itr))
 			{
-				hawk_val_t* str;
-
-				str = (hawk_val_t*)hawk_rtx_makenstrvalwithoochars(rtx, HAWK_HTB_KPTR(pair), HAWK_HTB_KLEN(pair));
-				if (HAWK_UNLIKELY(!str))
+				do
 				{
-					ADJERR_LOC (rtx, &test->left->loc);
-					ret = -1;
-					goto done2;
-				}
+					hawk_val_t* str;
 
-				rtx->forin.ptr[rtx->forin.size++] = str;
-				hawk_rtx_refupval (rtx, str);
+					str = (hawk_val_t*)hawk_rtx_makenstrvalwithoochars(rtx, itr.key.ptr, itr.key.len);
+					if (HAWK_UNLIKELY(!str))
+					{
+						ADJERR_LOC (rtx, &test->left->loc);
+						ret = -1;
+						goto done2;
+					}
 
-				pair = hawk_map_getnextpair(map, &itr);
+					rtx->forin.ptr[rtx->forin.size++] = str;
+					hawk_rtx_refupval (rtx, str);
+				}
+				while (hawk_rtx_getnextmapvalitr(rtx, rv, &itr));
 			}
 
 			/* iterate over the keys in the snapshot */
@@ -2917,24 +3351,24 @@ static int run_nextfile (hawk_rtx_t* rtx, hawk_nde_nextfile_t* nde)
 }
 
 
-static hawk_val_t* assign_newmapval_in_map (hawk_rtx_t* rtx, hawk_map_t* container, hawk_ooch_t* idxptr, hawk_oow_t idxlen)
+static hawk_val_t* assign_newmapval_in_map (hawk_rtx_t* rtx, hawk_val_t* container, const hawk_val_map_key_t* key)
 {
 	hawk_val_t* tmp;
-	hawk_map_pair_t* pair;
+	hawk_val_t** slot;
 
 	tmp = hawk_rtx_makemapval(rtx);
 	if (HAWK_UNLIKELY(!tmp)) return HAWK_NULL;
 
 	/* as this is the assignment, it needs to update the reference count of the target value. */
 	hawk_rtx_refupval (rtx, tmp);
-	pair = hawk_map_upsert(container, idxptr, idxlen, tmp, 0);
-	if (HAWK_UNLIKELY(!pair))
+	slot = hawk_rtx_upsertmapval(rtx, container, key, tmp);
+	if (HAWK_UNLIKELY(!slot))
 	{
 		hawk_rtx_refdownval (rtx, tmp);  /* decrement upon upsert() failure */
 		return HAWK_NULL;
 	}
 
-	HAWK_ASSERT (tmp == HAWK_MAP_VPTR(pair));
+	HAWK_ASSERT (tmp == *slot);
 	return tmp;
 }
 
@@ -3070,9 +3504,9 @@ static hawk_val_t* assign_newmapval_to_var (hawk_rtx_t* rtx, hawk_nde_var_t* var
 
 static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde_var_t* var)
 {
-	hawk_map_t* map;
+	hawk_val_t* map;
 	hawk_ooch_t* str = HAWK_NULL;
-	hawk_oow_t len;
+	hawk_val_map_key_t key;
 	hawk_ooch_t idxbuf[HAWK_IDX_BUF_SIZE];
 
 	hawk_arr_t* arr;
@@ -3089,10 +3523,10 @@ static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde
 	vtype = HAWK_RTX_GETVALTYPE(rtx, vv);
 	if (vtype == HAWK_VAL_MAP)
 	{
-		len = HAWK_COUNTOF(idxbuf);
-		str = idxnde_to_str(rtx, var->idx, idxbuf, &len, &remidx, HAWK_NULL);
+		key.len = HAWK_COUNTOF(idxbuf);
+		str = idxnde_to_key(rtx, var->idx, idxbuf, &key, &remidx);
 		if (HAWK_UNLIKELY(!str)) goto oops;
-		map = ((hawk_val_map_t*)vv)->map;
+		map = vv;
 	}
 	else
 	{
@@ -3109,9 +3543,9 @@ static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde
 
 		if (vtype == HAWK_VAL_MAP)
 		{
-			hawk_map_pair_t* pair;
-			pair = hawk_map_search(map, str, len);
-			vv = pair? (hawk_val_t*)HAWK_MAP_VPTR(pair): hawk_val_nil;
+			hawk_val_t** slot;
+			slot = hawk_rtx_searchmapval(rtx, map, &key);
+			vv = slot? *slot: hawk_val_nil;
 		}
 		else
 		{
@@ -3125,10 +3559,10 @@ static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde
 			case HAWK_VAL_MAP:
 			val_map:
 				if (str && str != idxbuf) hawk_rtx_freemem (rtx, str);
-				len = HAWK_COUNTOF(idxbuf);
-				str = idxnde_to_str(rtx, remidx, idxbuf, &len, &remidx, HAWK_NULL);
+				key.len = HAWK_COUNTOF(idxbuf);
+				str = idxnde_to_key(rtx, remidx, idxbuf, &key, &remidx);
 				if (HAWK_UNLIKELY(!str)) goto oops;
-				map = ((hawk_val_map_t*)vv)->map;
+				map = vv;
 				break;
 
 			case HAWK_VAL_ARR:
@@ -3143,7 +3577,7 @@ static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde
 				{
 					if (container_vtype == HAWK_VAL_MAP)
 					{
-						vv = assign_newmapval_in_map(rtx, map, str, len);
+						vv = assign_newmapval_in_map(rtx, map, &key);
 						if (HAWK_UNLIKELY(!vv)) { ADJERR_LOC(rtx, &var->loc); goto oops; }
 						vtype = HAWK_VAL_MAP;
 						goto val_map;
@@ -3166,7 +3600,7 @@ static HAWK_INLINE int delete_indexed (hawk_rtx_t* rtx, hawk_val_t* vv, hawk_nde
 #endif
 
 	if (vtype == HAWK_VAL_MAP)
-		hawk_map_delete (map, str, len);
+		hawk_rtx_deletemapval (rtx, map, &key);
 	else
 		hawk_arr_uplete (arr, idx,  1); /* no reindexing by compaction. keep the place unset */
 
@@ -3214,7 +3648,7 @@ static int run_delete (hawk_rtx_t* rtx, hawk_nde_delete_t* nde)
 				  print typename(a), length(a);
 				}
 				*/
-				hawk_map_clear (((hawk_val_map_t*)val)->map);
+				hawk_rtx_clearmapval (rtx, val);
 			}
 			break;
 
@@ -3325,11 +3759,55 @@ static hawk_val_t* io_nde_to_str(hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_oocs_t*
 	return v;
 }
 
-static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
+/* write the part of the print line assembled from the position base
+ * and drop it from the line buffer. print can be nested in the evaluation
+ * of an argument. the nested print appends after the part assembled by
+ * the outer print and drops its own part only */
+static int write_print_line (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* dst, hawk_oow_t base)
 {
-	hawk_oocs_t out;
-	hawk_val_t* out_v = HAWK_NULL;
-	int n, xret = 0;
+	int n;
+	n = hawk_rtx_writeiostr(rtx, out_type, dst, HAWK_OOECS_PTR(&rtx->print.line) + base, HAWK_OOECS_LEN(&rtx->print.line) - base);
+	hawk_ooecs_setlen (&rtx->print.line, base);
+	return n;
+}
+
+static int append_print_val (hawk_rtx_t* rtx, hawk_out_type_t out_type, const hawk_ooch_t* dst, hawk_oow_t base, hawk_val_t* v)
+{
+	switch (HAWK_RTX_GETVALTYPE(rtx, v))
+	{
+		case HAWK_VAL_CHAR:
+			return (hawk_ooecs_ccat(&rtx->print.line, HAWK_RTX_GETCHARFROMVAL(rtx, v)) == (hawk_oow_t)-1)? -1: 0;
+
+		case HAWK_VAL_STR:
+			return (hawk_ooecs_ncat(&rtx->print.line, ((hawk_val_str_t*)v)->val.ptr, ((hawk_val_str_t*)v)->val.len) == (hawk_oow_t)-1)? -1: 0;
+
+		case HAWK_VAL_BCHR:
+		case HAWK_VAL_MBS:
+		{
+			/* the bytes are written as they are. write the part
+			 * assembled so far before them */
+			int n;
+			if (HAWK_OOECS_LEN(&rtx->print.line) > base && write_print_line(rtx, out_type, dst, base) <= -1) return -1;
+			n = hawk_rtx_writeioval(rtx, out_type, dst, v);
+			return (n <= -1)? -1: 0;
+		}
+
+		default:
+		{
+			hawk_rtx_valtostr_out_t out;
+			out.type = HAWK_RTX_VALTOSTR_STRPCAT | HAWK_RTX_VALTOSTR_PRINT;
+			out.u.strpcat = &rtx->print.line;
+			return hawk_rtx_valtostr(rtx, v, &out);
+		}
+	}
+}
+
+static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
+{
+	hawk_oocs_t out;
+	hawk_val_t* out_v = HAWK_NULL;
+	hawk_oow_t base;
+	int n, xret = 0;
 
 	HAWK_ASSERT (
 		(nde->out_type == HAWK_OUT_PIPE && nde->out != HAWK_NULL) ||
@@ -3338,6 +3816,10 @@ static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 		(nde->out_type == HAWK_OUT_APFILE && nde->out != HAWK_NULL) ||
 		(nde->out_type == HAWK_OUT_CONSOLE && nde->out == HAWK_NULL));
 
+	/* the output line is assembled in the line buffer and handed over
+	 * to the I/O handler in one go */
+	base = HAWK_OOECS_LEN(&rtx->print.line);
+
 	/* check if destination has been specified. */
 	if (nde->out)
 	{
@@ -3354,18 +3836,7 @@ static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 	if (!nde->args)
 	{
 		/* if it doesn't have any arguments, print the entire input record */
-		n = hawk_rtx_writeiostr(rtx, nde->out_type, out.ptr, HAWK_OOECS_PTR(&rtx->inrec.line), HAWK_OOECS_LEN(&rtx->inrec.line));
-		if (n <= -1 /*&& rtx->errinf.num != HAWK_EIOIMPL*/)
-		{
-			if (rtx->hawk->opt.trait & HAWK_TOLERANT)
-			{
-				xret = PRINT_IOERR;
-			}
-			else
-			{
-				goto oops;
-			}
-		}
+		if (hawk_ooecs_ncat(&rtx->print.line, HAWK_OOECS_PTR(&rtx->inrec.line), HAWK_OOECS_LEN(&rtx->inrec.line)) == (hawk_oow_t)-1) goto oops;
 	}
 	else
 	{
@@ -3384,27 +3855,14 @@ static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 
 		for (np = head; np != HAWK_NULL; np = np->next)
 		{
-			if (np != head)
-			{
-				n = hawk_rtx_writeiostr(rtx, nde->out_type, out.ptr, rtx->gbl.ofs.ptr, rtx->gbl.ofs.len);
-				if (n <= -1 /*&& rtx->errinf.num != HAWK_EIOIMPL*/)
-				{
-					if (rtx->hawk->opt.trait & HAWK_TOLERANT)
-					{
-						xret = PRINT_IOERR;
-					}
-					else
-					{
-						goto oops;
-					}
-				}
-			}
+			if (np != head &&
+			    hawk_ooecs_ncat(&rtx->print.line, rtx->gbl.ofs.ptr, rtx->gbl.ofs.len) == (hawk_oow_t)-1) goto oops;
 
 			v = eval_expression(rtx, np);
 			if (HAWK_UNLIKELY(!v)) goto oops_1;
 
 			hawk_rtx_refupval (rtx, v);
-			n = hawk_rtx_writeioval(rtx, nde->out_type, out.ptr, v);
+			n = append_print_val(rtx, nde->out_type, out.ptr, base, v);
 			hawk_rtx_refdownval (rtx, v);
 
 			if (n <= -1 /*&& rtx->errinf.num != HAWK_EIOIMPL*/)
@@ -3422,7 +3880,8 @@ static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 	}
 
 	/* print the value ORS to terminate the operation */
-	n = hawk_rtx_writeiostr(rtx, nde->out_type, out.ptr, rtx->gbl.ors.ptr, rtx->gbl.ors.len);
+	if (hawk_ooecs_ncat(&rtx->print.line, rtx->gbl.ors.ptr, rtx->gbl.ors.len) == (hawk_oow_t)-1) goto oops;
+	n = write_print_line(rtx, nde->out_type, out.ptr, base);
 	if (n <= -1 /*&& rtx->errinf.num != HAWK_EIOIMPL*/)
 	{
 		if (rtx->hawk->opt.trait & HAWK_TOLERANT)
@@ -3435,8 +3894,6 @@ static int run_print (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 		}
 	}
 
-	/* unlike printf, flushio() is not needed here as print
-	 * inserts <NL> that triggers auto-flush */
 	if (out_v)
 	{
 		hawk_rtx_freevaloocstr (rtx, out_v, out.ptr);
@@ -3449,6 +3906,7 @@ oops:
 	ADJERR_LOC (rtx, &nde->loc);
 
 oops_1:
+	hawk_ooecs_setlen (&rtx->print.line, base);
 	if (out_v)
 	{
 		hawk_rtx_freevaloocstr (rtx, out_v, out.ptr);
@@ -3542,7 +4000,10 @@ static int run_printf (hawk_rtx_t* rtx, hawk_nde_print_t* nde)
 			break;
 	}
 
-	if (hawk_rtx_flushio(rtx, nde->out_type, out.ptr) <= -1)
+	/* the output is not flushed but for a two-way pipe whose peer may
+	 * wait for it. the standard I/O handlers flush a terminal at each
+	 * write and the other outputs when the buffer is full */
+	if (nde->out_type == HAWK_OUT_RWPIPE && hawk_rtx_flushio(rtx, nde->out_type, out.ptr) <= -1)
 	{
 		if (rtx->hawk->opt.trait & HAWK_TOLERANT) xret = PRINT_IOERR;
 		else goto oops_1;
@@ -3725,7 +4186,8 @@ static hawk_val_t* eval_expression0 (hawk_rtx_t* rtx, hawk_nde_t* nde)
 		eval_pos,
 		eval_getline,
 		eval_print,
-		eval_printf
+		eval_printf,
+		eval_code
 	};
 
 	hawk_val_t* v;
@@ -3794,14 +4256,167 @@ loop:
 	return val;
 }
 
+/* the maximum number of operands an assignment can append to a variable in place */
+#define MAX_APPEND_OPNDS 16
+
+static int has_gblset_ecb (hawk_rtx_t* rtx)
+{
+	hawk_rtx_ecb_t* ecb;
+	for (ecb = rtx->ecb; ecb != (hawk_rtx_ecb_t*)rtx; ecb = ecb->next)
+	{
+		if (ecb->gblset) return 1;
+	}
+	return 0;
+}
+
+/* get the operands of an assignment that appends to a plain variable
+ * like 'x = x a b' and 'x %%= a'. the operands are stored in the
+ * reverse order as 'x = x a b' is parsed as 'x = (x a) b'. it returns 0
+ * if the assignment is not of the form. */
+static hawk_oow_t get_append_operands (hawk_nde_ass_t* ass, hawk_nde_t** opnd)
+{
+	hawk_nde_var_t* var = (hawk_nde_var_t*)ass->left;
+	hawk_nde_var_t* leaf;
+	hawk_nde_t* nde;
+	hawk_oow_t n = 0;
+
+	switch (var->type)
+	{
+		case HAWK_NDE_GBL:
+			/* a built-in variable acts on assignment and some of them
+			 * refer to the string of the value assigned */
+			if (var->id.idxa <= HAWK_MAX_GBL_ID) return 0;
+			break;
+
+		case HAWK_NDE_NAMED:
+		case HAWK_NDE_LCL:
+		case HAWK_NDE_ARG:
+			break;
+
+		default:
+			return 0;
+	}
+
+	if (ass->opcode == HAWK_ASSOP_CONCAT)
+	{
+		opnd[0] = ass->right;
+		return 1;
+	}
+	if (ass->opcode != HAWK_ASSOP_NONE) return 0;
+
+	nde = ass->right;
+	if (nde->type == HAWK_NDE_CODE) nde = ((hawk_nde_code_t*)nde)->expr;
+	while (nde->type == HAWK_NDE_EXP_BIN && ((hawk_nde_exp_t*)nde)->opcode == HAWK_BINOP_CONCAT)
+	{
+		if (n >= MAX_APPEND_OPNDS) return 0;
+		opnd[n++] = ((hawk_nde_exp_t*)nde)->right;
+		nde = ((hawk_nde_exp_t*)nde)->left;
+	}
+
+	if (n <= 0 || nde->type != var->type) return 0;
+
+	leaf = (hawk_nde_var_t*)nde;
+	if (var->type == HAWK_NDE_NAMED)
+	{
+		if (hawk_comp_oochars(leaf->id.name.ptr, leaf->id.name.len, var->id.name.ptr, var->id.name.len, 0) != 0) return 0;
+	}
+	else if (leaf->id.idxa != var->id.idxa) return 0;
+
+	return n;
+}
+
+static hawk_val_t* eval_append_assignment (hawk_rtx_t* rtx, hawk_nde_ass_t* ass, hawk_nde_t** opnd, hawk_oow_t nopnds)
+{
+	hawk_nde_var_t* var = (hawk_nde_var_t*)ass->left;
+	hawk_val_t* left = HAWK_NULL, * val[MAX_APPEND_OPNDS], * res, * ret = HAWK_NULL;
+	hawk_oow_t i, nvals = 0;
+
+	/* evaluate the operands in the same order as the ordinary path */
+	if (ass->opcode == HAWK_ASSOP_CONCAT)
+	{
+		val[0] = eval_expression(rtx, opnd[0]);
+		if (HAWK_UNLIKELY(!val[0])) return HAWK_NULL;
+		hawk_rtx_refupval (rtx, val[0]);
+		nvals = 1;
+	}
+
+	left = eval_expression(rtx, (hawk_nde_t*)var);
+	if (HAWK_UNLIKELY(!left)) goto done;
+	hawk_rtx_refupval (rtx, left);
+
+	while (nvals < nopnds)
+	{
+		val[nvals] = eval_expression(rtx, opnd[nopnds - nvals - 1]);
+		if (HAWK_UNLIKELY(!val[nvals])) goto done;
+		hawk_rtx_refupval (rtx, val[nvals]);
+		nvals++;
+	}
+
+	if (HAWK_RTX_GETVALTYPE(rtx, left) == HAWK_VAL_STR && !left->v_static &&
+	    left->v_refs == 2 && fetch_topval_from_var(rtx, var) == left &&
+	    !(var->type == HAWK_NDE_GBL && has_gblset_ecb(rtx)))
+	{
+		/* no one but the variable holds the string. extend it
+		 * in place instead of copying it to a new string */
+		for (i = 0; i < nvals; i++)
+		{
+			hawk_oocs_t str;
+			int x;
+
+			str.ptr = hawk_rtx_getvaloocstr(rtx, val[i], &str.len);
+			if (HAWK_UNLIKELY(!str.ptr)) goto done;
+			x = hawk_rtx_appendtostrval(rtx, left, str.ptr, str.len);
+			hawk_rtx_freevaloocstr (rtx, val[i], str.ptr);
+			if (HAWK_UNLIKELY(x <= -1)) goto done;
+		}
+
+		res = left;
+		hawk_rtx_refupval (rtx, res);
+	}
+	else
+	{
+		res = left;
+		hawk_rtx_refupval (rtx, res);
+
+		for (i = 0; i < nvals; i++)
+		{
+			hawk_val_t* tmp;
+
+			tmp = eval_binop_concat(rtx, res, val[i]);
+			if (HAWK_UNLIKELY(!tmp))
+			{
+				hawk_rtx_refdownval (rtx, res);
+				goto done;
+			}
+
+			hawk_rtx_refupval (rtx, tmp);
+			hawk_rtx_refdownval (rtx, res);
+			res = tmp;
+		}
+	}
+
+	ret = do_assignment(rtx, (hawk_nde_t*)var, res);
+	hawk_rtx_refdownval (rtx, res);
+
+done:
+	while (nvals > 0) hawk_rtx_refdownval (rtx, val[--nvals]);
+	if (left) hawk_rtx_refdownval (rtx, left);
+	return ret;
+}
+
 static hawk_val_t* eval_assignment (hawk_rtx_t* rtx, hawk_nde_t* nde)
 {
 	hawk_val_t* val, * ret;
 	hawk_nde_ass_t* ass = (hawk_nde_ass_t*)nde;
+	hawk_nde_t* opnd[MAX_APPEND_OPNDS];
+	hawk_oow_t nopnds;
 
 	HAWK_ASSERT (ass->left != HAWK_NULL);
 	HAWK_ASSERT (ass->right != HAWK_NULL);
 
+	nopnds = get_append_operands(ass, opnd);
+	if (nopnds > 0) return eval_append_assignment(rtx, ass, opnd, nopnds);
+
 	HAWK_ASSERT (ass->right->next == HAWK_NULL);
 	val = eval_expression(rtx, ass->right);
 	if (HAWK_UNLIKELY(!val)) return HAWK_NULL;
@@ -4062,9 +4677,10 @@ static hawk_val_t* do_assignment_nonindexed (hawk_rtx_t* rtx, hawk_nde_var_t* va
 
 static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var, hawk_val_t* val)
 {
-	hawk_map_t* map;
+	hawk_val_t* oval = val;
+	hawk_val_t* map;
 	hawk_ooch_t* str = HAWK_NULL;
-	hawk_oow_t len;
+	hawk_val_map_key_t key;
 	hawk_ooch_t idxbuf[HAWK_IDX_BUF_SIZE];
 
 	hawk_ooi_t idx;
@@ -4095,10 +4711,10 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 		val_map_or_arr:
 			if (vtype == HAWK_VAL_MAP)
 			{
-				len = HAWK_COUNTOF(idxbuf);
-				str = idxnde_to_str(rtx, var->idx, idxbuf, &len, &remidx, HAWK_NULL);
+				key.len = HAWK_COUNTOF(idxbuf);
+				str = idxnde_to_key(rtx, var->idx, idxbuf, &key, &remidx);
 				if (HAWK_UNLIKELY(!str)) goto oops;
-				map = ((hawk_val_map_t*)vv)->map;
+				map = vv;
 			}
 			else
 			{
@@ -4114,9 +4730,9 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 
 				if (vtype == HAWK_VAL_MAP)
 				{
-					hawk_map_pair_t* pair;
-					pair = hawk_map_search(map, str, len);
-					vv = pair? (hawk_val_t*)HAWK_MAP_VPTR(pair): hawk_val_nil;
+					hawk_val_t** slot;
+					slot = hawk_rtx_searchmapval(rtx, map, &key);
+					vv = slot? *slot: hawk_val_nil;
 				}
 				else
 				{
@@ -4130,10 +4746,10 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 					case HAWK_VAL_MAP:
 					val_map:
 						if (str != idxbuf) hawk_rtx_freemem (rtx, str);
-						len = HAWK_COUNTOF(idxbuf);
-						str = idxnde_to_str(rtx, remidx, idxbuf, &len, &remidx, HAWK_NULL);
+						key.len = HAWK_COUNTOF(idxbuf);
+						str = idxnde_to_key(rtx, remidx, idxbuf, &key, &remidx);
 						if (HAWK_UNLIKELY(!str)) goto oops;
-						map = ((hawk_val_map_t*)vv)->map;
+						map = vv;
 						break;
 
 					case HAWK_VAL_ARR:
@@ -4155,7 +4771,7 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 							 * here it simply creates a new map. */
 							if (container_vtype == HAWK_VAL_MAP)
 							{
-								vv = assign_newmapval_in_map(rtx, map, str, len);
+								vv = assign_newmapval_in_map(rtx, map, &key);
 								if (HAWK_UNLIKELY(!vv)) { ADJERR_LOC(rtx, &var->loc); goto oops; }
 								vtype = HAWK_VAL_MAP;
 								goto val_map;
@@ -4181,10 +4797,22 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 			hawk_logbfmt (hawk_rtx_gethawk(rtx), "**** index str=>%js, map->ref=%d, map->type=%d\n", str, (int)v->ref, (int)v->type);
 		#endif
 
+			/* the element outlives the record. move the value out of the arena */
+			if (HAWK_IS_ARENAVAL(val))
+			{
+				val = hawk_rtx_promoteval(rtx, val);
+				if (HAWK_UNLIKELY(!val))
+				{
+					ADJERR_LOC (rtx, &var->loc);
+					goto oops;
+				}
+			}
+
 			if (vtype == HAWK_VAL_MAP)
 			{
-				if (HAWK_UNLIKELY(hawk_map_upsert(map, str, len, val, 0) == HAWK_NULL))
+				if (HAWK_UNLIKELY(hawk_rtx_upsertmapval(rtx, map, &key, val) == HAWK_NULL))
 				{
+					if (val != oval) hawk_rtx_freeval (rtx, val, HAWK_RTX_FREEVAL_CACHE);
 					ADJERR_LOC (rtx, &var->loc);
 					goto oops;
 				}
@@ -4193,6 +4821,7 @@ static hawk_val_t* do_assignment_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var,
 			{
 				if (HAWK_UNLIKELY(hawk_arr_upsert(arr, idx, val, 0) == HAWK_ARR_NIL))
 				{
+					if (val != oval) hawk_rtx_freeval (rtx, val, HAWK_RTX_FREEVAL_CACHE);
 					ADJERR_LOC (rtx, &var->loc);
 					goto oops;
 				}
@@ -4288,46 +4917,47 @@ static hawk_val_t* do_assignment_positional (hawk_rtx_t* rtx, hawk_nde_pos_t* po
 	return (lv == 0)? rtx->inrec.d0: rtx->inrec.flds[lv-1].val;
 }
 
-static hawk_val_t* eval_binary (hawk_rtx_t* rtx, hawk_nde_t* nde)
+/* used by eval_binary() and eval_code() */
+static binop_func_t binop_func[] =
 {
-	static binop_func_t binop_func[] =
-	{
-		/* the order of the functions should be inline with
-		 * the operator declaration in rtx.h */
-
-		HAWK_NULL, /* eval_binop_lor */
-		HAWK_NULL, /* eval_binop_land */
-		HAWK_NULL, /* eval_binop_in */
-
-		eval_binop_bor,
-		eval_binop_bxor,
-		eval_binop_band,
-
-		eval_binop_teq,
-		eval_binop_tne,
-		eval_binop_eq,
-		eval_binop_ne,
-		eval_binop_gt,
-		eval_binop_ge,
-		eval_binop_lt,
-		eval_binop_le,
-
-		eval_binop_lshift,
-		eval_binop_rshift,
-
-		eval_binop_plus,
-		eval_binop_minus,
-		eval_binop_mul,
-		eval_binop_div,
-		eval_binop_idiv,
-		eval_binop_mod,
-		eval_binop_exp,
-
-		eval_binop_concat,
-		HAWK_NULL, /* eval_binop_ma */
-		HAWK_NULL  /* eval_binop_nm */
-	};
+	/* the order of the functions should be inline with
+	 * the operator declaration in rtx.h */
+
+	HAWK_NULL, /* eval_binop_lor */
+	HAWK_NULL, /* eval_binop_land */
+	HAWK_NULL, /* eval_binop_in */
+
+	eval_binop_bor,
+	eval_binop_bxor,
+	eval_binop_band,
 
+	eval_binop_teq,
+	eval_binop_tne,
+	eval_binop_eq,
+	eval_binop_ne,
+	eval_binop_gt,
+	eval_binop_ge,
+	eval_binop_lt,
+	eval_binop_le,
+
+	eval_binop_lshift,
+	eval_binop_rshift,
+
+	eval_binop_plus,
+	eval_binop_minus,
+	eval_binop_mul,
+	eval_binop_div,
+	eval_binop_idiv,
+	eval_binop_mod,
+	eval_binop_exp,
+
+	eval_binop_concat,
+	HAWK_NULL, /* eval_binop_ma */
+	HAWK_NULL  /* eval_binop_nm */
+};
+
+static hawk_val_t* eval_binary (hawk_rtx_t* rtx, hawk_nde_t* nde)
+{
 	hawk_nde_exp_t* exp = (hawk_nde_exp_t*)nde;
 	hawk_val_t* left, * right, * res;
 
@@ -4552,11 +5182,11 @@ rvalue_ok:
 
 		case HAWK_VAL_MAP:
 		{
+			hawk_val_map_key_t key;
 
-			hawk_map_t* map;
-
-			map = ((hawk_val_map_t*)ropv)->map;
-			res = (hawk_map_search(map, str, len) == HAWK_NULL)? HAWK_VAL_ZERO: HAWK_VAL_ONE;
+			key.ptr = str;
+			key.len = len;
+			res = (hawk_rtx_searchmapval(rtx, ropv, &key) == HAWK_NULL)? HAWK_VAL_ZERO: HAWK_VAL_ONE;
 			break;
 		}
 
@@ -4739,7 +5369,7 @@ static HAWK_INLINE int __cmp_nil_fun (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 
 static HAWK_INLINE int __cmp_nil_map (hawk_rtx_t* rtx, hawk_val_t* left, hawk_val_t* right, cmp_op_t op_hint)
 {
-	return (HAWK_MAP_SIZE(((hawk_val_map_t*)right)->map) == 0)? 0: -1;
+	return (HAWK_VAL_MAP_SIZE(right) == 0)? 0: -1;
 }
 
 static HAWK_INLINE int __cmp_nil_arr (hawk_rtx_t* rtx, hawk_val_t* left, hawk_val_t* right, cmp_op_t op_hint)
@@ -4970,12 +5600,22 @@ static HAWK_INLINE int __cmp_int_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 		hawk_int_t ll, v1;
 		hawk_flt_t rr;
 
-		n = hawk_oochars_to_num(
-			HAWK_OOCHARS_TO_NUM_MAKE_OPTION(1, 0, HAWK_RTX_IS_STRIPSTRSPC_ON(rtx), 0),
-			((hawk_val_str_t*)right)->val.ptr,
-			((hawk_val_str_t*)right)->val.len,
-			&ll, &rr
-		);
+		if (right->v_nstr && right->v_ncache)
+		{
+			/* the number of a numeric string has been cached */
+			n = right->v_ncache - 1;
+			if (n == 0) ll = ((hawk_val_str_t*)right)->num.l;
+			else rr = ((hawk_val_str_t*)right)->num.r;
+		}
+		else
+		{
+			n = hawk_oochars_to_num(
+				HAWK_OOCHARS_TO_NUM_MAKE_OPTION(1, 0, HAWK_RTX_IS_STRIPSTRSPC_ON(rtx), 0),
+				((hawk_val_str_t*)right)->val.ptr,
+				((hawk_val_str_t*)right)->val.len,
+				&ll, &rr
+			);
+		}
 
 		v1 = HAWK_RTX_GETINTFROMVAL(rtx, left);
 		if (n == 0)
@@ -5104,7 +5744,15 @@ static HAWK_INLINE int __cmp_flt_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 		const hawk_ooch_t* end;
 		hawk_flt_t rr;
 
-		rr = hawk_oochars_to_flt(((hawk_val_str_t*)right)->val.ptr, ((hawk_val_str_t*)right)->val.len, &end, HAWK_RTX_IS_STRIPSTRSPC_ON(rtx));
+		if (right->v_nstr == 2 && right->v_ncache == 2)
+		{
+			rr = ((hawk_val_str_t*)right)->num.r;
+			end = ((hawk_val_str_t*)right)->val.ptr + ((hawk_val_str_t*)right)->val.len;
+		}
+		else
+		{
+			rr = hawk_oochars_to_flt(((hawk_val_str_t*)right)->val.ptr, ((hawk_val_str_t*)right)->val.len, &end, HAWK_RTX_IS_STRIPSTRSPC_ON(rtx));
+		}
 		if (end == ((hawk_val_str_t*)right)->val.ptr + ((hawk_val_str_t*)right)->val.len)
 		{
 			return (((hawk_val_flt_t*)left)->val > rr)? 1:
@@ -5217,19 +5865,20 @@ static HAWK_INLINE int __cmp_str_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 		return hawk_comp_oochars(ls->val.ptr, ls->val.len, rs->val.ptr, rs->val.len, rtx->gbl.ignorecase);
 	}
 
+	/* a number cached in a numeric string is of the type that v_nstr indicates */
 	stripspc = HAWK_RTX_IS_STRIPSTRSPC_ON(rtx);
 
 	if (ls->v_nstr == 1)
 	{
 		hawk_int_t ll;
 
-		ll = hawk_oochars_to_int(ls->val.ptr, ls->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
+		ll = (ls->v_ncache == 1)? ls->num.l: hawk_oochars_to_int(ls->val.ptr, ls->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
 
 		if (rs->v_nstr == 1)
 		{
 			hawk_int_t rr;
 
-			rr = hawk_oochars_to_int(rs->val.ptr, rs->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
+			rr = (rs->v_ncache == 1)? rs->num.l: hawk_oochars_to_int(rs->val.ptr, rs->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
 
 			return (ll > rr)? 1:
 			       (ll < rr)? -1: 0;
@@ -5240,7 +5889,7 @@ static HAWK_INLINE int __cmp_str_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 
 			HAWK_ASSERT (rs->v_nstr == 2);
 
-			rr = hawk_oochars_to_flt(rs->val.ptr, rs->val.len, HAWK_NULL, stripspc);
+			rr = (rs->v_ncache == 2)? rs->num.r: hawk_oochars_to_flt(rs->val.ptr, rs->val.len, HAWK_NULL, stripspc);
 
 			return (ll > rr)? 1:
 			       (ll < rr)? -1: 0;
@@ -5252,13 +5901,13 @@ static HAWK_INLINE int __cmp_str_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 
 		HAWK_ASSERT (ls->v_nstr == 2);
 
-		ll = hawk_oochars_to_flt(ls->val.ptr, ls->val.len, HAWK_NULL, stripspc);
+		ll = (ls->v_ncache == 2)? ls->num.r: hawk_oochars_to_flt(ls->val.ptr, ls->val.len, HAWK_NULL, stripspc);
 
 		if (rs->v_nstr == 1)
 		{
 			hawk_int_t rr;
 
-			rr = hawk_oochars_to_int(rs->val.ptr, rs->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
+			rr = (rs->v_ncache == 1)? rs->num.l: hawk_oochars_to_int(rs->val.ptr, rs->val.len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc, stripspc, 0), HAWK_NULL, HAWK_NULL);
 
 			return (ll > rr)? 1:
 			       (ll < rr)? -1: 0;
@@ -5269,7 +5918,7 @@ static HAWK_INLINE int __cmp_str_str (hawk_rtx_t* rtx, hawk_val_t* left, hawk_va
 
 			HAWK_ASSERT (rs->v_nstr == 2);
 
-			rr = hawk_oochars_to_flt(rs->val.ptr, rs->val.len, HAWK_NULL, stripspc);
+			rr = (rs->v_ncache == 2)? rs->num.r: hawk_oochars_to_flt(rs->val.ptr, rs->val.len, HAWK_NULL, stripspc);
 
 			return (ll > rr)? 1:
 			       (ll < rr)? -1: 0;
@@ -6259,35 +6908,18 @@ static hawk_val_t* eval_binop_nm (hawk_rtx_t* run, hawk_nde_t* left, hawk_nde_t*
 	return res;
 }
 
-static hawk_val_t* eval_unary (hawk_rtx_t* rtx, hawk_nde_t* nde)
+static hawk_val_t* eval_unrop (hawk_rtx_t* rtx, int opcode, hawk_val_t* left)
 {
-	hawk_val_t* left, * res = HAWK_NULL;
-	hawk_nde_exp_t* exp = (hawk_nde_exp_t*)nde;
+	hawk_val_t* res = HAWK_NULL;
 	int n;
 	hawk_int_t l;
 	hawk_flt_t r;
 
-	HAWK_ASSERT (
-		exp->type == HAWK_NDE_EXP_UNR);
-	HAWK_ASSERT (
-		exp->left != HAWK_NULL && exp->right == HAWK_NULL);
-	HAWK_ASSERT (
-		exp->opcode == HAWK_UNROP_PLUS ||
-		exp->opcode == HAWK_UNROP_MINUS ||
-		exp->opcode == HAWK_UNROP_LNOT ||
-		exp->opcode == HAWK_UNROP_BNOT);
-
-	HAWK_ASSERT (exp->left->next == HAWK_NULL);
-	left = eval_expression(rtx, exp->left);
-	if (HAWK_UNLIKELY(!left)) return HAWK_NULL;
-
-	hawk_rtx_refupval (rtx, left);
-
-	switch (exp->opcode)
+	switch (opcode)
 	{
 		case HAWK_UNROP_MINUS:
 			n = hawk_rtx_valtonum(rtx, left, &l, &r);
-			if (HAWK_UNLIKELY(n <= -1)) goto exit_func;
+			if (HAWK_UNLIKELY(n <= -1)) break;
 
 			res = (n == 0)? hawk_rtx_makeintval(rtx, -l):
 			                hawk_rtx_makefltval(rtx, -r);
@@ -6303,7 +6935,7 @@ static hawk_val_t* eval_unary (hawk_rtx_t* rtx, hawk_nde_t* nde)
 			else
 			{
 				n = hawk_rtx_valtonum(rtx, left, &l, &r);
-				if (HAWK_UNLIKELY(n <= -1)) goto exit_func;
+				if (HAWK_UNLIKELY(n <= -1)) break;
 
 				res = (n == 0)? hawk_rtx_makeintval(rtx, !l):
 				                hawk_rtx_makefltval(rtx, !r);
@@ -6312,22 +6944,46 @@ static hawk_val_t* eval_unary (hawk_rtx_t* rtx, hawk_nde_t* nde)
 
 		case HAWK_UNROP_BNOT:
 			n = hawk_rtx_valtoint(rtx, left, &l);
-			if (HAWK_UNLIKELY(n <= -1)) goto exit_func;
+			if (HAWK_UNLIKELY(n <= -1)) break;
 
 			res = hawk_rtx_makeintval(rtx, ~l);
 			break;
 
 		case HAWK_UNROP_PLUS:
 			n = hawk_rtx_valtonum(rtx, left, &l, &r);
-			if (HAWK_UNLIKELY(n <= -1)) goto exit_func;
+			if (HAWK_UNLIKELY(n <= -1)) break;
 
 			res = (n == 0)? hawk_rtx_makeintval(rtx, l):
 			                hawk_rtx_makefltval(rtx, r);
 			break;
 	}
 
-exit_func:
+	return res;
+}
+
+static hawk_val_t* eval_unary (hawk_rtx_t* rtx, hawk_nde_t* nde)
+{
+	hawk_val_t* left, * res;
+	hawk_nde_exp_t* exp = (hawk_nde_exp_t*)nde;
+
+	HAWK_ASSERT (
+		exp->type == HAWK_NDE_EXP_UNR);
+	HAWK_ASSERT (
+		exp->left != HAWK_NULL && exp->right == HAWK_NULL);
+	HAWK_ASSERT (
+		exp->opcode == HAWK_UNROP_PLUS ||
+		exp->opcode == HAWK_UNROP_MINUS ||
+		exp->opcode == HAWK_UNROP_LNOT ||
+		exp->opcode == HAWK_UNROP_BNOT);
+
+	HAWK_ASSERT (exp->left->next == HAWK_NULL);
+	left = eval_expression(rtx, exp->left);
+	if (HAWK_UNLIKELY(!left)) return HAWK_NULL;
+
+	hawk_rtx_refupval (rtx, left);
+	res = eval_unrop(rtx, exp->opcode, left);
 	hawk_rtx_refdownval (rtx, left);
+
 	if (HAWK_UNLIKELY(!res)) ADJERR_LOC (rtx, &nde->loc);
 	return res;
 }
@@ -6633,6 +7289,178 @@ static hawk_val_t* eval_cnd (hawk_rtx_t* run, hawk_nde_t* nde)
 	return v;
 }
 
+static hawk_val_t* eval_code (hawk_rtx_t* rtx, hawk_nde_t* nde)
+{
+	/* execute the register code compiled by hawk_compilept().
+	 * a register holds a referenced value until an instruction
+	 * consumes it. the result is left in the first register. */
+	hawk_nde_code_t* code = (hawk_nde_code_t*)nde;
+	const hawk_code_insn_t* ip, * end;
+	hawk_val_t* reg[HAWK_CODE_MAX_REGS];
+	hawk_val_t* v;
+	hawk_int_t lv;
+	hawk_oow_t i;
+	int b;
+
+	HAWK_ASSERT (code->nregs > 0 && code->nregs <= HAWK_CODE_MAX_REGS);
+	for (i = 0; i < code->nregs; i++) reg[i] = HAWK_NULL;
+
+	ip = code->insn;
+	end = ip + code->ninsns;
+	while (ip < end)
+	{
+		switch (ip->op)
+		{
+			case HAWK_CODE_LDINT:
+				v = eval_int(rtx, ip->nde);
+				goto load;
+
+			case HAWK_CODE_LDFLT:
+				v = eval_flt(rtx, ip->nde);
+				goto load;
+
+			case HAWK_CODE_LDSTR:
+				v = eval_str(rtx, ip->nde);
+				goto load;
+
+			case HAWK_CODE_LDGBL:
+				v = HAWK_RTX_STACK_GBL(rtx, ((hawk_nde_var_t*)ip->nde)->id.idxa);
+				goto load_var;
+
+			case HAWK_CODE_LDLCL:
+				v = HAWK_RTX_STACK_LCL(rtx, ((hawk_nde_var_t*)ip->nde)->id.idxa);
+				goto load_var;
+
+			case HAWK_CODE_LDARG:
+				v = HAWK_RTX_STACK_ARG(rtx, ((hawk_nde_var_t*)ip->nde)->id.idxa);
+			load_var:
+				/* let eval_expression() match a regular expression against $0 */
+				if (HAWK_RTX_GETVALTYPE(rtx, v) == HAWK_VAL_REX) v = eval_expression(rtx, ip->nde);
+				goto load;
+
+			case HAWK_CODE_LDFLD:
+				lv = ((hawk_nde_int_t*)((hawk_nde_pos_t*)ip->nde)->val)->val;
+				HAWK_ASSERT (lv >= 0);
+				goto load_fld;
+
+			case HAWK_CODE_FLD:
+				b = hawk_rtx_valtoint(rtx, reg[ip->a], &lv);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				if (b <= -1 || lv < 0)
+				{
+					hawk_rtx_seterrnum (rtx, &ip->nde->loc, HAWK_EPOSIDX);
+					goto oops;
+				}
+			load_fld:
+				/* the same as eval_pos() */
+				if (lv > (hawk_int_t)rtx->inrec.nflds && rtx->inrec.split.pending && hawk_rtx_splitrec(rtx) <= -1)
+				{
+					ADJERR_LOC (rtx, &ip->nde->loc);
+					goto oops;
+				}
+				v = POS_VAL(rtx, lv);
+				goto load;
+
+			case HAWK_CODE_EVAL:
+				v = eval_expression(rtx, ip->nde);
+			load:
+				if (HAWK_UNLIKELY(!v)) goto oops;
+				reg[ip->dst] = v;
+				hawk_rtx_refupval (rtx, v);
+				break;
+
+			case HAWK_CODE_BIN:
+				HAWK_ASSERT (binop_func[ip->opx] != HAWK_NULL);
+				v = binop_func[ip->opx](rtx, reg[ip->a], reg[ip->b]);
+				if (HAWK_UNLIKELY(!v))
+				{
+					ADJERR_LOC (rtx, &ip->nde->loc);
+					goto oops;
+				}
+				hawk_rtx_refupval (rtx, v);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				hawk_rtx_refdownval (rtx, reg[ip->b]);
+				reg[ip->a] = HAWK_NULL;
+				reg[ip->b] = HAWK_NULL;
+				reg[ip->dst] = v;
+				break;
+
+			case HAWK_CODE_UNR:
+				v = eval_unrop(rtx, ip->opx, reg[ip->a]);
+				if (HAWK_UNLIKELY(!v))
+				{
+					ADJERR_LOC (rtx, &ip->nde->loc);
+					goto oops;
+				}
+				hawk_rtx_refupval (rtx, v);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				reg[ip->dst] = v;
+				break;
+
+			case HAWK_CODE_ASS:
+				v = do_assignment(rtx, ((hawk_nde_ass_t*)ip->nde)->left, reg[ip->a]);
+				if (HAWK_UNLIKELY(!v)) goto oops;
+				hawk_rtx_refupval (rtx, v);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				reg[ip->dst] = v;
+				break;
+
+			case HAWK_CODE_LAND:
+			case HAWK_CODE_LOR:
+				b = hawk_rtx_valtobool(rtx, reg[ip->a]);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				if (b == (ip->op == HAWK_CODE_LOR))
+				{
+					/* short-circuited. skip the right operand */
+					reg[ip->dst] = b? HAWK_VAL_ONE: HAWK_VAL_ZERO;
+					ip = code->insn + ip->b;
+					continue;
+				}
+				break;
+
+			case HAWK_CODE_BOOL:
+				v = hawk_rtx_valtobool(rtx, reg[ip->a])? HAWK_VAL_ONE: HAWK_VAL_ZERO;
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				reg[ip->dst] = v;
+				break;
+
+			case HAWK_CODE_JMPF:
+				b = hawk_rtx_valtobool(rtx, reg[ip->a]);
+				hawk_rtx_refdownval (rtx, reg[ip->a]);
+				reg[ip->a] = HAWK_NULL;
+				if (!b)
+				{
+					ip = code->insn + ip->b;
+					continue;
+				}
+				break;
+
+			case HAWK_CODE_JMP:
+				ip = code->insn + ip->b;
+				continue;
+		}
+
+		ip++;
+	}
+
+	v = reg[0];
+	HAWK_ASSERT (v != HAWK_NULL);
+	hawk_rtx_refdownval_nofree (rtx, v);
+	return v;
+
+oops:
+	for (i = 0; i < code->nregs; i++)
+	{
+		if (reg[i]) hawk_rtx_refdownval (rtx, reg[i]);
+	}
+	return HAWK_NULL;
+}
+
 static hawk_val_t* eval_fncall_fnc (hawk_rtx_t* rtx, hawk_nde_t* nde)
 {
 	/* intrinsic function */
@@ -7267,9 +8095,9 @@ static int get_reference (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_val_t*** ref)
 
 static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 {
-	hawk_map_t* map;
+	hawk_val_t* map;
 	hawk_ooch_t* str = HAWK_NULL;
-	hawk_oow_t len;
+	hawk_val_map_key_t key;
 	hawk_ooch_t idxbuf[HAWK_IDX_BUF_SIZE];
 
 	hawk_arr_t* arr;
@@ -7294,10 +8122,10 @@ static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 		case HAWK_VAL_MAP:
 		val_map_init:
-			len = HAWK_COUNTOF(idxbuf);
-			str = idxnde_to_str(rtx, var->idx, idxbuf, &len, &remidx, HAWK_NULL);
+			key.len = HAWK_COUNTOF(idxbuf);
+			str = idxnde_to_key(rtx, var->idx, idxbuf, &key, &remidx);
 			if (HAWK_UNLIKELY(!str)) goto oops;
-			map = ((hawk_val_map_t*)v)->map;
+			map = v;
 			break;
 
 		case HAWK_VAL_ARR:
@@ -7318,9 +8146,9 @@ static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 		if (vtype == HAWK_VAL_MAP)
 		{
-			hawk_map_pair_t* pair;
-			pair = hawk_map_search(map, str, len);
-			v = pair? (hawk_val_t*)HAWK_MAP_VPTR(pair): hawk_val_nil;
+			hawk_val_t** slot;
+			slot = hawk_rtx_searchmapval(rtx, map, &key);
+			v = slot? *slot: hawk_val_nil;
 		}
 		else
 		{
@@ -7334,10 +8162,10 @@ static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 			case HAWK_VAL_MAP:
 			val_map:
 				if (str && str != idxbuf) hawk_rtx_freemem (rtx, str);
-				len = HAWK_COUNTOF(idxbuf);
-				str = idxnde_to_str(rtx, remidx, idxbuf, &len, &remidx, HAWK_NULL);
+				key.len = HAWK_COUNTOF(idxbuf);
+				str = idxnde_to_key(rtx, remidx, idxbuf, &key, &remidx);
 				if (HAWK_UNLIKELY(!str)) goto oops;
-				map = ((hawk_val_map_t*)v)->map;
+				map = v;
 				break;
 
 			case HAWK_VAL_ARR:
@@ -7352,7 +8180,7 @@ static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 				{
 					if (container_vtype == HAWK_VAL_MAP)
 					{
-						v = assign_newmapval_in_map(rtx, map, str, len);
+						v = assign_newmapval_in_map(rtx, map, &key);
 						if (HAWK_UNLIKELY(!v)) { ADJERR_LOC (rtx, &var->loc); goto oops; }
 						vtype = HAWK_VAL_MAP;
 						goto val_map;
@@ -7374,20 +8202,20 @@ static hawk_val_t** get_reference_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 	if (vtype == HAWK_VAL_MAP)
 	{
-		hawk_map_pair_t* pair;
-		pair = hawk_map_search(map, str, len);
-		if (!pair)
+		hawk_val_t** slot;
+		slot = hawk_rtx_searchmapval(rtx, map, &key);
+		if (!slot)
 		{
 			/* if the value doesn't exist for the given key, insert a nil for it to create a placeholder for the reference */
-			pair = hawk_map_upsert(map, str, len, hawk_val_nil, 0);
-			if (HAWK_UNLIKELY(!pair)) { ADJERR_LOC(rtx, &var->loc); goto oops; }
-			HAWK_ASSERT (HAWK_MAP_VPTR(pair) == hawk_val_nil);
+			slot = hawk_rtx_upsertmapval(rtx, map, &key, hawk_val_nil);
+			if (HAWK_UNLIKELY(!slot)) { ADJERR_LOC(rtx, &var->loc); goto oops; }
+			HAWK_ASSERT (*slot == hawk_val_nil);
 			/* no reference count increment as hawk_val_nil is upserted
-			hawk_rtx_refupval (rtx, HAWK_MAP_VPTR(pair)); */
+			hawk_rtx_refupval (rtx, *slot); */
 		}
 
 		if (str && str != idxbuf) hawk_rtx_freemem (rtx, str);
-		return (hawk_val_t**)&HAWK_MAP_VPTR(pair);
+		return slot;
 	}
 	else
 	{
@@ -7579,9 +8407,9 @@ static hawk_val_t* eval_arg (hawk_rtx_t* rtx, hawk_nde_t* nde)
 
 static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 {
-	hawk_map_t* map; /* containing map */
+	hawk_val_t* map; /* containing map */
 	hawk_ooch_t* str = HAWK_NULL;
-	hawk_oow_t len;
+	hawk_val_map_key_t key;
 	hawk_ooch_t idxbuf[HAWK_IDX_BUF_SIZE];
 
 	hawk_arr_t* arr; /* containing array */
@@ -7607,10 +8435,10 @@ static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 		case HAWK_VAL_MAP:
 		init_val_map:
-			len = HAWK_COUNTOF(idxbuf);
-			str = idxnde_to_str(rtx, var->idx, idxbuf, &len, &remidx, HAWK_NULL);
+			key.len = HAWK_COUNTOF(idxbuf);
+			str = idxnde_to_key(rtx, var->idx, idxbuf, &key, &remidx);
 			if (HAWK_UNLIKELY(!str)) goto oops;
-			map = ((hawk_val_map_t*)v)->map;
+			map = v;
 			break;
 
 		case HAWK_VAL_ARR:
@@ -7631,9 +8459,9 @@ static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 		if (vtype == HAWK_VAL_MAP)
 		{
-			hawk_map_pair_t* pair;
-			pair = hawk_map_search(map, str, len);
-			v = pair? (hawk_val_t*)HAWK_MAP_VPTR(pair): hawk_val_nil;
+			hawk_val_t** slot;
+			slot = hawk_rtx_searchmapval(rtx, map, &key);
+			v = slot? *slot: hawk_val_nil;
 		}
 		else
 		{
@@ -7647,10 +8475,10 @@ static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 			case HAWK_VAL_MAP:
 			val_map:
 				if (str && str != idxbuf) hawk_rtx_freemem (rtx, str);
-				len = HAWK_COUNTOF(idxbuf);
-				str = idxnde_to_str(rtx, remidx, idxbuf, &len, &remidx, HAWK_NULL);
+				key.len = HAWK_COUNTOF(idxbuf);
+				str = idxnde_to_key(rtx, remidx, idxbuf, &key, &remidx);
 				if (HAWK_UNLIKELY(!str)) goto oops;
-				map = ((hawk_val_map_t*)v)->map;
+				map = v;
 				break;
 
 			case HAWK_VAL_ARR:
@@ -7665,7 +8493,7 @@ static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 				{
 					if (container_vtype == HAWK_VAL_MAP)
 					{
-						v = assign_newmapval_in_map(rtx, map, str, len);
+						v = assign_newmapval_in_map(rtx, map, &key);
 						if (HAWK_UNLIKELY(!v)) { ADJERR_LOC (rtx, &var->loc); goto oops; }
 						vtype = HAWK_VAL_MAP;
 						goto val_map;
@@ -7687,10 +8515,10 @@ static hawk_val_t* eval_indexed (hawk_rtx_t* rtx, hawk_nde_var_t* var)
 
 	if (vtype == HAWK_VAL_MAP)
 	{
-		hawk_map_pair_t* pair;
-		pair = hawk_map_search(map, str, len);
+		hawk_val_t** slot;
+		slot = hawk_rtx_searchmapval(rtx, map, &key);
 		if (str && str != idxbuf) hawk_rtx_freemem (rtx, str);
-		return pair? (hawk_val_t*)HAWK_MAP_VPTR(pair): hawk_val_nil;
+		return slot? *slot: hawk_val_nil;
 	}
 	else
 	{
@@ -7752,6 +8580,12 @@ static hawk_val_t* eval_pos (hawk_rtx_t* rtx, hawk_nde_t* nde)
 		return HAWK_NULL;
 	}
 
+	if (lv > (hawk_int_t)rtx->inrec.nflds && rtx->inrec.split.pending && hawk_rtx_splitrec(rtx) <= -1)
+	{
+		ADJERR_LOC (rtx, &nde->loc);
+		return HAWK_NULL;
+	}
+
 	v = POS_VAL(rtx, lv);
 #if 0
 	if (lv == 0) v = rtx->inrec.d0;
@@ -8041,9 +8875,41 @@ read_again:
 	return 1;
 }
 
-static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t* buf, hawk_oow_t* len, hawk_nde_t** remidx, hawk_int_t* firstidxint)
+static hawk_ooch_t* idxval_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_val_t* idx, hawk_ooch_t* buf, hawk_oow_t* len)
 {
-	hawk_ooch_t* str;
+	hawk_rtx_valtostr_out_t out;
+
+	if (buf)
+	{
+		/* try with a fixed-size buffer if given */
+		out.type = HAWK_RTX_VALTOSTR_CPLCPY;
+		out.u.cplcpy.ptr = buf;
+		out.u.cplcpy.len = *len;
+
+		if (hawk_rtx_valtostr(rtx, idx, &out) >= 0)
+		{
+			*len = out.u.cplcpy.len;
+			HAWK_ASSERT (out.u.cplcpy.ptr == buf);
+			return out.u.cplcpy.ptr;
+		}
+	}
+
+	/* if no fixed-size buffer was given or the fixed-size
+	 * conversion failed, switch to the dynamic mode */
+	out.type = HAWK_RTX_VALTOSTR_CPLDUP;
+	if (hawk_rtx_valtostr(rtx, idx, &out) <= -1)
+	{
+		ADJERR_LOC (rtx, &nde->loc);
+		return HAWK_NULL;
+	}
+
+	*len = out.u.cpldup.len;
+	return out.u.cpldup.ptr;
+}
+
+static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t* buf, hawk_oow_t* len, hawk_nde_t** remidx, hawk_int_t* firstidxint)
+{
+	hawk_ooch_t* str;
 	hawk_val_t* idx;
 	hawk_int_t idxint;
 
@@ -8051,8 +8917,6 @@ static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t
 
 	if (!nde->next)
 	{
-		hawk_rtx_valtostr_out_t out;
-
 		/* single node index */
 		idx = eval_expression(rtx, nde);
 		if (HAWK_UNLIKELY(!idx)) return HAWK_NULL;
@@ -8069,40 +8933,10 @@ static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t
 			}
 		}
 
-		str = HAWK_NULL;
-
-		if (buf)
-		{
-			/* try with a fixed-size buffer if given */
-			out.type = HAWK_RTX_VALTOSTR_CPLCPY;
-			out.u.cplcpy.ptr = buf;
-			out.u.cplcpy.len = *len;
-
-			if (hawk_rtx_valtostr(rtx, idx, &out) >= 0)
-			{
-				str = out.u.cplcpy.ptr;
-				*len = out.u.cplcpy.len;
-				HAWK_ASSERT (str == buf);
-			}
-		}
-
-		if (!str)
-		{
-			/* if no fixed-size buffer was given or the fixed-size
-			 * conversion failed, switch to the dynamic mode */
-			out.type = HAWK_RTX_VALTOSTR_CPLDUP;
-			if (hawk_rtx_valtostr(rtx, idx, &out) <= -1)
-			{
-				hawk_rtx_refdownval (rtx, idx);
-				ADJERR_LOC (rtx, &nde->loc);
-				return HAWK_NULL;
-			}
-
-			str = out.u.cpldup.ptr;
-			*len = out.u.cpldup.len;
-		}
-
+		str = idxval_to_str(rtx, nde, idx, buf, len);
 		hawk_rtx_refdownval (rtx, idx);
+		if (HAWK_UNLIKELY(!str)) return HAWK_NULL;
+
 		*remidx = HAWK_NULL;
 	}
 	else
@@ -8186,6 +9020,51 @@ static hawk_ooch_t* idxnde_to_str (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t
 	return str;
 }
 
+/* convert an index to a key to a map value. an integer index is used as
+ * it is without conversion to a string. the return value is the string
+ * to free with hawk_rtx_freemem() if it is not buf. key->len must hold
+ * the capacity of buf on entry. */
+static hawk_ooch_t* idxnde_to_key (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_ooch_t* buf, hawk_val_map_key_t* key, hawk_nde_t** remidx)
+{
+	hawk_ooch_t* str;
+	hawk_val_t* idx;
+
+	HAWK_ASSERT (nde != HAWK_NULL);
+
+#if defined(HAWK_ENABLE_GC)
+	if (nde->next && nde->next->type != HAWK_NDE_NULL)
+#else
+	if (nde->next)
+#endif
+	{
+		/* multidimensional index */
+		str = idxnde_to_str(rtx, nde, buf, &key->len, remidx, HAWK_NULL);
+		key->ptr = str;
+		return str;
+	}
+
+	idx = eval_expression(rtx, nde);
+	if (HAWK_UNLIKELY(!idx)) return HAWK_NULL;
+
+	hawk_rtx_refupval (rtx, idx);
+	if (HAWK_RTX_GETVALTYPE(rtx, idx) == HAWK_VAL_INT)
+	{
+		key->ptr = HAWK_NULL;
+		key->idx = HAWK_RTX_GETINTFROMVAL(rtx, idx);
+		str = buf;
+	}
+	else
+	{
+		str = idxval_to_str(rtx, nde, idx, buf, &key->len);
+		key->ptr = str;
+	}
+	hawk_rtx_refdownval (rtx, idx);
+
+	/* the index nested under this is after the HAWK_NDE_NULL node if any */
+	*remidx = nde->next? nde->next->next: HAWK_NULL;
+	return str;
+}
+
 static hawk_ooi_t idxnde_to_int (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_nde_t** remidx)
 {
 	hawk_int_t v;
@@ -8224,12 +9103,220 @@ static hawk_ooi_t idxnde_to_int (hawk_rtx_t* rtx, hawk_nde_t* nde, hawk_nde_t**
 
 /* ========================================================================= */
 
-hawk_ooch_t* hawk_rtx_format (
+/* a format string is parsed into a list of the literal text and the
+ * conversion specifications once and the list is kept in a small cache
+ * of the runtime context. hawk_rtx_format() and hawk_rtx_formatmbs()
+ * walk the list instead of parsing the format string at each call. */
+
+#define FLAG_SPACE (1 << 0)
+#define FLAG_HASH  (1 << 1)
+#define FLAG_ZERO  (1 << 2)
+#define FLAG_PLUS  (1 << 3)
+#define FLAG_MINUS (1 << 4)
+
+static hawk_oow_t parse_format (const hawk_ooch_t* ofmt, const hawk_bch_t* bfmt, hawk_oow_t fmt_len, hawk_fmtseg_t* seg)
+{
+	/* either ofmt or bfmt is given. only the ascii characters are
+	 * looked at. the fixed width and precision are taken in the
+	 * digits that hawk_rtx_format() and hawk_rtx_formatmbs() used
+	 * to accept respectively */
+#define FC(x) (ofmt? ofmt[x]: (hawk_ooch_t)bfmt[x])
+#define IS_FDIGIT(x) (ofmt? hawk_is_ooch_digit(ofmt[x]): hawk_is_bch_digit(bfmt[x]))
+
+	hawk_oow_t i = 0, lit = 0, n = 0;
+	hawk_fmtseg_t s;
+
+	while (i < fmt_len)
+	{
+		if (FC(i) != '%')
+		{
+			i++;
+			continue;
+		}
+
+		if (i > lit)
+		{
+			if (seg)
+			{
+				seg[n].type = HAWK_FMTSEG_LITERAL;
+				seg[n].off = lit;
+				seg[n].len = i - lit;
+			}
+			n++;
+		}
+
+		s.off = i++;
+		s.flags = 0;
+		while (i < fmt_len)
+		{
+			switch (FC(i))
+			{
+				case ' ':
+					s.flags |= FLAG_SPACE;
+					break;
+				case '#':
+					s.flags |= FLAG_HASH;
+					break;
+				case '0':
+					s.flags |= FLAG_ZERO;
+					break;
+				case '+':
+					s.flags |= FLAG_PLUS;
+					break;
+				case '-':
+					s.flags |= FLAG_MINUS;
+					break;
+				default:
+					goto wp_init;
+			}
+			i++;
+		}
+
+	wp_init:
+		s.wp[0] = 0; /* width */
+		s.wp[1] = -1; /* precision */
+		s.wp_idx = 0; /* width first */
+		s.star[0] = (hawk_oow_t)-1;
+		s.star[1] = (hawk_oow_t)-1;
+
+	wp_main:
+		if (i < fmt_len && FC(i) == '*')
+		{
+			s.star[s.wp_idx] = i++;
+		}
+		else if (i < fmt_len && IS_FDIGIT(i))
+		{
+			s.wp[s.wp_idx] = 0;
+			do
+			{
+				s.wp[s.wp_idx] = s.wp[s.wp_idx] * 10 + FC(i) - '0';
+				i++;
+			}
+			while (i < fmt_len && IS_FDIGIT(i));
+		}
+
+		if (s.wp_idx == 0 && i < fmt_len && FC(i) == '.')
+		{
+			i++;
+			s.wp[1] = 0;
+			s.wp_idx = 1; /* precision */
+			goto wp_main;
+		}
+
+		if (i >= fmt_len)
+		{
+			s.type = HAWK_FMTSEG_TAIL;
+			s.len = fmt_len - s.off;
+		}
+		else
+		{
+			s.type = HAWK_FMTSEG_SPEC;
+			s.len = i - s.off;
+			i++; /* skip the conversion character */
+		}
+
+		if (seg) seg[n] = s;
+		n++;
+		lit = i;
+	}
+
+	if (lit < fmt_len)
+	{
+		if (seg)
+		{
+			seg[n].type = HAWK_FMTSEG_LITERAL;
+			seg[n].off = lit;
+			seg[n].len = fmt_len - lit;
+		}
+		n++;
+	}
+
+	return n;
+
+#undef IS_FDIGIT
+#undef FC
+}
+
+static hawk_fmtseg_t* get_fmtsegs (hawk_rtx_t* rtx, const void* fmt, hawk_oow_t fmt_len, int mbs, hawk_oow_t* nsegs, hawk_fmtcache_ent_t** pin)
+{
+	hawk_fmtcache_ent_t* ent;
+	hawk_fmtseg_t* seg;
+	hawk_oow_t hash, fmt_size, n;
+
+	fmt_size = fmt_len * (mbs? HAWK_SIZEOF(hawk_bch_t): HAWK_SIZEOF(hawk_ooch_t));
+	HAWK_HASH_BYTES (hash, fmt, fmt_size);
+	hash = HAWK_HASH_VALUE(hash, mbs);
+
+	ent = &rtx->fmtcache.ent[hash & (HAWK_FMT_CACHE_SIZE - 1)];
+	if (ent->seg && ent->hash == hash && ent->mbs == mbs && ent->len == fmt_len &&
+	    HAWK_MEMCMP(ent->seg + ent->nsegs, fmt, fmt_size) == 0)
+	{
+		ent->busy++;
+		*nsegs = ent->nsegs;
+		*pin = ent;
+		return ent->seg;
+	}
+
+	n = mbs? parse_format(HAWK_NULL, (const hawk_bch_t*)fmt, fmt_len, HAWK_NULL):
+	         parse_format((const hawk_ooch_t*)fmt, HAWK_NULL, fmt_len, HAWK_NULL);
+
+	/* the copy of the format string follows the segments */
+	seg = (hawk_fmtseg_t*)hawk_rtx_allocmem(rtx, n * HAWK_SIZEOF(*seg) + fmt_size + 1);
+	if (HAWK_UNLIKELY(!seg)) return HAWK_NULL;
+
+	if (mbs) parse_format(HAWK_NULL, (const hawk_bch_t*)fmt, fmt_len, seg);
+	else parse_format((const hawk_ooch_t*)fmt, HAWK_NULL, fmt_len, seg);
+	HAWK_MEMCPY (seg + n, fmt, fmt_size);
+	*nsegs = n;
+
+	if (ent->busy)
+	{
+		/* a call up the stack is using the entry while an argument
+		 * is evaluated. use the segments without keeping them */
+		*pin = HAWK_NULL;
+		return seg;
+	}
+
+	if (ent->seg) hawk_rtx_freemem (rtx, ent->seg);
+	ent->hash = hash;
+	ent->len = fmt_len;
+	ent->mbs = mbs;
+	ent->busy = 1;
+	ent->nsegs = n;
+	ent->seg = seg;
+
+	*pin = ent;
+	return seg;
+}
+
+static HAWK_INLINE void put_fmtsegs (hawk_rtx_t* rtx, hawk_fmtseg_t* seg, hawk_fmtcache_ent_t* ent)
+{
+	if (ent) ent->busy--;
+	else hawk_rtx_freemem (rtx, seg);
+}
+
+static void clear_fmtcache (hawk_rtx_t* rtx)
+{
+	hawk_oow_t i;
+
+	for (i = 0; i < HAWK_COUNTOF(rtx->fmtcache.ent); i++)
+	{
+		HAWK_ASSERT (rtx->fmtcache.ent[i].busy == 0);
+		if (rtx->fmtcache.ent[i].seg)
+		{
+			hawk_rtx_freemem (rtx, rtx->fmtcache.ent[i].seg);
+			rtx->fmtcache.ent[i].seg = HAWK_NULL;
+		}
+	}
+}
+
+static hawk_ooch_t* format_with_segs (
 	hawk_rtx_t* rtx, hawk_ooecs_t* out, hawk_ooecs_t* fbu,
 	const hawk_ooch_t* fmt, hawk_oow_t fmt_len,
-	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len)
+	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len,
+	const hawk_fmtseg_t* segs, hawk_oow_t nsegs)
 {
-	hawk_oow_t i;
+	hawk_oow_t i, si;
 	hawk_oow_t stack_arg_idx = 1;
 	hawk_val_t* val;
 
@@ -8291,10 +9378,12 @@ hawk_ooch_t* hawk_rtx_format (
 	hawk_ooecs_clear (out);
 	hawk_ooecs_clear (fbu);
 
-	for (i = 0; i < fmt_len; i++)
+	for (si = 0; si < nsegs; si++)
 	{
+		const hawk_fmtseg_t* seg = &segs[si];
 		hawk_int_t wp[2];
-		int wp_idx;
+		int wp_idx, k;
+		hawk_oow_t pos;
 #define WP_WIDTH     0
 #define WP_PRECISION 1
 
@@ -8305,57 +9394,23 @@ hawk_ooch_t* hawk_rtx_format (
 #define FLAG_PLUS  (1 << 3)
 #define FLAG_MINUS (1 << 4)
 
-		if (HAWK_OOECS_LEN(fbu) == 0)
+		if (seg->type == HAWK_FMTSEG_LITERAL)
 		{
-			/* format specifier is empty */
-			if (fmt[i] == HAWK_T('%'))
-			{
-				/* add % to format specifier (fbu) */
-				FMT_CHAR (fmt[i]);
-			}
-			else
-			{
-				/* normal output */
-				OUT_CHAR (fmt[i]);
-			}
+			/* normal output */
+			OUT_STR (&fmt[seg->off], seg->len);
 			continue;
 		}
 
-		/* handle flags */
-		flags = 0;
-		while (i < fmt_len)
-		{
-			switch (fmt[i])
-			{
-				case HAWK_T(' '):
-					flags |= FLAG_SPACE;
-					break;
-				case HAWK_T('#'):
-					flags |= FLAG_HASH;
-					break;
-				case HAWK_T('0'):
-					flags |= FLAG_ZERO;
-					break;
-				case HAWK_T('+'):
-					flags |= FLAG_PLUS;
-					break;
-				case HAWK_T('-'):
-					flags |= FLAG_MINUS;
-					break;
-				default:
-					goto wp_mod_init;
-			}
+		flags = seg->flags;
+		wp[WP_WIDTH] = seg->wp[WP_WIDTH];
+		wp[WP_PRECISION] = seg->wp[WP_PRECISION];
+		wp_idx = seg->wp_idx;
 
-			FMT_CHAR (fmt[i]); i++;
-		}
-
-wp_mod_init:
-		wp[WP_WIDTH] = 0; /* width */
-		wp[WP_PRECISION] = -1; /* precision */
-		wp_idx = WP_WIDTH; /* width first */
-
-wp_mod_main:
-		if (i < fmt_len && fmt[i] == HAWK_T('*'))
+		/* the format specifier (fbu) is the specification in the format
+		 * string with the variable width/precision replaced by the value */
+		hawk_ooecs_clear (fbu);
+		pos = seg->off;
+		for (k = WP_WIDTH; k <= WP_PRECISION; k++)
 		{
 			/* variable width/precision modifier.
 			 * take the width/precision from a parameter and
@@ -8363,6 +9418,11 @@ wp_mod_main:
 			hawk_val_t* v;
 			int n;
 
+			if (seg->star[k] == (hawk_oow_t)-1) continue;
+
+			FMT_STR (&fmt[pos], seg->star[k] - pos);
+			pos = seg->star[k] + 1;
+
 			if (!args)
 			{
 				if (stack_arg_idx >= nargs_on_stack)
@@ -8391,7 +9451,7 @@ wp_mod_main:
 			}
 
 			hawk_rtx_refupval (rtx, v);
-			n = hawk_rtx_valtoint(rtx, v, &wp[wp_idx]);
+			n = hawk_rtx_valtoint(rtx, v, &wp[k]);
 			hawk_rtx_refdownval (rtx, v);
 			if (HAWK_UNLIKELY(n <= -1)) return HAWK_NULL;
 
@@ -8400,7 +9460,7 @@ wp_mod_main:
 				n = hawk_fmt_intmax_to_oocstr(
 					rtx->format.tmp.ptr,
 					rtx->format.tmp.len,
-					wp[wp_idx],
+					wp[k],
 					10 | HAWK_FMT_INTMAX_NOTRUNC | HAWK_FMT_INTMAX_NONULL,
 					-1,
 					HAWK_T('\0'),
@@ -8422,32 +9482,17 @@ wp_mod_main:
 
 			if (!args || val) stack_arg_idx++;
 			else args = args->next;
-			i++;
-		}
-		else
-		{
-			/* fixed width/precision modifier */
-			if (i < fmt_len && hawk_is_ooch_digit(fmt[i]))
-			{
-				wp[wp_idx] = 0;
-				do
-				{
-					wp[wp_idx] = wp[wp_idx] * 10 + fmt[i] - HAWK_T('0');
-					FMT_CHAR (fmt[i]); i++;
-				}
-				while (i < fmt_len && hawk_is_ooch_digit(fmt[i]));
-			}
 		}
+		FMT_STR (&fmt[pos], seg->off + seg->len - pos);
 
-		if (wp_idx == WP_WIDTH && i < fmt_len && fmt[i] == HAWK_T('.'))
+		if (seg->type == HAWK_FMTSEG_TAIL)
 		{
-			FMT_CHAR (fmt[i]); i++;
-			wp[WP_PRECISION] = 0;
-			wp_idx = WP_PRECISION; /* change index to precision */
-			goto wp_mod_main;
+			/* flush uncompleted formatting sequence */
+			OUT_STR (HAWK_OOECS_PTR(fbu), HAWK_OOECS_LEN(fbu));
+			break;
 		}
 
-		if (i >= fmt_len) break;
+		i = seg->off + seg->len; /* conversion character */
 
 		if (wp[WP_WIDTH] < 0)
 		{
@@ -9088,24 +10133,40 @@ wp_mod_main:
 		if (!args || val) stack_arg_idx++;
 		else args = args->next;
 	skip_taking_arg:
-		hawk_ooecs_clear (fbu);
+		;
 	}
 
-	/* flush uncompleted formatting sequence */
-	OUT_STR (HAWK_OOECS_PTR(fbu), HAWK_OOECS_LEN(fbu));
-
 	*len = HAWK_OOECS_LEN(out);
 	return HAWK_OOECS_PTR(out);
 }
 
+hawk_ooch_t* hawk_rtx_format (
+	hawk_rtx_t* rtx, hawk_ooecs_t* out, hawk_ooecs_t* fbu,
+	const hawk_ooch_t* fmt, hawk_oow_t fmt_len,
+	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len)
+{
+	hawk_fmtcache_ent_t* ent;
+	hawk_fmtseg_t* segs;
+	hawk_oow_t nsegs;
+	hawk_ooch_t* ptr;
+
+	segs = get_fmtsegs(rtx, fmt, fmt_len, 0, &nsegs, &ent);
+	if (HAWK_UNLIKELY(!segs)) return HAWK_NULL;
+
+	ptr = format_with_segs(rtx, out, fbu, fmt, fmt_len, nargs_on_stack, args, len, segs, nsegs);
+	put_fmtsegs (rtx, segs, ent);
+	return ptr;
+}
+
 /* ========================================================================= */
 
-hawk_bch_t* hawk_rtx_formatmbs (
+static hawk_bch_t* formatmbs_with_segs (
 	hawk_rtx_t* rtx, hawk_becs_t* out, hawk_becs_t* fbu,
 	const hawk_bch_t* fmt, hawk_oow_t fmt_len,
-	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len)
+	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len,
+	const hawk_fmtseg_t* segs, hawk_oow_t nsegs)
 {
-	hawk_oow_t i;
+	hawk_oow_t i, si;
 	hawk_oow_t stack_arg_idx = 1;
 	hawk_val_t* val;
 
@@ -9167,10 +10228,12 @@ hawk_bch_t* hawk_rtx_formatmbs (
 	hawk_becs_clear (out);
 	hawk_becs_clear (fbu);
 
-	for (i = 0; i < fmt_len; i++)
+	for (si = 0; si < nsegs; si++)
 	{
+		const hawk_fmtseg_t* seg = &segs[si];
 		hawk_int_t wp[2];
-		int wp_idx;
+		int wp_idx, k;
+		hawk_oow_t pos;
 #define WP_WIDTH     0
 #define WP_PRECISION 1
 
@@ -9181,57 +10244,23 @@ hawk_bch_t* hawk_rtx_formatmbs (
 #define FLAG_PLUS  (1 << 3)
 #define FLAG_MINUS (1 << 4)
 
-		if (HAWK_BECS_LEN(fbu) == 0)
+		if (seg->type == HAWK_FMTSEG_LITERAL)
 		{
-			/* format specifier is empty */
-			if (fmt[i] == HAWK_BT('%'))
-			{
-				/* add % to format specifier (fbu) */
-				FMT_MCHAR (fmt[i]);
-			}
-			else
-			{
-				/* normal output */
-				OUT_MCHAR (fmt[i]);
-			}
+			/* normal output */
+			OUT_MBS (&fmt[seg->off], seg->len);
 			continue;
 		}
 
-		/* handle flags */
-		flags = 0;
-		while (i < fmt_len)
-		{
-			switch (fmt[i])
-			{
-				case HAWK_BT(' '):
-					flags |= FLAG_SPACE;
-					break;
-				case HAWK_BT('#'):
-					flags |= FLAG_HASH;
-					break;
-				case HAWK_BT('0'):
-					flags |= FLAG_ZERO;
-					break;
-				case HAWK_BT('+'):
-					flags |= FLAG_PLUS;
-					break;
-				case HAWK_BT('-'):
-					flags |= FLAG_MINUS;
-					break;
-				default:
-					goto wp_mod_init;
-			}
-
-			FMT_MCHAR (fmt[i]); i++;
-		}
-
-wp_mod_init:
-		wp[WP_WIDTH] = 0; /* width */
-		wp[WP_PRECISION] = -1; /* precision */
-		wp_idx = WP_WIDTH; /* width first */
+		flags = seg->flags;
+		wp[WP_WIDTH] = seg->wp[WP_WIDTH];
+		wp[WP_PRECISION] = seg->wp[WP_PRECISION];
+		wp_idx = seg->wp_idx;
 
-wp_mod_main:
-		if (i < fmt_len && fmt[i] == HAWK_BT('*'))
+		/* the format specifier (fbu) is the specification in the format
+		 * string with the variable width/precision replaced by the value */
+		hawk_becs_clear (fbu);
+		pos = seg->off;
+		for (k = WP_WIDTH; k <= WP_PRECISION; k++)
 		{
 			/* variable width/precision modifier.
 			 * take the width/precision from a parameter and
@@ -9239,6 +10268,11 @@ wp_mod_main:
 			hawk_val_t* v;
 			int n;
 
+			if (seg->star[k] == (hawk_oow_t)-1) continue;
+
+			FMT_MBS (&fmt[pos], seg->star[k] - pos);
+			pos = seg->star[k] + 1;
+
 			if (!args)
 			{
 				if (stack_arg_idx >= nargs_on_stack)
@@ -9267,7 +10301,7 @@ wp_mod_main:
 			}
 
 			hawk_rtx_refupval (rtx, v);
-			n = hawk_rtx_valtoint(rtx, v, &wp[wp_idx]);
+			n = hawk_rtx_valtoint(rtx, v, &wp[k]);
 			hawk_rtx_refdownval (rtx, v);
 			if (HAWK_UNLIKELY(n <= -1)) return HAWK_NULL;
 
@@ -9276,7 +10310,7 @@ wp_mod_main:
 				n = hawk_fmt_intmax_to_bcstr (
 					rtx->formatmbs.tmp.ptr,
 					rtx->formatmbs.tmp.len,
-					wp[wp_idx],
+					wp[k],
 					10 | HAWK_FMT_INTMAX_NOTRUNC | HAWK_FMT_INTMAX_NONULL,
 					-1,
 					HAWK_BT('\0'),
@@ -9298,33 +10332,17 @@ wp_mod_main:
 
 			if (!args || val) stack_arg_idx++;
 			else args = args->next;
-			i++;
-		}
-		else
-		{
-			/* fixed width/precision modifier */
-			if (i < fmt_len && hawk_is_bch_digit(fmt[i]))
-			{
-				wp[wp_idx] = 0;
-				do
-				{
-					wp[wp_idx] = wp[wp_idx] * 10 + fmt[i] - HAWK_BT('0');
-					FMT_MCHAR (fmt[i]); i++;
-				}
-				while (i < fmt_len && hawk_is_bch_digit(fmt[i]));
-			}
 		}
+		FMT_MBS (&fmt[pos], seg->off + seg->len - pos);
 
-		if (wp_idx == WP_WIDTH && i < fmt_len && fmt[i] == HAWK_BT('.'))
+		if (seg->type == HAWK_FMTSEG_TAIL)
 		{
-			FMT_MCHAR (fmt[i]); i++;
-
-			wp[WP_PRECISION] = 0;
-			wp_idx = WP_PRECISION; /* change index to precision */
-			goto wp_mod_main;
+			/* flush uncompleted formatting sequence */
+			OUT_MBS (HAWK_BECS_PTR(fbu), HAWK_BECS_LEN(fbu));
+			break;
 		}
 
-		if (i >= fmt_len) break;
+		i = seg->off + seg->len; /* conversion character */
 
 		if (wp[WP_WIDTH] < 0)
 		{
@@ -9971,16 +10989,31 @@ wp_mod_main:
 		if (!args || val) stack_arg_idx++;
 		else args = args->next;
 	skip_taking_arg:
-		hawk_becs_clear (fbu);
+		;
 	}
 
-	/* flush uncompleted formatting sequence */
-	OUT_MBS (HAWK_BECS_PTR(fbu), HAWK_BECS_LEN(fbu));
-
 	*len = HAWK_BECS_LEN(out);
 	return HAWK_BECS_PTR(out);
 }
 
+hawk_bch_t* hawk_rtx_formatmbs (
+	hawk_rtx_t* rtx, hawk_becs_t* out, hawk_becs_t* fbu,
+	const hawk_bch_t* fmt, hawk_oow_t fmt_len,
+	hawk_oow_t nargs_on_stack, hawk_nde_t* args, hawk_oow_t* len)
+{
+	hawk_fmtcache_ent_t* ent;
+	hawk_fmtseg_t* segs;
+	hawk_oow_t nsegs;
+	hawk_bch_t* ptr;
+
+	segs = get_fmtsegs(rtx, fmt, fmt_len, 1, &nsegs, &ent);
+	if (HAWK_UNLIKELY(!segs)) return HAWK_NULL;
+
+	ptr = formatmbs_with_segs(rtx, out, fbu, fmt, fmt_len, nargs_on_stack, args, len, segs, nsegs);
+	put_fmtsegs (rtx, segs, ent);
+	return ptr;
+}
+
 /* ------------------------------------------------------------------------- */
 
 void hawk_rtx_setnrflt (hawk_rtx_t* rtx, const hawk_nrflt_t* nrflt)
@@ -10023,3 +11056,118 @@ int hawk_rtx_buildrex (hawk_rtx_t* rtx, const hawk_ooch_t* ptn, hawk_oow_t len,
 {
 	return hawk_gem_buildrex(hawk_rtx_getgem(rtx), ptn, len, !(rtx->hawk->opt.trait & HAWK_REXBOUND), code, icode);
 }
+
+/* ------------------------------------------------------------------------ */
+
+static HAWK_INLINE void unlink_rexcache_lru (hawk_rtx_t* rtx, hawk_rexcache_ent_t* ent)
+{
+	if (ent->prev) ent->prev->next = ent->next;
+	else rtx->rexcache.head = ent->next;
+	if (ent->next) ent->next->prev = ent->prev;
+	else rtx->rexcache.tail = ent->prev;
+}
+
+static HAWK_INLINE void link_rexcache_lru (hawk_rtx_t* rtx, hawk_rexcache_ent_t* ent)
+{
+	ent->prev = HAWK_NULL;
+	ent->next = rtx->rexcache.head;
+	if (rtx->rexcache.head) rtx->rexcache.head->prev = ent;
+	else rtx->rexcache.tail = ent;
+	rtx->rexcache.head = ent;
+}
+
+static void evict_rexcache (hawk_rtx_t* rtx, hawk_rexcache_ent_t* ent)
+{
+	hawk_rexcache_ent_t** pp;
+
+	pp = &rtx->rexcache.bucket[ent->hash & (HAWK_REX_CACHE_BUCKETS - 1)];
+	while (*pp != ent) pp = &(*pp)->link;
+	*pp = ent->link;
+
+	unlink_rexcache_lru (rtx, ent);
+
+	hawk_tre_close (ent->code);
+	hawk_rtx_freemem (rtx, ent->ptn);
+	ent->code = HAWK_NULL;
+	ent->ptn = HAWK_NULL;
+}
+
+static void clear_rexcache (hawk_rtx_t* rtx)
+{
+	while (rtx->rexcache.tail) evict_rexcache (rtx, rtx->rexcache.tail);
+	rtx->rexcache.count = 0;
+}
+
+hawk_tre_t* hawk_rtx_getcachedrex (hawk_rtx_t* rtx, const hawk_ooch_t* ptn, hawk_oow_t len, int ignorecase)
+{
+	hawk_rexcache_ent_t* ent;
+	hawk_oow_t hash;
+	hawk_ooch_t* dup;
+	hawk_tre_t* code;
+	int flags, x;
+
+	flags = (ignorecase? HAWK_REXCACHE_IGNORECASE: 0) |
+	        ((rtx->hawk->opt.trait & HAWK_REXBOUND)? 0: HAWK_REXCACHE_NOBOUND);
+
+	HAWK_HASH_BYTES (hash, ptn, len * HAWK_SIZEOF(*ptn));
+	hash = HAWK_HASH_VALUE(hash, flags);
+
+	for (ent = rtx->rexcache.bucket[hash & (HAWK_REX_CACHE_BUCKETS - 1)]; ent; ent = ent->link)
+	{
+		if (ent->hash == hash && ent->flags == flags && ent->len == len &&
+		    HAWK_MEMCMP(ent->ptn, ptn, len * HAWK_SIZEOF(*ptn)) == 0)
+		{
+			if (ent != rtx->rexcache.head)
+			{
+				unlink_rexcache_lru (rtx, ent);
+				link_rexcache_lru (rtx, ent);
+			}
+			rtx->rexcache.hits++;
+			return ent->code;
+		}
+	}
+
+	rtx->rexcache.misses++;
+
+	x = ignorecase? hawk_rtx_buildrex(rtx, ptn, len, HAWK_NULL, &code):
+	                hawk_rtx_buildrex(rtx, ptn, len, &code, HAWK_NULL);
+	if (HAWK_UNLIKELY(x <= -1)) return HAWK_NULL;
+
+	dup = hawk_rtx_dupoochars(rtx, ptn, len);
+	if (HAWK_UNLIKELY(!dup))
+	{
+		hawk_tre_close (code);
+		return HAWK_NULL;
+	}
+
+	if (rtx->rexcache.count < HAWK_REX_CACHE_SIZE)
+	{
+		ent = &rtx->rexcache.ent[rtx->rexcache.count++];
+	}
+	else
+	{
+		/* reuse the least recently used entry */
+		ent = rtx->rexcache.tail;
+		evict_rexcache (rtx, ent);
+	}
+
+	ent->hash = hash;
+	ent->ptn = dup;
+	ent->len = len;
+	ent->flags = flags;
+	ent->code = code;
+
+	ent->link = rtx->rexcache.bucket[hash & (HAWK_REX_CACHE_BUCKETS - 1)];
+	rtx->rexcache.bucket[hash & (HAWK_REX_CACHE_BUCKETS - 1)] = ent;
+	link_rexcache_lru (rtx, ent);
+
+	return code;
+}
+
+void hawk_rtx_getrexcachestats (hawk_rtx_t* rtx, hawk_rexcache_stats_t* stats)
+{
+	stats->capa = HAWK_REX_CACHE_SIZE;
+	stats->size = rtx->rexcache.count;
+	stats->hits = rtx->rexcache.hits;
+	stats->misses = rtx->rexcache.misses;
+}
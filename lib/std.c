@@ -56,6 +56,9 @@
 	/* nothing to include */
 #else
 #	include "syscall.h"
+#	if defined(HAVE_SYS_MMAN_H)
+#		include <sys/mman.h>
+#	endif
 #	if defined(HAWK_ENABLE_LIBLTDL)
 #		include <ltdl.h>
 #		define USE_LTDL
@@ -1079,6 +1082,18 @@ static hawk_sio_t* open_sio_std_rtx (hawk_rtx_t* rtx, hawk_sio_std_t std, int fl
 
 /*** PARSESTD ***/
 
+static hawk_cmgr_t* get_script_cmgr (hawk_t* hawk, hawk_cmgr_t* cmgr)
+{
+	/* a script not given an explicit encoding takes a byte per character
+	 * in the byte I/O mode for its literals to hold the same bytes as
+	 * the records read */
+	if (cmgr) return cmgr;
+#if defined(HAWK_OOCH_IS_UCH)
+	if (hawk->opt.trait & HAWK_BYTEIO) return hawk_get_cmgr_by_id(HAWK_CMGR_MB8);
+#endif
+	return hawk_getcmgr(hawk);
+}
+
 static int is_psin_file (hawk_parsestd_t* psin)
 {
 	return psin->type == HAWK_PARSESTD_FILE ||
@@ -1121,7 +1136,7 @@ static int open_parsestd (hawk_t* hawk, hawk_sio_arg_t* arg, xtn_t* xtn, hawk_oo
 
 			arg->handle = tmp;
 			arg->path = path;
-			if (psin->u.fileb.cmgr) hawk_sio_setcmgr (arg->handle, psin->u.fileb.cmgr);
+			hawk_sio_setcmgr (arg->handle, get_script_cmgr(hawk, psin->u.fileb.cmgr));
 			return 0;
 		}
 
@@ -1153,7 +1168,7 @@ static int open_parsestd (hawk_t* hawk, hawk_sio_arg_t* arg, xtn_t* xtn, hawk_oo
 
 			arg->handle = tmp;
 			arg->path = path;
-			if (psin->u.fileu.cmgr) hawk_sio_setcmgr (arg->handle, psin->u.fileu.cmgr);
+			hawk_sio_setcmgr (arg->handle, get_script_cmgr(hawk, psin->u.fileu.cmgr));
 			return 0;
 		}
 
@@ -1370,6 +1385,7 @@ static hawk_ooi_t sf_in_open (hawk_t* hawk, hawk_sio_arg_t* arg, xtn_t* xtn)
 			return -1;
 		}
 
+		hawk_sio_setcmgr (arg->handle, get_script_cmgr(hawk, HAWK_NULL));
 		arg->path = xpath;
 		/* TODO: use the system handle(file descriptor) instead of the path? */
 		/*syshnd = hawk_sio_gethnd(arg->handle);*/
@@ -1479,7 +1495,7 @@ static hawk_ooi_t sf_in_read (hawk_t* hawk, hawk_sio_arg_t* arg, hawk_ooch_t* da
 
 				mbslen = xtn->s.in.u.bcs.end - xtn->s.in.u.bcs.ptr;
 				wcslen = size;
-				if ((m = hawk_conv_bchars_to_uchars_with_cmgr(xtn->s.in.u.bcs.ptr, &mbslen, data, &wcslen, hawk_getcmgr(hawk), 0)) <= -1 && m != -2)
+				if ((m = hawk_conv_bchars_to_uchars_with_cmgr(xtn->s.in.u.bcs.ptr, &mbslen, data, &wcslen, get_script_cmgr(hawk, HAWK_NULL), 0)) <= -1 && m != -2)
 				{
 					hawk_seterrnum (hawk, HAWK_NULL, HAWK_EINVAL);
 					n = -1;
@@ -1620,7 +1636,7 @@ static hawk_ooi_t sf_out (hawk_t* hawk, hawk_sio_cmd_t cmd, hawk_sio_arg_t* arg,
 						if (xtn->s.out.u.file.sio == HAWK_NULL) return -1;
 					}
 
-					if (xtn->s.out.x->u.fileb.cmgr) hawk_sio_setcmgr (xtn->s.out.u.file.sio, xtn->s.out.x->u.fileb.cmgr);
+					hawk_sio_setcmgr (xtn->s.out.u.file.sio, get_script_cmgr(hawk, xtn->s.out.x->u.fileb.cmgr));
 					return 1;
 
 			#if defined(HAWK_OOCH_IS_UCH)
@@ -1649,7 +1665,7 @@ static hawk_ooi_t sf_out (hawk_t* hawk, hawk_sio_cmd_t cmd, hawk_sio_arg_t* arg,
 						if (xtn->s.out.u.file.sio == HAWK_NULL) return -1;
 					}
 
-					if (xtn->s.out.x->u.fileu.cmgr) hawk_sio_setcmgr (xtn->s.out.u.file.sio, xtn->s.out.x->u.fileu.cmgr);
+					hawk_sio_setcmgr (xtn->s.out.u.file.sio, get_script_cmgr(hawk, xtn->s.out.x->u.fileu.cmgr));
 					return 1;
 
 				case HAWK_PARSESTD_OOCS:
@@ -1870,6 +1886,115 @@ int hawk_parsestd (hawk_t* hawk, hawk_parsestd_t in[], hawk_parsestd_t* out)
 	return n;
 }
 
+int hawk_saveimgstd (hawk_t* hawk, const hawk_bch_t* path)
+{
+	void* img;
+	hawk_oow_t len;
+	hawk_bch_t* tmp;
+	hawk_oow_t plen;
+	FILE* fp;
+	int n = -1;
+
+	img = hawk_saveimg(hawk, &len);
+	if (HAWK_UNLIKELY(!img)) return -1;
+
+	/* write to a temporary file and rename it not to leave a partial
+	 * image for a concurrent run to pick up */
+	plen = hawk_count_bcstr(path);
+	tmp = (hawk_bch_t*)hawk_allocmem(hawk, (plen + 5) * HAWK_SIZEOF(*tmp));
+	if (HAWK_UNLIKELY(!tmp)) goto done;
+	hawk_copy_bchars_to_bcstr_unlimited (tmp, path, plen);
+	hawk_copy_bcstr_unlimited (&tmp[plen], ".tmp");
+
+	fp = fopen(tmp, "wb");
+	if (!fp)
+	{
+		hawk_seterrfmt (hawk, HAWK_NULL, HAWK_EOPEN, HAWK_T("unable to open %hs"), tmp);
+		goto done;
+	}
+
+	if (fwrite(img, 1, len, fp) != len || fflush(fp) != 0)
+	{
+		hawk_seterrfmt (hawk, HAWK_NULL, HAWK_EIOERR, HAWK_T("unable to write %hs"), tmp);
+		fclose (fp);
+		remove (tmp);
+		goto done;
+	}
+	fclose (fp);
+
+#if defined(_WIN32) || defined(__OS2__) || defined(__DOS__)
+	remove (path);
+#endif
+	if (rename(tmp, path) != 0)
+	{
+		hawk_seterrfmt (hawk, HAWK_NULL, HAWK_EIOERR, HAWK_T("unable to rename %hs to %hs"), tmp, path);
+		remove (tmp);
+		goto done;
+	}
+
+	n = 0;
+
+done:
+	if (tmp) hawk_freemem (hawk, tmp);
+	hawk_freemem (hawk, img);
+	return n;
+}
+
+int hawk_loadimgstd (hawk_t* hawk, hawk_parsestd_t in[], const hawk_bch_t* path)
+{
+	hawk_sio_cbs_t sio;
+	xtn_t* xtn = GET_XTN(hawk);
+	FILE* fp;
+	long len;
+	void* img = HAWK_NULL;
+	int n = 0;
+
+	if (in == HAWK_NULL || in[0].type == HAWK_PARSESTD_NULL)
+	{
+		hawk_seterrnum (hawk, HAWK_NULL, HAWK_EINVAL);
+		return -1;
+	}
+
+	/* a missing image is the same as a stale image. the source is parsed */
+	fp = fopen(path, "rb");
+	if (!fp) goto parse;
+
+	if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET) != 0) goto close;
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+	img = mmap(HAWK_NULL, len, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+	if (img == MAP_FAILED) img = HAWK_NULL;
+#else
+	img = hawk_allocmem(hawk, len);
+	if (img && fread(img, 1, len, fp) != (size_t)len)
+	{
+		hawk_freemem (hawk, img);
+		img = HAWK_NULL;
+	}
+#endif
+
+	if (img)
+	{
+		sio.in = sf_in;
+		sio.out = HAWK_NULL;
+		xtn->s.in.x = in;
+		n = hawk_loadimg(hawk, &sio, img, len);
+
+	#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+		munmap (img, len);
+	#else
+		hawk_freemem (hawk, img);
+	#endif
+	}
+
+close:
+	fclose (fp);
+	if (n != 0) return n;
+
+parse:
+	return (hawk_parsestd(hawk, in, HAWK_NULL) <= -1)? -1: 0;
+}
+
 static int check_var_assign (hawk_rtx_t* rtx, const hawk_ooch_t* str)
 {
 	hawk_ooch_t* eq, * dstr;
@@ -2019,6 +2144,10 @@ static hawk_ooi_t pio_handler_open (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 		return -1;
 	}
 
+	/* the command may write to the same output as this program does.
+	 * write out the buffered output before the command starts */
+	hawk_rtx_flushallios (rtx);
+
 	handle = hawk_pio_open(
 		hawk_rtx_getgem(rtx),
 		0,
@@ -2153,6 +2282,32 @@ static void set_rio_error (hawk_rtx_t* rtx, hawk_errnum_t errnum, const hawk_ooc
 		errmsg, (path? HAWK_T(" "): HAWK_T("")), (path? path: HAWK_T("")), bem);
 }
 
+/* riod->uflags of a file or console output stream. the output to a stream
+ * opened with HAWK_SIO_NOAUTOFLUSH is written out when the buffer gets
+ * full or when it's flushed explicitly. a terminal is flushed after each
+ * write so that a prompt shows up before the input is read */
+#define RIO_UFLAG_FLUSH   (1 << 0)
+#define RIO_UFLAG_STDOUT  (1 << 1)
+
+static int is_interactive_sio (hawk_sio_t* sio)
+{
+#if defined(HAVE_ISATTY) && !defined(_WIN32) && !defined(__OS2__) && !defined(__DOS__)
+	return isatty(hawk_sio_gethnd(sio));
+#else
+	return 1;
+#endif
+}
+
+static void flush_console_output (hawk_rtx_t* rtx)
+{
+	rxtn_t* rxtn = GET_RXTN(rtx);
+
+	/* the file "-" and a device file such as /dev/stdout may write to
+	 * the standard output as the console does. write out what the
+	 * console holds first to keep the order */
+	if (rxtn->c.out.count > 0) hawk_rtx_flushio (rtx, HAWK_OUT_CONSOLE, HAWK_T(""));
+}
+
 static hawk_ooi_t hawk_rio_file (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_rio_arg_t* riod, void* data, hawk_oow_t size)
 {
 	switch (cmd)
@@ -2179,16 +2334,33 @@ static hawk_ooi_t hawk_rio_file (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_rio_a
 					return -1;
 			}
 
+			riod->uflags = 0;
 			if (riod->name[0] == '-' && riod->name[1] == '\0')
 			{
 				if (riod->mode == HAWK_RIO_FILE_READ)
+				{
 					handle = open_sio_std_rtx(rtx, HAWK_SIO_STDIN, HAWK_SIO_READ | HAWK_SIO_IGNOREECERR);
+				}
 				else
+				{
 					handle = open_sio_std_rtx(rtx, HAWK_SIO_STDOUT, HAWK_SIO_WRITE | HAWK_SIO_IGNOREECERR | HAWK_SIO_LINEBREAK);
+					riod->uflags = RIO_UFLAG_STDOUT;
+				}
 			}
 			else
 			{
+				/* buffer the output to a file fully. a device file such
+				 * as /dev/stderr is flushed at each newline as before.
+				 * it may well be the standard output as /dev/stdout and
+				 * /dev/fd/1 are. the console output is written out before
+				 * each write to it to keep the order */
+				if (riod->mode != HAWK_RIO_FILE_READ)
+				{
+					if (hawk_comp_oocstr_limited(riod->name, HAWK_T("/dev/"), 5, 0) == 0) riod->uflags = RIO_UFLAG_STDOUT;
+					else flags |= HAWK_SIO_NOAUTOFLUSH;
+				}
 				handle = hawk_sio_open(hawk_rtx_getgem(rtx), 0, riod->name, flags);
+				if (handle && (flags & HAWK_SIO_NOAUTOFLUSH) && is_interactive_sio(handle)) riod->uflags = RIO_UFLAG_FLUSH;
 			}
 			if (!handle)
 			{
@@ -2231,16 +2403,20 @@ static hawk_ooi_t hawk_rio_file (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_rio_a
 		case HAWK_RIO_CMD_WRITE:
 		{
 			hawk_ooi_t t;
+			if (riod->uflags & RIO_UFLAG_STDOUT) flush_console_output (rtx);
 			t = hawk_sio_putoochars((hawk_sio_t*)riod->handle, data, size);
 			if (t <= -1) set_rio_error (rtx, HAWK_EOPEN, HAWK_T("unable to write"), riod->name);
+			else if (riod->uflags & RIO_UFLAG_FLUSH) hawk_sio_flush ((hawk_sio_t*)riod->handle);
 			return t;
 		}
 
 		case HAWK_RIO_CMD_WRITE_BYTES:
 		{
 			hawk_ooi_t t;
+			if (riod->uflags & RIO_UFLAG_STDOUT) flush_console_output (rtx);
 			t = hawk_sio_putbchars((hawk_sio_t*)riod->handle, data, size);
 			if (t <= -1) set_rio_error (rtx, HAWK_EOPEN, HAWK_T("unable to write"), riod->name);
+			else if (riod->uflags & RIO_UFLAG_FLUSH) hawk_sio_flush ((hawk_sio_t*)riod->handle);
 			return t;
 		}
 
@@ -2266,6 +2442,16 @@ static hawk_ooi_t hawk_rio_file (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_rio_a
 	return -1;
 }
 
+static void set_console_cmgr (hawk_rtx_t* rtx, hawk_sio_t* sio)
+{
+	rxtn_t* rxtn = GET_RXTN(rtx);
+
+	if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+#if defined(HAWK_OOCH_IS_UCH)
+	else if (rtx->hawk->opt.trait & HAWK_BYTEIO) hawk_sio_setcmgr (sio, hawk_get_cmgr_by_id(HAWK_CMGR_MB8));
+#endif
+}
+
 static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 {
 	rxtn_t* rxtn = GET_RXTN(rtx);
@@ -2281,8 +2467,6 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 		hawk_val_t* v_argc, * v_argv, * v_pair;
 		hawk_int_t i_argc;
 		const hawk_ooch_t* file;
-		hawk_map_t* map;
-		hawk_map_pair_t* pair;
 		hawk_ooch_t ibuf[128];
 		hawk_oow_t ibuflen;
 		hawk_oocs_t as;
@@ -2310,9 +2494,6 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 			return -1;
 		}
 
-		map = ((hawk_val_map_t*)v_argv)->map;
-		HAWK_ASSERT (map != HAWK_NULL);
-
 	nextfile:
 		if (rxtn->c.in.index >= (i_argc - 1))  /* ARGV is a kind of 0-based array unlike other normal arrays or substring indexing scheme */
 		{
@@ -2325,7 +2506,7 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 				sio = open_sio_std_rtx(rtx, HAWK_SIO_STDIN, HAWK_SIO_READ | HAWK_SIO_IGNOREECERR);
 				if (HAWK_UNLIKELY(!sio)) return -1;
 
-				if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+				set_console_cmgr (rtx, sio);
 
 				riod->handle = sio;
 				rxtn->c.in.count++;
@@ -2337,17 +2518,14 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 
 		ibuflen = hawk_int_to_oocstr(rxtn->c.in.index + 1, 10, HAWK_NULL, ibuf, HAWK_COUNTOF(ibuf));
 
-		pair = hawk_map_search(map, ibuf, ibuflen);
-		if (!pair)
+		v_pair = hawk_rtx_getmapvalfld(rtx, v_argv, ibuf, ibuflen);
+		if (!v_pair)
 		{
 			/* the key doesn't exist any more */
 			if (rxtn->c.in.count <= 0) goto console_open_stdin;
 			return 0; /* end of console */
 		}
 
-		v_pair = HAWK_HTB_VPTR(pair);
-		HAWK_ASSERT (v_pair != HAWK_NULL);
-
 		as.ptr = hawk_rtx_getvaloocstr(rtx, v_pair, &as.len);
 		if (HAWK_UNLIKELY(!as.ptr)) return -1;
 
@@ -2398,7 +2576,7 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 			return -1;
 		}
 
-		if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+		set_console_cmgr (rtx, sio);
 
 		if (hawk_rtx_setfilenamewithoochars(rtx, file, hawk_count_oocstr(file)) <= -1)
 		{
@@ -2430,7 +2608,7 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 				sio = open_sio_std_rtx(rtx, HAWK_SIO_STDIN, HAWK_SIO_READ | HAWK_SIO_IGNOREECERR);
 				if (sio == HAWK_NULL) return -1;
 
-				if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+				set_console_cmgr (rtx, sio);
 
 				riod->handle = sio;
 				rxtn->c.in.count++;
@@ -2465,7 +2643,7 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 				open_sio_rtx(rtx, file, HAWK_SIO_READ | HAWK_SIO_IGNOREECERR);
 			if (HAWK_UNLIKELY(!sio)) return -1;
 
-			if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+			set_console_cmgr (rtx, sio);
 
 			if (hawk_rtx_setfilenamewithoochars(rtx, file, hawk_count_oocstr(file)) <= -1)
 			{
@@ -2492,13 +2670,14 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 			{
 				sio = open_sio_std_rtx (
 					rtx, HAWK_SIO_STDOUT,
-					HAWK_SIO_WRITE | HAWK_SIO_IGNOREECERR | HAWK_SIO_LINEBREAK
+					HAWK_SIO_WRITE | HAWK_SIO_IGNOREECERR | HAWK_SIO_LINEBREAK | HAWK_SIO_NOAUTOFLUSH
 				);
 				if (sio == HAWK_NULL) return -1;
 
-				if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+				set_console_cmgr (rtx, sio);
 
 				riod->handle = sio;
+				riod->uflags = is_interactive_sio(sio)? RIO_UFLAG_FLUSH: 0;
 				rxtn->c.out.count++;
 				return 1;
 			}
@@ -2521,11 +2700,11 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 			}
 
 			sio = (file[0] == HAWK_T('-') && file[1] == HAWK_T('\0'))?
-				open_sio_std_rtx(rtx, HAWK_SIO_STDOUT, HAWK_SIO_WRITE | HAWK_SIO_IGNOREECERR | HAWK_SIO_LINEBREAK):
-				open_sio_rtx(rtx, file, HAWK_SIO_WRITE | HAWK_SIO_CREATE | HAWK_SIO_TRUNCATE | HAWK_SIO_IGNOREECERR);
+				open_sio_std_rtx(rtx, HAWK_SIO_STDOUT, HAWK_SIO_WRITE | HAWK_SIO_IGNOREECERR | HAWK_SIO_LINEBREAK | HAWK_SIO_NOAUTOFLUSH):
+				open_sio_rtx(rtx, file, HAWK_SIO_WRITE | HAWK_SIO_CREATE | HAWK_SIO_TRUNCATE | HAWK_SIO_IGNOREECERR | HAWK_SIO_NOAUTOFLUSH);
 			if (sio == HAWK_NULL) return -1;
 
-			if (rxtn->c.cmgr) hawk_sio_setcmgr (sio, rxtn->c.cmgr);
+			set_console_cmgr (rtx, sio);
 
 			if (hawk_rtx_setofilenamewithoochars(rtx, file, hawk_count_oocstr(file)) <= -1)
 			{
@@ -2534,6 +2713,7 @@ static int open_rio_console (hawk_rtx_t* rtx, hawk_rio_arg_t* riod)
 			}
 
 			riod->handle = sio;
+			riod->uflags = is_interactive_sio(sio)? RIO_UFLAG_FLUSH: 0;
 			rxtn->c.out.index++;
 			rxtn->c.out.count++;
 			return 1;
@@ -2614,6 +2794,7 @@ static hawk_ooi_t hawk_rio_console (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_ri
 			hawk_ooi_t nn;
 			nn = hawk_sio_putoochars((hawk_sio_t*)riod->handle, data, size);
 			if (nn <= -1) set_rio_error (rtx, HAWK_EREAD, HAWK_T("unable to write"), hawk_sio_getpath((hawk_sio_t*)riod->handle));
+			else if (riod->uflags & RIO_UFLAG_FLUSH) hawk_sio_flush ((hawk_sio_t*)riod->handle);
 			return nn;
 		}
 
@@ -2622,6 +2803,7 @@ static hawk_ooi_t hawk_rio_console (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_ri
 			hawk_ooi_t nn;
 			nn = hawk_sio_putbchars((hawk_sio_t*)riod->handle, data, size);
 			if (nn <= -1) set_rio_error (rtx, HAWK_EREAD, HAWK_T("unable to write"), hawk_sio_getpath((hawk_sio_t*)riod->handle));
+			else if (riod->uflags & RIO_UFLAG_FLUSH) hawk_sio_flush ((hawk_sio_t*)riod->handle);
 			return nn;
 		}
 
@@ -2703,8 +2885,7 @@ static int build_argcv (hawk_rtx_t* rtx, int argc_id, int argv_id, const hawk_oo
 	hawk_val_t* v_argc;
 	hawk_val_t* v_argv;
 	hawk_val_t* v_tmp;
-	hawk_ooch_t key[HAWK_SIZEOF(hawk_int_t)*8+2];
-	hawk_oow_t key_len;
+	hawk_val_map_key_t key;
 
 	v_argv = hawk_rtx_makemapval(rtx);
 	if (v_argv == HAWK_NULL) return -1;
@@ -2723,8 +2904,9 @@ static int build_argcv (hawk_rtx_t* rtx, int argc_id, int argv_id, const hawk_oo
 	 * it has successfully been assigned into ARGV. */
 	hawk_rtx_refupval (rtx, v_tmp);
 
-	key_len = hawk_copy_oocstr(key, HAWK_COUNTOF(key), HAWK_T("0"));
-	if (hawk_map_upsert(((hawk_val_map_t*)v_argv)->map, key, key_len, v_tmp, 0) == HAWK_NULL)
+	key.ptr = HAWK_NULL;
+	key.idx = 0;
+	if (hawk_rtx_upsertmapval(rtx, v_argv, &key, v_tmp) == HAWK_NULL)
 	{
 		/* if the assignment operation fails, decrements
 		 * the reference of v_tmp to free it */
@@ -2750,12 +2932,10 @@ static int build_argcv (hawk_rtx_t* rtx, int argc_id, int argv_id, const hawk_oo
 				return -1;
 			}
 
-			key_len = hawk_int_to_oocstr(argc, 10, HAWK_NULL, key, HAWK_COUNTOF(key));
-			HAWK_ASSERT (key_len != (hawk_oow_t)-1);
-
+			key.idx = argc;
 			hawk_rtx_refupval (rtx, v_tmp);
 
-			if (hawk_map_upsert(((hawk_val_map_t*)v_argv)->map, key, key_len, v_tmp, 0) == HAWK_NULL)
+			if (hawk_rtx_upsertmapval(rtx, v_argv, &key, v_tmp) == HAWK_NULL)
 			{
 				hawk_rtx_refdownval (rtx, v_tmp);
 				hawk_rtx_refdownval (rtx, v_argv);
@@ -2819,6 +2999,7 @@ static int build_environ (hawk_rtx_t* rtx, int gbl_id, env_char_t* envarr[])
 		env_char_t* eq;
 		hawk_ooch_t* kptr, * vptr;
 		hawk_oow_t klen, vlen, count;
+		hawk_val_map_key_t key;
 
 		for (count = 0; envarr[count]; count++)
 		{
@@ -2835,13 +3016,13 @@ static int build_environ (hawk_rtx_t* rtx, int gbl_id, env_char_t* envarr[])
 			eq = hawk_find_bchar_in_bcstr(envarr[count], '=');
 			if (HAWK_UNLIKELY(!eq || eq == envarr[count])) continue;
 
-			*eq = '\0';
-
 			/* dupbtoucstr() may fail for invalid encoding. as the environment
 			 * variaables are not under control, call mbstowcsalldup() instead
-			 * to go on despite encoding failure */
+			 * to go on despite encoding failure. the environment is shared
+			 * by the runtime contexts on other threads and must not be
+			 * altered even temporarily */
 
-			kptr = hawk_rtx_dupbtoucstr(rtx, envarr[count], &klen, 1);
+			kptr = hawk_rtx_dupbtouchars(rtx, envarr[count], eq - envarr[count], &klen, 1);
 			vptr = hawk_rtx_dupbtoucstr(rtx, eq + 1, &vlen, 1);
 			if (HAWK_UNLIKELY(!kptr || !vptr))
 			{
@@ -2850,25 +3031,19 @@ static int build_environ (hawk_rtx_t* rtx, int gbl_id, env_char_t* envarr[])
 				hawk_rtx_refdownval (rtx, v_env);
 				return -1;
 			}
-
-			*eq = '=';
 		#else
 			eq = hawk_find_uchar_in_ucstr(envarr[count], '=');
 			if (HAWK_UNLIKELY(!eq || eq == envarr[count])) continue;
 
-			*eq = '\0';
-
-			kptr = hawk_rtx_duputobcstr(rtx, envarr[count], &klen);
+			kptr = hawk_rtx_duputobchars(rtx, envarr[count], eq - envarr[count], &klen);
 			vptr = hawk_rtx_duputobcstr(rtx, eq + 1, &vlen);
 			if (HAWK_UNLIKELY(!kptr || !vptr))
 			{
 				if (kptr) hawk_rtx_freemem (rtx, kptr);
-				if (vptr) hawk_rtx_freeme (rtx, vptr):
+				if (vptr) hawk_rtx_freemem (rtx, vptr);
 				hawk_rtx_refdownval (rtx, v_env);
 				return -1;
 			}
-
-			*eq = '=';
 		#endif
 
 			/* the string in ENVIRON should be a numeric value if
@@ -2892,7 +3067,9 @@ static int build_environ (hawk_rtx_t* rtx, int gbl_id, env_char_t* envarr[])
 			 * it has successfully been assigned into ARGV. */
 			hawk_rtx_refupval (rtx, v_tmp);
 
-			if (hawk_map_upsert(((hawk_val_map_t*)v_env)->map, kptr, klen, v_tmp, 0) == HAWK_NULL)
+			key.ptr = kptr;
+			key.len = klen;
+			if (hawk_rtx_upsertmapval(rtx, v_env, &key, v_tmp) == HAWK_NULL)
 			{
 				/* if the assignment operation fails, decrements
 				 * the reference of v_tmp to free it */
@@ -3451,7 +3628,8 @@ hawk_cmgr_t* hawk_rtx_getiocmgrstd (hawk_rtx_t* rtx, const hawk_ooch_t* ioname)
 	HAWK_ASSERT (rxtn->cmgrtab_inited == 1);
 
 	ioattr = get_ioattr(&rxtn->cmgrtab, ioname, hawk_count_oocstr(ioname));
-	if (ioattr) return ioattr->cmgr;
+	if (ioattr && ioattr->cmgr) return ioattr->cmgr;
+	if (rtx->hawk->opt.trait & HAWK_BYTEIO) return hawk_get_cmgr_by_id(HAWK_CMGR_MB8);
 #endif
 	return HAWK_NULL;
 }
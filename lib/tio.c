@@ -260,48 +260,66 @@ int hawk_tio_detachout (hawk_tio_t* tio)
 	return detach_out(tio, 0);
 }
 
-hawk_ooi_t hawk_tio_flush (hawk_tio_t* tio)
+/* write out the first len bytes of the output buffer. the bytes not
+ * written are moved to the front of the buffer */
+static hawk_ooi_t flush_upto (hawk_tio_t* tio, hawk_oow_t len)
 {
 	hawk_oow_t left, count;
 	hawk_ooi_t n;
 	hawk_bch_t* cur;
+	int x = 0;
 
-	if (tio->out.fun == HAWK_NULL)
-	{
-		/* no output function */
-		hawk_gem_seterrnum (tio->gem, HAWK_NULL, HAWK_EINVAL);
-		return (hawk_ooi_t)-1;
-	}
-
-	left = tio->outbuf_len;
+	left = len;
 	cur = tio->out.buf.ptr;
 	while (left > 0)
 	{
 		n = tio->out.fun(tio, HAWK_TIO_DATA, cur, left);
 		if (n <= -1)
 		{
-			if (cur != tio->out.buf.ptr)
-			{
-				HAWK_MEMCPY (tio->out.buf.ptr, cur, left);
-				tio->outbuf_len = left;
-			}
-			return -1;
-		}
-		if (n == 0)
-		{
-			if (cur != tio->out.buf.ptr)
-				HAWK_MEMCPY (tio->out.buf.ptr, cur, left);
+			x = -1;
 			break;
 		}
+		if (n == 0) break;
 
 		left -= n;
 		cur += n;
 	}
 
-	count = tio->outbuf_len - left;
-	tio->outbuf_len = left;
+	count = len - left;
+	if (count > 0)
+	{
+		tio->outbuf_len -= count;
+		HAWK_MEMMOVE (tio->out.buf.ptr, cur, tio->outbuf_len);
+	}
 
-	return (hawk_ooi_t)count;
+	return (x <= -1)? -1: (hawk_ooi_t)count;
+}
+
+hawk_ooi_t hawk_tio_flush (hawk_tio_t* tio)
+{
+	if (tio->out.fun == HAWK_NULL)
+	{
+		/* no output function */
+		hawk_gem_seterrnum (tio->gem, HAWK_NULL, HAWK_EINVAL);
+		return (hawk_ooi_t)-1;
+	}
+
+	return flush_upto(tio, tio->outbuf_len);
+}
+
+/* flush the output buffer that got full. the stream not flushed at each
+ * newline writes up to the last newline and keeps the rest in the buffer
+ * so that a line shorter than the buffer doesn't get split over writes */
+static hawk_ooi_t flush_full (hawk_tio_t* tio)
+{
+	if (tio->flags & HAWK_TIO_NOAUTOFLUSH)
+	{
+		hawk_oow_t len = tio->outbuf_len;
+		while (len > 0 && tio->out.buf.ptr[len - 1] != '\n') len--;
+		if (len > 0 && tio->out.fun) return flush_upto(tio, len);
+	}
+
+	return hawk_tio_flush(tio);
 }
 
 void hawk_tio_drain (hawk_tio_t* tio)
@@ -409,6 +427,21 @@ static HAWK_INLINE hawk_ooi_t tio_read_uchars (
 	mlen = tio->inbuf_len - tio->inbuf_cur;
 	wlen = bufsize;
 
+	if (tio->cmgr->bctouc == hawk_mb8_to_uc)
+	{
+		/* each byte is a character. widen the bytes up to a newline
+		 * without going through the character manager */
+		const hawk_uint8_t* bp = (const hawk_uint8_t*)&tio->in.buf.ptr[tio->inbuf_cur];
+		if (mlen > wlen) mlen = wlen;
+		for (wlen = 0; wlen < mlen; )
+		{
+			buf[wlen] = bp[wlen];
+			if (bp[wlen++] == '\n') break;
+		}
+		tio->inbuf_cur += wlen;
+		return wlen;
+	}
+
 	x = hawk_conv_bchars_to_uchars_upto_stopper_with_cmgr(
 		&tio->in.buf.ptr[tio->inbuf_cur],
 		&mlen, buf, &wlen, '\n', tio->cmgr);
@@ -527,7 +560,7 @@ hawk_ooi_t hawk_tio_writebchars (hawk_tio_t* tio, const hawk_bch_t* mptr, hawk_o
 			{
 				tio->out.buf.ptr[tio->outbuf_len++] = mptr[pos++];
 				if (tio->outbuf_len >= tio->out.buf.capa &&
-				    hawk_tio_flush(tio) <= -1) return -1;
+				    flush_full(tio) <= -1) return -1;
 				if (pos >= HAWK_TYPE_MAX(hawk_ooi_t)) break;
 			}
 		}
@@ -567,7 +600,7 @@ hawk_ooi_t hawk_tio_writebchars (hawk_tio_t* tio, const hawk_bch_t* mptr, hawk_o
 		{
 			for (xend = xptr + capa; xptr < xend; xptr++)
 				tio->out.buf.ptr[tio->outbuf_len++] = *xptr;
-			if (hawk_tio_flush(tio) <= -1) return -1;
+			if (flush_full(tio) <= -1) return -1;
 			mlen -= capa;
 		}
 
@@ -605,6 +638,30 @@ hawk_ooi_t hawk_tio_writebchars (hawk_tio_t* tio, const hawk_bch_t* mptr, hawk_o
 	}
 }
 
+static HAWK_INLINE int tio_conv_uchars (hawk_tio_t* tio, const hawk_uch_t* wptr, hawk_oow_t* wcnt, hawk_bch_t* mptr, hawk_oow_t* mcnt)
+{
+	if (tio->cmgr->uctobc == hawk_uc_to_mb8)
+	{
+		/* narrow the characters directly. it returns the same
+		 * result as hawk_conv_uchars_to_bchars_with_cmgr() */
+		hawk_oow_t i, n;
+		int x = 0;
+
+		n = *wcnt;
+		if (n > *mcnt) { n = *mcnt; x = -2; }
+		for (i = 0; i < n; i++)
+		{
+			if (wptr[i] > HAWK_TYPE_MAX(hawk_uint8_t)) { x = -1; break; }
+			mptr[i] = (hawk_bch_t)wptr[i];
+		}
+		*wcnt = i;
+		*mcnt = i;
+		return x;
+	}
+
+	return hawk_conv_uchars_to_bchars_with_cmgr(wptr, wcnt, mptr, mcnt, tio->cmgr);
+}
+
 hawk_ooi_t hawk_tio_writeuchars (hawk_tio_t* tio, const hawk_uch_t* wptr, hawk_oow_t wlen)
 {
 	hawk_oow_t capa, wcnt, mcnt, xwlen;
@@ -627,7 +684,7 @@ hawk_ooi_t hawk_tio_writeuchars (hawk_tio_t* tio, const hawk_uch_t* wptr, hawk_o
 		capa = tio->out.buf.capa - tio->outbuf_len;
 		wcnt = xwlen; mcnt = capa;
 
-		n = hawk_conv_uchars_to_bchars_with_cmgr(wptr, &wcnt, &tio->out.buf.ptr[tio->outbuf_len], &mcnt, tio->cmgr);
+		n = tio_conv_uchars(tio, wptr, &wcnt, &tio->out.buf.ptr[tio->outbuf_len], &mcnt);
 		tio->outbuf_len += mcnt;
 
 		if (n == -2)
@@ -636,7 +693,7 @@ hawk_ooi_t hawk_tio_writeuchars (hawk_tio_t* tio, const hawk_uch_t* wptr, hawk_o
 			 * convert more. so flush now and continue.
 			 * note that the buffer may not be full though
 			 * it is not large enough in this case */
-			if (hawk_tio_flush(tio) <= -1) return -1;
+			if (flush_full(tio) <= -1) return -1;
 			nl = 0;
 		}
 		else
@@ -645,7 +702,7 @@ hawk_ooi_t hawk_tio_writeuchars (hawk_tio_t* tio, const hawk_uch_t* wptr, hawk_o
 			{
 				/* flush the full buffer regardless of conversion
 				 * result. */
-				if (hawk_tio_flush (tio) <= -1) return -1;
+				if (flush_full(tio) <= -1) return -1;
 				nl = 0;
 			}
 
@@ -1931,6 +1931,130 @@ tre_ast_to_tnfa(hawk_gem_t* gem, tre_ast_node_t *node, tre_tnfa_transition_t *tr
 	tre_stack_destroy(stack);
 	return x;
 }
+
+/* Finds the longest literal that every match must contain. The tree is
+   walked in the order of the characters matched. Each node matching a
+   single character extends the current run of characters. A node that
+   may match more or less than a character ends the run. The arguments of
+   iterations repeated at least once are walked too, with the run broken
+   around them. A null pointer pushed to the stack marks such a break. */
+static reg_errcode_t
+tre_find_required(tre_stack_t *stack, tre_ast_node_t *tree, tre_tnfa_t *tnfa)
+{
+	int bottom = tre_stack_num_objects(stack);
+	tre_char_t run[TRE_REQUIRED_MAX];
+	int run_len = 0, run_icase = 0;
+	reg_errcode_t status;
+
+	tnfa->required_len = 0;
+	tnfa->required_icase = 0;
+
+	status = tre_stack_push_voidptr(stack, tree);
+	while (status == REG_OK && tre_stack_num_objects(stack) > bottom)
+	{
+		tre_ast_node_t *node = tre_stack_pop_voidptr(stack);
+		tre_cint_t c = -1;
+		int icase = 0, brk = 0;
+
+		if (!node)
+		{
+			brk = 1;
+		}
+		else if (node->type == CATENATION)
+		{
+			tre_catenation_t *cat = node->obj;
+			status = tre_stack_push_voidptr(stack, cat->right);
+			if (status == REG_OK) status = tre_stack_push_voidptr(stack, cat->left);
+			continue;
+		}
+		else if (node->type == ITERATION)
+		{
+			tre_iteration_t *iter = node->obj;
+			if (iter->min == 1 && iter->max == 1 && !iter->params)
+			{
+				status = tre_stack_push_voidptr(stack, iter->arg);
+				continue;
+			}
+			brk = 1;
+			if (iter->min >= 1 && !iter->params)
+			{
+				status = tre_stack_push_voidptr(stack, NULL);
+				if (status == REG_OK) status = tre_stack_push_voidptr(stack, iter->arg);
+			}
+		}
+		else if (node->type == UNION)
+		{
+			/* a letter under REG_ICASE is a union of its two cases */
+			tre_union_t *uni = node->obj;
+			tre_literal_t *l, *r;
+
+			brk = 1;
+			if (uni->left->type == LITERAL && uni->right->type == LITERAL)
+			{
+				l = uni->left->obj;
+				r = uni->right->obj;
+				if (!IS_SPECIAL(l) && !IS_SPECIAL(r) && l->code_min == l->code_max && r->code_min == r->code_max &&
+				    !l->u.class && !r->u.class && !l->neg_classes && !r->neg_classes &&
+				    tre_tolower((tre_cint_t)l->code_min) == tre_tolower((tre_cint_t)r->code_min))
+				{
+					c = tre_tolower((tre_cint_t)l->code_min);
+					icase = 1;
+					brk = 0;
+				}
+			}
+		}
+		else
+		{
+			tre_literal_t *lit = node->obj;
+			if (IS_BACKREF(lit) || IS_PARAMETER(lit)) brk = 1;
+			else if (IS_SPECIAL(lit)) continue; /* empty, assertion, tag. they match nothing */
+			else if (lit->code_min == lit->code_max && !lit->u.class && !lit->neg_classes) c = (tre_cint_t)lit->code_min;
+			else brk = 1;
+		}
+
+		if (brk)
+		{
+			if (run_len > tnfa->required_len)
+			{
+				HAWK_MEMCPY (tnfa->required, run, run_len * HAWK_SIZEOF(run[0]));
+				tnfa->required_len = run_len;
+				tnfa->required_icase = run_icase;
+			}
+			run_len = 0;
+			run_icase = 0;
+		}
+		else if (run_len < TRE_REQUIRED_MAX)
+		{
+			run[run_len++] = c;
+			run_icase |= icase;
+		}
+	}
+
+	if (status != REG_OK)
+	{
+		/* it's only a hint. don't fail the compilation */
+		while (tre_stack_num_objects(stack) > bottom) tre_stack_pop_voidptr(stack);
+		tnfa->required_len = 0;
+		return REG_OK;
+	}
+
+	if (run_len > tnfa->required_len)
+	{
+		HAWK_MEMCPY (tnfa->required, run, run_len * HAWK_SIZEOF(run[0]));
+		tnfa->required_len = run_len;
+		tnfa->required_icase = run_icase;
+	}
+
+	if (tnfa->required_icase)
+	{
+		/* compare all in lower case. characters that had to match in
+		 * the exact case only make the test a bit looser */
+		int i;
+		for (i = 0; i < tnfa->required_len; i++) tnfa->required[i] = tre_tolower((tre_cint_t)tnfa->required[i]);
+	}
+
+	return REG_OK;
+}
 /* END HAWK */
 
 #define ERROR_EXIT(err) \
@@ -2009,6 +2133,11 @@ int tre_compile (regex_t *preg, const tre_char_t *regex, size_t n, int cflags)
 	tnfa->have_approx = parse_ctx.have_approx;
 	tnfa->num_submatches = parse_ctx.submatch_id;
 
+/* HAWK */
+	errcode = tre_find_required(stack, tree, tnfa);
+	if (errcode != REG_OK) ERROR_EXIT(errcode);
+/* END HAWK */
+
 	/* Set up tags for submatch addressing.  If REG_NOSUB is set and the
 	   regexp does not have back references, this can be skipped. */
 	if (tnfa->have_backrefs || !(cflags & REG_NOSUB))
@@ -2303,6 +2432,10 @@ void tre_free (regex_t *preg)
 /* END HAWK */
 	if (tnfa->minimal_tags)
 		xfree(preg->gem,tnfa->minimal_tags);
+/* HAWK */
+	if (tnfa->dfa)
+		tre_dfa_free(preg->gem,tnfa->dfa);
+/* END HAWK */
 	xfree(preg->gem,tnfa);
 }
 
@@ -0,0 +1,373 @@
+/*
+    Copyright (c) 2006-2020 Chung, Hyung-Hwan. All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+  tre-match-dfa.c - lazily built DFA deciding if a TNFA matches
+
+  A DFA state stands for a set of TNFA states. The initial TNFA states are
+  merged into every DFA state so that a single forward scan finds a match
+  starting anywhere. DFA states and their transitions on characters below
+  256 are built on demand and kept in the TNFA for later matches. The
+  number of DFA states is bounded. The cache is flushed when the bound is
+  hit and the DFA gives up when it keeps getting flushed in a single run.
+
+  A state reached over a transition with the end-of-line assertion is kept
+  in a separate pending set. It is valid only if the next character is
+  '\0' or the end of the input comes next.
+
+  The DFA doesn't produce the match positions. It only decides if the
+  input matches and leaves the rest to the TNFA matchers.
+*/
+
+#include "tre-prv.h"
+#include "tre-match-ut.h"
+
+#define DFA_MAX_STATES   250 /* must fit in hawk_uint8_t of the transition table */
+#define DFA_MAX_FLUSHES  4
+#define DFA_BUCKETS      64
+
+#define DFA_ACCEPT     1 /* the final tnfa state is in the set */
+#define DFA_ACCEPT_EOL 2 /* the final tnfa state is pending on the end-of-line assertion */
+
+typedef struct tre_dfa_state_t tre_dfa_state_t;
+
+struct tre_dfa_state_t
+{
+	hawk_oow_t hash;
+	tre_dfa_state_t* link;
+	int index; /* position in the state table */
+	int flags;
+	int nids; /* number of tnfa states in the set */
+	int npend; /* number of tnfa states pending on the end-of-line assertion */
+	/* next state index plus 1 for each character below 256. 0 if not built yet */
+	hawk_uint8_t next[256];
+	int ids[1]; /* nids tnfa state ids followed by npend ids, both sorted */
+};
+
+struct tre_dfa_t
+{
+	int usable;
+	int final_id;
+	int nstates;
+	int nflushes;
+
+	/* transition list of each tnfa state */
+	tre_tnfa_transition_t** trans;
+
+	/* scratch space to build a new set */
+	hawk_uint8_t* mark;
+	int* touched;
+	int* ids;
+
+	tre_dfa_state_t* start[2]; /* [0] at the beginning of a line, [1] elsewhere */
+	tre_dfa_state_t* state[DFA_MAX_STATES];
+	tre_dfa_state_t* bucket[DFA_BUCKETS];
+};
+
+static tre_dfa_t* open_dfa (hawk_gem_t* gem, const tre_tnfa_t* tnfa)
+{
+	tre_dfa_t* dfa;
+	tre_tnfa_transition_t* trans_i;
+	unsigned int i;
+	int usable;
+
+	usable = !tnfa->have_backrefs && !tnfa->have_approx && !(tnfa->cflags & REG_NEWLINE) && tnfa->num_states > 0;
+
+	/* the context around a position is known only partially while scanning.
+	 * word boundaries need the next character. leave them to the tnfa */
+	for (i = 0; usable && i < tnfa->num_transitions; i++)
+	{
+		trans_i = &tnfa->transitions[i];
+		if (!trans_i->state) continue;
+		if (trans_i->params || (trans_i->assertions & ~(ASSERT_AT_BOL | ASSERT_AT_EOL | ASSERT_CHAR_CLASS | ASSERT_CHAR_CLASS_NEG))) usable = 0;
+	}
+	for (trans_i = tnfa->initial; usable && trans_i->state; trans_i++)
+	{
+		if (trans_i->params || (trans_i->assertions & ~(ASSERT_AT_BOL | ASSERT_AT_EOL))) usable = 0;
+	}
+
+	if (!usable)
+	{
+		/* remember that it's not usable not to check again */
+		dfa = xcalloc(gem, 1, sizeof(*dfa));
+		return dfa;
+	}
+
+	dfa = xcalloc(gem, 1, sizeof(*dfa) + (sizeof(*dfa->trans) + sizeof(*dfa->touched) + sizeof(*dfa->ids) + sizeof(*dfa->mark)) * tnfa->num_states);
+	if (!dfa) return HAWK_NULL;
+
+	dfa->trans = (tre_tnfa_transition_t**)(dfa + 1);
+	dfa->touched = (int*)(dfa->trans + tnfa->num_states);
+	dfa->ids = dfa->touched + tnfa->num_states;
+	dfa->mark = (hawk_uint8_t*)(dfa->ids + tnfa->num_states);
+
+	dfa->final_id = -1;
+	for (i = 0; i < tnfa->num_transitions; i++)
+	{
+		trans_i = &tnfa->transitions[i];
+		if (trans_i->state) dfa->trans[trans_i->state_id] = trans_i->state;
+	}
+	for (trans_i = tnfa->initial; trans_i->state; trans_i++) dfa->trans[trans_i->state_id] = trans_i->state;
+	for (i = 0; i < tnfa->num_states; i++)
+	{
+		if (dfa->trans[i] == tnfa->final) dfa->final_id = i;
+	}
+
+	dfa->usable = 1;
+	return dfa;
+}
+
+static void flush_dfa (hawk_gem_t* gem, tre_dfa_t* dfa)
+{
+	int i;
+	for (i = 0; i < dfa->nstates; i++) xfree (gem, dfa->state[i]);
+	dfa->nstates = 0;
+	dfa->start[0] = HAWK_NULL;
+	dfa->start[1] = HAWK_NULL;
+	HAWK_MEMSET (dfa->bucket, 0, HAWK_SIZEOF(dfa->bucket));
+}
+
+void tre_dfa_free (hawk_gem_t* gem, tre_dfa_t* dfa)
+{
+	flush_dfa (gem, dfa);
+	xfree (gem, dfa);
+}
+
+/* ------------------------------------------------------------------------ */
+
+#define ADD_ID(dfa,ntouched,id) do { \
+	if ((dfa)->mark[id] != 1) \
+	{ \
+		if ((dfa)->mark[id] == 0) (dfa)->touched[ntouched++] = (id); \
+		(dfa)->mark[id] = 1; \
+	} \
+} while (0)
+
+#define ADD_PENDING_ID(dfa,ntouched,id) do { \
+	if ((dfa)->mark[id] == 0) \
+	{ \
+		(dfa)->touched[ntouched++] = (id); \
+		(dfa)->mark[id] = 2; \
+	} \
+} while (0)
+
+static void sort_ids (int* ids, int n)
+{
+	int i, j, x;
+	for (i = 1; i < n; i++)
+	{
+		x = ids[i];
+		for (j = i; j > 0 && ids[j - 1] > x; j--) ids[j] = ids[j - 1];
+		ids[j] = x;
+	}
+}
+
+static int add_initial (tre_dfa_t* dfa, const tre_tnfa_t* tnfa, int at_bol, int ntouched)
+{
+	tre_tnfa_transition_t* trans_i;
+
+	for (trans_i = tnfa->initial; trans_i->state; trans_i++)
+	{
+		if ((trans_i->assertions & ASSERT_AT_BOL) && !at_bol) continue;
+		if (trans_i->assertions & ASSERT_AT_EOL) ADD_PENDING_ID (dfa, ntouched, trans_i->state_id);
+		else ADD_ID (dfa, ntouched, trans_i->state_id);
+	}
+
+	return ntouched;
+}
+
+/* turn the tnfa state ids touched into a dfa state. the same set
+ * always yields the same dfa state as long as it's not flushed */
+static tre_dfa_state_t* intern_state (hawk_gem_t* gem, tre_dfa_t* dfa, int ntouched)
+{
+	tre_dfa_state_t* st;
+	hawk_oow_t hash;
+	int i, nids, npend;
+
+	for (nids = 0, i = 0; i < ntouched; i++)
+	{
+		if (dfa->mark[dfa->touched[i]] == 1) dfa->ids[nids++] = dfa->touched[i];
+	}
+	for (npend = 0, i = 0; i < ntouched; i++)
+	{
+		if (dfa->mark[dfa->touched[i]] == 2) dfa->ids[nids + npend++] = dfa->touched[i];
+		dfa->mark[dfa->touched[i]] = 0;
+	}
+	sort_ids (dfa->ids, nids);
+	sort_ids (dfa->ids + nids, npend);
+
+	hash = nids * 31 + npend;
+	for (i = 0; i < ntouched; i++) hash = hash * 31 + dfa->ids[i];
+
+	for (st = dfa->bucket[hash % DFA_BUCKETS]; st; st = st->link)
+	{
+		if (st->hash == hash && st->nids == nids && st->npend == npend &&
+		    HAWK_MEMCMP(st->ids, dfa->ids, ntouched * HAWK_SIZEOF(*dfa->ids)) == 0) return st;
+	}
+
+	if (dfa->nstates >= DFA_MAX_STATES)
+	{
+		flush_dfa (gem, dfa);
+		dfa->nflushes++;
+	}
+
+	st = xmalloc(gem, HAWK_SIZEOF(*st) + ntouched * HAWK_SIZEOF(*dfa->ids));
+	if (HAWK_UNLIKELY(!st)) return HAWK_NULL;
+
+	st->hash = hash;
+	st->nids = nids;
+	st->npend = npend;
+	st->flags = 0;
+	HAWK_MEMSET (st->next, 0, HAWK_SIZEOF(st->next));
+	HAWK_MEMCPY (st->ids, dfa->ids, ntouched * HAWK_SIZEOF(*dfa->ids));
+	for (i = 0; i < nids; i++)
+	{
+		if (st->ids[i] == dfa->final_id) st->flags |= DFA_ACCEPT;
+	}
+	for (; i < ntouched; i++)
+	{
+		if (st->ids[i] == dfa->final_id) st->flags |= DFA_ACCEPT_EOL;
+	}
+
+	st->link = dfa->bucket[hash % DFA_BUCKETS];
+	dfa->bucket[hash % DFA_BUCKETS] = st;
+	st->index = dfa->nstates;
+	dfa->state[dfa->nstates++] = st;
+	return st;
+}
+
+static tre_dfa_state_t* get_start_state (hawk_gem_t* gem, tre_dfa_t* dfa, const tre_tnfa_t* tnfa, int notbol)
+{
+	if (!dfa->start[notbol])
+	{
+		int ntouched = add_initial(dfa, tnfa, !notbol, 0);
+		dfa->start[notbol] = intern_state(gem, dfa, ntouched);
+	}
+	return dfa->start[notbol];
+}
+
+static tre_dfa_state_t* move_state (hawk_gem_t* gem, tre_dfa_t* dfa, const tre_tnfa_t* tnfa, const tre_dfa_state_t* from, tre_char_t prev_c, int eflags)
+{
+	tre_tnfa_transition_t* trans_i;
+	int i, nact, ntouched = 0;
+
+	/* the pending states are valid only when the character consumed is '\0' */
+	nact = from->nids + ((prev_c == HAWK_T('\0'))? from->npend: 0);
+	for (i = 0; i < nact; i++)
+	{
+		for (trans_i = dfa->trans[from->ids[i]]; trans_i->state; trans_i++)
+		{
+			if (trans_i->code_min > (tre_cint_t)prev_c || trans_i->code_max < (tre_cint_t)prev_c) continue;
+
+			if (trans_i->assertions)
+			{
+				/* no longer at the beginning after a character is consumed */
+				if (trans_i->assertions & ASSERT_AT_BOL) continue;
+				if (CHECK_CHAR_CLASSES(trans_i, tnfa, eflags)) continue;
+				if (trans_i->assertions & ASSERT_AT_EOL)
+				{
+					ADD_PENDING_ID (dfa, ntouched, trans_i->state_id);
+					continue;
+				}
+			}
+
+			ADD_ID (dfa, ntouched, trans_i->state_id);
+		}
+	}
+
+	/* a match can start at any position */
+	ntouched = add_initial(dfa, tnfa, 0, ntouched);
+	return intern_state(gem, dfa, ntouched);
+}
+
+int tre_tnfa_run_dfa (hawk_gem_t* gem, tre_tnfa_t* tnfa, const void* string, int len, tre_str_type_t type, int eflags)
+{
+	tre_dfa_t* dfa;
+	tre_dfa_state_t* cur, * nxt;
+	const hawk_bch_t* str_byte = string;
+#if defined(TRE_WCHAR)
+	const hawk_uch_t* str_wide = string;
+#endif
+	tre_char_t c;
+	int pos;
+
+	if (type != STR_BYTE && type != STR_WIDE) return -1;
+	if (eflags & REG_NOTEOL) return -1;
+
+	dfa = tnfa->dfa;
+	if (!dfa)
+	{
+		dfa = open_dfa(gem, tnfa);
+		if (HAWK_UNLIKELY(!dfa)) return -1;
+		tnfa->dfa = dfa;
+	}
+	if (!dfa->usable) return -1;
+
+	dfa->nflushes = 0;
+	cur = get_start_state(gem, dfa, tnfa, !!(eflags & REG_NOTBOL));
+	if (HAWK_UNLIKELY(!cur)) return -1;
+
+	for (pos = 0; ; pos++)
+	{
+		int nflushes;
+
+		if (cur->flags & DFA_ACCEPT) return REG_OK;
+		/* no tnfa state alive and no initial state to add any more */
+		if (cur->nids + cur->npend <= 0) return REG_NOMATCH;
+
+		if (len >= 0 && pos >= len) break;
+	#if defined(TRE_WCHAR)
+		c = (type == STR_BYTE)? (tre_char_t)(hawk_uint8_t)str_byte[pos]: (tre_char_t)str_wide[pos];
+	#else
+		c = (tre_char_t)(hawk_uint8_t)str_byte[pos];
+	#endif
+		if (c == HAWK_T('\0'))
+		{
+			if (len < 0) break;
+			if (cur->flags & DFA_ACCEPT_EOL) return REG_OK;
+		}
+
+		if ((tre_cint_t)c < 256 && cur->next[(tre_cint_t)c])
+		{
+			cur = dfa->state[cur->next[(tre_cint_t)c] - 1];
+			continue;
+		}
+
+		nflushes = dfa->nflushes;
+		nxt = move_state(gem, dfa, tnfa, cur, c, eflags);
+		if (HAWK_UNLIKELY(!nxt)) return -1;
+		if (dfa->nflushes != nflushes)
+		{
+			/* the current state is gone. the transition can't be remembered */
+			if (dfa->nflushes > DFA_MAX_FLUSHES) return -1;
+		}
+		else if ((tre_cint_t)c < 256)
+		{
+			cur->next[(tre_cint_t)c] = nxt->index + 1;
+		}
+		cur = nxt;
+	}
+
+	return (cur->flags & DFA_ACCEPT_EOL)? REG_OK: REG_NOMATCH;
+}
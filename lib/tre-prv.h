@@ -213,6 +213,7 @@ typedef hawk_ooci_t tre_cint_t;
 #define REG_NOTBOL HAWK_TRE_NOTBOL
 #define REG_NOTEOL HAWK_TRE_NOTEOL
 #define REG_BACKTRACKING_MATCHER HAWK_TRE_BACKTRACKING
+#define REG_SHARED HAWK_TRE_SHARED
 
 
 #define tre_strlen(c) hawk_count_oocstr(c)
@@ -413,6 +414,12 @@ typedef struct tre_submatch_data tre_submatch_data_t;
 /* TNFA definition. */
 typedef struct tnfa tre_tnfa_t;
 
+/* Maximum length of the literal remembered as required in a match */
+#define TRE_REQUIRED_MAX 32
+
+/* Lazily built DFA cached in a TNFA. See tre-match-dfa.c */
+typedef struct tre_dfa_t tre_dfa_t;
+
 struct tnfa
 {
 	tre_tnfa_transition_t *transitions;
@@ -435,6 +442,17 @@ struct tnfa
 	int have_backrefs;
 	int have_approx;
 	int params_depth;
+/* HAWK */
+	tre_dfa_t *dfa;
+	/* nonzero while a thread runs the dfa given REG_SHARED */
+	int dfa_busy;
+	/* literal contained in every match. input without it is rejected
+	 * before any matcher runs. it's compared case-insensitively if
+	 * required_icase is set */
+	tre_char_t required[TRE_REQUIRED_MAX];
+	int required_len;
+	int required_icase;
+/* END HAWK */
 };
 
 
@@ -457,6 +475,16 @@ reg_errcode_t tre_tnfa_run_parallel(
 	tre_str_type_t type, int *match_tags, int eflags,
 	int *match_end_ofs);
 
+/* HAWK */
+/* returns REG_OK if the string matches, REG_NOMATCH if it doesn't,
+ * and -1 if the dfa can't decide it for the pattern or the flags given */
+int tre_tnfa_run_dfa(
+	hawk_gem_t* gem, tre_tnfa_t *tnfa, const void *string, int len,
+	tre_str_type_t type, int eflags);
+
+void tre_dfa_free(hawk_gem_t* gem, tre_dfa_t *dfa);
+/* END HAWK */
+
 
 #endif
 
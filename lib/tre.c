@@ -172,6 +172,78 @@ int tre_have_backrefs (const regex_t *preg)
 	return tnfa->have_backrefs;
 }
 
+/* HAWK */
+/* tells if the string contains the literal that every match must contain */
+static int tre_has_required (const tre_tnfa_t* tnfa, const void* string, int len, tre_str_type_t type)
+{
+	const tre_char_t* req = tnfa->required;
+	int req_len = tnfa->required_len;
+	int i, j;
+
+	if (type == STR_BYTE)
+	{
+		const hawk_uint8_t* str = string;
+		const hawk_uint8_t* ptr, * end;
+
+		if (len < 0) len = (int)hawk_count_bcstr((const hawk_bch_t*)str);
+		if (len < req_len) return 0;
+		for (j = 0; j < req_len; j++)
+		{
+			/* the character can't be found in a byte string */
+			if ((tre_cint_t)req[j] > 0xFF) return 0;
+		}
+
+		end = str + len - req_len;
+		if (!tnfa->required_icase)
+		{
+			for (ptr = str; ptr <= end; ptr++)
+			{
+				ptr = HAWK_MEMCHR(ptr, req[0], end - ptr + 1);
+				if (!ptr) return 0;
+				for (j = 1; j < req_len && ptr[j] == req[j]; j++) /* nothing */;
+				if (j >= req_len) return 1;
+			}
+		}
+		else
+		{
+			for (ptr = str; ptr <= end; ptr++)
+			{
+				for (j = 0; j < req_len && (tre_cint_t)tre_tolower(ptr[j]) == (tre_cint_t)req[j]; j++) /* nothing */;
+				if (j >= req_len) return 1;
+			}
+		}
+	}
+#if defined(TRE_WCHAR)
+	else if (type == STR_WIDE)
+	{
+		const hawk_uch_t* str = string;
+
+		if (len < 0) len = (int)hawk_count_ucstr(str);
+		for (i = 0; i + req_len <= len; i++)
+		{
+			if (!tnfa->required_icase)
+			{
+				if (str[i] != req[0]) continue;
+				for (j = 1; j < req_len && str[i + j] == req[j]; j++) /* nothing */;
+			}
+			else
+			{
+				for (j = 0; j < req_len && (tre_cint_t)tre_tolower(str[i + j]) == (tre_cint_t)req[j]; j++) /* nothing */;
+			}
+			if (j >= req_len) return 1;
+		}
+	}
+#endif
+	else
+	{
+		/* not sure. let the matcher decide */
+		return 1;
+	}
+
+	return 0;
+}
+/* END HAWK */
+
 static int tre_match (
 	const regex_t* preg, const void *string, hawk_oow_t len,
 	tre_str_type_t type, hawk_oow_t nmatch, regmatch_t pmatch[],
@@ -180,6 +252,35 @@ static int tre_match (
 	tre_tnfa_t *tnfa = (void *)preg->TRE_REGEX_T_FIELD;
 	reg_errcode_t status;
 	int *tags = HAWK_NULL, eo;
+
+/* HAWK */
+	if (tnfa->required_len > 0 && !tre_has_required(tnfa, string, (int)len, type)) return REG_NOMATCH;
+
+	if (!tnfa->have_backrefs)
+	{
+		/* the lazy dfa tells if there is a match in a single pass.
+		 * the tnfa is needed only if the match positions are wanted */
+		int n;
+
+		if (!(eflags & REG_SHARED))
+		{
+			n = tre_tnfa_run_dfa(preg->gem, tnfa, string, (int)len, type, eflags);
+		}
+	#if defined(HAWK_HAVE_SYNC_LOCK_TEST_AND_SET) && defined(HAWK_HAVE_SYNC_LOCK_RELEASE)
+		else if (__sync_lock_test_and_set(&tnfa->dfa_busy, 1) == 0)
+		{
+			/* the dfa states are built and flushed while matching.
+			 * the other threads don't wait but use the tnfa */
+			n = tre_tnfa_run_dfa(preg->gem, tnfa, string, (int)len, type, eflags);
+			__sync_lock_release (&tnfa->dfa_busy);
+		}
+	#endif
+		else n = -1;
+
+		if (n == REG_NOMATCH || (n == REG_OK && (nmatch <= 0 || (tnfa->cflags & REG_NOSUB)))) return n;
+	}
+/* END HAWK */
+
 	if (tnfa->num_tags > 0 && nmatch > 0)
 	{
 		tags = xmalloc(preg->gem, sizeof(*tags) * tnfa->num_tags);
@@ -87,6 +87,7 @@ typedef struct hawk_nde_nextfile_t  hawk_nde_nextfile_t;
 typedef struct hawk_nde_delete_t    hawk_nde_delete_t;
 typedef struct hawk_nde_reset_t     hawk_nde_reset_t;
 typedef struct hawk_nde_print_t     hawk_nde_print_t;
+typedef struct hawk_nde_code_t      hawk_nde_code_t;
 
 /* HAWK_NDE_BLK - block statement including top-level blocks */
 struct hawk_nde_blk_t
@@ -369,6 +370,55 @@ struct hawk_nde_print_t
 	hawk_nde_t* out;
 };
 
+/* maximum number of registers a compiled expression can use.
+ * an expression requiring more is left to the tree walker. */
+#define HAWK_CODE_MAX_REGS 32
+
+enum hawk_code_op_t
+{
+	HAWK_CODE_LDINT, /* r[dst] = integer literal in nde */
+	HAWK_CODE_LDFLT, /* r[dst] = floating-point literal in nde */
+	HAWK_CODE_LDSTR, /* r[dst] = string literal in nde */
+	HAWK_CODE_LDGBL, /* r[dst] = global variable in nde */
+	HAWK_CODE_LDLCL, /* r[dst] = local variable in nde */
+	HAWK_CODE_LDARG, /* r[dst] = argument in nde */
+	HAWK_CODE_LDFLD, /* r[dst] = field at the non-negative integer literal position of nde */
+	HAWK_CODE_EVAL,  /* r[dst] = nde evaluated by the tree walker */
+	HAWK_CODE_BIN,   /* r[dst] = r[a] opx r[b] */
+	HAWK_CODE_UNR,   /* r[dst] = opx r[a] */
+	HAWK_CODE_FLD,   /* r[dst] = field at the position in r[a] */
+	HAWK_CODE_ASS,   /* r[dst] = r[a] assigned to the left-hand side of nde */
+	HAWK_CODE_LAND,  /* if r[a] is false, r[dst] = 0 and jump to b */
+	HAWK_CODE_LOR,   /* if r[a] is true, r[dst] = 1 and jump to b */
+	HAWK_CODE_BOOL,  /* r[dst] = r[a]? 1: 0 */
+	HAWK_CODE_JMPF,  /* jump to b if r[a] is false */
+	HAWK_CODE_JMP    /* jump to b */
+};
+typedef enum hawk_code_op_t hawk_code_op_t;
+
+/* a register operand is released by the instruction consuming it.
+ * the result of the whole expression is left in r[0]. */
+typedef struct hawk_code_insn_t hawk_code_insn_t;
+struct hawk_code_insn_t
+{
+	hawk_uint16_t op; /* hawk_code_op_t */
+	hawk_uint16_t opx; /* hawk_binop_type_t or hawk_unrop_type_t */
+	hawk_uint16_t dst;
+	hawk_uint16_t a;
+	hawk_uint16_t b; /* second operand register or jump target */
+	hawk_nde_t* nde; /* operand node or the node for error location */
+};
+
+/* HAWK_NDE_CODE - an expression compiled to register code */
+struct hawk_nde_code_t
+{
+	HAWK_NDE_HDR;
+	hawk_nde_t* expr; /* original expression for deparsing */
+	hawk_oow_t nregs;
+	hawk_oow_t ninsns;
+	hawk_code_insn_t insn[1];
+};
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -382,6 +432,9 @@ int hawk_prnptnpt (hawk_t* hawk, hawk_nde_t* tree);
 
 void hawk_clrpt (hawk_t* hawk, hawk_nde_t* tree);
 
+/* compile expressions in the parse tree to register code */
+int hawk_compilept (hawk_t* hawk);
+
 #if defined(__cplusplus)
 }
 #endif
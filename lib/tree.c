@@ -230,6 +230,9 @@ static int print_expr (hawk_t* hawk, hawk_nde_t* nde)
 		case HAWK_NDE_EXP_BIN:
 		{
 			hawk_nde_exp_t* px = (hawk_nde_exp_t*)nde;
+			/* an assignment may have been compiled to register code */
+			int rass = px->right->type == HAWK_NDE_ASS ||
+			           (px->right->type == HAWK_NDE_CODE && ((hawk_nde_code_t*)px->right)->expr->type == HAWK_NDE_ASS);
 
 			PUT_SRCSTR (hawk, HAWK_T("("));
 			PRINT_EXPR (hawk, px->left);
@@ -239,11 +242,9 @@ static int print_expr (hawk_t* hawk, hawk_nde_t* nde)
 			PUT_SRCSTR (hawk, binop_str[px->opcode][(hawk->opt.trait & HAWK_BLANKCONCAT)? 0: 1]);
 			PUT_SRCSTR (hawk, HAWK_T(" "));
 
-			if (px->right->type == HAWK_NDE_ASS)
-				PUT_SRCSTR (hawk, HAWK_T("("));
+			if (rass) PUT_SRCSTR (hawk, HAWK_T("("));
 			PRINT_EXPR (hawk, px->right);
-			if (px->right->type == HAWK_NDE_ASS)
-				PUT_SRCSTR (hawk, HAWK_T(")"));
+			if (rass) PUT_SRCSTR (hawk, HAWK_T(")"));
 			HAWK_ASSERT (px->right->next == HAWK_NULL);
 			PUT_SRCSTR (hawk, HAWK_T(")"));
 			break;
@@ -829,6 +830,13 @@ static int print_expr (hawk_t* hawk, hawk_nde_t* nde)
 			break;
 		}
 
+		case HAWK_NDE_CODE:
+		{
+			/* print the original expression */
+			PRINT_EXPR (hawk, ((hawk_nde_code_t*)nde)->expr);
+			break;
+		}
+
 		default:
 		{
 			hawk_seterrnum (hawk, HAWK_NULL, HAWK_EINTERN);
@@ -1564,6 +1572,13 @@ void hawk_clrpt (hawk_t* hawk, hawk_nde_t* tree)
 				break;
 			}
 
+			case HAWK_NDE_CODE:
+			{
+				hawk_clrpt (hawk, ((hawk_nde_code_t*)p)->expr);
+				hawk_freemem (hawk, p);
+				break;
+			}
+
 			default:
 			{
 				HAWK_ASSERT (!"should never happen - invalid node type");
@@ -32,6 +32,12 @@
 #include "hawk-prv.h"
 #include <hawk-chr.h>
 
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
 static int match_uch_class (const hawk_uch_t* pp, hawk_uch_t sc, int* matched)
 {
 	if (hawk_comp_ucstr_bcstr_limited(pp, "[:upper:]", 9, 0) == 0) 
@@ -154,6 +160,79 @@ static int match_bch_class (const hawk_bch_t* pp, hawk_bch_t sc, int* matched)
 	return 0;
 }
 
+/* the character search functions are hot in scanning input records.
+ * they compare 16 or 32 bytes at a time where SSE2 or AVX2 is enabled
+ * at compile time and fall back to a simple loop otherwise */
+
+#if defined(__AVX2__)
+#	define SIMD_BYTES 32
+#	define SIMD_VEC_T __m256i
+#	define SIMD_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#	define SIMD_SET16(c) _mm256_set1_epi16(c)
+#	define SIMD_SET32(c) _mm256_set1_epi32(c)
+#	define SIMD_EQ16(a,b) _mm256_cmpeq_epi16(a,b)
+#	define SIMD_EQ32(a,b) _mm256_cmpeq_epi32(a,b)
+#	define SIMD_MASK(v) ((hawk_oow_t)(hawk_uint32_t)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#	define SIMD_BYTES 16
+#	define SIMD_VEC_T __m128i
+#	define SIMD_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#	define SIMD_SET16(c) _mm_set1_epi16(c)
+#	define SIMD_SET32(c) _mm_set1_epi32(c)
+#	define SIMD_EQ16(a,b) _mm_cmpeq_epi16(a,b)
+#	define SIMD_EQ32(a,b) _mm_cmpeq_epi32(a,b)
+#	define SIMD_MASK(v) ((hawk_oow_t)(hawk_uint32_t)_mm_movemask_epi8(v))
+#endif
+
+hawk_uch_t* hawk_find_uchar_in_uchars (const hawk_uch_t* ptr, hawk_oow_t len, hawk_uch_t c)
+{
+	const hawk_uch_t* end;
+
+	end = ptr + len;
+
+#if defined(SIMD_BYTES) && (HAWK_SIZEOF_UCH_T == 2 || HAWK_SIZEOF_UCH_T == 4)
+	if (len >= SIMD_BYTES / HAWK_SIZEOF_UCH_T)
+	{
+		SIMD_VEC_T needle;
+
+	#if (HAWK_SIZEOF_UCH_T == 2)
+		needle = SIMD_SET16((short)c);
+	#else
+		needle = SIMD_SET32((int)c);
+	#endif
+
+		while (end - ptr >= SIMD_BYTES / HAWK_SIZEOF_UCH_T)
+		{
+			hawk_oow_t mask;
+
+		#if (HAWK_SIZEOF_UCH_T == 2)
+			mask = SIMD_MASK(SIMD_EQ16(SIMD_LOAD(ptr), needle));
+		#else
+			mask = SIMD_MASK(SIMD_EQ32(SIMD_LOAD(ptr), needle));
+		#endif
+			/* each matching character sets as many bits as its size in bytes */
+			if (mask) return (hawk_uch_t*)ptr + hawk_get_pos_of_msb_set_pow2(mask & (~mask + 1)) / HAWK_SIZEOF_UCH_T;
+			ptr += SIMD_BYTES / HAWK_SIZEOF_UCH_T;
+		}
+	}
+#endif
+
+	while (ptr < end)
+	{
+		if (*ptr == c) return (hawk_uch_t*)ptr;
+		ptr++;
+	}
+
+	return HAWK_NULL;
+}
+
+hawk_bch_t* hawk_find_bchar_in_bchars (const hawk_bch_t* ptr, hawk_oow_t len, hawk_bch_t c)
+{
+	/* the c library implements it with the widest vector instructions
+	 * the cpu supports */
+	return (hawk_bch_t*)HAWK_MEMCHR(ptr, c, len);
+}
+
 dnl
 dnl ---------------------------------------------------------------------------
 include(`utl-str.m4')dnl
@@ -213,9 +292,6 @@ dnl --
 fn_fill_chars(hawk_fill_uchars, hawk_uch_t)
 fn_fill_chars(hawk_fill_bchars, hawk_bch_t)
 dnl --
-fn_find_char_in_chars(hawk_find_uchar_in_uchars, hawk_uch_t)
-fn_find_char_in_chars(hawk_find_bchar_in_bchars, hawk_bch_t)
-dnl --
 fn_rfind_char_in_chars(hawk_rfind_uchar_in_uchars, hawk_uch_t)
 fn_rfind_char_in_chars(hawk_rfind_bchar_in_bchars, hawk_bch_t)
 dnl --
@@ -22,7 +22,7 @@
     THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <hawk-utl.h>
+#include "hawk-prv.h"
 #include <hawk-chr.h>
 
 void hawk_unescape_ucstr (hawk_uch_t* str)
@@ -1102,6 +1102,241 @@ done:
 	return (negative)? -fraction: fraction;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* the fast path of hawk_uchars_to_num() and hawk_bchars_to_num() takes
+ * a plain decimal number with up to 18 digits in total and a small
+ * exponent, optionally followed by what is not a number. it performs the
+ * same arithmetic as hawk_uchars_to_int() and hawk_uchars_to_flt() for
+ * such a number in a single pass and returns -2 for anything else so that
+ * the caller falls back to the full scan. */
+
+#if defined(HAWK_HAVE_UINT64_T)
+
+#define FAST_NUM_MAX_DIGITS 18
+#define FAST_NUM_MAX_EXP 22 /* 10^22 is the largest power exact in double */
+#if (HAWK_SIZEOF_INT_T >= 8)
+#	define FAST_NUM_MAX_INT_DIGITS 18
+#else
+#	define FAST_NUM_MAX_INT_DIGITS 9
+#endif
+
+static const hawk_flt_t fast_num_pow10[FAST_NUM_MAX_EXP + 1] =
+{
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+	1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#if defined(HAWK_ENDIAN_LITTLE)
+/* take 8 digits at a time with the arithmetic on a 64-bit word */
+#	define FAST_NUM_SWAR 1
+
+static HAWK_INLINE int swar_is_8_bch_digits (const hawk_bch_t* p)
+{
+	hawk_uint64_t v;
+	HAWK_MEMCPY (&v, p, 8);
+	return (v & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull &&
+	       ((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull;
+}
+
+static HAWK_INLINE hawk_uint64_t swar_parse_8_bch_digits (const hawk_bch_t* p)
+{
+	hawk_uint64_t v;
+	HAWK_MEMCPY (&v, p, 8);
+	v -= 0x3030303030303030ull;
+	v = (v * 10) + (v >> 8); /* pairs of digits */
+	v = (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+	     (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+	return (hawk_uint32_t)v;
+}
+
+#if (HAWK_SIZEOF_UCH_T == 2)
+static HAWK_INLINE int swar_is_4_uch_digits (hawk_uint64_t v)
+{
+	return (v & 0xFFF0FFF0FFF0FFF0ull) == 0x0030003000300030ull &&
+	       ((v + 0x0006000600060006ull) & 0xFFF0FFF0FFF0FFF0ull) == 0x0030003000300030ull;
+}
+
+static HAWK_INLINE int swar_is_8_uch_digits (const hawk_uch_t* p)
+{
+	hawk_uint64_t v[2];
+	HAWK_MEMCPY (v, p, 16);
+	return swar_is_4_uch_digits(v[0]) && swar_is_4_uch_digits(v[1]);
+}
+
+static HAWK_INLINE hawk_uint64_t swar_parse_4_uch_digits (hawk_uint64_t v)
+{
+	v -= 0x0030003000300030ull;
+	v = ((v * 10) + (v >> 16)) & 0x0000FFFF0000FFFFull; /* pairs of digits */
+	return (v & 0xFFFF) * 100 + (v >> 32);
+}
+
+static HAWK_INLINE hawk_uint64_t swar_parse_8_uch_digits (const hawk_uch_t* p)
+{
+	hawk_uint64_t v[2];
+	HAWK_MEMCPY (v, p, 16);
+	return swar_parse_4_uch_digits(v[0]) * 10000 + swar_parse_4_uch_digits(v[1]);
+}
+#endif
+#endif
+
+static HAWK_INLINE int fast_num_result (int option, hawk_uint64_t m, int neg, int nid, int nfd, int e, int first_is_zero, int partial, hawk_int_t* l, hawk_flt_t* r)
+{
+	if (nfd < 0)
+	{
+		/* an integer. a leading zero makes an octal, binary or hexadecimal
+		 * number with base 0 */
+		if (nid > FAST_NUM_MAX_INT_DIGITS) return -2;
+		if (first_is_zero && HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option) == 0 && (nid > 1 || partial)) return -2;
+
+		*l = neg? -(hawk_int_t)m: (hawk_int_t)m;
+		if (HAWK_OOCHARS_TO_NUM_GET_OPTION_REQSOBER(option) && nid <= 0) return -1;
+		if (HAWK_OOCHARS_TO_NUM_GET_OPTION_NOPARTIAL(option) && partial) return -1;
+		return 0;
+	}
+	else
+	{
+		int frac1, frac2;
+		hawk_flt_t fraction;
+
+		if (nfd > 0) e -= nfd;
+		if (e < -FAST_NUM_MAX_EXP || e > FAST_NUM_MAX_EXP) return -2;
+
+		/* combine the digits the same way as hawk_uchars_to_flt() */
+		frac1 = (int)(m / 1000000000);
+		frac2 = (int)(m % 1000000000);
+		fraction = (1.0e9 * frac1) + frac2;
+
+		if (e < 0) fraction /= fast_num_pow10[-e];
+		else fraction *= fast_num_pow10[e];
+
+		*r = neg? -fraction: fraction;
+		if (HAWK_OOCHARS_TO_NUM_GET_OPTION_NOPARTIAL(option) && partial) return -1;
+		return 1;
+	}
+}
+
+static int fast_uchars_to_num (int option, const hawk_uch_t* ptr, hawk_oow_t len, hawk_int_t* l, hawk_flt_t* r)
+{
+	const hawk_uch_t* p = ptr, * end = ptr + len, * q;
+	hawk_uint64_t m = 0;
+	int stripspc = HAWK_OOCHARS_TO_NUM_GET_OPTION_STRIPSPC(option);
+	int base = HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option);
+	int neg = 0, nid, nfd = -1, nd, e = 0;
+
+	if (base != 0 && base != 10) return -2;
+
+	if (stripspc) while (p < end && hawk_is_uch_space(*p)) p++;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		neg = (*p++ == '-');
+		if (p < end && (*p == '-' || *p == '+')) return -2; /* more signs */
+	}
+
+	q = p;
+#if defined(FAST_NUM_SWAR) && (HAWK_SIZEOF_UCH_T == 2)
+	while (end - p >= 8 && swar_is_8_uch_digits(p)) { m = m * 100000000 + swar_parse_8_uch_digits(p); p += 8; }
+#endif
+	while (p < end && hawk_is_uch_digit(*p)) m = m * 10 + (*p++ - '0');
+	nid = (int)(p - q);
+
+	if (p < end && *p == '.')
+	{
+		const hawk_uch_t* f = ++p;
+	#if defined(FAST_NUM_SWAR) && (HAWK_SIZEOF_UCH_T == 2)
+		while (end - p >= 8 && swar_is_8_uch_digits(p)) { m = m * 100000000 + swar_parse_8_uch_digits(p); p += 8; }
+	#endif
+		while (p < end && hawk_is_uch_digit(*p)) m = m * 10 + (*p++ - '0');
+		nfd = (int)(p - f);
+	}
+
+	nd = nid + (nfd > 0? nfd: 0);
+	if (nd > FAST_NUM_MAX_DIGITS) return -2;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const hawk_uch_t* x;
+		int eneg = 0;
+
+		if (nd <= 0) return -2;
+
+		p++;
+		if (p < end && (*p == '-' || *p == '+')) eneg = (*p++ == '-');
+		x = p;
+		while (p < end && hawk_is_uch_digit(*p) && p - x < 4) e = e * 10 + (*p++ - '0');
+		if (p == x || (p < end && hawk_is_uch_digit(*p))) return -2;
+		if (eneg) e = -e;
+		if (nfd < 0) nfd = 0; /* a number with an exponent is a floating-point number */
+	}
+	else if (nd <= 0 && nfd >= 0) return -2; /* a point without a digit */
+
+	if (stripspc) while (p < end && hawk_is_uch_space(*p)) p++;
+
+	return fast_num_result(option, m, neg, nid, nfd, e, (nid > 0 && *q == '0'), (p < end), l, r);
+}
+
+static int fast_bchars_to_num (int option, const hawk_bch_t* ptr, hawk_oow_t len, hawk_int_t* l, hawk_flt_t* r)
+{
+	const hawk_bch_t* p = ptr, * end = ptr + len, * q;
+	hawk_uint64_t m = 0;
+	int stripspc = HAWK_OOCHARS_TO_NUM_GET_OPTION_STRIPSPC(option);
+	int base = HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option);
+	int neg = 0, nid, nfd = -1, nd, e = 0;
+
+	if (base != 0 && base != 10) return -2;
+
+	if (stripspc) while (p < end && hawk_is_bch_space(*p)) p++;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		neg = (*p++ == '-');
+		if (p < end && (*p == '-' || *p == '+')) return -2; /* more signs */
+	}
+
+	q = p;
+#if defined(FAST_NUM_SWAR)
+	while (end - p >= 8 && swar_is_8_bch_digits(p)) { m = m * 100000000 + swar_parse_8_bch_digits(p); p += 8; }
+#endif
+	while (p < end && hawk_is_bch_digit(*p)) m = m * 10 + (*p++ - '0');
+	nid = (int)(p - q);
+
+	if (p < end && *p == '.')
+	{
+		const hawk_bch_t* f = ++p;
+	#if defined(FAST_NUM_SWAR)
+		while (end - p >= 8 && swar_is_8_bch_digits(p)) { m = m * 100000000 + swar_parse_8_bch_digits(p); p += 8; }
+	#endif
+		while (p < end && hawk_is_bch_digit(*p)) m = m * 10 + (*p++ - '0');
+		nfd = (int)(p - f);
+	}
+
+	nd = nid + (nfd > 0? nfd: 0);
+	if (nd > FAST_NUM_MAX_DIGITS) return -2;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const hawk_bch_t* x;
+		int eneg = 0;
+
+		if (nd <= 0) return -2;
+
+		p++;
+		if (p < end && (*p == '-' || *p == '+')) eneg = (*p++ == '-');
+		x = p;
+		while (p < end && hawk_is_bch_digit(*p) && p - x < 4) e = e * 10 + (*p++ - '0');
+		if (p == x || (p < end && hawk_is_bch_digit(*p))) return -2;
+		if (eneg) e = -e;
+		if (nfd < 0) nfd = 0; /* a number with an exponent is a floating-point number */
+	}
+	else if (nd <= 0 && nfd >= 0) return -2; /* a point without a digit */
+
+	if (stripspc) while (p < end && hawk_is_bch_space(*p)) p++;
+
+	return fast_num_result(option, m, neg, nid, nfd, e, (nid > 0 && *q == '0'), (p < end), l, r);
+}
+
+#endif
+
 int hawk_uchars_to_num (int option, const hawk_uch_t* ptr, hawk_oow_t len, hawk_int_t* l, hawk_flt_t* r)
 {
 	const hawk_uch_t* endptr;
@@ -1113,6 +1348,11 @@ int hawk_uchars_to_num (int option, const hawk_uch_t* ptr, hawk_oow_t len, hawk_
 	int base = HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option);
 	int is_sober;
 
+#if defined(HAWK_HAVE_UINT64_T)
+	is_sober = fast_uchars_to_num(option, ptr, len, l, r);
+	if (is_sober >= 0) return is_sober;
+#endif
+
 	end = ptr + len;
 	*l = hawk_uchars_to_int(ptr, len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc,0,base), &endptr, &is_sober);
 	if (endptr < end)
@@ -1171,6 +1411,11 @@ int hawk_bchars_to_num (int option, const hawk_bch_t* ptr, hawk_oow_t len, hawk_
 	int base = HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option);
 	int is_sober;
 
+#if defined(HAWK_HAVE_UINT64_T)
+	is_sober = fast_bchars_to_num(option, ptr, len, l, r);
+	if (is_sober >= 0) return is_sober;
+#endif
+
 	end = ptr + len;
 	*l = hawk_bchars_to_int(ptr, len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc,0,base), &endptr, &is_sober);
 	if (endptr < end)
@@ -54,6 +54,20 @@ struct hawk_val_rchunk_t
 	hawk_val_flt_t slot[HAWK_VAL_CHUNK_SIZE];
 };
 
+typedef struct hawk_val_arena_blk_t hawk_val_arena_blk_t;
+
+/* a block of the per-record arena. the values are carved out of the
+ * space following the header. each value is preceded by a pointer to
+ * the block to find the block when the value is freed. */
+struct hawk_val_arena_blk_t
+{
+	hawk_val_arena_blk_t* prev;
+	hawk_val_arena_blk_t* next;
+	hawk_oow_t live; /* number of the values not freed yet */
+	hawk_oow_t used;
+	hawk_oow_t capa;
+};
+
 
 /*
  * if shared objects link a static library, statically defined objects
@@ -68,6 +82,9 @@ struct hawk_val_rchunk_t
 */
 #define HAWK_IS_STATICVAL(val) ((val)->v_static)
 
+/* tell if a value is allocated in the per-record arena */
+#define HAWK_IS_ARENAVAL(val) (HAWK_VTR_IS_POINTER(val) && (val)->v_arena)
+
 
 /* hawk_val_t pointer encoding assumes the pointer is an even number.
  * i shift an integer within a certain range and set bit 0 to 1 to
@@ -158,6 +175,16 @@ struct hawk_val_rchunk_t
 #define HAWK_RTX_FREEVAL_CACHE       (1 << 0)
 #define HAWK_RTX_FREEVAL_GC_PRESERVE (1 << 1)
 
+/* a key to a field in a map value. an integer key is held in idx with
+ * ptr set to HAWK_NULL. a string key is held in ptr and len. */
+typedef struct hawk_val_map_key_t hawk_val_map_key_t;
+struct hawk_val_map_key_t
+{
+	const hawk_ooch_t* ptr;
+	hawk_oow_t len;
+	hawk_int_t idx;
+};
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -183,6 +210,64 @@ void hawk_rtx_freevalchunk (
 	hawk_val_chunk_t* chunk
 );
 
+/* free all the blocks of the per-record arena */
+void hawk_rtx_finiarena (
+	hawk_rtx_t*       rtx
+);
+
+/* return a copy of the value allocated outside the per-record arena if
+ * the value is in the arena. return the value itself otherwise. the
+ * copy has the reference count of 0. */
+hawk_val_t* hawk_rtx_promoteval (
+	hawk_rtx_t*       rtx,
+	hawk_val_t*       val
+);
+
+/* the functions below work on a map value like their counterparts on
+ * hawk_map_t except that the given key may be an integer. an integer
+ * key and a string key that spells the same integer in the canonical
+ * decimal form refer to the same field. */
+
+/* return the address of the slot holding the value of a field or
+ * HAWK_NULL if not found. the address stays valid until the field
+ * gets deleted */
+hawk_val_t** hawk_rtx_searchmapval (
+	hawk_rtx_t*               rtx,
+	hawk_val_t*               map,
+	const hawk_val_map_key_t* key
+);
+
+/* set a field to v without incrementing the reference count of v.
+ * the old value is released like hawk_map_upsert() does */
+hawk_val_t** hawk_rtx_upsertmapval (
+	hawk_rtx_t*               rtx,
+	hawk_val_t*               map,
+	const hawk_val_map_key_t* key,
+	hawk_val_t*               v
+);
+
+int hawk_rtx_deletemapval (
+	hawk_rtx_t*               rtx,
+	hawk_val_t*               map,
+	const hawk_val_map_key_t* key
+);
+
+void hawk_rtx_clearmapval (
+	hawk_rtx_t*               rtx,
+	hawk_val_t*               map
+);
+
+/* append characters to a string value in place. the value must not be
+ * shared as the change is visible to all the holders of the value. when
+ * the characters don't fit in the space given at the creation time, the
+ * characters move to a separate buffer that grows geometrically */
+int hawk_rtx_appendtostrval (
+	hawk_rtx_t*               rtx,
+	hawk_val_t*               val,
+	const hawk_ooch_t*        ptr,
+	hawk_oow_t                len
+);
+
 #if defined(__cplusplus)
 }
 #endif
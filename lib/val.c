@@ -35,7 +35,9 @@ static hawk_val_nil_t hawk_nil = {
 	HAWK_SFN(v_type)   HAWK_VAL_NIL,
 	HAWK_SFN(v_static) 1,
 	HAWK_SFN(v_nstr)   0,
-	HAWK_SFN(v_gc)     0
+	HAWK_SFN(v_gc)     0,
+	HAWK_SFN(v_arena)  0,
+	HAWK_SFN(v_ncache) 0
 };
 /* zero-length string */
 static hawk_val_str_t hawk_zls = {
@@ -44,6 +46,8 @@ static hawk_val_str_t hawk_zls = {
 	HAWK_SFN(v_static) 1,
 	HAWK_SFN(v_nstr)   0,
 	HAWK_SFN(v_gc)     0,
+	HAWK_SFN(v_arena)  0,
+	HAWK_SFN(v_ncache) 0,
 	HAWK_SFN(val)      { HAWK_T(""), 0 }
 };
 /* zero-length byte string */
@@ -53,6 +57,8 @@ static hawk_val_mbs_t hawk_zlbs = {
 	HAWK_SFN(v_static) 1,
 	HAWK_SFN(v_nstr)   0,
 	HAWK_SFN(v_gc)     0,
+	HAWK_SFN(v_arena)  0,
+	HAWK_SFN(v_ncache) 0,
 	HAWK_SFN(val)      { HAWK_BT(""), 0 }
 };
 
@@ -149,8 +155,16 @@ BEGIN {
 
 /*#define DEBUG_GC*/
 
+/* gc_refs of a value holds a reference count below GCH_ROUND while the
+ * value is under collection in a single pass. it holds a reference count
+ * offset by GCH_ROUND while the value is under the incremental collection
+ * of the oldest generation. otherwise, it holds one of the marks. */
 #define GCH_MOVED HAWK_TYPE_MAX(hawk_uintptr_t)
 #define GCH_UNREACHABLE (GCH_MOVED - 1)
+#define GCH_REACHED (GCH_MOVED - 2)
+#define GCH_ROUND ((GCH_MOVED >> 1) + 1)
+#define GCH_IS_COUNTED(gch) ((gch)->gc_refs < GCH_ROUND)
+#define GCH_IS_IN_ROUND(gch) ((gch)->gc_refs >= GCH_ROUND && (gch)->gc_refs < GCH_REACHED)
 
 static HAWK_INLINE void gc_chain_gch (hawk_gch_t* list, hawk_gch_t* gch)
 {
@@ -162,7 +176,9 @@ static HAWK_INLINE void gc_chain_gch (hawk_gch_t* list, hawk_gch_t* gch)
 
 static HAWK_INLINE void gc_chain_val (hawk_gch_t* list, hawk_val_t* v)
 {
-	gc_chain_gch (list, hawk_val_to_gch(v));
+	hawk_gch_t* gch = hawk_val_to_gch(v);
+	gch->gc_refs = GCH_MOVED; /* not under collection */
+	gc_chain_gch (list, gch);
 }
 
 static HAWK_INLINE void gc_move_all_gchs (hawk_gch_t* src, hawk_gch_t* dst)
@@ -199,6 +215,7 @@ static void gc_trace_refs (hawk_gch_t* list)
 	hawk_val_t* v, * iv;
 	hawk_map_itr_t itr;
 	hawk_map_pair_t* pair;
+	hawk_oow_t i, j;
 
 	/* phase 1 - copy the reference count field from the value header to the gc header */
 	gch = list->gc_next;
@@ -208,7 +225,8 @@ static void gc_trace_refs (hawk_gch_t* list)
 		gch = gch->gc_next;
 	}
 
-	/* phase 2 - decrement the reference count in the gc header whenever a reference is found */
+	/* phase 2 - decrement the reference count in the gc header whenever a reference is found.
+	 *           a value outside the list is left alone as its gc_refs is a mark */
 	gch = list->gc_next;
 	while (gch != list)
 	{
@@ -224,16 +242,28 @@ static void gc_trace_refs (hawk_gch_t* list)
 			while (pair)
 			{
 				iv = (hawk_val_t*)HAWK_MAP_VPTR(pair);
-				if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc)
+				if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc && GCH_IS_COUNTED(hawk_val_to_gch(iv)))
 				{
 					hawk_val_to_gch(iv)->gc_refs--;
 				}
 				pair = hawk_map_getnextpair(map, &itr);
 			}
+
+			for (i = 0; i < ((hawk_val_map_t*)v)->vec.nchunks; i++)
+			{
+				for (j = 0; j < HAWK_VAL_MAP_VEC_CHUNK_SIZE; j++)
+				{
+					iv = ((hawk_val_map_t*)v)->vec.chunk[i][j];
+					if (iv && HAWK_VTR_IS_POINTER(iv) && iv->v_gc && GCH_IS_COUNTED(hawk_val_to_gch(iv)))
+					{
+						hawk_val_to_gch(iv)->gc_refs--;
+					}
+				}
+			}
 		}
 		else /* if (v->v_type == HAWK_VAL_ARR) */
 		{
-			hawk_oow_t size, i;
+			hawk_oow_t size;
 			hawk_arr_t* arr;
 
 			HAWK_ASSERT (v->v_type == HAWK_VAL_ARR); /* only HAWK_VAL_MAP and HAWK_VAL_ARR */
@@ -245,7 +275,7 @@ static void gc_trace_refs (hawk_gch_t* list)
 				if (HAWK_ARR_SLOT(arr, i))
 				{
 					iv = (hawk_val_t*)HAWK_ARR_DPTR(arr, i);
-					if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc)
+					if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc && GCH_IS_COUNTED(hawk_val_to_gch(iv)))
 					{
 						hawk_val_to_gch(iv)->gc_refs--;
 					}
@@ -271,12 +301,14 @@ static void gc_dump_refs (hawk_rtx_t* rtx, hawk_gch_t* list)
 	hawk_logbfmt (hawk_rtx_gethawk(rtx), HAWK_LOG_STDERR, "[GC] dumped %ju values\n", count);
 }
 
-static void gc_move_reachables (hawk_gch_t* list, hawk_gch_t* reachable_list)
+/* it returns the number of values moved and slots looked at */
+static hawk_oow_t gc_move_reachables (hawk_gch_t* list, hawk_gch_t* reachable_list)
 {
 	hawk_gch_t* gch, * tmp;
 	hawk_val_t* v, * iv;
 	hawk_map_itr_t itr;
 	hawk_map_pair_t* pair;
+	hawk_oow_t i, j, work = 0;
 
 	gch = list->gc_next;
 	while (gch != list)
@@ -311,19 +343,39 @@ static void gc_move_reachables (hawk_gch_t* list, hawk_gch_t* reachable_list)
 				if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc)
 				{
 					tmp = hawk_val_to_gch(iv);
-					if (tmp->gc_refs != GCH_MOVED)
+					if (GCH_IS_COUNTED(tmp))
 					{
 						gc_unchain_gch (tmp);
 						gc_chain_gch (reachable_list, tmp);
 						tmp->gc_refs = GCH_MOVED;
 					}
 				}
+				work++;
 				pair = hawk_map_getnextpair(map, &itr);
 			}
+
+			for (i = 0; i < ((hawk_val_map_t*)v)->vec.nchunks; i++)
+			{
+				for (j = 0; j < HAWK_VAL_MAP_VEC_CHUNK_SIZE; j++)
+				{
+					iv = ((hawk_val_map_t*)v)->vec.chunk[i][j];
+					if (iv && HAWK_VTR_IS_POINTER(iv) && iv->v_gc)
+					{
+						tmp = hawk_val_to_gch(iv);
+						if (GCH_IS_COUNTED(tmp))
+						{
+							gc_unchain_gch (tmp);
+							gc_chain_gch (reachable_list, tmp);
+							tmp->gc_refs = GCH_MOVED;
+						}
+					}
+				}
+				work += HAWK_VAL_MAP_VEC_CHUNK_SIZE;
+			}
 		}
 		else /* if (v->v_type == HAWK_VAL_ARR) */
 		{
-			hawk_oow_t size, i;
+			hawk_oow_t size;
 			hawk_arr_t* arr;
 
 			HAWK_ASSERT (v->v_type == HAWK_VAL_ARR); /* only HAWK_VAL_MAP and HAWK_VAL_ARR */
@@ -338,7 +390,7 @@ static void gc_move_reachables (hawk_gch_t* list, hawk_gch_t* reachable_list)
 					if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc)
 					{
 						tmp = hawk_val_to_gch(iv);
-						if (tmp->gc_refs != GCH_MOVED)
+						if (GCH_IS_COUNTED(tmp))
 						{
 							gc_unchain_gch (tmp);
 							gc_chain_gch (reachable_list, tmp);
@@ -347,10 +399,14 @@ static void gc_move_reachables (hawk_gch_t* list, hawk_gch_t* reachable_list)
 					}
 				}
 			}
+			work += size;
 		}
 
+		work++;
 		gch = gch->gc_next;
 	}
+
+	return work;
 }
 
 static HAWK_INLINE void gc_free_val (hawk_rtx_t* rtx, hawk_val_t* v)
@@ -395,9 +451,12 @@ static void gc_free_unreachables (hawk_rtx_t* rtx, hawk_gch_t* list)
 		/* do what hawk_rtx_freeval() would do without HAWK_RTX_FREEVAL_GC_PRESERVE */
 		gc_unchain_gch (gch);
 		gc_free_val (rtx, hawk_gch_to_val(gch));
+		rtx->gc.stat.freed++;
 	}
 }
 
+static hawk_oow_t gc_inc_step (hawk_rtx_t* rtx);
+
 static HAWK_INLINE void gc_collect_garbage_in_generation (hawk_rtx_t* rtx, int gen)
 {
 	hawk_oow_t i, newgen;
@@ -412,15 +471,43 @@ static HAWK_INLINE void gc_collect_garbage_in_generation (hawk_rtx_t* rtx, int g
 		gc_move_all_gchs (&rtx->gc.g[i], &rtx->gc.g[gen]);
 	}
 
+	if (gen == HAWK_COUNTOF(rtx->gc.g) - 1 && rtx->gc.inc.phase != GC_INC_IDLE)
+	{
+		/* the values being swept in the incremental round in progress
+		 * are garbage for sure. finish sweeping them. the collection of
+		 * the oldest generation in a single pass takes over the round
+		 * in other phases */
+		while (rtx->gc.inc.phase >= GC_INC_MARK) gc_inc_step (rtx);
+		if (rtx->gc.inc.phase != GC_INC_IDLE)
+		{
+			gc_move_all_gchs (&rtx->gc.inc.todo, &rtx->gc.g[gen]);
+			gc_move_all_gchs (&rtx->gc.inc.done, &rtx->gc.g[gen]);
+			gc_move_all_gchs (&rtx->gc.inc.reach, &rtx->gc.g[gen]);
+			rtx->gc.inc.phase = GC_INC_IDLE;
+			rtx->gc.inc.debt = 0;
+			rtx->gc.inc.pay = 0;
+		}
+	}
+
 	if (rtx->gc.g[gen].gc_next != &rtx->gc.g[gen])
 	{
 		hawk_gch_t reachable;
+		hawk_oow_t work;
 
 		gc_trace_refs (&rtx->gc.g[gen]);
 
 		reachable.gc_prev = &reachable;
 		reachable.gc_next = &reachable;
-		gc_move_reachables (&rtx->gc.g[gen], &reachable);
+		work = gc_move_reachables(&rtx->gc.g[gen], &reachable);
+
+		if (newgen != gen && newgen == HAWK_COUNTOF(rtx->gc.g) - 1 && rtx->gc.inc.phase != GC_INC_IDLE)
+		{
+			/* the incremental round in progress owes work for the values
+			 * promoted to the oldest generation. spread the payment over
+			 * the slices until the next promotion */
+			rtx->gc.inc.debt += work * HAWK_GC_INC_PACE;
+			rtx->gc.inc.pay = rtx->gc.inc.debt / (rtx->gc.threshold[gen] + 1) + 1;
+		}
 
 		/* only unreachables are left in rtx->gc.g[0] */
 	#if defined(DEBUG_GC)
@@ -433,6 +520,8 @@ static HAWK_INLINE void gc_collect_garbage_in_generation (hawk_rtx_t* rtx, int g
 		gc_move_all_gchs (&reachable, &rtx->gc.g[newgen]);
 	}
 
+	rtx->gc.stat.collections[gen]++;
+
 	/* [NOTE] pressure is greater than other elements by 1 in size.
 	 *        i store the number of collections for gen 0 in pressure[1].
 	 *        so i can avoid some comparison when doing this */
@@ -445,11 +534,294 @@ static HAWK_INLINE void gc_collect_garbage_in_generation (hawk_rtx_t* rtx, int g
 #endif
 }
 
+typedef void (*gc_visit_t) (hawk_rtx_t* rtx, hawk_gch_t* gch);
+
+/* call a function for each value under gc management held in a container.
+ * it returns the number of slots looked at */
+static hawk_oow_t gc_walk_children (hawk_rtx_t* rtx, hawk_val_t* v, gc_visit_t visit)
+{
+	hawk_val_t* iv;
+	hawk_oow_t i, j, work = 0;
+
+	if (v->v_type == HAWK_VAL_MAP)
+	{
+		hawk_map_t* map;
+		hawk_map_itr_t itr;
+		hawk_map_pair_t* pair;
+
+		map = ((hawk_val_map_t*)v)->map;
+		hawk_init_map_itr (&itr, 0);
+		pair = hawk_map_getfirstpair(map, &itr);
+		while (pair)
+		{
+			iv = (hawk_val_t*)HAWK_MAP_VPTR(pair);
+			if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc) visit (rtx, hawk_val_to_gch(iv));
+			work++;
+			pair = hawk_map_getnextpair(map, &itr);
+		}
+
+		for (i = 0; i < ((hawk_val_map_t*)v)->vec.nchunks; i++)
+		{
+			for (j = 0; j < HAWK_VAL_MAP_VEC_CHUNK_SIZE; j++)
+			{
+				iv = ((hawk_val_map_t*)v)->vec.chunk[i][j];
+				if (iv && HAWK_VTR_IS_POINTER(iv) && iv->v_gc) visit (rtx, hawk_val_to_gch(iv));
+			}
+			work += HAWK_VAL_MAP_VEC_CHUNK_SIZE;
+		}
+	}
+	else /* if (v->v_type == HAWK_VAL_ARR) */
+	{
+		hawk_oow_t size;
+		hawk_arr_t* arr;
+
+		HAWK_ASSERT (v->v_type == HAWK_VAL_ARR); /* only HAWK_VAL_MAP and HAWK_VAL_ARR */
+
+		arr = ((hawk_val_arr_t*)v)->arr;
+		size = HAWK_ARR_SIZE(arr);
+		for (i = 0; i < size; i++)
+		{
+			if (HAWK_ARR_SLOT(arr, i))
+			{
+				iv = (hawk_val_t*)HAWK_ARR_DPTR(arr, i);
+				if (HAWK_VTR_IS_POINTER(iv) && iv->v_gc) visit (rtx, hawk_val_to_gch(iv));
+			}
+		}
+		work += size;
+	}
+
+	return work;
+}
+
+static void gc_inc_subtract (hawk_rtx_t* rtx, hawk_gch_t* gch)
+{
+	if (GCH_IS_IN_ROUND(gch))
+	{
+		/* a reference made after the count got copied gets the value
+		 * reached in hawk_rtx_refupval(). the count doesn't go below zero */
+		HAWK_ASSERT (gch->gc_refs > GCH_ROUND);
+		gch->gc_refs--;
+	}
+}
+
+static void gc_inc_reach (hawk_rtx_t* rtx, hawk_gch_t* gch)
+{
+	if (GCH_IS_IN_ROUND(gch))
+	{
+		gc_unchain_gch (gch);
+		gc_chain_gch (&rtx->gc.inc.reach, gch);
+		gch->gc_refs = GCH_REACHED;
+	}
+}
+
+static void gc_finish_round (hawk_rtx_t* rtx)
+{
+	hawk_oow_t last = HAWK_COUNTOF(rtx->gc.g) - 1;
+
+	rtx->gc.inc.phase = GC_INC_IDLE;
+	rtx->gc.inc.debt = 0;
+	rtx->gc.inc.pay = 0;
+	rtx->gc.stat.rounds++;
+
+	rtx->gc.pressure[last + 1]++;
+	rtx->gc.pressure[last] = 0;
+}
+
+/* advance the incremental collection by a step. it returns the amount
+ * of work done, which is 0 when the step moves to the next phase */
+static hawk_oow_t gc_inc_step (hawk_rtx_t* rtx)
+{
+	hawk_oow_t last = HAWK_COUNTOF(rtx->gc.g) - 1;
+	hawk_gch_t* gch;
+	hawk_val_t* v;
+	hawk_oow_t work;
+
+	switch (rtx->gc.inc.phase)
+	{
+		case GC_INC_COPY:
+			gch = rtx->gc.inc.todo.gc_next;
+			if (gch == &rtx->gc.inc.todo)
+			{
+				gc_move_all_gchs (&rtx->gc.inc.done, &rtx->gc.inc.todo);
+				rtx->gc.inc.phase = GC_INC_SUBTRACT;
+				return 0;
+			}
+
+			gch->gc_refs = GCH_ROUND + hawk_gch_to_val(gch)->v_refs;
+			gc_unchain_gch (gch);
+			gc_chain_gch (&rtx->gc.inc.done, gch);
+			return 1;
+
+		case GC_INC_SUBTRACT:
+			gch = rtx->gc.inc.todo.gc_next;
+			if (gch == &rtx->gc.inc.todo)
+			{
+				gc_move_all_gchs (&rtx->gc.inc.done, &rtx->gc.inc.todo);
+				rtx->gc.inc.phase = GC_INC_REACH;
+				return 0;
+			}
+
+			work = 1 + gc_walk_children(rtx, hawk_gch_to_val(gch), gc_inc_subtract);
+			gc_unchain_gch (gch);
+			gc_chain_gch (&rtx->gc.inc.done, gch);
+			return work;
+
+		case GC_INC_REACH:
+			/* a value reached is done first. a value still having
+			 * references is reached. a value having no references
+			 * waits in the done list until it gets reached */
+			gch = rtx->gc.inc.reach.gc_next;
+			if (gch == &rtx->gc.inc.reach)
+			{
+				gch = rtx->gc.inc.todo.gc_next;
+				if (gch == &rtx->gc.inc.todo)
+				{
+					/* the values left in the done list are garbage */
+					gc_move_all_gchs (&rtx->gc.inc.done, &rtx->gc.inc.todo);
+					rtx->gc.inc.phase = GC_INC_MARK;
+					return 0;
+				}
+
+				if (gch->gc_refs == GCH_ROUND)
+				{
+					gc_unchain_gch (gch);
+					gc_chain_gch (&rtx->gc.inc.done, gch);
+					return 1;
+				}
+
+				gch->gc_refs = GCH_REACHED;
+			}
+
+			work = 1 + gc_walk_children(rtx, hawk_gch_to_val(gch), gc_inc_reach);
+			gc_unchain_gch (gch);
+			gc_chain_gch (&rtx->gc.g[last], gch);
+			return work;
+
+		case GC_INC_MARK:
+			/* mark all the garbage before clearing any of it like
+			 * gc_free_unreachables() */
+			gch = rtx->gc.inc.todo.gc_next;
+			if (gch == &rtx->gc.inc.todo)
+			{
+				gc_move_all_gchs (&rtx->gc.inc.done, &rtx->gc.inc.todo);
+				rtx->gc.inc.phase = GC_INC_CLEAR;
+				return 0;
+			}
+
+			gch->gc_refs = GCH_UNREACHABLE;
+			gc_unchain_gch (gch);
+			gc_chain_gch (&rtx->gc.inc.done, gch);
+			return 1;
+
+		case GC_INC_CLEAR:
+			gch = rtx->gc.inc.todo.gc_next;
+			if (gch == &rtx->gc.inc.todo)
+			{
+				rtx->gc.inc.phase = GC_INC_FREE;
+				return 0;
+			}
+
+			/* count the slots freed like gc_walk_children() */
+			v = hawk_gch_to_val(gch);
+			work = (v->v_type == HAWK_VAL_MAP)?
+				(1 + HAWK_MAP_SIZE(((hawk_val_map_t*)v)->map) + ((hawk_val_map_t*)v)->vec.nchunks * HAWK_VAL_MAP_VEC_CHUNK_SIZE):
+				(1 + HAWK_ARR_SIZE(((hawk_val_arr_t*)v)->arr));
+			hawk_rtx_freeval (rtx, v, HAWK_RTX_FREEVAL_GC_PRESERVE);
+			gc_unchain_gch (gch);
+			gc_chain_gch (&rtx->gc.inc.done, gch);
+			return work;
+
+		case GC_INC_FREE:
+			gch = rtx->gc.inc.done.gc_next;
+			if (gch == &rtx->gc.inc.done)
+			{
+				gc_finish_round (rtx);
+				return 0;
+			}
+
+			gc_unchain_gch (gch);
+			gc_free_val (rtx, hawk_gch_to_val(gch));
+			rtx->gc.stat.freed++;
+			return 1;
+	}
+
+	return 0;
+}
+
+static void gc_collect_garbage_in_slice (hawk_rtx_t* rtx)
+{
+	hawk_oow_t last, pay, work = 0, n = 0;
+	hawk_ntime_t start, now;
+
+	/* a round of the incremental collection goes over the values in the
+	 * oldest generation at the beginning of the round in the phases below.
+	 *  GC_INC_COPY     - copy the reference count of each value
+	 *  GC_INC_SUBTRACT - subtract the references from the values in the round
+	 *  GC_INC_REACH    - move the values reachable from the values still
+	 *                    having references to the oldest generation
+	 *  GC_INC_MARK     - mark the values left unreached as unreachable
+	 *  GC_INC_CLEAR    - free what the values marked hold
+	 *  GC_INC_FREE     - free the values marked
+	 *
+	 * the values in progress are held in the lists of rtx->gc.inc and
+	 * a slice always takes a value from the head of a list. the program
+	 * running between slices may free any value without harm. a value in
+	 * the round gaining a reference gets reached in hawk_rtx_refupval().
+	 * so the references the program moves around between slices can't
+	 * leave a live value unreached. the values promoted to the oldest
+	 * generation during a round join the next round.
+	 *
+	 * the values promoted to the oldest generation during a round put the
+	 * round in debt. the slices until the next promotion pay it off on top
+	 * of the work budget for the round to finish before the promoted values
+	 * pile up. the time budget doesn't cut the payment. */
+
+	last = HAWK_COUNTOF(rtx->gc.g) - 1;
+
+	if (rtx->gc.inc.phase == GC_INC_IDLE)
+	{
+		gc_move_all_gchs (&rtx->gc.g[last], &rtx->gc.inc.todo);
+		rtx->gc.inc.phase = GC_INC_COPY;
+	}
+
+	rtx->gc.stat.slices++;
+
+	start.sec = 0;
+	start.nsec = 0;
+	if (rtx->gc.inc.time > 0) hawk_get_ntime (&start);
+
+	pay = rtx->gc.inc.pay;
+	if (pay > rtx->gc.inc.debt) pay = rtx->gc.inc.debt;
+	rtx->gc.inc.debt -= pay;
+
+	while (work < rtx->gc.inc.work + pay && rtx->gc.inc.phase != GC_INC_IDLE)
+	{
+		if (rtx->gc.inc.time > 0 && work >= pay && (++n % 32) == 0 && hawk_get_ntime(&now) >= 0 &&
+		    (hawk_oow_t)((now.sec - start.sec) * 1000000 + (now.nsec - start.nsec) / 1000) >= rtx->gc.inc.time) break;
+
+		work += gc_inc_step(rtx);
+	}
+}
+
 static HAWK_INLINE int gc_collect_garbage_auto (hawk_rtx_t* rtx)
 {
 	hawk_oow_t i;
 
 	i = HAWK_COUNTOF(rtx->gc.g);
+	if (rtx->gc.inc.work > 0 && (rtx->gc.inc.phase != GC_INC_IDLE || rtx->gc.pressure[i - 1] >= rtx->gc.threshold[i - 1]))
+	{
+		/* collect the young generations as usual and advance the
+		 * incremental collection of the oldest generation by a slice */
+		for (i = i - 2; i > 0; i--)
+		{
+			if (rtx->gc.pressure[i] >= rtx->gc.threshold[i]) break;
+		}
+
+		gc_collect_garbage_in_generation (rtx, i);
+		gc_collect_garbage_in_slice (rtx);
+		return i;
+	}
+
 	while (i > 1)
 	{
 		--i;
@@ -466,16 +838,83 @@ static HAWK_INLINE int gc_collect_garbage_auto (hawk_rtx_t* rtx)
 
 int hawk_rtx_gc (hawk_rtx_t* rtx, int gen)
 {
+	hawk_ntime_t start, now;
+	hawk_oow_t pause;
+
+	hawk_get_ntime (&start);
+
 	if (gen < 0)
 	{
-		return gc_collect_garbage_auto (rtx);
+		gen = gc_collect_garbage_auto(rtx);
 	}
 	else
 	{
 		if (gen >= HAWK_COUNTOF(rtx->gc.g)) gen = HAWK_COUNTOF(rtx->gc.g) - 1;
 		gc_collect_garbage_in_generation (rtx, gen);
-		return gen;
 	}
+
+	if (hawk_get_ntime(&now) >= 0 && (now.sec > start.sec || (now.sec == start.sec && now.nsec >= start.nsec)))
+	{
+		pause = (now.sec - start.sec) * 1000000 + (now.nsec - start.nsec) / 1000;
+		rtx->gc.stat.pause_total += pause;
+		if (pause > rtx->gc.stat.pause_max) rtx->gc.stat.pause_max = pause;
+	}
+
+	return gen;
+}
+
+void hawk_rtx_getgcstats (hawk_rtx_t* rtx, hawk_gcstats_t* stats)
+{
+	hawk_gch_t* gch;
+	hawk_oow_t i;
+
+	HAWK_MEMSET (stats, 0, HAWK_SIZEOF(*stats));
+
+	HAWK_ASSERT (HAWK_COUNTOF(rtx->gc.g) <= HAWK_COUNTOF(stats->gen));
+	stats->ngens = HAWK_COUNTOF(rtx->gc.g);
+	for (i = 0; i < HAWK_COUNTOF(rtx->gc.g); i++)
+	{
+		for (gch = rtx->gc.g[i].gc_next; gch != &rtx->gc.g[i]; gch = gch->gc_next) stats->gen[i].count++;
+		stats->gen[i].collections = rtx->gc.stat.collections[i];
+		stats->gen[i].pressure = rtx->gc.pressure[i];
+		stats->gen[i].threshold = rtx->gc.threshold[i];
+		stats->collections += rtx->gc.stat.collections[i];
+	}
+
+	/* the values in the incremental round belong to the oldest generation */
+	i--;
+	for (gch = rtx->gc.inc.todo.gc_next; gch != &rtx->gc.inc.todo; gch = gch->gc_next) stats->gen[i].count++;
+	for (gch = rtx->gc.inc.done.gc_next; gch != &rtx->gc.inc.done; gch = gch->gc_next) stats->gen[i].count++;
+	for (gch = rtx->gc.inc.reach.gc_next; gch != &rtx->gc.inc.reach; gch = gch->gc_next) stats->gen[i].count++;
+
+	stats->slices = rtx->gc.stat.slices;
+	stats->rounds = rtx->gc.stat.rounds;
+	stats->freed = rtx->gc.stat.freed;
+	stats->pause_total = rtx->gc.stat.pause_total;
+	stats->pause_max = rtx->gc.stat.pause_max;
+
+	stats->str_cache.hits = rtx->vstat.str_hits;
+	stats->str_cache.misses = rtx->vstat.str_misses;
+	stats->mbs_cache.hits = rtx->vstat.mbs_hits;
+	stats->mbs_cache.misses = rtx->vstat.mbs_misses;
+	stats->int_cache.hits = rtx->vstat.int_hits;
+	stats->int_cache.misses = rtx->vstat.int_misses;
+	stats->flt_cache.hits = rtx->vstat.flt_hits;
+	stats->flt_cache.misses = rtx->vstat.flt_misses;
+	stats->ref_cache.hits = rtx->vstat.ref_hits;
+	stats->ref_cache.misses = rtx->vstat.ref_misses;
+}
+
+int hawk_rtx_setgcthreshold (hawk_rtx_t* rtx, int gen, hawk_oow_t threshold)
+{
+	if (gen < 0 || gen >= HAWK_COUNTOF(rtx->gc.threshold))
+	{
+		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
+		return -1;
+	}
+
+	rtx->gc.threshold[gen] = threshold;
+	return 0;
 }
 
 
@@ -487,7 +926,7 @@ static HAWK_INLINE hawk_val_t* gc_calloc_val (hawk_rtx_t* rtx, hawk_oow_t size)
 	if (HAWK_UNLIKELY(rtx->gc.pressure[0] >= rtx->gc.threshold[0]))
 	{
 		/* invoke generational garbage collection */
-		gc_gen = gc_collect_garbage_auto(rtx);
+		gc_gen = hawk_rtx_gc(rtx, HAWK_RTX_GC_GEN_AUTO);
 	}
 
 	gch = (hawk_gch_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*gch) + size);
@@ -557,6 +996,8 @@ hawk_val_t* hawk_rtx_makeintval (hawk_rtx_t* rtx, hawk_int_t v)
 		/*hawk_val_int_t* x;*/
 		hawk_oow_t i;
 
+		rtx->vstat.int_misses++;
+
 		/* use hawk_val_ichunk structure to avoid
 		 * any alignment issues on platforms requiring
 		 * aligned memory access - using the code commented out
@@ -582,6 +1023,7 @@ hawk_val_t* hawk_rtx_makeintval (hawk_rtx_t* rtx, hawk_int_t v)
 
 		rtx->vmgr.ifree = &c->slot[0];
 	}
+	else rtx->vstat.int_hits++;
 
 	val = rtx->vmgr.ifree;
 	rtx->vmgr.ifree = (hawk_val_int_t*)val->nde;
@@ -590,7 +1032,9 @@ hawk_val_t* hawk_rtx_makeintval (hawk_rtx_t* rtx, hawk_int_t v)
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->i_val = v;
 	val->nde = HAWK_NULL;
 
@@ -609,6 +1053,8 @@ hawk_val_t* hawk_rtx_makefltval (hawk_rtx_t* rtx, hawk_flt_t v)
 		hawk_val_rchunk_t* c;
 		hawk_oow_t i;
 
+		rtx->vstat.flt_misses++;
+
 		c = hawk_rtx_allocmem(rtx, HAWK_SIZEOF(hawk_val_rchunk_t));
 		if (!c) return HAWK_NULL;
 
@@ -621,6 +1067,7 @@ hawk_val_t* hawk_rtx_makefltval (hawk_rtx_t* rtx, hawk_flt_t v)
 
 		rtx->vmgr.rfree = &c->slot[0];
 	}
+	else rtx->vstat.flt_hits++;
 
 	val = rtx->vmgr.rfree;
 	rtx->vmgr.rfree = (hawk_val_flt_t*)val->nde;
@@ -629,7 +1076,9 @@ hawk_val_t* hawk_rtx_makefltval (hawk_rtx_t* rtx, hawk_flt_t v)
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->val = v;
 	val->nde = HAWK_NULL;
 
@@ -639,6 +1088,120 @@ hawk_val_t* hawk_rtx_makefltval (hawk_rtx_t* rtx, hawk_flt_t v)
 	return (hawk_val_t*)val;
 }
 
+/* ---------------------------------------------------------------------
+ * PER-RECORD ARENA
+ *
+ * the string values made while the pattern-action blocks run are carved
+ * out of a block with a bump pointer. each value is preceded by a pointer
+ * to its block and the block counts the values not freed yet. when the
+ * count drops to zero, the current block is reset wholesale. it mostly
+ * happens when the next record replaces the fields of the current record.
+ *
+ * a value surviving the record keeps its block alive. the current block
+ * full of such values is moved to the pinned list and freed when the last
+ * value in it is freed. a scalar variable holds a single value at a time
+ * and pins a block only until the next assignment. the value assigned to
+ * a map element gets promoted to the heap as a map may accumulate values
+ * over many records.
+ * --------------------------------------------------------------------- */
+
+static void* alloc_in_arena (hawk_rtx_t* rtx, hawk_oow_t size)
+{
+	hawk_val_arena_blk_t* blk;
+	hawk_uint8_t* ptr;
+
+	size = HAWK_ALIGN_POW2(HAWK_SIZEOF(blk) + size, HAWK_SIZEOF_VOID_P);
+	/* a large value goes to the heap not to waste the block */
+	if (size > rtx->arena.capa / 8) return HAWK_NULL;
+
+	blk = rtx->arena.cur;
+	if (!blk || blk->used + size > blk->capa)
+	{
+		if (blk)
+		{
+			/* the block is full of live values. it can't be reset until
+			 * the values are gone. chain it to the pinned list */
+			HAWK_ASSERT (blk->live > 0);
+			blk->next = &rtx->arena.pinned;
+			blk->prev = rtx->arena.pinned.prev;
+			rtx->arena.pinned.prev->next = blk;
+			rtx->arena.pinned.prev = blk;
+			rtx->arena.cur = HAWK_NULL;
+		}
+
+		if (rtx->arena.spare)
+		{
+			blk = rtx->arena.spare;
+			rtx->arena.spare = HAWK_NULL;
+		}
+		else
+		{
+			blk = (hawk_val_arena_blk_t*)hawk_rtx_allocmem(rtx, HAWK_SIZEOF(*blk) + rtx->arena.capa);
+			if (HAWK_UNLIKELY(!blk)) return HAWK_NULL; /* let the caller try the heap */
+		}
+
+		blk->prev = HAWK_NULL;
+		blk->next = HAWK_NULL;
+		blk->live = 0;
+		blk->used = 0;
+		blk->capa = rtx->arena.capa;
+		rtx->arena.cur = blk;
+	}
+
+	ptr = (hawk_uint8_t*)(blk + 1) + blk->used;
+	blk->used += size;
+	blk->live++;
+
+	*(hawk_val_arena_blk_t**)ptr = blk;
+	return (hawk_val_arena_blk_t**)ptr + 1;
+}
+
+static void free_in_arena (hawk_rtx_t* rtx, hawk_val_t* val)
+{
+	hawk_val_arena_blk_t* blk;
+
+	blk = ((hawk_val_arena_blk_t**)val)[-1];
+	HAWK_ASSERT (blk->live > 0);
+	if (--blk->live > 0) return;
+
+	if (blk == rtx->arena.cur)
+	{
+		/* reset the block wholesale */
+		blk->used = 0;
+		return;
+	}
+
+	/* the last value in a pinned block */
+	blk->prev->next = blk->next;
+	blk->next->prev = blk->prev;
+	if (rtx->arena.spare) hawk_rtx_freemem (rtx, blk);
+	else rtx->arena.spare = blk;
+}
+
+void hawk_rtx_finiarena (hawk_rtx_t* rtx)
+{
+	hawk_val_arena_blk_t* blk;
+
+	while (rtx->arena.pinned.next != &rtx->arena.pinned)
+	{
+		blk = rtx->arena.pinned.next;
+		rtx->arena.pinned.next = blk->next;
+		hawk_rtx_freemem (rtx, blk);
+	}
+	rtx->arena.pinned.prev = &rtx->arena.pinned;
+
+	if (rtx->arena.cur)
+	{
+		hawk_rtx_freemem (rtx, rtx->arena.cur);
+		rtx->arena.cur = HAWK_NULL;
+	}
+	if (rtx->arena.spare)
+	{
+		hawk_rtx_freemem (rtx, rtx->arena.spare);
+		rtx->arena.spare = HAWK_NULL;
+	}
+}
+
 static HAWK_INLINE hawk_val_t* make_str_val (hawk_rtx_t* rtx, const hawk_ooch_t* str1, hawk_oow_t len1, const hawk_ooch_t* str2, hawk_oow_t len2)
 {
 	hawk_val_str_t* val = HAWK_NULL;
@@ -650,6 +1213,16 @@ static HAWK_INLINE hawk_val_t* make_str_val (hawk_rtx_t* rtx, const hawk_ooch_t*
 	if (HAWK_UNLIKELY(len1 <= 0 && len2 <= 0)) return hawk_val_zls;
 	aligned_len = HAWK_ALIGN_POW2((len1 + len2 + 1), HAWK_STR_CACHE_BLOCK_UNIT);
 
+	if (rtx->arena.active)
+	{
+		val = (hawk_val_str_t*)alloc_in_arena(rtx, HAWK_SIZEOF(hawk_val_str_t) + (aligned_len * HAWK_SIZEOF(hawk_ooch_t)));
+		if (val)
+		{
+			val->v_arena = 1;
+			goto init_arena;
+		}
+	}
+
 #if defined(HAWK_ENABLE_STR_CACHE)
 	i = aligned_len / HAWK_STR_CACHE_BLOCK_UNIT;
 	if (i < HAWK_COUNTOF(rtx->str_cache_count))
@@ -657,8 +1230,10 @@ static HAWK_INLINE hawk_val_t* make_str_val (hawk_rtx_t* rtx, const hawk_ooch_t*
 		if (rtx->str_cache_count[i] > 0)
 		{
 			val = rtx->str_cache[i][--rtx->str_cache_count[i]];
+			rtx->vstat.str_hits++;
 			goto init;
 		}
+		rtx->vstat.str_misses++;
 	}
 #endif
 
@@ -668,10 +1243,13 @@ static HAWK_INLINE hawk_val_t* make_str_val (hawk_rtx_t* rtx, const hawk_ooch_t*
 #if defined(HAWK_ENABLE_STR_CACHE)
 init:
 #endif
+	val->v_arena = 0;
+init_arena:
 	val->v_type = HAWK_VAL_STR;
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
 	val->val.len = len1 + len2;
 	val->val.ptr = (hawk_ooch_t*)(val + 1);
@@ -777,6 +1355,53 @@ hawk_val_t* hawk_rtx_makestrvalwithbchars2 (hawk_rtx_t* rtx, const hawk_bch_t* b
 #endif
 }
 
+/* a string value keeps the characters right after the value header
+ * until it outgrows the space there. it then keeps them in a separate
+ * buffer prefixed with the buffer capacity */
+#define STR_VAL_IS_INLINE(v) ((v)->val.ptr == (hawk_ooch_t*)((v) + 1))
+#define STR_VAL_EXT_HDR(v) ((hawk_oow_t*)(v)->val.ptr - 1)
+
+int hawk_rtx_appendtostrval (hawk_rtx_t* rtx, hawk_val_t* val, const hawk_ooch_t* ptr, hawk_oow_t len)
+{
+	hawk_val_str_t* v = (hawk_val_str_t*)val;
+	hawk_oow_t newlen, capa;
+
+	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, val) == HAWK_VAL_STR);
+	HAWK_ASSERT (!val->v_static);
+
+	newlen = v->val.len + len;
+	capa = STR_VAL_IS_INLINE(v)? HAWK_ALIGN_POW2((v->val.len + 1), HAWK_STR_CACHE_BLOCK_UNIT): *STR_VAL_EXT_HDR(v);
+
+	/* the inline space is used only up to the boundary that keeps
+	 * the value in the same cache slot when freed */
+	if (newlen + 1 > capa)
+	{
+		hawk_oow_t* ext;
+
+		capa = HAWK_ALIGN_POW2((newlen + 1 + newlen / 2), HAWK_STR_CACHE_BLOCK_UNIT);
+		if (STR_VAL_IS_INLINE(v))
+		{
+			ext = (hawk_oow_t*)hawk_rtx_allocmem(rtx, HAWK_SIZEOF(*ext) + (capa * HAWK_SIZEOF(hawk_ooch_t)));
+			if (HAWK_UNLIKELY(!ext)) return -1;
+			HAWK_MEMCPY (ext + 1, v->val.ptr, v->val.len * HAWK_SIZEOF(hawk_ooch_t));
+		}
+		else
+		{
+			ext = (hawk_oow_t*)hawk_rtx_reallocmem(rtx, STR_VAL_EXT_HDR(v), HAWK_SIZEOF(*ext) + (capa * HAWK_SIZEOF(hawk_ooch_t)));
+			if (HAWK_UNLIKELY(!ext)) return -1;
+		}
+
+		ext[0] = capa;
+		v->val.ptr = (hawk_ooch_t*)(ext + 1);
+	}
+
+	hawk_copy_oochars_to_oocstr_unlimited (&v->val.ptr[v->val.len], ptr, len);
+	v->val.len = newlen;
+	v->v_nstr = 0; /* the numeric form cached, if any, is no longer valid */
+	v->v_ncache = 0;
+	return 0;
+}
+
 /* --------------------------------------------------------------------- */
 
 hawk_val_t* hawk_rtx_makenumorstrvalwithuchars (hawk_rtx_t* rtx, const hawk_uch_t* ptr, hawk_oow_t len)
@@ -820,6 +1445,19 @@ make_str:
 
 /* --------------------------------------------------------------------- */
 
+/* keep the number converted from a string in the string value so that it
+ * is not converted again. a string beginning with a space is not cached as
+ * its conversion depends on STRIPSTRSPC which can change at runtime */
+static HAWK_INLINE void cache_str_num (hawk_val_str_t* v, int x, const hawk_int_t* l, const hawk_flt_t* r)
+{
+	HAWK_ASSERT (v->v_type == HAWK_VAL_STR);
+	HAWK_ASSERT (x == 0 || x == 1);
+	if (v->v_static || (v->val.len > 0 && hawk_is_ooch_space(v->val.ptr[0]))) return;
+	if (x == 0) v->num.l = *l;
+	else v->num.r = *r;
+	v->v_ncache = x + 1; /* long -> 1, real -> 2 */
+}
+
 hawk_val_t* hawk_rtx_makenstrvalwithuchars (hawk_rtx_t* rtx, const hawk_uch_t* ptr, hawk_oow_t len)
 {
 	int x;
@@ -838,6 +1476,7 @@ hawk_val_t* hawk_rtx_makenstrvalwithuchars (hawk_rtx_t* rtx, const hawk_uch_t* p
 		 * can be converted to a number */
 		HAWK_ASSERT (x == 0 || x == 1);
 		v->v_nstr = x + 1; /* long -> 1, real -> 2 */
+		cache_str_num ((hawk_val_str_t*)v, x, &l, &r);
 	}
 
 	return v;
@@ -860,6 +1499,7 @@ hawk_val_t* hawk_rtx_makenstrvalwithbchars (hawk_rtx_t* rtx, const hawk_bch_t* p
 		 * can be converted to a number */
 		HAWK_ASSERT (x == 0 || x == 1);
 		v->v_nstr = x + 1; /* long -> 1, real -> 2 */
+		cache_str_num ((hawk_val_str_t*)v, x, &l, &r);
 	}
 
 	return v;
@@ -898,6 +1538,16 @@ static HAWK_INLINE hawk_val_t* make_mbs_val (hawk_rtx_t* rtx, const hawk_bch_t*
 	if (HAWK_UNLIKELY(len1 <= 0 && len2 <= 0)) return hawk_val_zlbs;
 	aligned_len = HAWK_ALIGN_POW2((len1 + len2 + 1), HAWK_MBS_CACHE_BLOCK_UNIT);
 
+	if (rtx->arena.active)
+	{
+		val = (hawk_val_mbs_t*)alloc_in_arena(rtx, HAWK_SIZEOF(hawk_val_mbs_t) + (aligned_len * HAWK_SIZEOF(hawk_bch_t)));
+		if (val)
+		{
+			val->v_arena = 1;
+			goto init_arena;
+		}
+	}
+
 #if defined(HAWK_ENABLE_MBS_CACHE)
 	i = aligned_len / HAWK_MBS_CACHE_BLOCK_UNIT;
 	if (i < HAWK_COUNTOF(rtx->mbs_cache_count))
@@ -905,8 +1555,10 @@ static HAWK_INLINE hawk_val_t* make_mbs_val (hawk_rtx_t* rtx, const hawk_bch_t*
 		if (rtx->mbs_cache_count[i] > 0)
 		{
 			val = rtx->mbs_cache[i][--rtx->mbs_cache_count[i]];
+			rtx->vstat.mbs_hits++;
 			goto init;
 		}
+		rtx->vstat.mbs_misses++;
 	}
 #endif
 
@@ -916,10 +1568,13 @@ static HAWK_INLINE hawk_val_t* make_mbs_val (hawk_rtx_t* rtx, const hawk_bch_t*
 #if defined(HAWK_ENABLE_MBS_CACHE)
 init:
 #endif
+	val->v_arena = 0;
+init_arena:
 	val->v_type = HAWK_VAL_MBS;
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
 	val->val.len = len1 + len2;
 	val->val.ptr = (hawk_bch_t*)(val + 1);
@@ -933,6 +1588,40 @@ init:
 	return (hawk_val_t*)val;
 }
 
+hawk_val_t* hawk_rtx_promoteval (hawk_rtx_t* rtx, hawk_val_t* val)
+{
+	hawk_val_t* v;
+	int active;
+
+	if (!HAWK_IS_ARENAVAL(val)) return val;
+
+	active = rtx->arena.active;
+	rtx->arena.active = 0;
+	if (HAWK_RTX_GETVALTYPE(rtx, val) == HAWK_VAL_STR)
+	{
+		hawk_val_str_t* sv = (hawk_val_str_t*)val;
+		v = make_str_val(rtx, sv->val.ptr, sv->val.len, HAWK_NULL, 0);
+	}
+	else
+	{
+		hawk_val_mbs_t* mv = (hawk_val_mbs_t*)val;
+		HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, val) == HAWK_VAL_MBS);
+		v = make_mbs_val(rtx, mv->val.ptr, mv->val.len, HAWK_NULL, 0);
+	}
+	rtx->arena.active = active;
+
+	if (HAWK_LIKELY(v))
+	{
+		v->v_nstr = val->v_nstr;
+		if (val->v_ncache)
+		{
+			((hawk_val_str_t*)v)->num = ((hawk_val_str_t*)val)->num;
+			v->v_ncache = val->v_ncache;
+		}
+	}
+	return v;
+}
+
 hawk_val_t* hawk_rtx_makembsvalwithbchars (hawk_rtx_t* rtx, const hawk_bch_t* ptr, hawk_oow_t len)
 {
 	return make_mbs_val(rtx, ptr, len, HAWK_NULL, 0);
@@ -1055,7 +1744,9 @@ hawk_val_t* hawk_rtx_makerexval (hawk_rtx_t* rtx, const hawk_oocs_t* str, hawk_t
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->str.len = str->len;
 
 	val->str.ptr = (hawk_ooch_t*)(val + 1);
@@ -1133,7 +1824,9 @@ retry:
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->arr = (hawk_arr_t*)(val + 1);
 
 	if (init_capa < 0) init_capa = 64; /* TODO: what is the best initial value? */
@@ -1160,6 +1853,7 @@ retry:
 #if defined(HAWK_ENABLE_GC)
 	gc_chain_val (&rtx->gc.g[0], (hawk_val_t*)val);
 	val->v_gc = 1; /* only array and map are to be garbaged collected as of now */
+	val->v_arena = 0;
 	#if defined(DEBUG_GC)
 	hawk_logbfmt (hawk_rtx_gethawk(rtx), HAWK_LOG_STDERR, "[GC] MADE GCH %p VAL(ARR) %p\n", hawk_val_to_gch(val), val);
 	#endif
@@ -1201,6 +1895,258 @@ static void same_mapval (hawk_map_t* map, void* dptr, hawk_oow_t dlen)
 	hawk_rtx_refdownval_nofree (rtx, dptr);
 }
 
+/* --------------------------------------------------------------------- */
+
+/* the largest integer index that can be placed in the vector part of a
+ * map value. the string form of an index not greater than this has at
+ * most 9 digits */
+#define MAP_VEC_IDX_MAX 999999999
+
+typedef struct map_key_t map_key_t;
+struct map_key_t
+{
+	const hawk_ooch_t* ptr;
+	hawk_oow_t len;
+	hawk_int_t idx; /* -1 if the key is not an integer in the vector range */
+	hawk_ooch_t buf[HAWK_SIZEOF_INT_T * 3 + 2];
+};
+
+static HAWK_INLINE void init_map_key (map_key_t* mk, const hawk_val_map_key_t* key)
+{
+	if (!key->ptr)
+	{
+		mk->ptr = HAWK_NULL;
+		mk->idx = key->idx;
+		if (mk->idx < 0 || mk->idx > MAP_VEC_IDX_MAX)
+		{
+			mk->len = hawk_int_to_oocstr(key->idx, 10, HAWK_NULL, mk->buf, HAWK_COUNTOF(mk->buf));
+			mk->ptr = mk->buf;
+			mk->idx = -1;
+		}
+	}
+	else
+	{
+		const hawk_ooch_t* p = key->ptr;
+		hawk_oow_t i;
+
+		mk->ptr = key->ptr;
+		mk->len = key->len;
+		mk->idx = -1;
+
+		/* only the canonical decimal form is an integer index. "01" or "+1" is not */
+		if (mk->len <= 0 || mk->len > 9 || p[0] < '0' || p[0] > '9' || (p[0] == '0' && mk->len > 1)) return;
+		mk->idx = p[0] - '0';
+		for (i = 1; i < mk->len; i++)
+		{
+			if (p[i] < '0' || p[i] > '9') { mk->idx = -1; return; }
+			mk->idx = mk->idx * 10 + (p[i] - '0');
+		}
+	}
+}
+
+static HAWK_INLINE void get_map_key_str (map_key_t* mk)
+{
+	if (!mk->ptr)
+	{
+		mk->len = hawk_int_to_oocstr(mk->idx, 10, HAWK_NULL, mk->buf, HAWK_COUNTOF(mk->buf));
+		mk->ptr = mk->buf;
+	}
+}
+
+static HAWK_INLINE hawk_val_t** get_map_vec_slot (hawk_val_map_t* m, hawk_int_t idx)
+{
+	hawk_oow_t ci = (hawk_oow_t)idx / HAWK_VAL_MAP_VEC_CHUNK_SIZE;
+	return (ci < m->vec.nchunks)? &m->vec.chunk[ci][(hawk_oow_t)idx % HAWK_VAL_MAP_VEC_CHUNK_SIZE]: HAWK_NULL;
+}
+
+static int grow_map_vec (hawk_rtx_t* rtx, hawk_val_map_t* m, hawk_int_t idx)
+{
+	hawk_oow_t ci, newcapa;
+
+	/* grow the vector part up to the chunk holding the index only if
+	 * at least about half of the slots would be in use */
+	ci = (hawk_oow_t)idx / HAWK_VAL_MAP_VEC_CHUNK_SIZE;
+	if (ci > 0 && (ci + 1) * HAWK_VAL_MAP_VEC_CHUNK_SIZE > (m->vec.count + 1) * 2) return 0;
+
+	if (ci >= m->vec.capa)
+	{
+		hawk_val_t*** tmp;
+
+		newcapa = HAWK_ALIGN_POW2(ci + 1, 8);
+		if (newcapa < m->vec.capa * 2) newcapa = m->vec.capa * 2;
+		tmp = (hawk_val_t***)hawk_rtx_reallocmem(rtx, m->vec.chunk, newcapa * HAWK_SIZEOF(*tmp));
+		if (HAWK_UNLIKELY(!tmp)) return -1;
+		m->vec.chunk = tmp;
+		m->vec.capa = newcapa;
+	}
+
+	while (m->vec.nchunks <= ci)
+	{
+		hawk_val_t** c;
+		c = (hawk_val_t**)hawk_rtx_callocmem(rtx, HAWK_VAL_MAP_VEC_CHUNK_SIZE * HAWK_SIZEOF(*c));
+		if (HAWK_UNLIKELY(!c)) return -1;
+		m->vec.chunk[m->vec.nchunks++] = c;
+	}
+
+	return 1;
+}
+
+static void free_vecval (hawk_rtx_t* rtx, hawk_val_t* v)
+{
+#if defined(HAWK_ENABLE_GC)
+	/* see free_mapval() */
+	if (HAWK_VTR_IS_POINTER(v) && v->v_gc && hawk_val_to_gch(v)->gc_refs == GCH_UNREACHABLE) return;
+#endif
+	hawk_rtx_refdownval (rtx, v);
+}
+
+static void clear_map_vec (hawk_rtx_t* rtx, hawk_val_map_t* m, int fini)
+{
+	hawk_oow_t i, j;
+
+	for (i = 0; i < m->vec.nchunks; i++)
+	{
+		hawk_val_t** c = m->vec.chunk[i];
+		for (j = 0; m->vec.count > 0 && j < HAWK_VAL_MAP_VEC_CHUNK_SIZE; j++)
+		{
+			if (c[j])
+			{
+				hawk_val_t* v = c[j];
+				c[j] = HAWK_NULL;
+				m->vec.count--;
+				free_vecval (rtx, v);
+			}
+		}
+		if (fini) hawk_rtx_freemem (rtx, c);
+	}
+
+	if (fini)
+	{
+		if (m->vec.chunk) hawk_rtx_freemem (rtx, m->vec.chunk);
+		m->vec.chunk = HAWK_NULL;
+		m->vec.nchunks = 0;
+		m->vec.capa = 0;
+	}
+	m->vec.count = 0;
+	m->vec.spill = 0;
+}
+
+hawk_val_t** hawk_rtx_searchmapval (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_val_map_key_t* key)
+{
+	hawk_val_map_t* m = (hawk_val_map_t*)map;
+	map_key_t mk;
+	hawk_map_pair_t* pair;
+
+	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
+
+	init_map_key (&mk, key);
+	if (mk.idx >= 0)
+	{
+		hawk_val_t** slot = get_map_vec_slot(m, mk.idx);
+		if (slot && *slot) return slot;
+		if (m->vec.spill <= 0) return HAWK_NULL;
+		get_map_key_str (&mk);
+	}
+
+	pair = hawk_map_search(m->map, mk.ptr, mk.len);
+	return pair? (hawk_val_t**)&HAWK_MAP_VPTR(pair): HAWK_NULL;
+}
+
+hawk_val_t** hawk_rtx_upsertmapval (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_val_map_key_t* key, hawk_val_t* v)
+{
+	hawk_val_map_t* m = (hawk_val_map_t*)map;
+	map_key_t mk;
+	hawk_map_pair_t* pair;
+	hawk_oow_t old_size;
+
+	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
+
+	init_map_key (&mk, key);
+	if (mk.idx >= 0)
+	{
+		hawk_val_t** slot;
+
+		slot = get_map_vec_slot(m, mk.idx);
+		if (slot && *slot)
+		{
+			hawk_val_t* old = *slot;
+			if (old == v)
+			{
+				/* see same_mapval() */
+				hawk_rtx_refdownval_nofree (rtx, old);
+			}
+			else
+			{
+				*slot = v;
+				free_vecval (rtx, old);
+			}
+			return slot;
+		}
+
+		if (m->vec.spill > 0) get_map_key_str (&mk);
+		if (m->vec.spill <= 0 || !hawk_map_search(m->map, mk.ptr, mk.len))
+		{
+			if (!slot)
+			{
+				int n = grow_map_vec(rtx, m, mk.idx);
+				if (HAWK_UNLIKELY(n <= -1)) return HAWK_NULL;
+				if (n >= 1) slot = get_map_vec_slot(m, mk.idx);
+			}
+
+			if (slot)
+			{
+				*slot = v;
+				m->vec.count++;
+				return slot;
+			}
+		}
+	}
+
+	get_map_key_str (&mk);
+	old_size = HAWK_MAP_SIZE(m->map);
+	pair = hawk_map_upsert(m->map, (hawk_ooch_t*)mk.ptr, mk.len, v, 0);
+	if (HAWK_UNLIKELY(!pair)) return HAWK_NULL;
+	if (mk.idx >= 0 && HAWK_MAP_SIZE(m->map) > old_size) m->vec.spill++;
+	return (hawk_val_t**)&HAWK_MAP_VPTR(pair);
+}
+
+int hawk_rtx_deletemapval (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_val_map_key_t* key)
+{
+	hawk_val_map_t* m = (hawk_val_map_t*)map;
+	map_key_t mk;
+
+	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
+
+	init_map_key (&mk, key);
+	if (mk.idx >= 0)
+	{
+		hawk_val_t** slot = get_map_vec_slot(m, mk.idx);
+		if (slot && *slot)
+		{
+			hawk_val_t* old = *slot;
+			*slot = HAWK_NULL;
+			m->vec.count--;
+			free_vecval (rtx, old);
+			return 0;
+		}
+		if (m->vec.spill <= 0) return -1;
+		get_map_key_str (&mk);
+		if (hawk_map_delete(m->map, mk.ptr, mk.len) <= -1) return -1;
+		m->vec.spill--;
+		return 0;
+	}
+
+	return hawk_map_delete(m->map, mk.ptr, mk.len);
+}
+
+void hawk_rtx_clearmapval (hawk_rtx_t* rtx, hawk_val_t* map)
+{
+	hawk_val_map_t* m = (hawk_val_map_t*)map;
+	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
+	clear_map_vec (rtx, m, 0);
+	hawk_map_clear (m->map);
+}
+
 hawk_val_t* hawk_rtx_makemapval (hawk_rtx_t* rtx)
 {
 	static hawk_map_style_t style =
@@ -1219,7 +2165,7 @@ hawk_val_t* hawk_rtx_makemapval (hawk_rtx_t* rtx)
 		},
 		HAWK_MAP_COMPER_DEFAULT,
 		same_mapval,
-	#if defined(HAWK_MAP_IS_HTB)
+	#if defined(HAWK_MAP_IS_HTB) || defined(HAWK_MAP_IS_OHT)
 		HAWK_MAP_SIZER_DEFAULT,
 		HAWK_MAP_HASHER_DEFAULT
 	#endif
@@ -1241,7 +2187,9 @@ retry:
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->map = (hawk_map_t*)(val + 1);
 
 	if (HAWK_UNLIKELY(hawk_map_init(val->map, hawk_rtx_getgem(rtx), 256, 70, HAWK_SIZEOF(hawk_ooch_t), 1) <= -1))
@@ -1267,6 +2215,7 @@ retry:
 #if defined(HAWK_ENABLE_GC)
 	gc_chain_val (&rtx->gc.g[0], (hawk_val_t*)val);
 	val->v_gc = 1; /* only array and map are to be garbaged collected as of now */
+	val->v_arena = 0;
 	#if defined(DEBUG_GC)
 	hawk_logbfmt (hawk_rtx_gethawk(rtx), HAWK_LOG_STDERR, "[GC] MADE GCH %p VAL(MAP) %p\n", hawk_val_to_gch(val), val);
 	#endif
@@ -1363,9 +2312,13 @@ hawk_val_t* hawk_rtx_makemapvalwithdata (hawk_rtx_t* rtx, hawk_val_map_data_t da
 
 hawk_val_t* hawk_rtx_setmapvalfld (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_ooch_t* kptr, hawk_oow_t klen, hawk_val_t* v)
 {
+	hawk_val_map_key_t key;
+
 	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
 
-	if (hawk_map_upsert(((hawk_val_map_t*)map)->map, (hawk_ooch_t*)kptr, klen, v, 0) == HAWK_NULL) return HAWK_NULL;
+	key.ptr = kptr;
+	key.len = klen;
+	if (hawk_rtx_upsertmapval(rtx, map, &key, v) == HAWK_NULL) return HAWK_NULL;
 
 	/* the value is passed in by an external party. we can't refup()
 	 * and refdown() the value if htb_upsert() fails. that way, the value
@@ -1378,12 +2331,15 @@ hawk_val_t* hawk_rtx_setmapvalfld (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_
 
 hawk_val_t* hawk_rtx_getmapvalfld (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_ooch_t* kptr, hawk_oow_t klen)
 {
-	hawk_map_pair_t* pair;
+	hawk_val_map_key_t key;
+	hawk_val_t** slot;
 
 	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
 
-	pair = hawk_map_search(((hawk_val_map_t*)map)->map, kptr, klen);
-	if (!pair)
+	key.ptr = kptr;
+	key.len = klen;
+	slot = hawk_rtx_searchmapval(rtx, map, &key);
+	if (!slot)
 	{
 		/* the given key is not found in the map.
 		 * we return NULL here as this function is called by
@@ -1394,22 +2350,61 @@ hawk_val_t* hawk_rtx_getmapvalfld (hawk_rtx_t* rtx, hawk_val_t* map, const hawk_
 		return HAWK_NULL;
 	}
 
-	return HAWK_MAP_VPTR(pair);
+	return *slot;
+}
+
+static hawk_val_map_itr_t* get_next_map_val_itr (hawk_rtx_t* rtx, hawk_val_map_t* m, hawk_val_map_itr_t* itr)
+{
+	hawk_map_pair_t* pair;
+
+	if (itr->_vi != (hawk_oow_t)-1)
+	{
+		hawk_oow_t end = m->vec.nchunks * HAWK_VAL_MAP_VEC_CHUNK_SIZE;
+		while (itr->_vi < end)
+		{
+			hawk_oow_t i = itr->_vi++;
+			hawk_val_t* v = m->vec.chunk[i / HAWK_VAL_MAP_VEC_CHUNK_SIZE][i % HAWK_VAL_MAP_VEC_CHUNK_SIZE];
+			if (v)
+			{
+				itr->key.ptr = itr->_kbuf;
+				itr->key.len = hawk_int_to_oocstr(i, 10, HAWK_NULL, itr->_kbuf, HAWK_COUNTOF(itr->_kbuf));
+				itr->val = v;
+				return itr;
+			}
+		}
+
+		itr->_vi = (hawk_oow_t)-1;
+		pair = hawk_map_getfirstpair(m->map, &itr->_mitr);
+	}
+	else
+	{
+		pair = hawk_map_getnextpair(m->map, &itr->_mitr);
+	}
+
+	if (!pair)
+	{
+		itr->val = HAWK_NULL;
+		return HAWK_NULL;
+	}
+
+	itr->key.ptr = (hawk_ooch_t*)HAWK_MAP_KPTR(pair);
+	itr->key.len = HAWK_MAP_KLEN(pair);
+	itr->val = (hawk_val_t*)HAWK_MAP_VPTR(pair);
+	return itr;
 }
 
 hawk_val_map_itr_t* hawk_rtx_getfirstmapvalitr (hawk_rtx_t* rtx, hawk_val_t* map, hawk_val_map_itr_t* itr)
 {
 	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
-	hawk_init_map_itr (itr, 0); /* override the caller provided direction to 0 */
-	itr->pair = hawk_map_getfirstpair(((hawk_val_map_t*)map)->map, itr);
-	return itr->pair? itr: HAWK_NULL;
+	hawk_init_map_itr (&itr->_mitr, 0); /* override the caller provided direction to 0 */
+	itr->_vi = 0;
+	return get_next_map_val_itr(rtx, (hawk_val_map_t*)map, itr);
 }
 
 hawk_val_map_itr_t* hawk_rtx_getnextmapvalitr (hawk_rtx_t* rtx, hawk_val_t* map, hawk_val_map_itr_t* itr)
 {
 	HAWK_ASSERT (HAWK_RTX_GETVALTYPE(rtx, map) == HAWK_VAL_MAP);
-	itr->pair = hawk_map_getnextpair(((hawk_val_map_t*)map)->map, itr);
-	return itr->pair? itr: HAWK_NULL;
+	return get_next_map_val_itr(rtx, (hawk_val_map_t*)map, itr);
 }
 
 hawk_val_t* hawk_rtx_setarrvalfld (hawk_rtx_t* rtx, hawk_val_t* arr, hawk_ooi_t index, hawk_val_t* v)
@@ -1443,11 +2438,13 @@ hawk_val_t* hawk_rtx_makerefval (hawk_rtx_t* rtx, int id, hawk_val_t** adr)
 	if (rtx->rcache_count > 0)
 	{
 		val = rtx->rcache[--rtx->rcache_count];
+		rtx->vstat.ref_hits++;
 	}
 	else
 	{
 		val = (hawk_val_ref_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*val));
 		if (!val) return HAWK_NULL;
+		rtx->vstat.ref_misses++;
 	}
 
 	HAWK_RTX_INIT_REF_VAL (val, id, adr, 0);
@@ -1465,7 +2462,9 @@ hawk_val_t* hawk_rtx_makefunval (hawk_rtx_t* rtx, const hawk_fun_t* fun)
 	val->v_refs = 0;
 	val->v_static = 0;
 	val->v_nstr = 0;
+	val->v_ncache = 0;
 	val->v_gc = 0;
+	val->v_arena = 0;
 	val->fun = (hawk_fun_t*)fun;
 
 	return (hawk_val_t*)val;
@@ -1535,6 +2534,22 @@ void hawk_rtx_freeval (hawk_rtx_t* rtx, hawk_val_t* val, int flags)
 
 			case HAWK_VAL_STR:
 			{
+				if (!STR_VAL_IS_INLINE((hawk_val_str_t*)val))
+				{
+					/* the value grown by hawk_rtx_appendtostrval() can't go to
+					 * the cache as its original size is not known any more */
+					hawk_rtx_freemem (rtx, STR_VAL_EXT_HDR((hawk_val_str_t*)val));
+					if (val->v_arena) free_in_arena (rtx, val);
+					else hawk_rtx_freemem (rtx, val);
+					break;
+				}
+
+				if (val->v_arena)
+				{
+					free_in_arena (rtx, val);
+					break;
+				}
+
 			#if defined(HAWK_ENABLE_STR_CACHE)
 				if (flags & HAWK_RTX_FREEVAL_CACHE)
 				{
@@ -1549,6 +2564,7 @@ void hawk_rtx_freeval (hawk_rtx_t* rtx, hawk_val_t* val, int flags)
 					{
 						rtx->str_cache[i][rtx->str_cache_count[i]++] = v;
 						v->v_nstr = 0;
+						v->v_ncache = 0;
 					}
 					else hawk_rtx_freemem (rtx, val);
 					break;
@@ -1560,6 +2576,12 @@ void hawk_rtx_freeval (hawk_rtx_t* rtx, hawk_val_t* val, int flags)
 			}
 
 			case HAWK_VAL_MBS:
+				if (val->v_arena)
+				{
+					free_in_arena (rtx, val);
+					break;
+				}
+
 			#if defined(HAWK_ENABLE_MBS_CACHE)
 				if (flags & HAWK_RTX_FREEVAL_CACHE)
 				{
@@ -1608,6 +2630,7 @@ void hawk_rtx_freeval (hawk_rtx_t* rtx, hawk_val_t* val, int flags)
 				hawk_logbfmt (hawk_rtx_gethawk(rtx), HAWK_LOG_STDERR, "[GC] FREEING GCH %p VAL(MAP) %p - flags %d\n", hawk_val_to_gch(val), val, flags);
 				#endif
 
+				clear_map_vec (rtx, (hawk_val_map_t*)val, 1);
 				hawk_map_fini (((hawk_val_map_t*)val)->map);
 				if (!(flags & HAWK_RTX_FREEVAL_GC_PRESERVE))
 				{
@@ -1615,6 +2638,7 @@ void hawk_rtx_freeval (hawk_rtx_t* rtx, hawk_val_t* val, int flags)
 					gc_free_val (rtx, val);
 				}
 			#else
+				clear_map_vec (rtx, (hawk_val_map_t*)val, 1);
 				hawk_map_fini (((hawk_val_map_t*)val)->map);
 				hawk_rtx_freemem (rtx, val);
 			#endif
@@ -1665,6 +2689,12 @@ void hawk_rtx_refupval (hawk_rtx_t* rtx, hawk_val_t* val)
 	#else
 		val->v_refs++;
 	#endif
+
+	#if defined(HAWK_ENABLE_GC)
+		/* a value in the incremental round in progress is alive if it gains
+		 * a reference. see gc_collect_garbage_in_slice() */
+		if (HAWK_UNLIKELY(rtx->gc.inc.phase != GC_INC_IDLE) && val->v_gc) gc_inc_reach (rtx, hawk_val_to_gch(val));
+	#endif
 	}
 }
 
@@ -1798,7 +2828,7 @@ int hawk_rtx_valtobool (hawk_rtx_t* rtx, const hawk_val_t* val)
 			return 1;
 		case HAWK_VAL_MAP:
 			/* true if the map size is greater than 0. false if not */
-			return HAWK_MAP_SIZE(((hawk_val_map_t*)val)->map) > 0;
+			return HAWK_VAL_MAP_SIZE(val) > 0;
 		case HAWK_VAL_ARR:
 			return HAWK_ARR_SIZE(((hawk_val_arr_t*)val)->arr) > 0;
 		case HAWK_VAL_REF:
@@ -1930,112 +2960,90 @@ static int mbs_to_str (hawk_rtx_t* rtx, const hawk_bch_t* str, hawk_oow_t str_le
 #endif
 
 
-static int val_int_to_str (hawk_rtx_t* rtx, const hawk_val_int_t* v, hawk_rtx_valtostr_out_t* out)
+/* deliver the text of a number formatted in a temporary buffer */
+static int num_to_str (hawk_rtx_t* rtx, const hawk_ooch_t* str, hawk_oow_t str_len, hawk_rtx_valtostr_out_t* out)
 {
-	hawk_ooch_t* tmp;
-	hawk_oow_t rlen = 0;
 	int type = out->type & ~HAWK_RTX_VALTOSTR_PRINT;
-	hawk_int_t orgval = HAWK_RTX_GETINTFROMVAL (rtx, v);
-	hawk_uint_t t;
-
-	if (orgval == 0) rlen++;
-	else
-	{
-		/* non-zero values */
-		if (orgval < 0)
-		{
-			t = orgval * -1; rlen++;
-		}
-		else t = orgval;
-		while (t > 0) { rlen++; t /= 10; }
-	}
 
 	switch (type)
 	{
 		case HAWK_RTX_VALTOSTR_CPL:
-			/* CPL and CPLCP behave the same for int_t.
-			 * i just fall through assuming that cplcpy
-			 * and cpl are the same type. the following
-			 * assertion at least ensure that they have
-			 * the same size. */
+			/* CPL and CPLCP behave the same for a number as the text
+			 * is not kept anywhere. the following assertion at least
+			 * ensure that they have the same size. */
 			HAWK_ASSERT (HAWK_SIZEOF(out->u.cpl) == HAWK_SIZEOF(out->u.cplcpy));
 
 		case HAWK_RTX_VALTOSTR_CPLCPY:
-			if (rlen >= out->u.cplcpy.len)
+			if (str_len >= out->u.cplcpy.len)
 			{
 				hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
 				/* store the buffer size needed */
-				out->u.cplcpy.len = rlen + 1;
+				out->u.cplcpy.len = str_len + 1;
 				return -1;
 			}
 
-			tmp = out->u.cplcpy.ptr;
-			tmp[rlen] = HAWK_T('\0');
-			out->u.cplcpy.len = rlen;
-			break;
+			out->u.cplcpy.len = hawk_copy_oochars_to_oocstr_unlimited(out->u.cplcpy.ptr, str, str_len);
+			return 0;
 
 		case HAWK_RTX_VALTOSTR_CPLDUP:
-			tmp = hawk_rtx_allocmem(rtx, (rlen + 1) * HAWK_SIZEOF(hawk_ooch_t));
+		{
+			hawk_ooch_t* tmp;
+
+			tmp = hawk_rtx_dupoochars(rtx, str, str_len);
 			if (!tmp) return -1;
 
-			tmp[rlen] = HAWK_T('\0');
 			out->u.cpldup.ptr = tmp;
-			out->u.cpldup.len = rlen;
-			break;
+			out->u.cpldup.len = str_len;
+			return 0;
+		}
 
 		case HAWK_RTX_VALTOSTR_STRP:
-		{
-			hawk_oow_t n;
-
 			hawk_ooecs_clear (out->u.strp);
-			HAWK_ASSERT (HAWK_OOECS_LEN(out->u.strp) == 0);
+			if (hawk_ooecs_ncat(out->u.strp, str, str_len) == (hawk_oow_t)-1) return -1;
+			return 0;
 
-			/* point to the beginning of the buffer */
-			tmp = HAWK_OOECS_PTR(out->u.strp);
+		case HAWK_RTX_VALTOSTR_STRPCAT:
+			if (hawk_ooecs_ncat(out->u.strpcat, str, str_len) == (hawk_oow_t)-1) return -1;
+			return 0;
+	}
 
-			/* extend the buffer */
-			n = hawk_ooecs_nccat(out->u.strp, HAWK_T(' '), rlen);
-			if (n == (hawk_oow_t)-1) return -1;
-			break;
-		}
+	hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
+	return -1;
+}
 
-		case HAWK_RTX_VALTOSTR_STRPCAT:
-		{
-			hawk_oow_t n;
+static int val_int_to_str (hawk_rtx_t* rtx, const hawk_val_int_t* v, hawk_rtx_valtostr_out_t* out)
+{
+	hawk_ooch_t tmp[HAWK_SIZEOF(hawk_int_t) * 3 + 2];
+	int len;
 
-			/* point to the insertion point */
-			tmp = HAWK_OOECS_PTR(out->u.strpcat) + HAWK_OOECS_LEN(out->u.strpcat);
+	len = hawk_fmt_intmax_to_decoocstr(tmp, HAWK_COUNTOF(tmp), HAWK_RTX_GETINTFROMVAL(rtx, v));
+	HAWK_ASSERT (len > 0);
+	return num_to_str(rtx, tmp, len, out);
+}
 
-			/* extend the buffer */
-			n = hawk_ooecs_nccat(out->u.strpcat, HAWK_T(' '), rlen);
-			if (n == (hawk_oow_t)-1) return -1;
-			break;
-		}
+/* get the conversion character and the precision if the format
+ * is one of %g, %.Ng, %f, %.Nf that hawk_fmt_flt_to_oocstr() handles */
+static int get_simple_fltfmt (const hawk_ooch_t* fmt, hawk_oow_t len, int* prec)
+{
+	hawk_oow_t i;
+	int p = 6;
 
-		default:
-		{
-			hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_EINVAL);
-			return -1;
-		}
-	}
+	if (len < 2 || len > 5 || fmt[0] != '%') return 0;
 
-	if (orgval == 0) tmp[0] = HAWK_T('0');
-	else
+	i = 1;
+	if (fmt[i] == '.')
 	{
-		t = (orgval < 0)? (orgval * -1): orgval;
-
-		/* fill in the buffer with digits */
-		while (t > 0)
+		p = 0;
+		for (i++; i < len - 1; i++)
 		{
-			tmp[--rlen] = (hawk_ooch_t)(t % 10) + HAWK_T('0');
-			t /= 10;
+			if (!hawk_is_ooch_digit(fmt[i])) return 0;
+			p = p * 10 + (fmt[i] - '0');
 		}
-
-		/* insert the negative sign if necessary */
-		if (orgval < 0) tmp[--rlen] = HAWK_T('-');
 	}
+	if (i != len - 1 || (fmt[i] != 'g' && fmt[i] != 'f')) return 0;
 
-	return 0;
+	*prec = p;
+	return fmt[i];
 }
 
 static int val_flt_to_str (hawk_rtx_t* rtx, const hawk_val_flt_t* v, hawk_rtx_valtostr_out_t* out)
@@ -2057,6 +3065,17 @@ static int val_flt_to_str (hawk_rtx_t* rtx, const hawk_val_flt_t* v, hawk_rtx_va
 		tmp_len = rtx->gbl.convfmt.len;
 	}
 
+	{
+		/* the number in the common format is formatted without
+		 * going through hawk_rtx_format() */
+		hawk_ooch_t fbuf[64];
+		int conv, prec, len;
+
+		conv = get_simple_fltfmt(tmp, tmp_len, &prec);
+		if (conv && (len = hawk_fmt_flt_to_oocstr(fbuf, HAWK_COUNTOF(fbuf), v->val, conv, prec)) >= 0)
+			return num_to_str(rtx, fbuf, len, out);
+	}
+
 	if (hawk_ooecs_init(&buf, hawk_rtx_getgem(rtx), 256) <= -1) return -1;
 	buf_inited = 1;
 
@@ -2736,12 +3755,28 @@ int hawk_rtx_valtonum (hawk_rtx_t* rtx, const hawk_val_t* v, hawk_int_t* l, hawk
 			return 1; /* real */
 
 		case HAWK_VAL_STR:
-			return hawk_oochars_to_num(
+		{
+			hawk_val_str_t* sv = (hawk_val_str_t*)v;
+			int x;
+
+			if (sv->v_ncache == 1)
+			{
+				*l = sv->num.l;
+				return 0; /* long */
+			}
+			if (sv->v_ncache == 2)
+			{
+				*r = sv->num.r;
+				return 1; /* real */
+			}
+
+			x = hawk_oochars_to_num(
 				HAWK_OOCHARS_TO_NUM_MAKE_OPTION(0, 0, HAWK_RTX_IS_STRIPSTRSPC_ON(rtx), 0),
-				((hawk_val_str_t*)v)->val.ptr,
-				((hawk_val_str_t*)v)->val.len,
-				l, r
+				sv->val.ptr, sv->val.len, l, r
 			);
+			if (x >= 0) cache_str_num (sv, x, l, r);
+			return x;
+		}
 
 		case HAWK_VAL_MBS:
 			return hawk_bchars_to_num(
@@ -2758,7 +3793,7 @@ int hawk_rtx_valtonum (hawk_rtx_t* rtx, const hawk_val_t* v, hawk_int_t* l, hawk
 		case HAWK_VAL_MAP:
 			if (rtx->hawk->opt.trait & HAWK_FLEXMAP)
 			{
-				*l = HAWK_MAP_SIZE(((hawk_val_map_t*)v)->map);
+				*l = HAWK_VAL_MAP_SIZE(v);
 				return 0; /* long */
 			}
 			goto invalid;
@@ -2900,7 +3935,7 @@ hawk_fnc_t* hawk_rtx_valtofnc (hawk_rtx_t* rtx, hawk_val_t* v, hawk_fnc_t* rfnc)
 				goto error_inval;
 			}
 
-			fnc = hawk_findfncwithoocs(hawk, &x);
+			fnc = hawk_rtx_findfncwithoocs(rtx, &x);
 			if (fnc)
 			{
 				hawk_rtx_freevaloocstr (rtx, v, x.ptr);
@@ -2911,7 +3946,7 @@ hawk_fnc_t* hawk_rtx_valtofnc (hawk_rtx_t* rtx, hawk_val_t* v, hawk_fnc_t* rfnc)
 				hawk_mod_t* mod;
 				hawk_mod_sym_t sym;
 
-				mod = hawk_querymodulewithname(hawk, x.ptr, &sym);
+				mod = hawk_rtx_querymodulewithname(rtx, x.ptr, &sym);
 				hawk_rtx_freevaloocstr (rtx, v, x.ptr);
 				if (!mod) return HAWK_NULL;
 
@@ -70,12 +70,10 @@ static void free_memc_node (hawk_rtx_t* rtx, memc_list_t* memc_list, memc_node_t
 
 static HAWK_INLINE memc_list_t* rtx_to_memc_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-	hawk_rbt_pair_t* pair;
 	rtx_data_t* data;
 
-	pair = hawk_rbt_search((hawk_rbt_t*)fi->mod->ctx, &rtx, HAWK_SIZEOF(rtx));
-	HAWK_ASSERT (pair != HAWK_NULL);
-	data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (data != HAWK_NULL);
 	return &data->memc_list;
 }
 
@@ -375,67 +373,49 @@ static int query (hawk_mod_t* mod, hawk_t* hawk, const hawk_ooch_t* name, hawk_m
 
 static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	rtx_data_t data, * datap;
-	hawk_rbt_pair_t* pair;
+	rtx_data_t* datap;
 
-	rbt = (hawk_rbt_t*)mod->ctx;
+	datap = (rtx_data_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*datap));
+	if (HAWK_UNLIKELY(!datap)) return -1;
 
-	HAWK_MEMSET (&data, 0, HAWK_SIZEOF(data));
-	pair = hawk_rbt_insert(rbt, &rtx, HAWK_SIZEOF(rtx), &data, HAWK_SIZEOF(data));
-	if (HAWK_UNLIKELY(!pair)) return -1;
+	if (hawk_rtx_setmodinst(rtx, mod, datap) <= -1)
+	{
+		hawk_rtx_freemem (rtx, datap);
+		return -1;
+	}
 
-	datap = (rtx_data_t*)HAWK_RBT_VPTR(pair);
 	__init_memc_list (rtx, &datap->memc_list);
-
 	return 0;
 }
 
 static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	hawk_rbt_pair_t* pair;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
+	rtx_data_t* data;
 
 	/* garbage clean-up */
-	pair = hawk_rbt_search(rbt, &rtx, HAWK_SIZEOF(rtx));
-	if (pair)
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, mod);
+	if (data)
 	{
-		rtx_data_t* data;
-
-		data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
 		__fini_memc_list (rtx, &data->memc_list);
-		hawk_rbt_delete (rbt, &rtx, HAWK_SIZEOF(rtx));
+
+		hawk_rtx_setmodinst (rtx, mod, HAWK_NULL);
+		hawk_rtx_freemem (rtx, data);
 	}
 }
 
 static void unload (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
-
-	HAWK_ASSERT (HAWK_RBT_SIZE(rbt) == 0);
-	hawk_rbt_close (rbt);
+	/* nothing to do */
 }
 
 int hawk_mod_memc (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
 
-	rbt = hawk_rbt_open(hawk_getgem(hawk), 0, 1, 1);
-	if (HAWK_UNLIKELY(!rbt)) return -1;
-
-	hawk_rbt_setstyle (rbt, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_COPIERS));
-	mod->ctx = rbt;
-
 	return 0;
 }
 
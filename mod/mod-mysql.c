@@ -177,11 +177,9 @@ static void free_stmt_node (hawk_rtx_t* rtx, stmt_list_t* stmt_list, stmt_node_t
 
 static HAWK_INLINE sql_list_t* rtx_to_sql_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-	hawk_rbt_pair_t* pair;
 	rtx_data_t* data;
-	pair = hawk_rbt_search((hawk_rbt_t*)fi->mod->ctx, &rtx, HAWK_SIZEOF(rtx));
-	HAWK_ASSERT (pair != HAWK_NULL);
-	data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (data != HAWK_NULL);
 	return &data->sql_list;
 }
 
@@ -193,11 +191,9 @@ static HAWK_INLINE sql_node_t* get_sql_list_node (sql_list_t* sql_list, hawk_int
 
 static HAWK_INLINE res_list_t* rtx_to_res_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-	hawk_rbt_pair_t* pair;
 	rtx_data_t* data;
-	pair = hawk_rbt_search((hawk_rbt_t*)fi->mod->ctx, &rtx, HAWK_SIZEOF(rtx));
-	HAWK_ASSERT (pair != HAWK_NULL);
-	data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (data != HAWK_NULL);
 	return &data->res_list;
 }
 
@@ -210,11 +206,9 @@ static HAWK_INLINE res_node_t* get_res_list_node (res_list_t* res_list, hawk_int
 
 static HAWK_INLINE stmt_list_t* rtx_to_stmt_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-	hawk_rbt_pair_t* pair;
 	rtx_data_t* data;
-	pair = hawk_rbt_search((hawk_rbt_t*)fi->mod->ctx, &rtx, HAWK_SIZEOF(rtx));
-	HAWK_ASSERT (pair != HAWK_NULL);
-	data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (data != HAWK_NULL);
 	return &data->stmt_list;
 }
 
@@ -1833,17 +1827,17 @@ static int query (hawk_mod_t* mod, hawk_t* hawk, const hawk_ooch_t* name, hawk_m
 
 static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	rtx_data_t data, * datap;
-	hawk_rbt_pair_t* pair;
+	rtx_data_t* datap;
 
-	rbt = (hawk_rbt_t*)mod->ctx;
+	datap = (rtx_data_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*datap));
+	if (HAWK_UNLIKELY(!datap)) return -1;
 
-	HAWK_MEMSET (&data, 0, HAWK_SIZEOF(data));
-	pair = hawk_rbt_insert(rbt, &rtx, HAWK_SIZEOF(rtx), &data, HAWK_SIZEOF(data));
-	if (HAWK_UNLIKELY(!pair)) return -1;
+	if (hawk_rtx_setmodinst(rtx, mod, datap) <= -1)
+	{
+		hawk_rtx_freemem (rtx, datap);
+		return -1;
+	}
 
-	datap = (rtx_data_t*)HAWK_RBT_VPTR(pair);
 	__init_sql_list (rtx, &datap->sql_list);
 	__init_res_list (rtx, &datap->res_list);
 	__init_stmt_list (rtx, &datap->stmt_list);
@@ -1853,54 +1847,34 @@ static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 
 static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	hawk_rbt_pair_t* pair;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
+	rtx_data_t* data;
 
 	/* garbage clean-up */
-	pair = hawk_rbt_search(rbt, &rtx, HAWK_SIZEOF(rtx));
-	if (pair)
+	data = (rtx_data_t*)hawk_rtx_getmodinst(rtx, mod);
+	if (data)
 	{
-		rtx_data_t* data;
-
-		data = (rtx_data_t*)HAWK_RBT_VPTR(pair);
-
 		__fini_stmt_list (rtx, &data->stmt_list);
 		__fini_res_list (rtx, &data->res_list);
 		__fini_sql_list (rtx, &data->sql_list);
 
-		hawk_rbt_delete (rbt, &rtx, HAWK_SIZEOF(rtx));
+		hawk_rtx_setmodinst (rtx, mod, HAWK_NULL);
+		hawk_rtx_freemem (rtx, data);
 	}
 }
 
 static void unload (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
-
-	HAWK_ASSERT (HAWK_RBT_SIZE(rbt) == 0);
-	hawk_rbt_close (rbt);
 /*mysql_library_end ();*/
 }
 
 int hawk_mod_mysql (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
 
-	rbt = hawk_rbt_open(hawk_getgem(hawk), 0, 1, 1);
-	if (HAWK_UNLIKELY(!rbt)) return -1;
-
-	hawk_rbt_setstyle (rbt, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_COPIERS));
-
-	mod->ctx = rbt;
 	return 0;
 }
 
@@ -641,10 +641,10 @@ static int getoption_byid (hawk_rtx_t* rtx, uctx_list_t* list, hawk_int_t id, ha
 
 static HAWK_INLINE uctx_list_t* rtx_to_list (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
 {
-	hawk_rbt_pair_t* pair;
-	pair = hawk_rbt_search ((hawk_rbt_t*)fi->mod->ctx, &rtx, HAWK_SIZEOF(rtx));
-	HAWK_ASSERT (pair != HAWK_NULL);
-	return (uctx_list_t*)HAWK_RBT_VPTR(pair);
+	uctx_list_t* list;
+	list = (uctx_list_t*)hawk_rtx_getmodinst(rtx, fi->mod);
+	HAWK_ASSERT (list != HAWK_NULL);
+	return list;
 }
 
 static int fnc_uci_errno (hawk_rtx_t* rtx, const hawk_fnc_info_t* fi)
@@ -1324,15 +1324,14 @@ static int query (hawk_mod_t* mod, hawk_t* hawk, const hawk_ooch_t* name, hawk_m
 
 static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	uctx_list_t list;
+	uctx_list_t* list;
 
-	rbt = (hawk_rbt_t*)mod->ctx;
+	list = (uctx_list_t*)hawk_rtx_callocmem(rtx, HAWK_SIZEOF(*list));
+	if (!list) return -1;
 
-	HAWK_MEMSET (&list, 0, HAWK_SIZEOF(list));
-	if (hawk_rbt_insert(rbt, &rtx, HAWK_SIZEOF(rtx), &list, HAWK_SIZEOF(list)) == HAWK_NULL)
+	if (hawk_rtx_setmodinst(rtx, mod, list) <= -1)
 	{
-		hawk_rtx_seterrnum (rtx, HAWK_NULL, HAWK_ENOMEM);
+		hawk_rtx_freemem (rtx, list);
 		return -1;
 	}
 
@@ -1341,19 +1340,14 @@ static int init (hawk_mod_t* mod, hawk_rtx_t* rtx)
 
 static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 {
-	hawk_rbt_t* rbt;
-	hawk_rbt_pair_t* pair;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
+	uctx_list_t* list;
 
 	/* garbage clean-up */
-	pair = hawk_rbt_search  (rbt, &rtx, HAWK_SIZEOF(rtx));
-	if (pair)
+	list = (uctx_list_t*)hawk_rtx_getmodinst(rtx, mod);
+	if (list)
 	{
-		uctx_list_t* list;
 		uctx_node_t* node, * next;
 
-		list = HAWK_RBT_VPTR(pair);
 		node = list->head;
 		while (node)
 		{
@@ -1362,36 +1356,24 @@ static void fini (hawk_mod_t* mod, hawk_rtx_t* rtx)
 			node = next;
 		}
 
-		hawk_rbt_delete (rbt, &rtx, HAWK_SIZEOF(rtx));
+		hawk_rtx_setmodinst (rtx, mod, HAWK_NULL);
+		hawk_rtx_freemem (rtx, list);
 	}
 }
 
 static void unload (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
-	rbt = (hawk_rbt_t*)mod->ctx;
-
-	HAWK_ASSERT (HAWK_RBT_SIZE(rbt) == 0);
-	hawk_rbt_close (rbt);
+	/* nothing to do */
 }
 
 int hawk_mod_uci (hawk_mod_t* mod, hawk_t* hawk)
 {
-	hawk_rbt_t* rbt;
-
 	mod->query = query;
 	mod->unload = unload;
 
 	mod->init = init;
 	mod->fini = fini;
 
-	rbt = hawk_rbt_open(hawk_getgem(hawk), 0, 1, 1);
-	if (!rbt) return -1;
-
-	hawk_rbt_setstyle (rbt, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_COPIERS));
-
-	mod->ctx = rbt;
 	return 0;
 }
 
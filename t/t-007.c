@@ -0,0 +1,292 @@
+/* test the open-addressing hash table against the red-black tree */
+
+#include <hawk-oht.h>
+#include <hawk-rbt.h>
+#include <hawk-utl.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tap.h"
+
+#define OK_X(test) OK(test, #test)
+
+static void* sys_alloc (hawk_mmgr_t* mmgr, hawk_oow_t size)
+{
+	return malloc(size);
+}
+
+static void* sys_realloc (hawk_mmgr_t* mmgr, void* ptr, hawk_oow_t size)
+{
+	return realloc(ptr, size);
+}
+
+static void sys_free (hawk_mmgr_t* mmgr, void* ptr)
+{
+	free (ptr);
+}
+
+static hawk_mmgr_t sys_mmgr =
+{
+	sys_alloc,
+	sys_realloc,
+	sys_free,
+	HAWK_NULL
+};
+
+static int freed = 0;
+
+static void free_val (hawk_oht_t* oht, void* vptr, hawk_oow_t vlen)
+{
+	freed++;
+}
+
+static hawk_oht_walk_t count_pair (hawk_oht_t* oht, hawk_oht_pair_t* pair, void* ctx)
+{
+	(*(hawk_oow_t*)ctx)++;
+	return HAWK_OHT_WALK_FORWARD;
+}
+
+static hawk_oht_pair_t* cbserter (hawk_oht_t* oht, hawk_oht_pair_t* pair, void* kptr, hawk_oow_t klen, void* ctx)
+{
+	/* store the key length as the value on insertion and bump it on update */
+	if (!pair) return hawk_oht_allocpair(oht, kptr, klen, (void*)klen, 0);
+	HAWK_OHT_VPTR(pair) = (void*)((hawk_oow_t)HAWK_OHT_VPTR(pair) + 1);
+	return pair;
+}
+
+/* a poor hasher to produce long probe sequences */
+static hawk_oow_t bad_hasher (const hawk_oht_t* oht, const void* kptr, hawk_oow_t klen)
+{
+	return klen;
+}
+
+static void test1 (void)
+{
+	hawk_gem_t g;
+	hawk_oht_t* oht;
+	hawk_oht_pair_t* pair;
+	hawk_oht_itr_t itr;
+	hawk_oht_style_t style;
+	hawk_oow_t cnt;
+	char key[32];
+	int i, good;
+
+	memset (&g, 0, sizeof(g));
+	g.mmgr = &sys_mmgr;
+
+	oht = hawk_oht_open(&g, 0, 0, 70, 1, 1);
+	OK_X (oht != HAWK_NULL);
+	if (!oht) return;
+
+	style = *hawk_get_oht_style(HAWK_OHT_STYLE_INLINE_KEY_COPIER);
+	style.freeer[HAWK_OHT_VAL] = free_val;
+	hawk_oht_setstyle (oht, &style);
+
+	OK_X (hawk_oht_getsize(oht) == 0);
+	OK_X (hawk_oht_search(oht, "none", 4) == HAWK_NULL);
+	OK_X (hawk_oht_delete(oht, "none", 4) <= -1);
+
+	for (good = 1, i = 0; i < 10000; i++)
+	{
+		int len = sprintf(key, "key%d", i);
+		if (!hawk_oht_insert(oht, key, len, (void*)(hawk_oow_t)i, 0)) good = 0;
+	}
+	OK (good, "insert 10000 pairs");
+	OK_X (hawk_oht_getsize(oht) == 10000);
+	OK_X (hawk_oht_getcapa(oht) >= 10000 && (hawk_oht_getcapa(oht) & (hawk_oht_getcapa(oht) - 1)) == 0);
+	OK_X (hawk_oht_insert(oht, "key5", 4, HAWK_NULL, 0) == HAWK_NULL);
+
+	for (good = 1, i = 0; i < 10000; i++)
+	{
+		int len = sprintf(key, "key%d", i);
+		pair = hawk_oht_search(oht, key, len);
+		if (!pair || (hawk_oow_t)HAWK_OHT_VPTR(pair) != i) good = 0;
+	}
+	OK (good, "search 10000 pairs");
+
+	/* delete every other pair. backward shifting must keep the rest reachable */
+	for (good = 1, i = 0; i < 10000; i += 2)
+	{
+		int len = sprintf(key, "key%d", i);
+		if (hawk_oht_delete(oht, key, len) <= -1) good = 0;
+	}
+	OK (good, "delete 5000 pairs");
+	OK_X (freed == 5000);
+	OK_X (hawk_oht_getsize(oht) == 5000);
+
+	for (good = 1, i = 0; i < 10000; i++)
+	{
+		int len = sprintf(key, "key%d", i);
+		pair = hawk_oht_search(oht, key, len);
+		if ((i % 2 == 0 && pair) || (i % 2 == 1 && (!pair || (hawk_oow_t)HAWK_OHT_VPTR(pair) != i))) good = 0;
+	}
+	OK (good, "search after deletion");
+
+	OK_X (hawk_oht_update(oht, "key0", 4, HAWK_NULL, 0) == HAWK_NULL);
+	pair = hawk_oht_update(oht, "key1", 4, (void*)(hawk_oow_t)1234, 0);
+	OK_X (pair && (hawk_oow_t)HAWK_OHT_VPTR(pair) == 1234 && freed == 5001);
+	pair = hawk_oht_upsert(oht, "key0", 4, (void*)(hawk_oow_t)99, 0);
+	OK_X (pair && (hawk_oow_t)HAWK_OHT_VPTR(pair) == 99 && hawk_oht_getsize(oht) == 5001);
+	pair = hawk_oht_ensert(oht, "key0", 4, (void*)(hawk_oow_t)100, 0);
+	OK_X (pair && (hawk_oow_t)HAWK_OHT_VPTR(pair) == 99);
+
+	cnt = 0;
+	for (pair = hawk_oht_getfirstpair(oht, &itr); pair; pair = hawk_oht_getnextpair(oht, &itr)) cnt++;
+	OK_X (cnt == 5001);
+
+	cnt = 0;
+	hawk_oht_walk (oht, count_pair, &cnt);
+	OK_X (cnt == 5001);
+
+	hawk_oht_clear (oht);
+	OK_X (hawk_oht_getsize(oht) == 0);
+	OK_X (hawk_oht_getfirstpair(oht, &itr) == HAWK_NULL);
+	OK_X (hawk_oht_search(oht, "key1", 4) == HAWK_NULL);
+
+	style.freeer[HAWK_OHT_VAL] = HAWK_NULL;
+	pair = hawk_oht_cbsert(oht, "abc", 3, cbserter, HAWK_NULL);
+	OK_X (pair && (hawk_oow_t)HAWK_OHT_VPTR(pair) == 3);
+	pair = hawk_oht_cbsert(oht, "abc", 3, cbserter, HAWK_NULL);
+	OK_X (pair && (hawk_oow_t)HAWK_OHT_VPTR(pair) == 4 && hawk_oht_getsize(oht) == 1);
+
+	hawk_oht_close (oht);
+}
+
+static void test2 (void)
+{
+	hawk_gem_t g;
+	hawk_oht_t* oht;
+	hawk_oht_pair_t* pair;
+	hawk_oht_style_t style;
+	char key[64];
+	int i, good;
+
+	memset (&g, 0, sizeof(g));
+	g.mmgr = &sys_mmgr;
+
+	/* all keys of the same length collide. the table must still work */
+	oht = hawk_oht_open(&g, 0, 0, 90, 1, 1);
+	OK_X (oht != HAWK_NULL);
+	if (!oht) return;
+
+	style = *hawk_get_oht_style(HAWK_OHT_STYLE_INLINE_COPIERS);
+	style.hasher = bad_hasher;
+	hawk_oht_setstyle (oht, &style);
+
+	for (good = 1, i = 0; i < 500; i++)
+	{
+		int len = sprintf(key, "%05d", i);
+		if (!hawk_oht_upsert(oht, key, len, key, len)) good = 0;
+		if (i < 100)
+		{
+			len = sprintf(key, "%03d", i);
+			if (!hawk_oht_upsert(oht, key, len, key, len)) good = 0;
+		}
+	}
+	OK (good, "insert colliding pairs");
+	OK_X (hawk_oht_getsize(oht) == 600);
+
+	/* change the value length of an inline value */
+	pair = hawk_oht_upsert(oht, "00007", 5, "seven", 5);
+	OK_X (pair && HAWK_OHT_VLEN(pair) == 5 && memcmp(HAWK_OHT_VPTR(pair), "seven", 5) == 0);
+	pair = hawk_oht_upsert(oht, "00007", 5, "seventy", 7);
+	OK_X (pair && HAWK_OHT_VLEN(pair) == 7 && memcmp(HAWK_OHT_VPTR(pair), "seventy", 7) == 0);
+	OK_X (hawk_oht_search(oht, "00007", 5) == pair);
+
+	for (good = 1, i = 0; i < 500; i += 3)
+	{
+		int len = sprintf(key, "%05d", i);
+		if (hawk_oht_delete(oht, key, len) <= -1) good = 0;
+	}
+	OK (good, "delete colliding pairs");
+
+	for (good = 1, i = 0; i < 500; i++)
+	{
+		int len = sprintf(key, "%05d", i);
+		pair = hawk_oht_search(oht, key, len);
+		if ((i % 3 == 0) != (pair == HAWK_NULL)) good = 0;
+		if (pair && i != 7 && memcmp(HAWK_OHT_VPTR(pair), key, len) != 0) good = 0;
+	}
+	OK (good, "search colliding pairs");
+
+	hawk_oht_close (oht);
+}
+
+static double elapsed (clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+#define BENCH_KEYS 200000
+#define BENCH_KEY_SIZE 32
+
+static void bench (void)
+{
+	hawk_gem_t g;
+	hawk_oht_t* oht;
+	hawk_rbt_t* rbt;
+	clock_t start;
+	char* keys;
+	char msg[128];
+	int i, j;
+	hawk_oow_t found[2] = { 0, 0 };
+
+	memset (&g, 0, sizeof(g));
+	g.mmgr = &sys_mmgr;
+
+	oht = hawk_oht_open(&g, 0, 0, 70, 1, 1);
+	rbt = hawk_rbt_open(&g, 0, 1, 1);
+	keys = malloc(BENCH_KEYS * BENCH_KEY_SIZE);
+	OK_X (oht != HAWK_NULL && rbt != HAWK_NULL && keys != HAWK_NULL);
+	if (!oht || !rbt || !keys) goto done;
+
+	hawk_oht_setstyle (oht, hawk_get_oht_style(HAWK_OHT_STYLE_INLINE_KEY_COPIER));
+	hawk_rbt_setstyle (rbt, hawk_get_rbt_style(HAWK_RBT_STYLE_INLINE_KEY_COPIER));
+
+	/* prepare the keys in advance not to time the formatting */
+	for (i = 0; i < BENCH_KEYS; i++) sprintf (&keys[i * BENCH_KEY_SIZE], "%d-%d", i * 7919, i);
+
+	start = clock();
+	for (j = 0; j < 5; j++)
+	{
+		for (i = 0; i < BENCH_KEYS; i++)
+		{
+			char* key = &keys[i * BENCH_KEY_SIZE];
+			if (j == 0) hawk_oht_upsert (oht, key, strlen(key), HAWK_NULL, 0);
+			else if (hawk_oht_search(oht, key, strlen(key))) found[0]++;
+		}
+	}
+	snprintf (msg, sizeof(msg), "oht: %d distinct keys inserted and looked up 4 times in %.3f seconds", BENCH_KEYS, elapsed(start));
+	diag (msg);
+
+	start = clock();
+	for (j = 0; j < 5; j++)
+	{
+		for (i = 0; i < BENCH_KEYS; i++)
+		{
+			char* key = &keys[i * BENCH_KEY_SIZE];
+			if (j == 0) hawk_rbt_upsert (rbt, key, strlen(key), HAWK_NULL, 0);
+			else if (hawk_rbt_search(rbt, key, strlen(key))) found[1]++;
+		}
+	}
+	snprintf (msg, sizeof(msg), "rbt: %d distinct keys inserted and looked up 4 times in %.3f seconds", BENCH_KEYS, elapsed(start));
+	diag (msg);
+
+	OK_X (hawk_oht_getsize(oht) == hawk_rbt_getsize(rbt));
+	OK_X (found[0] == found[1] && found[0] == (hawk_oow_t)BENCH_KEYS * 4);
+
+done:
+	if (keys) free (keys);
+	if (rbt) hawk_rbt_close (rbt);
+	if (oht) hawk_oht_close (oht);
+}
+
+int main ()
+{
+	no_plan ();
+	test1 ();
+	test2 ();
+	bench ();
+	return exit_status();
+}
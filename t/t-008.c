@@ -0,0 +1,109 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap.h"
+
+/* the live maps reference each other and the references move around
+ * while garbage cycles get created. the incremental collection must
+ * not free any of the live maps. the low thresholds make the rounds
+ * of the incremental collection frequent */
+static const hawk_bch_t* src =
+	"BEGIN {"
+	"	hawk::gc_set_threshold(1, 2);"
+	"	hawk::gc_set_threshold(2, 2);"
+	"	for (i = 0; i < 500; i++) { keep[i][0] = i; keep[i][1] = keep[(i * 7) % (i + 1)]; }"
+	"	for (r = 0; r < 60000; r++) {"
+	"		@local a, b, x;"
+	"		a[1] = r; b[1] = a; a[2] = b;"
+	"		t[r % 50] = a;"
+	"		j = r % 500; k = (r * 13) % 500;"
+	"		x = keep[j][1]; keep[j][1] = keep[k][1]; keep[k][1] = x;"
+	"	}"
+	"	s = 0;"
+	"	for (i = 0; i < 500; i++) s += keep[i][0] * 3 + keep[i][1][0];"
+	"	exit s + t[7][1];"
+	"}";
+
+/* every map made becomes a garbage cycle after a while. the rounds of
+ * the incremental collection must keep up with them however small the
+ * work budget is */
+static const hawk_bch_t* src_cycles =
+	"BEGIN {"
+	"	for (i = 0; i < 200000; i++) { x = hawk::map(); x[5] = x; x[6] = i; y[i % 1000] = x; }"
+	"	exit length(y);"
+	"}";
+
+static int run (const hawk_bch_t* src, hawk_oow_t work, hawk_oow_t time, hawk_int_t* res, hawk_gcstats_t* stats)
+{
+	hawk_t* hawk = HAWK_NULL;
+	hawk_rtx_t* rtx = HAWK_NULL;
+	hawk_val_t* retv;
+	hawk_parsestd_t psin[2];
+	int ret = -1;
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk)
+	{
+		fprintf (stderr, "Unable to open hawk\n");
+		goto oops;
+	}
+
+	hawk_setopt (hawk, HAWK_OPT_MODLIBDIRS, HAWK_T("../lib/.libs"));
+	hawk_setopt (hawk, HAWK_OPT_RTX_GC_SLICE_WORK, &work);
+	hawk_setopt (hawk, HAWK_OPT_RTX_GC_SLICE_TIME, &time);
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)src;
+	psin[0].u.bcs.len = hawk_count_bcstr(src);
+	psin[1].type = HAWK_PARSESTD_NULL;
+
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(parse): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	rtx = hawk_rtx_openstd(hawk, 0, HAWK_T("t-008"), HAWK_NULL, HAWK_NULL, HAWK_NULL);
+	if (!rtx)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(rtx_open): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	retv = hawk_rtx_loop(rtx);
+	if (!retv)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(rtx_loop): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	ret = hawk_rtx_valtoint(rtx, retv, res);
+	hawk_rtx_refdownval (rtx, retv);
+	if (stats) hawk_rtx_getgcstats (rtx, stats);
+
+oops:
+	if (rtx) hawk_rtx_close (rtx);
+	if (hawk) hawk_close (hawk);
+	return ret;
+}
+
+int main ()
+{
+	hawk_int_t r0, r1;
+	hawk_gcstats_t stats;
+
+	no_plan ();
+
+	OK (run(src, 0, 0, &r0, HAWK_NULL) == 0, "stop-the-world collection");
+	OK (run(src, 10, 0, &r1, HAWK_NULL) == 0 && r1 == r0, "incremental collection with a small work budget");
+	OK (run(src, 1000, 0, &r1, HAWK_NULL) == 0 && r1 == r0, "incremental collection with a large work budget");
+	OK (run(src, 100000, 1, &r1, HAWK_NULL) == 0 && r1 == r0, "incremental collection with a time budget");
+
+	OK (run(src_cycles, 10, 0, &r1, &stats) == 0 && r1 == 1000, "incremental collection of garbage cycles");
+	OK (stats.rounds >= 3, "rounds finished with a small work budget");
+	OK (stats.freed >= 160000, "garbage cycles freed with a small work budget");
+	OK (stats.gen[stats.ngens - 1].count <= 30000, "oldest generation bounded with a small work budget");
+
+	return exit_status();
+}
@@ -0,0 +1,107 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap.h"
+
+#define INFILE "t-009.in"
+
+/* the string values made for a record are carved out of the arena when
+ * it is enabled. the values kept in the local variables, the global
+ * variables and the map elements must survive the reset of the arena.
+ * the tiny block size makes the blocks get full and pinned frequently */
+static const hawk_bch_t* src =
+	"{"
+	"	@local l;"
+	"	l = $2 \"-\" $3;"
+	"	g = l \"/\" $1;"
+	"	m[$1 % 50] = g;"
+	"	if ($1 % 3 == 0) $2 = toupper($2);"
+	"	s = s substr($3, 1, 2);"
+	"	if (length(s) > 1000) s = substr(s, 999);"
+	"	n += length($0) + length(g) + length(l);"
+	"}"
+	"END {"
+	"	for (k in m) n += length(m[k]) * (k + 1);"
+	"	exit n + length(s) + (m[7] == \"name5-val27699/3957\") * 1000000 + (g == \"name8-val27993/3999\") * 2000000;"
+	"}";
+
+static int run (hawk_oow_t arena, hawk_int_t* res)
+{
+	hawk_t* hawk = HAWK_NULL;
+	hawk_rtx_t* rtx = HAWK_NULL;
+	hawk_val_t* retv;
+	hawk_parsestd_t psin[2];
+	hawk_ooch_t* icf[2];
+	int ret = -1;
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk)
+	{
+		fprintf (stderr, "Unable to open hawk\n");
+		goto oops;
+	}
+
+	hawk_setopt (hawk, HAWK_OPT_RTX_ARENA_SIZE, &arena);
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)src;
+	psin[0].u.bcs.len = hawk_count_bcstr(src);
+	psin[1].type = HAWK_PARSESTD_NULL;
+
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(parse): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	icf[0] = (hawk_ooch_t*)HAWK_T(INFILE);
+	icf[1] = HAWK_NULL;
+	rtx = hawk_rtx_openstd(hawk, 0, HAWK_T("t-009"), icf, HAWK_NULL, HAWK_NULL);
+	if (!rtx)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(rtx_open): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	retv = hawk_rtx_loop(rtx);
+	if (!retv)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(rtx_loop): %js\n", hawk_geterrmsg(hawk));
+		goto oops;
+	}
+
+	ret = hawk_rtx_valtoint(rtx, retv, res);
+	hawk_rtx_refdownval (rtx, retv);
+
+oops:
+	if (rtx) hawk_rtx_close (rtx);
+	if (hawk) hawk_close (hawk);
+	return ret;
+}
+
+int main ()
+{
+	FILE* fp;
+	hawk_int_t r0, r1;
+	int i;
+
+	no_plan ();
+
+	fp = fopen(INFILE, "w");
+	if (!fp)
+	{
+		fprintf (stderr, "Unable to create %s\n", INFILE);
+		return -1;
+	}
+	for (i = 0; i < 4000; i++) fprintf (fp, "%d name%d val%d\n", i, i % 13, i * 7);
+	fclose (fp);
+
+	OK (run(0, &r0) == 0 && r0 >= 3000000, "no arena");
+	OK (run(256, &r1) == 0 && r1 == r0, "arena with blocks too small for most values");
+	OK (run(1024, &r1) == 0 && r1 == r0, "arena with small blocks");
+	OK (run(65536, &r1) == 0 && r1 == r0, "arena with large blocks");
+
+	remove (INFILE);
+	return exit_status();
+}
@@ -0,0 +1,131 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "tap.h"
+
+/* the runtime contexts created over a frozen hawk object run the same
+ * program on different threads at the same time. the regular expressions
+ * in the parse tree and the modules are shared by the contexts while
+ * the str module gets loaded by the first context calling hawk::call() */
+static const hawk_bch_t* src =
+	"BEGIN {"
+	"	s = 0;"
+	"	for (i = 0; i < 3000; i++) {"
+	"		x = \"item-\" i \"-\" (i * 7 % 13);"
+	"		if (x ~ /-[0-9]+-1[0-2]$/) s += i;"
+	"		n = split(x, a, /-/); s += n + length(a[3]);"
+	"		y = x; gsub(/[0-9]/, \"#\", y); s += index(y, \"#\");"
+	"		s += length(hawk::call(\"str::tolower\", toupper(x)));"
+	"	}"
+	"	math::srand(i);"
+	"	r = math::rand(); if (r < 0 || r >= 1) s = -1;"
+	"	if (hawk::call(\"sys::getpid\") != sys::getpid()) s = -2;"
+	"	if (!hawk::function_exists(\"str::length\")) s = -3;"
+	"	exit s;"
+	"}";
+
+#define NTHREADS 8
+#define NRUNS 5
+
+struct thr_ctx_t
+{
+	hawk_t* hawk;
+	pthread_t thr;
+	hawk_int_t res[NRUNS];
+	int ok;
+};
+typedef struct thr_ctx_t thr_ctx_t;
+
+static int run (hawk_t* hawk, hawk_int_t* res)
+{
+	hawk_rtx_t* rtx;
+	hawk_val_t* retv;
+	int ret = -1;
+
+	rtx = hawk_rtx_openstd(hawk, 0, HAWK_T("t-010"), HAWK_NULL, HAWK_NULL, HAWK_NULL);
+	if (!rtx) return -1;
+
+	retv = hawk_rtx_loop(rtx);
+	if (retv)
+	{
+		ret = hawk_rtx_valtoint(rtx, retv, res);
+		hawk_rtx_refdownval (rtx, retv);
+	}
+
+	hawk_rtx_close (rtx);
+	return ret;
+}
+
+static void* thr_main (void* arg)
+{
+	thr_ctx_t* ctx = (thr_ctx_t*)arg;
+	int i;
+
+	ctx->ok = 1;
+	for (i = 0; i < NRUNS; i++)
+	{
+		if (run(ctx->hawk, &ctx->res[i]) <= -1) ctx->ok = 0;
+	}
+	return HAWK_NULL;
+}
+
+int main ()
+{
+	hawk_t* hawk;
+	hawk_parsestd_t psin[2];
+	thr_ctx_t ctx[NTHREADS];
+	hawk_int_t r0;
+	int i, j, same;
+
+	no_plan ();
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk)
+	{
+		fprintf (stderr, "Unable to open hawk\n");
+		return -1;
+	}
+
+	hawk_setopt (hawk, HAWK_OPT_MODLIBDIRS, HAWK_T("../lib/.libs"));
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)src;
+	psin[0].u.bcs.len = hawk_count_bcstr(src);
+	psin[1].type = HAWK_PARSESTD_NULL;
+
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1)
+	{
+		hawk_logbfmt (hawk, HAWK_LOG_STDERR, "ERROR(parse): %js\n", hawk_geterrmsg(hawk));
+		hawk_close (hawk);
+		return -1;
+	}
+
+	hawk_freeze (hawk);
+	OK (hawk_isfrozen(hawk), "frozen");
+	OK (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1 && hawk_geterrnum(hawk) == HAWK_EPERM, "no parsing over a frozen hawk object");
+
+	OK (run(hawk, &r0) == 0 && r0 > 0, "single-threaded run");
+
+	for (i = 0; i < NTHREADS; i++)
+	{
+		ctx[i].hawk = hawk;
+		pthread_create (&ctx[i].thr, HAWK_NULL, thr_main, &ctx[i]);
+	}
+
+	same = 1;
+	for (i = 0; i < NTHREADS; i++)
+	{
+		pthread_join (ctx[i].thr, HAWK_NULL);
+		if (!ctx[i].ok) same = 0;
+		else
+		{
+			for (j = 0; j < NRUNS; j++) if (ctx[i].res[j] != r0) same = 0;
+		}
+	}
+	OK (same, "multi-threaded runs");
+
+	hawk_close (hawk);
+	return exit_status();
+}
@@ -0,0 +1,161 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap.h"
+
+/* two runtime contexts run the BEGIN blocks with a different value of w.
+ * the second is merged into the first with the reduction operators
+ * declared and the END blocks run on the first to report the result */
+static const hawk_bch_t* src =
+	"@pragma reduce cnt sum;"
+	"@pragma reduce lo min;"
+	"@pragma reduce hi max;"
+	"@pragma reduce s concat;"
+	"@pragma reduce u union;"
+	"@pragma reduce t sum;"
+	"@pragma reduce n sum;"
+	"@global w;"
+	"BEGIN {"
+	"	for (i = 0; i < 10; i++) cnt[i % 3] += w;"
+	"	lo = w; hi = w * 10; s = \"w\" w; t = w / 2;"
+	"	u[\"k\" w] = w; u[\"same\"] = w;"
+	"	n[1][w] = w;"
+	"}"
+	"END {"
+	"	exit cnt[0] \",\" cnt[1] \",\" cnt[2] \",\" lo \",\" hi \",\" s \",\" length(u) \",\" u[\"same\"] \",\" t \",\" length(n[1]) \",\" NR;"
+	"}";
+
+static hawk_t* open_hawk (const hawk_bch_t* text)
+{
+	hawk_t* hawk;
+	hawk_parsestd_t psin[2];
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk) return HAWK_NULL;
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)text;
+	psin[0].u.bcs.len = hawk_count_bcstr(text);
+	psin[1].type = HAWK_PARSESTD_NULL;
+
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1)
+	{
+		hawk_close (hawk);
+		return HAWK_NULL;
+	}
+
+	return hawk;
+}
+
+static hawk_rtx_t* run_begin (hawk_t* hawk, const hawk_ooch_t* w)
+{
+	hawk_rtx_t* rtx;
+	hawk_val_t* retv;
+
+	rtx = hawk_rtx_openstd(hawk, 0, HAWK_T("t-011"), HAWK_NULL, HAWK_NULL, HAWK_NULL);
+	if (!rtx) return HAWK_NULL;
+
+	if (hawk_rtx_setgbltostrbyname(rtx, HAWK_T("w"), w) <= -1 ||
+	    !(retv = hawk_rtx_loopwithphases(rtx, HAWK_RTX_PHASE_BEGIN)))
+	{
+		hawk_rtx_close (rtx);
+		return HAWK_NULL;
+	}
+
+	hawk_rtx_refdownval (rtx, retv);
+	return rtx;
+}
+
+static int run (hawk_bch_t* buf, hawk_oow_t len)
+{
+	hawk_t* hawk;
+	hawk_rtx_t* rtx1 = HAWK_NULL, * rtx2 = HAWK_NULL;
+	hawk_val_t* retv;
+	hawk_bch_t* str;
+	hawk_oow_t slen;
+	int ret = -1;
+
+	hawk = open_hawk(src);
+	if (!hawk) return -1;
+
+	rtx1 = run_begin(hawk, HAWK_T("1"));
+	rtx2 = run_begin(hawk, HAWK_T("2"));
+	if (!rtx1 || !rtx2 || hawk_rtx_reduce(rtx1, rtx2) <= -1) goto oops;
+
+	retv = hawk_rtx_loopwithphases(rtx1, HAWK_RTX_PHASE_END);
+	if (!retv) goto oops;
+
+	str = hawk_rtx_getvalbcstr(rtx1, retv, &slen);
+	if (str)
+	{
+		hawk_copy_bchars_to_bcstr (buf, len, str, slen);
+		hawk_rtx_freevalbcstr (rtx1, retv, str);
+		ret = 0;
+	}
+	hawk_rtx_refdownval (rtx1, retv);
+
+oops:
+	if (rtx2) hawk_rtx_close (rtx2);
+	if (rtx1) hawk_rtx_close (rtx1);
+	hawk_close (hawk);
+	return ret;
+}
+
+static int reduce_mismatch (void)
+{
+	hawk_t* hawk;
+	hawk_rtx_t* rtx1 = HAWK_NULL, * rtx2 = HAWK_NULL;
+	int n = 0;
+
+	hawk = open_hawk("@pragma reduce m sum; @global w; BEGIN { if (w == 1) m = 1; else m[1] = 1; } END { }");
+	if (!hawk) return 0;
+
+	rtx1 = run_begin(hawk, HAWK_T("1"));
+	rtx2 = run_begin(hawk, HAWK_T("2"));
+	if (rtx1 && rtx2) n = (hawk_rtx_reduce(rtx1, rtx2) <= -1 && hawk_rtx_geterrnum(rtx1) == HAWK_ESCALARTONONSCA);
+
+	if (rtx2) hawk_rtx_close (rtx2);
+	if (rtx1) hawk_rtx_close (rtx1);
+	hawk_close (hawk);
+	return n;
+}
+
+static int parse_fails (const hawk_bch_t* text)
+{
+	hawk_t* hawk;
+
+	hawk = open_hawk(text);
+	if (!hawk) return 1;
+	hawk_close (hawk);
+	return 0;
+}
+
+int main ()
+{
+	hawk_bch_t buf[256];
+	hawk_t* hawk;
+
+	no_plan ();
+
+	OK (run(buf, HAWK_COUNTOF(buf)) == 0, "merge two runtime contexts");
+	OK (strcmp(buf, "12,9,9,1,20,w1w2,3,1,1.5,2,0") == 0, "reduction result");
+	OK (reduce_mismatch(), "scalar merged with a map");
+
+	hawk = open_hawk("@pragma reduce x sum; { x++ }");
+	OK (hawk && hawk_isreducible(hawk), "reducible program");
+	if (hawk) hawk_close (hawk);
+	hawk = open_hawk("@pragma reduce x sum; BEGIN { x++ }");
+	OK (hawk && !hawk_isreducible(hawk), "program without input processing");
+	if (hawk) hawk_close (hawk);
+	hawk = open_hawk("{ x++ }");
+	OK (hawk && !hawk_isreducible(hawk), "program without reduction");
+	if (hawk) hawk_close (hawk);
+
+	OK (parse_fails("@pragma reduce x avg; { x++ }"), "unknown reduction operator");
+	OK (parse_fails("@pragma reduce x sum; @pragma reduce x max; { x++ }"), "duplicate reduction");
+	OK (parse_fails("@pragma reduce NR sum; { x++ }"), "reduction of an intrinsic global");
+	OK (parse_fails("@pragma reduce 10 sum; { x++ }"), "reduction without a name");
+
+	return exit_status();
+}
@@ -0,0 +1,128 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "tap.h"
+
+/* the console input and the file read with getline contain a UTF-8
+ * sequence and bytes that are not valid UTF-8. with HAWK_BYTEIO,
+ * every byte is a character and the bytes are written back as read */
+static const hawk_bch_t* src =
+	"@global F;"
+	"{"
+	"	print NR, length($0), toupper($0), ($1 ~ /^h..llo$/), substr($1, 2, 2);"
+	"}"
+	"END {"
+	"	while ((getline line < F) > 0) { n += length(line); t = t line; }"
+	"	print n, t;"
+	"}";
+
+static const hawk_bch_t input[] = "h\xc3\xa9llo w\xc3\xb6rld\n\xff\xfe bad\nabc\n";
+
+static int write_file (const hawk_bch_t* path, const hawk_bch_t* data, hawk_oow_t len)
+{
+	FILE* fp;
+	int n;
+
+	fp = fopen(path, "wb");
+	if (!fp) return -1;
+	n = (fwrite(data, 1, len, fp) == len)? 0: -1;
+	fclose (fp);
+	return n;
+}
+
+static hawk_oow_t read_file (const hawk_bch_t* path, hawk_bch_t* buf, hawk_oow_t len)
+{
+	FILE* fp;
+	hawk_oow_t n;
+
+	fp = fopen(path, "rb");
+	if (!fp) return 0;
+	n = fread(buf, 1, len, fp);
+	fclose (fp);
+	return n;
+}
+
+static int run (int trait, const hawk_bch_t* in, const hawk_bch_t* out)
+{
+	hawk_t* hawk = HAWK_NULL;
+	hawk_rtx_t* rtx = HAWK_NULL;
+	hawk_val_t* retv;
+	hawk_parsestd_t psin[2];
+	hawk_bch_t* icf[2], * ocf[2];
+	hawk_ooch_t fname[64];
+	hawk_oow_t i;
+	int opt, ret = -1;
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk) goto oops;
+
+	hawk_getopt (hawk, HAWK_OPT_TRAIT, &opt);
+	opt |= trait;
+	hawk_setopt (hawk, HAWK_OPT_TRAIT, &opt);
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)src;
+	psin[0].u.bcs.len = hawk_count_bcstr(src);
+	psin[1].type = HAWK_PARSESTD_NULL;
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1) goto oops;
+
+	icf[0] = (hawk_bch_t*)in; icf[1] = HAWK_NULL;
+	ocf[0] = (hawk_bch_t*)out; ocf[1] = HAWK_NULL;
+	rtx = hawk_rtx_openstdwithbcstr(hawk, 0, "t-012", icf, ocf, HAWK_NULL);
+	if (!rtx) goto oops;
+
+	for (i = 0; in[i] && i < HAWK_COUNTOF(fname) - 1; i++) fname[i] = in[i];
+	fname[i] = '\0';
+	if (hawk_rtx_setgbltostrbyname(rtx, HAWK_T("F"), fname) <= -1) goto oops;
+
+	retv = hawk_rtx_loop(rtx);
+	if (!retv) goto oops;
+	hawk_rtx_refdownval (rtx, retv);
+	ret = 0;
+
+oops:
+	if (rtx) hawk_rtx_close (rtx);
+	if (hawk) hawk_close (hawk);
+	return ret;
+}
+
+int main ()
+{
+	static const hawk_bch_t expected[] =
+		"1 13 H\xc3\xa9LLO W\xc3\xb6RLD 1 \xc3\xa9\n"
+		"2 6 \xff\xfe BAD 0 \xfe\n"
+		"3 3 ABC 0 bc\n"
+		"22 h\xc3\xa9llo w\xc3\xb6rld\xff\xfe badabc\n";
+	static const hawk_bch_t ascii[] = "hello world\nabc\n";
+	hawk_bch_t in[64], out[64], buf[256], buf2[256];
+	hawk_oow_t n, n2;
+
+	no_plan ();
+
+	sprintf (in, "/tmp/t-012.%d.in", (int)getpid());
+	sprintf (out, "/tmp/t-012.%d.out", (int)getpid());
+
+	if (write_file(in, input, HAWK_SIZEOF(input) - 1) <= -1)
+	{
+		OK (0, "unable to write the input file");
+		return exit_status();
+	}
+
+	OK (run(HAWK_BYTEIO, in, out) == 0, "run with HAWK_BYTEIO");
+	n = read_file(out, buf, HAWK_SIZEOF(buf));
+	OK (n == HAWK_SIZEOF(expected) - 1 && memcmp(buf, expected, n) == 0, "bytes as characters");
+
+	/* the output is the same for ASCII input with or without HAWK_BYTEIO */
+	write_file (in, ascii, HAWK_SIZEOF(ascii) - 1);
+	OK (run(HAWK_BYTEIO, in, out) == 0, "run ASCII input with HAWK_BYTEIO");
+	n = read_file(out, buf, HAWK_SIZEOF(buf));
+	OK (run(0, in, out) == 0, "run ASCII input without HAWK_BYTEIO");
+	n2 = read_file(out, buf2, HAWK_SIZEOF(buf2));
+	OK (n > 0 && n == n2 && memcmp(buf, buf2, n) == 0, "same output for ASCII input");
+
+	unlink (in);
+	unlink (out);
+	return exit_status();
+}
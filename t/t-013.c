@@ -0,0 +1,125 @@
+#include <hawk-std.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "tap.h"
+
+/* the script keeps 10000 output streams open and writes to them in turn.
+ * the file handler below keeps no file open. it counts the requests only
+ * so that the time taken is mostly spent on finding the streams */
+#define NUM_OUTPUTS 10000
+
+static const hawk_bch_t* src =
+	"BEGIN {"
+	"	for (i = 0; i < 10000; i++) print \"x\" > (\"f\" i);"
+	"	for (r = 0; r < 20; r++) for (i = 0; i < 10000; i++) printf \"%d\", r > (\"f\" i);"
+	"	getline line < \"f7\";"
+	"	c = close(\"f7\");"
+	"	print \"again\" > \"f7\";"
+	"	fflush (\"f9\");"
+	"	for (i = 0; i < 10000; i += 2) c += close(\"f\" i);"
+	"	c += (close(\"f0\") < 0);"
+	"	exit c;"
+	"}";
+
+static hawk_oow_t num_opens, num_closes, num_flushes, num_bytes;
+
+static hawk_ooi_t file_handler (hawk_rtx_t* rtx, hawk_rio_cmd_t cmd, hawk_rio_arg_t* riod, void* data, hawk_oow_t size)
+{
+	switch (cmd)
+	{
+		case HAWK_RIO_CMD_OPEN:
+			num_opens++;
+			return 1;
+
+		case HAWK_RIO_CMD_CLOSE:
+			num_closes++;
+			return 0;
+
+		case HAWK_RIO_CMD_READ:
+		case HAWK_RIO_CMD_READ_BYTES:
+			return 0;
+
+		case HAWK_RIO_CMD_WRITE:
+		case HAWK_RIO_CMD_WRITE_BYTES:
+			num_bytes += size;
+			return size;
+
+		case HAWK_RIO_CMD_FLUSH:
+			num_flushes++;
+			return 0;
+
+		case HAWK_RIO_CMD_NEXT:
+			return -1;
+	}
+
+	return -1;
+}
+
+static int run (hawk_int_t* res)
+{
+	hawk_t* hawk = HAWK_NULL;
+	hawk_rtx_t* rtx = HAWK_NULL;
+	hawk_val_t* retv;
+	hawk_parsestd_t psin[2];
+	hawk_rio_cbs_t rio;
+	int ret = -1;
+
+	hawk = hawk_openstd(0, HAWK_NULL);
+	if (!hawk) goto oops;
+
+	memset (&psin, 0, HAWK_SIZEOF(psin));
+	psin[0].type = HAWK_PARSESTD_BCS;
+	psin[0].u.bcs.ptr = (hawk_bch_t*)src;
+	psin[0].u.bcs.len = hawk_count_bcstr(src);
+	psin[1].type = HAWK_PARSESTD_NULL;
+	if (hawk_parsestd(hawk, psin, HAWK_NULL) <= -1) goto oops;
+
+	rtx = hawk_rtx_openstd(hawk, 0, HAWK_T("t-013"), HAWK_NULL, HAWK_NULL, HAWK_NULL);
+	if (!rtx) goto oops;
+
+	hawk_rtx_getrio (rtx, &rio);
+	rio.file = file_handler;
+	hawk_rtx_setrio (rtx, &rio);
+
+	retv = hawk_rtx_loop(rtx);
+	if (!retv) goto oops;
+	ret = hawk_rtx_valtoint(rtx, retv, res);
+	hawk_rtx_refdownval (rtx, retv);
+
+oops:
+	if (rtx) hawk_rtx_close (rtx);
+	if (hawk) hawk_close (hawk);
+	return ret;
+}
+
+int main ()
+{
+	hawk_int_t c;
+	clock_t start;
+	char msg[128];
+
+	no_plan ();
+
+	start = clock();
+	OK (run(&c) == 0, "run with 10000 outputs");
+	sprintf (msg, "%.3f seconds with %d outputs", (double)(clock() - start) / CLOCKS_PER_SEC, NUM_OUTPUTS);
+	diag (msg);
+
+	/* close() returns 0 for each of the 5001 streams closed and -1 for
+	 * the stream already closed. */
+	OK (c == 1, "close by name");
+
+	/* one input stream is opened for f7. each output stream is opened
+	 * once as print to f7 after closing the input stream finds the output
+	 * stream still open. the rest is closed when the runtime context
+	 * is closed */
+	OK (num_opens == NUM_OUTPUTS + 1, "opened once per name and type");
+	OK (num_closes == NUM_OUTPUTS + 1, "closed once per stream");
+	OK (num_flushes >= 1, "flushed by name");
+
+	/* "x\n" followed by 10 one-digit and 10 two-digit numbers, plus "again\n" */
+	OK (num_bytes == NUM_OUTPUTS * 32 + 6, "written to the right streams");
+
+	return exit_status();
+}
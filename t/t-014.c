@@ -0,0 +1,135 @@
+#include <hawk-fmt.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap.h"
+
+/* the fast decimal formatters must produce what snprintf() produces
+ * for every value they accept */
+
+#if (HAWK_SIZEOF_FLT_T == HAWK_SIZEOF_LONG_DOUBLE)
+#	define FLT_LM "L"
+#	define FLT_ARG(x) ((long double)(x))
+#elif (HAWK_SIZEOF_FLT_T == HAWK_SIZEOF_DOUBLE)
+#	define FLT_LM ""
+#	define FLT_ARG(x) ((double)(x))
+#endif
+
+static const hawk_flt_t edge_values[] =
+{
+	0.0, -0.0, 1.0, -1.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.0625, 0.05, 0.15, 0.25,
+	0.1, 0.2, 0.3, 0.7, 2.675, 1.005, 9.5, 99.5, 999999.5, 9999995.0, 0.00001,
+	0.0001, 0.00009999995, 0.000099999949, 123456.0, 1234567.0, 999999.0,
+	1e15, 1e16, 1e17, 1e18, 1e19, 18446744073709549568.0, 1e20, 1e-19, 1e-20,
+	3.14159265358979, 2.718281828459045, 100.0, 1000000.0, 4294967295.0,
+	4294967296.5, 0.3333333333333333, 0.6666666666666666, 12345.678901,
+	-0.000001, -98765.4321
+};
+
+static int check (hawk_flt_t x, int conv, int prec)
+{
+	hawk_bch_t buf[128];
+	char exp[512];
+	char fmt[16];
+	int n;
+
+	n = hawk_fmt_flt_to_bcstr(buf, HAWK_COUNTOF(buf), x, conv, prec);
+	if (n <= -1) return 0; /* not handled. ok */
+
+	sprintf (fmt, "%%.%d" FLT_LM "%c", prec, conv);
+	snprintf (exp, HAWK_SIZEOF(exp), fmt, FLT_ARG(x));
+	if (strcmp(buf, exp) != 0 || n != (int)strlen(exp))
+	{
+		char msg[700];
+		sprintf (msg, "%s -> [%s] expected [%s]", fmt, buf, exp);
+		diag (msg);
+		return -1;
+	}
+	return 1;
+}
+
+static int check_all (hawk_flt_t x, int* handled)
+{
+	int prec, r, bad = 0;
+
+	for (prec = 0; prec <= 19; prec++)
+	{
+		r = check(x, 'g', prec);
+		if (r <= -1) bad++;
+		else *handled += r;
+
+		r = check(x, 'f', prec);
+		if (r <= -1) bad++;
+		else *handled += r;
+	}
+
+	return bad;
+}
+
+int main ()
+{
+	int i, bad, handled;
+	hawk_uint32_t seed = 12345;
+	hawk_bch_t bbuf[64], ebuf[64];
+	hawk_uch_t ubuf[64];
+
+	no_plan ();
+
+#if defined(FLT_LM)
+	bad = 0; handled = 0;
+	for (i = 0; i < HAWK_COUNTOF(edge_values); i++) bad += check_all(edge_values[i], &handled);
+	OK (bad == 0, "edge values");
+	OK (handled > 0, "edge values handled");
+
+	bad = 0; handled = 0;
+	for (i = 0; i < 20000; i++)
+	{
+		hawk_flt_t x;
+		int e;
+
+		/* random digits at random decimal scales, and random binary fractions */
+		seed = seed * 1103515245 + 12345;
+		x = (hawk_flt_t)(seed >> 4);
+		seed = seed * 1103515245 + 12345;
+		e = (int)(seed >> 16) % 30 - 15;
+		while (e > 0) { x *= 10; e--; }
+		while (e < 0) { x /= 10; e++; }
+		if (i & 1) x = -x;
+		bad += check_all(x, &handled);
+
+		seed = seed * 1103515245 + 12345;
+		x = (hawk_flt_t)(seed >> 8) / (hawk_flt_t)(1u << ((seed >> 3) % 24));
+		bad += check_all(x, &handled);
+	}
+	OK (bad == 0, "random values");
+	OK (handled > 0, "random values handled");
+#endif
+
+	OK (hawk_fmt_flt_to_bcstr(bbuf, HAWK_COUNTOF(bbuf), 1.5, 'e', 6) == -1, "unsupported conversion");
+	OK (hawk_fmt_flt_to_bcstr(bbuf, HAWK_COUNTOF(bbuf), 1e30, 'g', 6) == -1, "value too large");
+	OK (hawk_fmt_flt_to_bcstr(bbuf, 4, 1234.5, 'f', 2) == -1, "buffer too small");
+	OK (hawk_fmt_flt_to_ucstr(ubuf, HAWK_COUNTOF(ubuf), 0.1, 'g', 6) == 3 && ubuf[0] == '0' && ubuf[1] == '.' && ubuf[2] == '1' && ubuf[3] == '\0', "unicode string");
+
+	bad = 0;
+	seed = 54321;
+	for (i = 0; i < 100000; i++)
+	{
+		hawk_intmax_t v;
+		int n1, n2;
+
+		seed = seed * 1103515245 + 12345;
+		v = (hawk_intmax_t)seed << (i % 40);
+		if (i & 1) v = -v;
+		if (i == 0) v = 0;
+		if (i == 1) v = HAWK_TYPE_MAX(hawk_intmax_t);
+		if (i == 2) v = HAWK_TYPE_MIN(hawk_intmax_t);
+
+		n1 = hawk_fmt_intmax_to_decbcstr(bbuf, HAWK_COUNTOF(bbuf), v);
+		n2 = hawk_fmt_intmax_to_bcstr(ebuf, HAWK_COUNTOF(ebuf), v, 10, -1, '\0', HAWK_NULL);
+		if (n1 != n2 || strcmp(bbuf, ebuf) != 0) bad++;
+	}
+	OK (bad == 0, "decimal integers");
+	OK (hawk_fmt_intmax_to_decbcstr(bbuf, 3, 123) == -1, "integer buffer too small");
+	OK (hawk_fmt_intmax_to_decucstr(ubuf, 4, -12) == 3 && ubuf[0] == '-' && ubuf[1] == '1' && ubuf[2] == '2' && ubuf[3] == '\0', "unicode integer string");
+
+	return exit_status();
+}
@@ -0,0 +1,153 @@
+#include <hawk-utl.h>
+#include <hawk-chr.h>
+#include <stdio.h>
+#include <string.h>
+#include "tap.h"
+
+/* hawk_bchars_to_num() and hawk_uchars_to_num() take a short plain decimal
+ * number in a single pass. the result must be the same as what the full
+ * scan with hawk_bchars_to_int() and hawk_bchars_to_flt() produces */
+
+static int ref_bchars_to_num (int option, const hawk_bch_t* ptr, hawk_oow_t len, hawk_int_t* l, hawk_flt_t* r)
+{
+	const hawk_bch_t* endptr, * end = ptr + len;
+	int nopartial = HAWK_OOCHARS_TO_NUM_GET_OPTION_NOPARTIAL(option);
+	int reqsober = HAWK_OOCHARS_TO_NUM_GET_OPTION_REQSOBER(option);
+	int stripspc = HAWK_OOCHARS_TO_NUM_GET_OPTION_STRIPSPC(option);
+	int base = HAWK_OOCHARS_TO_NUM_GET_OPTION_BASE(option);
+	int is_sober;
+
+	*l = hawk_bchars_to_int(ptr, len, HAWK_OOCHARS_TO_INT_MAKE_OPTION(stripspc,0,base), &endptr, &is_sober);
+	if (endptr < end)
+	{
+		const hawk_bch_t* p = endptr;
+		while (p < end && hawk_is_bch_digit(*p)) p++;
+		if (p < end && (*p == '.' || *p == 'E' || *p == 'e'))
+		{
+			*r = hawk_bchars_to_flt(ptr, len, &endptr, stripspc);
+			if (nopartial && endptr < end) return -1;
+			return 1;
+		}
+
+		if (stripspc) while (endptr < end && hawk_is_bch_space(*endptr)) endptr++;
+	}
+
+	if (reqsober && !is_sober) return -1;
+	if (nopartial && endptr < end) return -1;
+	return 0;
+}
+
+static int same_flt (hawk_flt_t a, hawk_flt_t b)
+{
+	/* the sign of zero must match too */
+	return a == b && (a != 0 || (1 / a) == (1 / b));
+}
+
+static int check (const hawk_bch_t* str, int option)
+{
+	hawk_oow_t len = strlen(str), i;
+	hawk_int_t l1, l2, l3;
+	hawk_flt_t r1, r2, r3;
+	hawk_uch_t ustr[64];
+	int x1, x2, x3;
+
+	for (i = 0; i <= len; i++) ustr[i] = str[i];
+
+	x1 = ref_bchars_to_num(option, str, len, &l1, &r1);
+	x2 = hawk_bchars_to_num(option, str, len, &l2, &r2);
+	x3 = hawk_uchars_to_num(option, ustr, len, &l3, &r3);
+
+	if (x1 != x2 || x1 != x3 ||
+	    (x1 == 0 && (l1 != l2 || l1 != l3)) ||
+	    (x1 == 1 && (!same_flt(r1, r2) || !same_flt(r1, r3))))
+	{
+		char msg[128];
+		sprintf (msg, "[%s] option 0x%x -> %d %d %d", str, option, x1, x2, x3);
+		diag (msg);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int check_options (const hawk_bch_t* str)
+{
+	int bad = 0, nopartial, stripspc;
+
+	for (nopartial = 0; nopartial <= 1; nopartial++)
+	{
+		for (stripspc = 0; stripspc <= 1; stripspc++)
+		{
+			bad += check(str, HAWK_OOCHARS_TO_NUM_MAKE_OPTION(nopartial, 0, stripspc, 0));
+			bad += check(str, HAWK_OOCHARS_TO_NUM_MAKE_OPTION(nopartial, 1, stripspc, 10));
+		}
+	}
+
+	return bad;
+}
+
+static const hawk_bch_t* samples[] =
+{
+	"0", "-0", "+0", "00", "007", "08", "08.5", "012.5", "0x1f", "0b101", "1", "-1", "+12",
+	"123456789012345678", "1234567890123456789", "-999999999999999999", ".5", "-.5", "5.",
+	"0.1", "0.0000000001", "3.14159", "1e5", "1E-5", "1e", "1e+", "-2.5e+3", "1.5e22",
+	"1.5e23", "1e-22", "1e-23", "1e0005", "123.456e-7", "12abc", "1.2.3", " 42", "42 ",
+	" 42 ", "\t-7.25\n", "", " ", ".", "-", "--5", "+-5", "1 2", "1e5x", "9007199254740993",
+	"0.30000000000000004", "12345678.12345678", "123456789.123456789", "2024-01-01", "GET",
+	"e5", "-e5", ".e5", "- 5", "12 x", "12 .5", "1.5.3", "0-", "0 x", "0b", "-0x", "12e5e",
+	"7 ", "x12", "1.5 x", " -3.25e2 y"
+};
+
+static const hawk_bch_t junk[] = " -+.exXbB0a/";
+
+int main ()
+{
+	int i, j, bad;
+	hawk_uint32_t seed = 2718;
+	hawk_bch_t buf[48];
+
+	no_plan ();
+
+	bad = 0;
+	for (i = 0; i < HAWK_COUNTOF(samples); i++) bad += check_options(samples[i]);
+	OK (bad == 0, "samples");
+
+	bad = 0;
+	for (i = 0; i < 200000; i++)
+	{
+		int n = 0, nd;
+
+		/* random decimal numbers with random signs, points, exponents, spaces
+		 * and trailing characters */
+		seed = seed * 1103515245 + 12345;
+		if (seed & 0x10000000) buf[n++] = ' ';
+		if (seed & 0x20000000) buf[n++] = (seed & 0x40000000)? '-': '+';
+
+		nd = (seed >> 8) % 22;
+		for (j = 0; j < nd; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			buf[n++] = '0' + (seed >> 16) % 10;
+			if ((seed & 0x1F000) == 0x1F000) buf[n++] = '.';
+		}
+
+		seed = seed * 1103515245 + 12345;
+		if (nd > 0 && (seed & 0x1000)) buf[(seed >> 20) % n] = '.';
+		if (seed & 0x2000)
+		{
+			buf[n++] = (seed & 0x4000)? 'e': 'E';
+			if (seed & 0x8000) buf[n++] = (seed & 0x10000)? '-': '+';
+			nd = (seed >> 24) % 6;
+			for (j = 0; j < nd; j++) buf[n++] = '0' + (seed >> (j * 3)) % 10;
+		}
+		if (seed & 0x20000) buf[n++] = ' ';
+		if (seed & 0x40000) buf[n++] = junk[(seed >> 19) % (HAWK_COUNTOF(junk) - 1)];
+		if ((seed & 0xC0000) == 0xC0000) buf[n++] = '7';
+		buf[n] = '\0';
+
+		bad += check_options(buf);
+	}
+	OK (bad == 0, "random numbers");
+
+	return exit_status();
+}